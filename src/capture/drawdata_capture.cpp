@@ -0,0 +1,419 @@
+/*
+@file
+
+	drawdata_capture.cpp
+
+@purpose
+
+	Recording ImGui's draw data (what the renderer gets to paint each frame) into a file,
+	and loading it back, so renderers can be benchmarked on real sessions without running
+	the game logic (see tools/replay)
+*/
+
+#include "drawdata_capture.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+	const char magic[8] = { 'R', 'G', 'D', 'R', 'A', 'W', 'D', 'T' };
+
+	const uint32_t version = 2;
+
+	enum chunk_type_t : uint8_t
+	{
+		CHUNK_ATLAS = 1,
+		CHUNK_FRAME,
+		CHUNK_REPEAT
+	};
+
+	// How a draw command gets stored
+	struct command_t final
+	{
+
+		float clip_rect[4];
+
+		uint32_t elem_count, vtx_offset, idx_offset, texture;
+
+		uint8_t callback;
+
+	};
+
+	/*
+	@brief
+
+		Reads exactly @size bytes, false if the file ended before that
+	*/
+	bool read(FILE* file, void* data, size_t size)
+	{
+		return size == 0 || fread(data, size, 1, file) == 1;
+	}
+
+}
+
+/*
+@brief
+
+	Constructor
+*/
+retrogames::drawdata_recorder_t::drawdata_recorder_t() :
+	file(nullptr),
+	frame_count(0),
+	atlas_texture(nullptr),
+	atlas_width(0),
+	atlas_height(0),
+	atlas_pixels(nullptr) {}
+
+/*
+@brief
+
+	Destructor, closes the file
+*/
+retrogames::drawdata_recorder_t::~drawdata_recorder_t()
+{
+	close();
+}
+
+/*
+@brief
+
+	Creates (or truncates) the file at @path and writes the header
+*/
+bool retrogames::drawdata_recorder_t::open(const std::string& path, std::string* error/* = nullptr*/)
+{
+	close();
+
+	file = fopen(path.c_str(), "wb");
+
+	if (file == nullptr)
+	{
+		if (error) *error = "Couldn't create " + path;
+
+		return false;
+	}
+
+	const uint32_t sizes[] = { version, static_cast<uint32_t>(sizeof(ImDrawVert)), static_cast<uint32_t>(sizeof(ImDrawIdx)) };
+
+	if (fwrite(magic, sizeof(magic), 1, file) != 1 || fwrite(sizes, sizeof(sizes), 1, file) != 1)
+	{
+		if (error) *error = "Couldn't write to " + path;
+
+		close();
+
+		return false;
+	}
+
+	frame_count = 0;
+	atlas_texture = nullptr;
+	atlas_pixels = nullptr;
+	other_textures.clear();
+	previous_frame.clear();
+
+	return true;
+}
+
+/*
+@brief
+
+	Appends raw bytes to current_frame
+*/
+void retrogames::drawdata_recorder_t::append(const void* data, size_t size)
+{
+	auto bytes = static_cast<const uint8_t*>(data);
+
+	current_frame.insert(current_frame.end(), bytes, bytes + size);
+}
+
+/*
+@brief
+
+	Writes the font atlas if it changed since the last frame
+*/
+bool retrogames::drawdata_recorder_t::write_atlas_if_changed(void)
+{
+	auto fonts = ImGui::GetIO().Fonts;
+
+	// Backends either ask for alpha (imgui_sw) or RGBA (OpenGL, DirectX) data, we want whichever one exists
+	const void* pixels = fonts->TexPixelsAlpha8 != nullptr ? static_cast<const void*>(fonts->TexPixelsAlpha8) : static_cast<const void*>(fonts->TexPixelsRGBA32);
+
+	if (pixels == nullptr || (fonts->TexID == atlas_texture && pixels == atlas_pixels && fonts->TexWidth == atlas_width && fonts->TexHeight == atlas_height)) return true;
+
+	atlas_texture = fonts->TexID;
+	atlas_pixels = pixels;
+	atlas_width = fonts->TexWidth;
+	atlas_height = fonts->TexHeight;
+
+	std::vector<uint8_t> alpha(static_cast<size_t>(atlas_width) * atlas_height);
+
+	if (fonts->TexPixelsAlpha8 != nullptr) memcpy(alpha.data(), fonts->TexPixelsAlpha8, alpha.size());
+	else for (size_t i = 0; i < alpha.size(); i++) alpha[i] = static_cast<uint8_t>(fonts->TexPixelsRGBA32[i] >> IM_COL32_A_SHIFT);
+
+	// Distance fields have to be drawn differently, replaying them as coverage gets the text wrong
+	const int32_t size[] = { atlas_width, atlas_height, (fonts->Flags & ImFontAtlasFlags_SignedDistanceField) ? fonts->TexSdfSpread : 0 };
+	const uint8_t type = CHUNK_ATLAS;
+
+	// The previous frame was painted with another atlas, so the next one can't be a repeat of it
+	previous_frame.clear();
+
+	return fwrite(&type, sizeof(type), 1, file) == 1 && fwrite(size, sizeof(size), 1, file) == 1 && fwrite(alpha.data(), alpha.size(), 1, file) == 1;
+}
+
+/*
+@brief
+
+	Appends a frame (call after ImGui::Render(), with ImGui::GetDrawData())
+*/
+bool retrogames::drawdata_recorder_t::record(const ImDrawData* draw_data)
+{
+	if (file == nullptr || draw_data == nullptr || !draw_data->Valid) return false;
+
+	if (!write_atlas_if_changed()) return false;
+
+	current_frame.clear();
+
+	const float display[] = { draw_data->DisplayPos.x, draw_data->DisplayPos.y, draw_data->DisplaySize.x, draw_data->DisplaySize.y, draw_data->FramebufferScale.x, draw_data->FramebufferScale.y };
+	const uint32_t list_count = static_cast<uint32_t>(draw_data->CmdListsCount);
+
+	append(display, sizeof(display));
+	append(&list_count, sizeof(list_count));
+
+	for (int i = 0; i < draw_data->CmdListsCount; i++)
+	{
+		auto list = draw_data->CmdLists[i];
+		const uint32_t counts[] = { static_cast<uint32_t>(list->VtxBuffer.Size), static_cast<uint32_t>(list->IdxBuffer.Size), static_cast<uint32_t>(list->CmdBuffer.Size) };
+
+		append(counts, sizeof(counts));
+		append(list->VtxBuffer.Data, list->VtxBuffer.size_in_bytes());
+		append(list->IdxBuffer.Data, list->IdxBuffer.size_in_bytes());
+
+		for (const auto& cmd : list->CmdBuffer)
+		{
+			command_t command;
+
+			memset(&command, 0, sizeof(command));
+
+			command.clip_rect[0] = cmd.ClipRect.x;
+			command.clip_rect[1] = cmd.ClipRect.y;
+			command.clip_rect[2] = cmd.ClipRect.z;
+			command.clip_rect[3] = cmd.ClipRect.w;
+			command.elem_count = cmd.ElemCount;
+			command.vtx_offset = cmd.VtxOffset;
+			command.idx_offset = cmd.IdxOffset;
+			command.callback = cmd.UserCallback != nullptr;
+
+			if (cmd.TextureId != atlas_texture)
+			{
+				auto it = std::find(other_textures.begin(), other_textures.end(), cmd.TextureId);
+
+				if (it == other_textures.end()) it = other_textures.insert(other_textures.end(), cmd.TextureId);
+
+				command.texture = static_cast<uint32_t>(it - other_textures.begin()) + 1;
+			}
+
+			append(&command, sizeof(command));
+		}
+	}
+
+	// Menus sit still most of the time, so don't write the same frame over and over
+	auto repeat = current_frame == previous_frame;
+	const uint8_t type = repeat ? CHUNK_REPEAT : CHUNK_FRAME;
+
+	if (fwrite(&type, sizeof(type), 1, file) != 1) return false;
+
+	if (!repeat)
+	{
+		if (fwrite(current_frame.data(), current_frame.size(), 1, file) != 1) return false;
+
+		previous_frame.swap(current_frame);
+	}
+
+	frame_count++;
+
+	return true;
+}
+
+/*
+@brief
+
+	Flushes and closes the file
+*/
+void retrogames::drawdata_recorder_t::close(void)
+{
+	if (file == nullptr) return;
+
+	fclose(file);
+
+	file = nullptr;
+}
+
+/*
+@brief
+
+	Constructor
+*/
+retrogames::drawdata_player_t::drawdata_player_t() :
+	dropped_commands(0) {}
+
+/*
+@brief
+
+	Loads every frame in the file at @path into memory, so replaying doesn't touch the disk
+*/
+bool retrogames::drawdata_player_t::load(const std::string& path, std::string* error/* = nullptr*/)
+{
+	atlases.clear();
+	unique_frames.clear();
+	frames.clear();
+	dropped_commands = 0;
+
+	std::unique_ptr<FILE, int(*)(FILE*)> file(fopen(path.c_str(), "rb"), fclose);
+
+	if (!file)
+	{
+		if (error) *error = "Couldn't open " + path;
+
+		return false;
+	}
+
+	char file_magic[sizeof(magic)];
+	uint32_t sizes[3];
+
+	if (!read(file.get(), file_magic, sizeof(file_magic)) || memcmp(file_magic, magic, sizeof(magic)) != 0 || !read(file.get(), sizes, sizeof(sizes)))
+	{
+		if (error) *error = path + " isn't a draw data recording";
+
+		return false;
+	}
+
+	if (sizes[0] != version || sizes[1] != sizeof(ImDrawVert) || sizes[2] != sizeof(ImDrawIdx))
+	{
+		if (error) *error = path + " was recorded with another version or ImGui configuration";
+
+		return false;
+	}
+
+	uint8_t type;
+
+	while (read(file.get(), &type, sizeof(type)))
+	{
+		if (type == CHUNK_ATLAS)
+		{
+			int32_t size[3];
+
+			if (!read(file.get(), size, sizeof(size)) || size[0] <= 0 || size[1] <= 0 || size[2] < 0) break;
+
+			atlas_t atlas;
+
+			atlas.width = size[0];
+			atlas.height = size[1];
+			atlas.sdf_spread = size[2];
+			atlas.alpha.resize(static_cast<size_t>(atlas.width) * atlas.height);
+
+			if (!read(file.get(), atlas.alpha.data(), atlas.alpha.size())) break;
+
+			atlases.push_back(std::move(atlas));
+		}
+		else if (type == CHUNK_REPEAT)
+		{
+			if (frames.empty()) break;
+
+			frames.push_back(frames.back());
+		}
+		else if (type == CHUNK_FRAME)
+		{
+			if (atlases.empty()) break;
+
+			std::unique_ptr<frame_t> frame(new frame_t);
+			float display[6];
+			uint32_t list_count;
+
+			if (!read(file.get(), display, sizeof(display)) || !read(file.get(), &list_count, sizeof(list_count))) break;
+
+			frame->atlas = atlases.size() - 1;
+
+			auto complete = true;
+
+			for (uint32_t i = 0; i < list_count && complete; i++)
+			{
+				uint32_t counts[3];
+
+				if (!read(file.get(), counts, sizeof(counts))) { complete = false; break; }
+
+				// The lists are never drawn into, so they don't need ImGui's shared data
+				std::unique_ptr<ImDrawList> list(new ImDrawList(nullptr));
+
+				list->VtxBuffer.resize(static_cast<int>(counts[0]));
+				list->IdxBuffer.resize(static_cast<int>(counts[1]));
+
+				complete = read(file.get(), list->VtxBuffer.Data, list->VtxBuffer.size_in_bytes()) && read(file.get(), list->IdxBuffer.Data, list->IdxBuffer.size_in_bytes());
+
+				for (uint32_t c = 0; c < counts[2] && complete; c++)
+				{
+					command_t command;
+
+					if (!read(file.get(), &command, sizeof(command))) { complete = false; break; }
+
+					// Callbacks point into the recording process, and we don't have the other textures
+					if (command.callback || command.texture != 0)
+					{
+						dropped_commands++;
+
+						continue;
+					}
+
+					ImDrawCmd cmd;
+
+					cmd.ClipRect = ImVec4(command.clip_rect[0], command.clip_rect[1], command.clip_rect[2], command.clip_rect[3]);
+					cmd.ElemCount = command.elem_count;
+					cmd.VtxOffset = command.vtx_offset;
+					cmd.IdxOffset = command.idx_offset;
+
+					list->CmdBuffer.push_back(cmd);
+				}
+
+				frame->list_pointers.push_back(list.get());
+				frame->lists.push_back(std::move(list));
+				frame->draw_data.TotalVtxCount += static_cast<int>(counts[0]);
+				frame->draw_data.TotalIdxCount += static_cast<int>(counts[1]);
+			}
+
+			if (!complete) break;
+
+			frame->draw_data.Valid = true;
+			frame->draw_data.CmdLists = frame->list_pointers.data();
+			frame->draw_data.CmdListsCount = static_cast<int>(frame->list_pointers.size());
+			frame->draw_data.DisplayPos = ImVec2(display[0], display[1]);
+			frame->draw_data.DisplaySize = ImVec2(display[2], display[3]);
+			frame->draw_data.FramebufferScale = ImVec2(display[4], display[5]);
+
+			frames.push_back(frame.get());
+			unique_frames.push_back(std::move(frame));
+		}
+		else break;
+	}
+
+	// A recording that got cut off (the game crashed, or got killed) is still useful up to there
+	if (!feof(file.get()) && frames.empty())
+	{
+		if (error) *error = path + " is corrupt";
+
+		return false;
+	}
+
+	return true;
+}
+
+/*
+@brief
+
+	Points every draw command at @texture_id, which has to be the font atlas of the renderer
+	we replay with (filled with get_atlases()[frame.atlas])
+*/
+void retrogames::drawdata_player_t::set_font_texture(ImTextureID texture_id)
+{
+	for (auto& frame : unique_frames)
+		for (auto& list : frame->lists)
+			for (auto& cmd : list->CmdBuffer)
+				cmd.TextureId = texture_id;
+}
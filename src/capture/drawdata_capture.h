@@ -0,0 +1,218 @@
+/*
+@file
+
+	drawdata_capture.h
+
+@purpose
+
+	Recording ImGui's draw data (what the renderer gets to paint each frame) into a file,
+	and loading it back, so renderers can be benchmarked on real sessions without running
+	the game logic (see tools/replay)
+
+@format
+
+	Native byte order, meant to be replayed on the same kind of machine that recorded it.
+
+	header:  "RGDRAWDT", uint32 version, uint32 sizeof(ImDrawVert), uint32 sizeof(ImDrawIdx)
+	chunks:  uint8 type, followed by
+	         atlas:  int32 width, int32 height, int32 distance field spread (0 for coverage), width * height
+	                 alpha bytes (the font atlas, whenever it changed)
+	         frame:  float display pos/size/framebuffer scale (6), uint32 list count, and per list:
+	                 uint32 vertex/index/command count, the raw vertices and indices, and per command:
+	                 float clip rect (4), uint32 elem count, vertex offset, index offset, texture
+	                 (0 is the font atlas, everything else can't be replayed) and uint8 "was a callback"
+	         repeat: nothing, the frame is the same as the one before (idle menus cost a byte per frame)
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "imgui/imgui.h"
+
+namespace retrogames
+{
+
+	class drawdata_recorder_t final
+	{
+
+	protected:
+
+
+
+	private:
+
+		FILE* file;
+
+		uint64_t frame_count;
+
+		// The font atlas we've written last, so we only write it again when it changes
+		ImTextureID atlas_texture;
+		int atlas_width, atlas_height;
+		const void* atlas_pixels;
+
+		// Textures other than the font atlas, in the order we've seen them (their index + 1 gets written)
+		std::vector<ImTextureID> other_textures;
+
+		// The last frame we've written, and the one we're writing (to detect repeated frames)
+		std::vector<uint8_t> previous_frame, current_frame;
+
+		/*
+		@brief
+
+			Writes the font atlas if it changed since the last frame
+		*/
+		bool write_atlas_if_changed(void);
+
+		/*
+		@brief
+
+			Appends raw bytes to current_frame
+		*/
+		void append(const void* data, size_t size);
+
+	public:
+
+		/*
+		@brief
+
+			Constructor
+		*/
+		drawdata_recorder_t();
+
+		/*
+		@brief
+
+			Destructor, closes the file
+		*/
+		~drawdata_recorder_t();
+
+		/*
+		@brief
+
+			Creates (or truncates) the file at @path and writes the header
+		*/
+		bool open(const std::string& path, std::string* error = nullptr);
+
+		/*
+		@brief
+
+			Appends a frame (call after ImGui::Render(), with ImGui::GetDrawData())
+		*/
+		bool record(const ImDrawData* draw_data);
+
+		/*
+		@brief
+
+			Flushes and closes the file
+		*/
+		void close(void);
+
+		/*
+		@brief
+
+			Gets the amount of frames recorded so far
+		*/
+		uint64_t get_frame_count(void) const { return frame_count; }
+
+	};
+
+	class drawdata_player_t final
+	{
+
+	public:
+
+		struct atlas_t final
+		{
+
+			int width, height;
+
+			// ImFontAtlas::TexSdfSpread of a signed distance field atlas, 0 if alpha is coverage
+			int sdf_spread;
+
+			std::vector<uint8_t> alpha;
+
+		};
+
+		struct frame_t final
+		{
+
+			// Index into get_atlases(), the font atlas this frame was painted with
+			size_t atlas;
+
+			std::vector<std::unique_ptr<ImDrawList>> lists;
+
+			std::vector<ImDrawList*> list_pointers;
+
+			ImDrawData draw_data;
+
+		};
+
+	protected:
+
+
+
+	private:
+
+		std::vector<atlas_t> atlases;
+
+		// Every distinct frame...
+		std::vector<std::unique_ptr<frame_t>> unique_frames;
+
+		// ...and the order they were recorded in (repeated frames point to the same one)
+		std::vector<const frame_t*> frames;
+
+		// Commands using textures we can't replay, which got dropped
+		uint64_t dropped_commands;
+
+	public:
+
+		/*
+		@brief
+
+			Constructor
+		*/
+		drawdata_player_t();
+
+		/*
+		@brief
+
+			Loads every frame in the file at @path into memory, so replaying doesn't touch the disk
+		*/
+		bool load(const std::string& path, std::string* error = nullptr);
+
+		/*
+		@brief
+
+			Points every draw command at @texture_id, which has to be the font atlas of the renderer
+			we replay with (filled with get_atlases()[frame.atlas])
+		*/
+		void set_font_texture(ImTextureID texture_id);
+
+		/*
+		@brief
+
+			Gets the recorded frames, in order
+		*/
+		const std::vector<const frame_t*>& get_frames(void) const { return frames; }
+
+		/*
+		@brief
+
+			Gets the recorded font atlases
+		*/
+		const std::vector<atlas_t>& get_atlases(void) const { return atlases; }
+
+		/*
+		@brief
+
+			Gets the amount of draw commands dropped because they used a texture other than the font atlas
+		*/
+		uint64_t get_dropped_commands(void) const { return dropped_commands; }
+
+	};
+
+}
@@ -0,0 +1,401 @@
+/*
+@file
+
+	latency_probe.cpp
+
+@purpose
+
+	Measuring input-to-photon latency (see latency_probe.h)
+*/
+
+#include "latency_probe.h"
+#include "misc/clock.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+
+	/*
+	@brief
+
+		Gets the milliseconds from @from to @to
+	*/
+	double to_ms(const std::chrono::high_resolution_clock::time_point& from, const std::chrono::high_resolution_clock::time_point& to)
+	{
+		return std::chrono::duration<double, std::milli>(to - from).count();
+	}
+
+}
+
+/*
+@brief
+
+	Constructor
+*/
+retrogames::latency_probe_t::latency_probe_t() :
+	enabled(false),
+	next_id(1),
+	key_stamped(false),
+	key_dispatching(false),
+	key_sample(0),
+	frame(0),
+	awaiting_present(false),
+	overlay{} {}
+
+/*
+@brief
+
+	Destructor, logs a session that's still running
+*/
+retrogames::latency_probe_t::~latency_probe_t()
+{
+	end_session();
+}
+
+/*
+@brief
+
+	Starts measuring a session named @name (ends the previous one)
+*/
+void retrogames::latency_probe_t::begin_session(const std::string& name)
+{
+	end_session();
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	session_name = name;
+	overlay = {};
+
+	enabled = true;
+}
+
+/*
+@brief
+
+	Stops measuring, logs the session if any input made it to the screen
+*/
+void retrogames::latency_probe_t::end_session(void)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (!enabled) return;
+
+	enabled = false;
+
+	if (!finished.empty()) write_log();
+
+	samples.clear();
+	finished.clear();
+	awaiting_present = false;
+}
+
+/*
+@brief
+
+	Remembers when the key event that's about to be handed to main_handle_key arrived.
+	Platforms that don't call this get the time main_handle_key ran at
+*/
+void retrogames::latency_probe_t::stamp_event(void)
+{
+	if (!enabled.load(std::memory_order_relaxed)) return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	key_time = get_clock().now();
+	key_stamped = true;
+}
+
+/*
+@brief
+
+	Called by main_handle_key around handing the key to the menu and game
+*/
+void retrogames::latency_probe_t::begin_key(void)
+{
+	if (!enabled.load(std::memory_order_relaxed)) return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (!key_stamped) key_time = get_clock().now();
+
+	key_stamped = false;
+	key_dispatching = true;
+	key_sample = 0;
+}
+
+void retrogames::latency_probe_t::end_key(void)
+{
+	if (!enabled.load(std::memory_order_relaxed)) return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	key_dispatching = false;
+}
+
+/*
+@brief
+
+	Starts following the key the game is handling (call from its handle_key).
+	Returns the input's id to hand to took_effect/discard/submitted, 0 if we're not measuring
+*/
+uint32_t retrogames::latency_probe_t::accept(void)
+{
+	if (!enabled.load(std::memory_order_relaxed)) return 0;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (!key_dispatching) return 0;
+
+	// A game accepting the same key twice still only pressed it once
+	if (key_sample != 0) return key_sample;
+
+	if (samples.size() >= max_in_flight) samples.pop_front();
+
+	sample_t sample{};
+
+	sample.id = next_id++;
+	sample.event = key_time;
+	sample.stage = sample_t::stage_e::STAGE_ACCEPTED;
+
+	samples.push_back(sample);
+
+	key_sample = sample.id;
+
+	return sample.id;
+}
+
+/*
+@brief
+
+	The input @id changed the game in tick @tick (any thread)
+*/
+void retrogames::latency_probe_t::took_effect(uint32_t id, uint64_t tick)
+{
+	if (id == 0) return;
+
+	auto now = get_clock().now();
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (auto& sample : samples)
+	{
+		if (sample.id != id || sample.stage != sample_t::stage_e::STAGE_ACCEPTED) continue;
+
+		sample.effect = now;
+		sample.tick = tick;
+		sample.stage = sample_t::stage_e::STAGE_EFFECT;
+
+		break;
+	}
+}
+
+/*
+@brief
+
+	The input @id didn't change anything, forget about it (any thread)
+*/
+void retrogames::latency_probe_t::discard(uint32_t id)
+{
+	if (id == 0) return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	samples.erase(std::remove_if(samples.begin(), samples.end(), [id](const sample_t& sample) { return sample.id == id; }), samples.end());
+}
+
+/*
+@brief
+
+	The current frame draws the result of every input up to @id that took effect
+*/
+void retrogames::latency_probe_t::submitted(uint32_t id)
+{
+	if (id == 0) return;
+
+	auto now = get_clock().now();
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	for (auto& sample : samples)
+	{
+		if (sample.id > id) break;
+		if (sample.stage != sample_t::stage_e::STAGE_EFFECT) continue;
+
+		sample.submit = now;
+		sample.frame = frame;
+		sample.stage = sample_t::stage_e::STAGE_SUBMITTED;
+
+		awaiting_present = true;
+	}
+}
+
+/*
+@brief
+
+	Called by main_frame before drawing
+*/
+void retrogames::latency_probe_t::begin_frame(void)
+{
+	if (!enabled.load(std::memory_order_relaxed)) return;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	frame++;
+}
+
+/*
+@brief
+
+	Called by the platform once the frame got swapped (or painted), finishes
+	the inputs it drew
+*/
+void retrogames::latency_probe_t::presented(void)
+{
+	if (!awaiting_present.exchange(false)) return;
+
+	auto now = get_clock().now();
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto last = std::stable_partition(samples.begin(), samples.end(), [](const sample_t& sample) { return sample.stage != sample_t::stage_e::STAGE_SUBMITTED; });
+
+	for (auto it = last; it != samples.end(); ++it)
+	{
+		it->present = now;
+
+		finished.push_back(*it);
+	}
+
+	samples.erase(last, samples.end());
+
+	// Update the overlay
+	std::vector<double> totals;
+
+	totals.reserve(finished.size());
+
+	for (const auto& sample : finished) totals.push_back(to_ms(sample.event, sample.present));
+
+	overlay = calculate_percentiles(totals);
+}
+
+/*
+@brief
+
+	Gets the current frame's number
+*/
+uint64_t retrogames::latency_probe_t::get_frame(void)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	return frame;
+}
+
+/*
+@brief
+
+	Gets the session's input-to-photon percentiles, false if no input finished yet
+*/
+bool retrogames::latency_probe_t::get_overlay(percentiles_t& percentiles)
+{
+	if (!enabled.load(std::memory_order_relaxed)) return false;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (finished.empty()) return false;
+
+	percentiles = overlay;
+
+	return true;
+}
+
+/*
+@brief
+
+	Gets the percentiles of @values (sorts them)
+*/
+retrogames::latency_probe_t::percentiles_t retrogames::latency_probe_t::calculate_percentiles(std::vector<double>& values)
+{
+	percentiles_t percentiles{};
+
+	if (values.empty()) return percentiles;
+
+	std::sort(values.begin(), values.end());
+
+	// Nearest rank
+	auto rank = [&values](double percentile) -> double
+	{
+		auto index = static_cast<size_t>(std::ceil(percentile * static_cast<double>(values.size())));
+
+		return values[std::min(std::max<size_t>(index, 1), values.size()) - 1];
+	};
+
+	percentiles.p50 = rank(.5);
+	percentiles.p90 = rank(.9);
+	percentiles.p99 = rank(.99);
+	percentiles.max = values.back();
+
+	return percentiles;
+}
+
+/*
+@brief
+
+	Writes the session's summary and samples to stdout and latency.log (mutex held)
+*/
+void retrogames::latency_probe_t::write_log(void)
+{
+	std::vector<double> totals, inputs, outputs;
+
+	for (const auto& sample : finished)
+	{
+		totals.push_back(to_ms(sample.event, sample.present));
+		inputs.push_back(to_ms(sample.event, sample.effect));
+		outputs.push_back(to_ms(sample.effect, sample.present));
+	}
+
+	auto total = calculate_percentiles(totals);
+	auto input = calculate_percentiles(inputs);
+	auto output = calculate_percentiles(outputs);
+
+	char summary[512];
+
+	snprintf(summary, sizeof(summary),
+		"latency [%s] %zu inputs (ms, p50/p90/p99/max): key to photon %.2f/%.2f/%.2f/%.2f, key to tick %.2f/%.2f/%.2f/%.2f, tick to photon %.2f/%.2f/%.2f/%.2f",
+		session_name.c_str(), finished.size(),
+		total.p50, total.p90, total.p99, total.max,
+		input.p50, input.p90, input.p99, input.max,
+		output.p50, output.p90, output.p99, output.max);
+
+	printf("%s\n", summary);
+
+	auto file = fopen("latency.log", "a");
+
+	if (file == nullptr) return;
+
+	fprintf(file, "%s\n", summary);
+
+	for (const auto& sample : finished)
+	{
+		fprintf(file, "%u tick %llu effect %.3f frame %llu submit %.3f present %.3f\n",
+			sample.id,
+			static_cast<unsigned long long>(sample.tick), to_ms(sample.event, sample.effect),
+			static_cast<unsigned long long>(sample.frame), to_ms(sample.event, sample.submit),
+			to_ms(sample.event, sample.present));
+	}
+
+	fclose(file);
+}
+
+/*
+@brief
+
+	Gets the probe everything reports to
+*/
+retrogames::latency_probe_t& retrogames::get_latency_probe(void)
+{
+	static latency_probe_t probe;
+
+	return probe;
+}
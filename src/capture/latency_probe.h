@@ -0,0 +1,246 @@
+/*
+@file
+
+	latency_probe.h
+
+@purpose
+
+	Measuring input-to-photon latency. Every key press a game reacts to gets followed from the
+	platform's key event, through main_handle_key and the game's handle_key, to the tick it took
+	effect in and the frame that drew the result and got swapped. Each game session (from starting
+	a game until leaving it) reports percentiles in an overlay and, once it ends, in a log
+
+@usage
+
+	platform:   stamp_event() as the key event arrives, presented() after swapping a frame
+	main:       begin_key()/end_key() around handing a key to the menu, begin_frame() every frame
+	games:      accept() in handle_key for keys they react to, took_effect() in the tick that
+	            applied it (or discard() if it didn't change anything), submitted() in the frame
+	            that draws the result
+
+@format
+
+	latency.log, appended to once per session: a summary line, then one line per input with
+	the times since its key event in ms:
+	"<input> tick <tick> effect <ms> frame <frame> submit <ms> present <ms>"
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace retrogames
+{
+
+	class latency_probe_t final
+	{
+
+	public:
+
+		// Percentiles of one stage of a session, in milliseconds
+		struct percentiles_t final
+		{
+
+			double p50, p90, p99, max;
+
+		};
+
+	protected:
+
+
+
+	private:
+
+		using time_point = std::chrono::high_resolution_clock::time_point;
+
+		// An input on its way to the screen
+		struct sample_t final
+		{
+
+			uint32_t id;
+
+			time_point event, effect, submit, present;
+
+			uint64_t tick, frame;
+
+			enum class stage_e : uint8_t
+			{
+				STAGE_ACCEPTED,
+				STAGE_EFFECT,
+				STAGE_SUBMITTED
+			} stage;
+
+		};
+
+		// Inputs still in flight (the oldest get dropped past this, e.g. keys a paused game never applies)
+		static constexpr size_t max_in_flight = 64;
+
+		std::mutex mutex;
+
+		// Only measuring while a session runs
+		std::atomic<bool> enabled;
+
+		std::string session_name;
+
+		// In flight, ordered by id
+		std::deque<sample_t> samples;
+
+		// Done (presented) in this session
+		std::vector<sample_t> finished;
+
+		uint32_t next_id;
+
+		// The key event being handed to the game (see begin_key), and whether the game took it
+		time_point key_time;
+		bool key_stamped, key_dispatching;
+		uint32_t key_sample;
+
+		uint64_t frame;
+
+		// Anything submitted but not presented yet (so presented() doesn't have to lock every frame)
+		std::atomic<bool> awaiting_present;
+
+		// Cached for the overlay, updated whenever an input finishes
+		percentiles_t overlay;
+
+		/*
+		@brief
+
+			Gets the percentiles of @values (sorts them)
+		*/
+		static percentiles_t calculate_percentiles(std::vector<double>& values);
+
+		/*
+		@brief
+
+			Writes the session's summary and samples to stdout and latency.log (mutex held)
+		*/
+		void write_log(void);
+
+	public:
+
+		/*
+		@brief
+
+			Constructor
+		*/
+		latency_probe_t();
+
+		/*
+		@brief
+
+			Destructor, logs a session that's still running
+		*/
+		~latency_probe_t();
+
+		/*
+		@brief
+
+			Starts measuring a session named @name (ends the previous one)
+		*/
+		void begin_session(const std::string& name);
+
+		/*
+		@brief
+
+			Stops measuring, logs the session if any input made it to the screen
+		*/
+		void end_session(void);
+
+		/*
+		@brief
+
+			Checks if a session is running
+		*/
+		bool is_enabled(void) const { return enabled.load(std::memory_order_relaxed); }
+
+		/*
+		@brief
+
+			Remembers when the key event that's about to be handed to main_handle_key arrived.
+			Platforms that don't call this get the time main_handle_key ran at
+		*/
+		void stamp_event(void);
+
+		/*
+		@brief
+
+			Called by main_handle_key around handing the key to the menu and game
+		*/
+		void begin_key(void);
+		void end_key(void);
+
+		/*
+		@brief
+
+			Starts following the key the game is handling (call from its handle_key).
+			Returns the input's id to hand to took_effect/discard/submitted, 0 if we're not measuring
+		*/
+		uint32_t accept(void);
+
+		/*
+		@brief
+
+			The input @id changed the game in tick @tick (any thread)
+		*/
+		void took_effect(uint32_t id, uint64_t tick);
+
+		/*
+		@brief
+
+			The input @id didn't change anything, forget about it (any thread)
+		*/
+		void discard(uint32_t id);
+
+		/*
+		@brief
+
+			The current frame draws the result of every input up to @id that took effect
+		*/
+		void submitted(uint32_t id);
+
+		/*
+		@brief
+
+			Called by main_frame before drawing
+		*/
+		void begin_frame(void);
+
+		/*
+		@brief
+
+			Called by the platform once the frame got swapped (or painted), finishes
+			the inputs it drew
+		*/
+		void presented(void);
+
+		/*
+		@brief
+
+			Gets the current frame's number
+		*/
+		uint64_t get_frame(void);
+
+		/*
+		@brief
+
+			Gets the session's input-to-photon percentiles, false if no input finished yet
+		*/
+		bool get_overlay(percentiles_t& percentiles);
+
+	};
+
+	/*
+	@brief
+
+		Gets the probe everything reports to
+	*/
+	latency_probe_t& get_latency_probe(void);
+
+}
@@ -0,0 +1,164 @@
+/*
+@file
+
+	startup_trace.cpp
+
+@purpose
+
+	Measuring the time to the first frame (see startup_trace.h)
+*/
+
+#include "startup_trace.h"
+#include <algorithm>
+#include <cstdio>
+
+/*
+@brief
+
+	Constructor, starts the stage @name
+*/
+retrogames::startup_trace_t::stage_t::stage_t(startup_trace_t& trace, const std::string& name) :
+	trace(&trace),
+	name(name),
+	begin(std::chrono::high_resolution_clock::now()) {}
+
+/*
+@brief
+
+	Ends the stage before it goes out of scope
+*/
+void retrogames::startup_trace_t::stage_t::end(void)
+{
+	if (trace == nullptr) return;
+
+	trace->add(name, begin, std::chrono::high_resolution_clock::now());
+
+	trace = nullptr;
+}
+
+/*
+@brief
+
+	Constructor, the time we launched at
+*/
+retrogames::startup_trace_t::startup_trace_t() :
+	launch(std::chrono::high_resolution_clock::now()),
+	main_thread(std::this_thread::get_id()),
+	first_frame_done(false) {}
+
+/*
+@brief
+
+	Gets the milliseconds from launching until @point
+*/
+double retrogames::startup_trace_t::since_launch(const time_point& point) const
+{
+	return std::chrono::duration<double, std::milli>(point - launch).count();
+}
+
+/*
+@brief
+
+	Adds a stage that ran from @begin to @end (any thread, see stage_t)
+*/
+void retrogames::startup_trace_t::add(const std::string& name, const time_point& begin, const time_point& end)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	records.push_back({ name, begin, end, std::this_thread::get_id() != main_thread });
+}
+
+/*
+@brief
+
+	Called by the platform once the first frame got swapped (or painted).
+	Only the first call counts
+*/
+void retrogames::startup_trace_t::first_frame(void)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (first_frame_done) return;
+
+	first_frame_time = std::chrono::high_resolution_clock::now();
+	first_frame_done = true;
+}
+
+/*
+@brief
+
+	Gets a one line summary of the stages and the time to the first frame
+*/
+std::string retrogames::startup_trace_t::get_summary(void)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto sorted = records;
+
+	std::stable_sort(sorted.begin(), sorted.end(), [](const record_t& a, const record_t& b) { return a.begin < b.begin; });
+
+	std::string summary = "startup (ms):";
+
+	char buffer[128];
+
+	for (const auto& record : sorted)
+	{
+		snprintf(buffer, sizeof(buffer), " %s %.2f%s,", record.name.c_str(), std::chrono::duration<double, std::milli>(record.end - record.begin).count(), record.worker ? " (worker)" : "");
+
+		summary += buffer;
+	}
+
+	if (first_frame_done) snprintf(buffer, sizeof(buffer), " first frame at %.2f", since_launch(first_frame_time));
+	else snprintf(buffer, sizeof(buffer), " no frame yet");
+
+	return summary + buffer;
+}
+
+/*
+@brief
+
+	Writes every stage into the file at @path (see @format)
+*/
+bool retrogames::startup_trace_t::write(const std::string& path, std::string* error/* = nullptr*/)
+{
+	auto file = fopen(path.c_str(), "w");
+
+	if (file == nullptr)
+	{
+		if (error != nullptr) *error = "Failed to open " + path + " for writing";
+
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto sorted = records;
+
+	std::stable_sort(sorted.begin(), sorted.end(), [](const record_t& a, const record_t& b) { return a.begin < b.begin; });
+
+	for (const auto& record : sorted)
+	{
+		fprintf(file, "%s %s %.3f %.3f %.3f\n",
+			record.name.c_str(), record.worker ? "worker" : "main",
+			since_launch(record.begin), since_launch(record.end),
+			std::chrono::duration<double, std::milli>(record.end - record.begin).count());
+	}
+
+	if (first_frame_done) fprintf(file, "first_frame %.3f\n", since_launch(first_frame_time));
+
+	fclose(file);
+
+	return true;
+}
+
+/*
+@brief
+
+	Gets the trace the platform's startup reports to
+*/
+retrogames::startup_trace_t& retrogames::get_startup_trace(void)
+{
+	static startup_trace_t trace;
+
+	return trace;
+}
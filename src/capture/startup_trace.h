@@ -0,0 +1,174 @@
+/*
+@file
+
+	startup_trace.h
+
+@purpose
+
+	Measuring how long it takes from launching until the first frame is on the screen.
+	The platform's main marks the stages of its startup (loading the settings, decoding the
+	sounds, creating the window, ...), some of which run on worker threads next to the others,
+	and the first frame it presented. The trace only gets written (and its summary printed) when
+	asked for with --startup-trace
+
+@usage
+
+	startup_trace_t::stage_t stage(get_startup_trace(), "window");  times everything until it goes out of scope
+	get_startup_trace().first_frame();                             after the first frame got swapped (or painted)
+	get_startup_trace().write(path);                               writes every stage into a file
+
+@format
+
+	One line per stage, ordered by the time it began, times in ms since launching:
+	"<stage> <main|worker> <begin> <end> <duration>"
+	and a last line "first_frame <ms>"
+*/
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace retrogames
+{
+
+	class startup_trace_t final
+	{
+
+	protected:
+
+
+
+	private:
+
+		using time_point = std::chrono::high_resolution_clock::time_point;
+
+		struct record_t final
+		{
+
+			std::string name;
+
+			time_point begin, end;
+
+			// Ran next to the main thread
+			bool worker;
+
+		};
+
+		std::mutex mutex;
+
+		// When we got created (the first thing the platform's main does)
+		time_point launch;
+
+		// Where the stages on the main thread run
+		std::thread::id main_thread;
+
+		std::vector<record_t> records;
+
+		// When the first frame got presented (launch until then)
+		time_point first_frame_time;
+
+		bool first_frame_done;
+
+		/*
+		@brief
+
+			Gets the milliseconds from launching until @point
+		*/
+		double since_launch(const time_point& point) const;
+
+	public:
+
+		// Times a stage from its construction until it goes out of scope (or end() gets called)
+		class stage_t final
+		{
+
+		protected:
+
+
+
+		private:
+
+			startup_trace_t* trace;
+
+			std::string name;
+
+			time_point begin;
+
+		public:
+
+			/*
+			@brief
+
+				Constructor, starts the stage @name
+			*/
+			stage_t(startup_trace_t& trace, const std::string& name);
+
+			/*
+			@brief
+
+				Destructor, ends the stage if it didn't end already
+			*/
+			~stage_t() { end(); }
+
+			stage_t(const stage_t&) = delete;
+			stage_t& operator=(const stage_t&) = delete;
+
+			/*
+			@brief
+
+				Ends the stage before it goes out of scope
+			*/
+			void end(void);
+
+		};
+
+		/*
+		@brief
+
+			Constructor, the time we launched at
+		*/
+		startup_trace_t();
+
+		/*
+		@brief
+
+			Adds a stage that ran from @begin to @end (any thread, see stage_t)
+		*/
+		void add(const std::string& name, const time_point& begin, const time_point& end);
+
+		/*
+		@brief
+
+			Called by the platform once the first frame got swapped (or painted).
+			Only the first call counts
+		*/
+		void first_frame(void);
+
+		/*
+		@brief
+
+			Gets a one line summary of the stages and the time to the first frame
+		*/
+		std::string get_summary(void);
+
+		/*
+		@brief
+
+			Writes every stage into the file at @path (see @format)
+		*/
+		bool write(const std::string& path, std::string* error = nullptr);
+
+	};
+
+	/*
+	@brief
+
+		Gets the trace the platform's startup reports to
+	*/
+	startup_trace_t& get_startup_trace(void);
+
+}
@@ -0,0 +1,652 @@
+/*
+@file
+
+	video_capture.cpp
+
+@purpose
+
+	Recording gameplay into a video (raw Y4M) and an audio track (WAV) next to it
+*/
+
+#include "video_capture.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef PLATFORM_LINUX
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+	// The audio track's format
+	const uint32_t sample_rate = 44100;
+	const uint16_t channels = 2;
+
+	/*
+	@brief
+
+		Reads a little endian integer of @size bytes at @data
+	*/
+	uint32_t read_le(const uint8_t* data, size_t size)
+	{
+		uint32_t value = 0;
+
+		for (size_t i = 0; i < size; i++) value |= static_cast<uint32_t>(data[i]) << (i * 8);
+
+		return value;
+	}
+
+	/*
+	@brief
+
+		Appends @value as a little endian integer of @size bytes to @data
+	*/
+	void write_le(uint8_t* data, uint32_t value, size_t size)
+	{
+		for (size_t i = 0; i < size; i++) data[i] = static_cast<uint8_t>(value >> (i * 8));
+	}
+
+	/*
+	@brief
+
+		Builds a WAV header for @data_size bytes of our audio format
+	*/
+	std::array<uint8_t, 44> make_wav_header(uint32_t data_size)
+	{
+		std::array<uint8_t, 44> header;
+
+		memcpy(header.data(), "RIFF", 4);
+		write_le(header.data() + 4, 36 + data_size, 4);
+		memcpy(header.data() + 8, "WAVEfmt ", 8);
+		write_le(header.data() + 16, 16, 4);
+		write_le(header.data() + 20, 1, 2); // PCM
+		write_le(header.data() + 22, channels, 2);
+		write_le(header.data() + 24, sample_rate, 4);
+		write_le(header.data() + 28, sample_rate * channels * 2, 4);
+		write_le(header.data() + 32, channels * 2, 2);
+		write_le(header.data() + 34, 16, 2);
+		memcpy(header.data() + 36, "data", 4);
+		write_le(header.data() + 40, data_size, 4);
+
+		return header;
+	}
+
+	/*
+	@brief
+
+		Turns the average of up to four RGBA pixels' colors (@r, @g and @b are sums of @count pixels)
+		into full range BT.601 chroma
+	*/
+	void rgb_to_chroma(uint32_t r, uint32_t g, uint32_t b, uint32_t count, uint8_t& u, uint8_t& v)
+	{
+		auto red = static_cast<int32_t>(r / count);
+		auto green = static_cast<int32_t>(g / count);
+		auto blue = static_cast<int32_t>(b / count);
+
+		u = static_cast<uint8_t>((-43 * red - 85 * green + 128 * blue + 32896) >> 8);
+		v = static_cast<uint8_t>((128 * red - 107 * green - 21 * blue + 32896) >> 8);
+	}
+
+}
+
+/*
+@brief
+
+	Constructor
+*/
+retrogames::video_recorder_t::video_recorder_t() :
+	video_file(nullptr),
+	audio_file(nullptr),
+	fps(60),
+	stopping(false),
+	pending_repeats(0),
+	frames_lent(0),
+	frames_returned(0),
+	next_frame(0),
+	dropped_frames(0),
+	video_width(0),
+	video_height(0),
+	frames_written(0),
+	audio_bytes_written(0),
+	write_failed(false) {}
+
+/*
+@brief
+
+	Destructor, finishes recording
+*/
+retrogames::video_recorder_t::~video_recorder_t()
+{
+	close();
+}
+
+/*
+@brief
+
+	Makes the .wav file @data (of @size bytes, 16 bit PCM) available as sound @id
+*/
+bool retrogames::video_recorder_t::set_sound(uint32_t id, const uint8_t* data, size_t size)
+{
+	if (is_open() || data == nullptr || size < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0) return false;
+
+	uint32_t format_channels = 0, format_rate = 0, format_bits = 0;
+
+	const uint8_t* samples = nullptr;
+	size_t samples_size = 0;
+
+	// Walk the chunks, we only care about the format and the samples
+	for (size_t offset = 12; offset + 8 <= size;)
+	{
+		auto chunk_size = static_cast<size_t>(read_le(data + offset + 4, 4));
+		auto chunk = data + offset + 8;
+
+		if (chunk_size > size - offset - 8) chunk_size = size - offset - 8;
+
+		if (memcmp(data + offset, "fmt ", 4) == 0 && chunk_size >= 16)
+		{
+			if (read_le(chunk, 2) != 1) return false;
+
+			format_channels = read_le(chunk + 2, 2);
+			format_rate = read_le(chunk + 4, 4);
+			format_bits = read_le(chunk + 14, 2);
+		}
+		else if (memcmp(data + offset, "data", 4) == 0)
+		{
+			samples = chunk;
+			samples_size = chunk_size;
+		}
+
+		offset += 8 + chunk_size + (chunk_size & 1);
+	}
+
+	if (samples == nullptr || format_bits != 16 || (format_channels != 1 && format_channels != 2) || format_rate == 0) return false;
+
+	// Store them as 16 bit stereo (like we write them), resampling happens while mixing
+	sound_t sound;
+
+	auto frame_count = samples_size / (2 * format_channels);
+
+	sound.samples.resize(frame_count * channels);
+	sound.step = static_cast<double>(format_rate) / static_cast<double>(sample_rate);
+
+	for (size_t i = 0; i < frame_count; i++)
+	{
+		auto left = static_cast<int16_t>(read_le(samples + i * 2 * format_channels, 2));
+		auto right = format_channels == 2 ? static_cast<int16_t>(read_le(samples + i * 4 + 2, 2)) : left;
+
+		sound.samples[i * 2] = left;
+		sound.samples[i * 2 + 1] = right;
+	}
+
+	if (sounds.size() <= id) sounds.resize(id + 1);
+
+	sounds[id] = std::move(sound);
+
+	return true;
+}
+
+/*
+@brief
+
+	Creates (or truncates) the video at @path (@width x @height) and the audio track next to it,
+	then starts the writer thread
+*/
+bool retrogames::video_recorder_t::open(const std::string& path, uint32_t fps, int width, int height, std::string* error/* = nullptr*/)
+{
+	close();
+
+	if (width <= 0 || height <= 0)
+	{
+		if (error) *error = "Invalid video size";
+
+		return false;
+	}
+
+	auto extension = path.find_last_of('.');
+	auto audio_path = (extension != std::string::npos && path.find_first_of("/\\", extension) == std::string::npos ? path.substr(0, extension) : path) + ".wav";
+
+	video_file = fopen(path.c_str(), "wb");
+
+	if (video_file == nullptr)
+	{
+		if (error) *error = "Couldn't create " + path;
+
+		return false;
+	}
+
+	this->fps = fps == 0 ? 60 : fps;
+
+	audio_file = fopen(audio_path.c_str(), "wb");
+
+	auto header = make_wav_header(0);
+
+	if (fprintf(video_file, "YUV4MPEG2 W%d H%d F%u:1 Ip A1:1 C420jpeg\n", width, height, this->fps) < 0 ||
+		audio_file == nullptr || fwrite(header.data(), header.size(), 1, audio_file) != 1)
+	{
+		if (error) *error = "Couldn't create " + audio_path;
+
+		fclose(video_file);
+
+		video_file = nullptr;
+
+		if (audio_file != nullptr) fclose(audio_file);
+
+		audio_file = nullptr;
+
+		return false;
+	}
+
+	// Frames are big, give the writes some room
+	setvbuf(video_file, nullptr, _IOFBF, 1 << 20);
+
+	stopping = false;
+	pending_repeats = 0;
+	next_frame = 0;
+	dropped_frames = 0;
+	video_width = width;
+	video_height = height;
+	frames_written = 0;
+	audio_bytes_written = 0;
+	write_failed = false;
+
+	voices.clear();
+	sound_events.clear();
+
+	auto chroma_size = static_cast<size_t>((width + 1) / 2) * static_cast<size_t>((height + 1) / 2);
+
+	yuv.resize(static_cast<size_t>(width) * static_cast<size_t>(height) + chroma_size * 2);
+	padded_row.assign(static_cast<size_t>(width) * 4, 0);
+
+	// Whatever the last recording left in there (the writer hands out the buffers again)
+	uint32_t buffer;
+
+	while (free_buffers.pop(buffer));
+
+	thread = std::thread(&video_recorder_t::run, this);
+
+	return true;
+}
+
+/*
+@brief
+
+	Records a frame of @width x @height RGBA pixels (game thread)
+*/
+bool retrogames::video_recorder_t::add_frame(const void* pixels, int width, int height, bool bottom_up/* = false*/)
+{
+	return queue_frame(pixels, width, height, bottom_up, false);
+}
+
+/*
+@brief
+
+	Like add_frame, without copying. @pixels have to stay valid until wait_returned(@ticket)
+*/
+bool retrogames::video_recorder_t::lend_frame(const void* pixels, int width, int height, bool bottom_up, uint64_t& ticket)
+{
+	if (!queue_frame(pixels, width, height, bottom_up, true)) return false;
+
+	ticket = ++frames_lent;
+
+	return true;
+}
+
+/*
+@brief
+
+	Waits until the writer is done with the pixels of lend_frame's @ticket (game thread)
+*/
+void retrogames::video_recorder_t::wait_returned(uint64_t ticket)
+{
+	// Converting takes a few ms, by the time the caller needs its pixels back they usually are
+	if (frames_returned.load(std::memory_order_acquire) >= ticket) return;
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	returned_condition.wait(lock, [this, ticket]() { return frames_returned.load(std::memory_order_acquire) >= ticket; });
+}
+
+/*
+@brief
+
+	Queues a frame of @width x @height RGBA pixels, copied into a free buffer unless @lend is set
+*/
+bool retrogames::video_recorder_t::queue_frame(const void* pixels, int width, int height, bool bottom_up, bool lend)
+{
+	if (!is_open() || width <= 0 || height <= 0) return false;
+
+	uint32_t buffer_index;
+
+	if (!free_buffers.pop(buffer_index))
+	{
+		// The writer is behind, the previous frame gets repeated in this one's place (keeps the timing intact)
+		pending_repeats++;
+
+		dropped_frames.fetch_add(1, std::memory_order_relaxed);
+		next_frame.fetch_add(1, std::memory_order_relaxed);
+
+		return false;
+	}
+
+	auto& buffer = buffers[buffer_index];
+	auto size = static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+
+	if (lend)
+	{
+		buffer.lent = static_cast<const uint8_t*>(pixels);
+	}
+	else
+	{
+		// Buffers start out at the video's size, this only happens after switching to a bigger video mode
+		if (buffer.pixels.size() < size) buffer.pixels.resize(size);
+
+		memcpy(buffer.pixels.data(), pixels, size);
+
+		buffer.lent = nullptr;
+	}
+
+	buffer.width = width;
+	buffer.height = height;
+	buffer.bottom_up = bottom_up;
+
+	// There's always room, the queue holds more than we have buffers
+	frames.push(frame_t{ buffer_index, pending_repeats });
+
+	pending_repeats = 0;
+
+	next_frame.fetch_add(1, std::memory_order_relaxed);
+
+	// The writer only holds the lock while checking for work, so this doesn't wait on writes
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+	}
+
+	condition.notify_one();
+
+	return true;
+}
+
+/*
+@brief
+
+	Mixes sound @id into the audio track, starting at the current frame (any thread)
+*/
+void retrogames::video_recorder_t::play_sound(uint32_t id, float volume/* = 100.f*/)
+{
+	if (!is_open() || id >= sounds.size() || sounds[id].samples.empty()) return;
+
+	std::lock_guard<std::mutex> lock(sound_events_mutex);
+
+	sound_events.push_back(sound_event_t{ next_frame.load(std::memory_order_relaxed), id, volume });
+}
+
+/*
+@brief
+
+	Writes everything still queued and closes the files
+*/
+bool retrogames::video_recorder_t::close(std::string* error/* = nullptr*/)
+{
+	if (!is_open()) return true;
+
+	// Frames dropped at the very end still need their repeats. The writer returns buffers
+	// as it goes, so there's going to be room in the queue
+	if (pending_repeats != 0)
+	{
+		while (!frames.push(frame_t{ buffer_count, pending_repeats })) std::this_thread::yield();
+
+		pending_repeats = 0;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		stopping = true;
+	}
+
+	condition.notify_one();
+
+	thread.join();
+
+	// Now that we know how much audio there is, fill in the sizes
+	auto header = make_wav_header(static_cast<uint32_t>(std::min<uint64_t>(audio_bytes_written, UINT32_MAX - 36)));
+
+	if (fseek(audio_file, 0, SEEK_SET) != 0 || fwrite(header.data(), header.size(), 1, audio_file) != 1) write_failed = true;
+
+	if (fclose(video_file) != 0) write_failed = true;
+	if (fclose(audio_file) != 0) write_failed = true;
+
+	video_file = nullptr;
+	audio_file = nullptr;
+
+	if (write_failed && error) *error = "Couldn't write the recorded video (is the disk full?)";
+
+	return !write_failed;
+}
+
+/*
+@brief
+
+	The writer thread's main loop
+*/
+void retrogames::video_recorder_t::run(void)
+{
+#ifdef PLATFORM_LINUX
+	// Writing can wait, the game can't (matters when both have to share a core)
+	setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#endif
+
+	// Allocate the buffers here, so the game thread doesn't spend its first frames on page faults
+	for (uint32_t i = 0; i < buffer_count; i++)
+	{
+		buffers[i].pixels.resize(static_cast<size_t>(video_width) * static_cast<size_t>(video_height) * 4);
+		buffers[i].lent = nullptr;
+
+		free_buffers.push(i);
+	}
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (true)
+	{
+		frame_t frame;
+
+		if (!frames.pop(frame))
+		{
+			if (stopping) break;
+
+			condition.wait(lock, [this]() { return stopping || !frames.empty(); });
+
+			continue;
+		}
+
+		// Don't hold the lock while converting and writing, add_frame() takes it to wake us up
+		lock.unlock();
+
+		for (uint32_t i = 0; i < frame.repeats; i++) write_frame();
+
+		if (frame.buffer < buffer_count)
+		{
+			auto& buffer = buffers[frame.buffer];
+
+			convert(buffer);
+
+			// The lender can have its pixels back
+			if (buffer.lent != nullptr)
+			{
+				buffer.lent = nullptr;
+
+				frames_returned.fetch_add(1, std::memory_order_release);
+
+				{
+					std::lock_guard<std::mutex> returned_lock(mutex);
+				}
+
+				returned_condition.notify_all();
+			}
+
+			free_buffers.push(frame.buffer);
+
+			write_frame();
+		}
+
+		lock.lock();
+	}
+}
+
+/*
+@brief
+
+	Converts @buffer into our YUV frame
+*/
+void retrogames::video_recorder_t::convert(const buffer_t& buffer)
+{
+	// Rows of the frame as we write it, frames of another size get cropped or padded with black
+	auto row = [&](int y) -> const uint8_t*
+	{
+		if (y >= buffer.height)
+		{
+			std::fill(padded_row.begin(), padded_row.end(), 0);
+
+			return padded_row.data();
+		}
+
+		auto source = (buffer.lent != nullptr ? buffer.lent : buffer.pixels.data()) + static_cast<size_t>(buffer.bottom_up ? buffer.height - 1 - y : y) * static_cast<size_t>(buffer.width) * 4;
+
+		if (buffer.width >= video_width) return source;
+
+		memcpy(padded_row.data(), source, static_cast<size_t>(buffer.width) * 4);
+		memset(padded_row.data() + static_cast<size_t>(buffer.width) * 4, 0, static_cast<size_t>(video_width - buffer.width) * 4);
+
+		return padded_row.data();
+	};
+
+	auto chroma_width = (video_width + 1) / 2;
+
+	auto y_plane = yuv.data();
+	auto u_plane = y_plane + static_cast<size_t>(video_width) * static_cast<size_t>(video_height);
+	auto v_plane = u_plane + static_cast<size_t>(chroma_width) * static_cast<size_t>((video_height + 1) / 2);
+
+	// Chroma is sampled from 2x2 blocks, keep both rows of a block around
+	std::vector<uint8_t> upper_row(static_cast<size_t>(video_width) * 4);
+
+	for (int y = 0; y < video_height; y += 2)
+	{
+		memcpy(upper_row.data(), row(y), upper_row.size());
+
+		auto has_lower_row = y + 1 < video_height;
+		auto lower_row = has_lower_row ? row(y + 1) : upper_row.data();
+
+		auto y_upper = y_plane + static_cast<size_t>(y) * static_cast<size_t>(video_width);
+		auto y_lower = y_upper + video_width;
+		auto u = u_plane + static_cast<size_t>(y / 2) * static_cast<size_t>(chroma_width);
+		auto v = v_plane + static_cast<size_t>(y / 2) * static_cast<size_t>(chroma_width);
+
+		for (int x = 0; x < video_width; x += 2)
+		{
+			uint32_t r = 0, g = 0, b = 0, count = 0;
+
+			auto add = [&](const uint8_t* pixel, uint8_t* luma)
+			{
+				*luma = static_cast<uint8_t>((77 * pixel[0] + 150 * pixel[1] + 29 * pixel[2] + 128) >> 8);
+
+				r += pixel[0];
+				g += pixel[1];
+				b += pixel[2];
+				count++;
+			};
+
+			uint8_t unused;
+
+			add(upper_row.data() + x * 4, y_upper + x);
+			add(lower_row + x * 4, has_lower_row ? y_lower + x : &unused);
+
+			if (x + 1 < video_width)
+			{
+				add(upper_row.data() + (x + 1) * 4, y_upper + x + 1);
+				add(lower_row + (x + 1) * 4, has_lower_row ? y_lower + x + 1 : &unused);
+			}
+
+			rgb_to_chroma(r, g, b, count, u[x / 2], v[x / 2]);
+		}
+	}
+}
+
+/*
+@brief
+
+	Writes the current YUV frame and the audio that goes with it
+*/
+void retrogames::video_recorder_t::write_frame(void)
+{
+	if (!write_failed)
+	{
+		if (fwrite("FRAME\n", 6, 1, video_file) != 1 || fwrite(yuv.data(), yuv.size(), 1, video_file) != 1) write_failed = true;
+	}
+
+	write_audio();
+
+	frames_written++;
+}
+
+/*
+@brief
+
+	Mixes the audio of the frame we're about to write
+*/
+void retrogames::video_recorder_t::write_audio(void)
+{
+	// Sounds played up to this frame start now
+	{
+		std::lock_guard<std::mutex> lock(sound_events_mutex);
+
+		auto started = std::remove_if(sound_events.begin(), sound_events.end(), [this](const sound_event_t& event)
+		{
+			if (event.frame > frames_written) return false;
+
+			voices.push_back(voice_t{ &sounds[event.id], 0., event.volume / 100.f });
+
+			return true;
+		});
+
+		sound_events.erase(started, sound_events.end());
+	}
+
+	// Frames don't line up with samples, spread the remainder so the track doesn't drift
+	auto sample_count = static_cast<size_t>((frames_written + 1) * sample_rate / fps - frames_written * sample_rate / fps);
+
+	mix_buffer.assign(sample_count * channels, 0);
+
+	for (auto& voice : voices)
+	{
+		auto sound_frames = voice.sound->samples.size() / channels;
+
+		for (size_t i = 0; i < sample_count; i++, voice.position += voice.sound->step)
+		{
+			auto source = static_cast<size_t>(voice.position);
+
+			if (source >= sound_frames) break;
+
+			mix_buffer[i * 2] += static_cast<int32_t>(voice.sound->samples[source * 2] * voice.volume);
+			mix_buffer[i * 2 + 1] += static_cast<int32_t>(voice.sound->samples[source * 2 + 1] * voice.volume);
+		}
+	}
+
+	voices.erase(std::remove_if(voices.begin(), voices.end(), [](const voice_t& voice)
+	{
+		return static_cast<size_t>(voice.position) >= voice.sound->samples.size() / channels;
+	}), voices.end());
+
+	audio_samples.resize(mix_buffer.size());
+
+	for (size_t i = 0; i < mix_buffer.size(); i++) audio_samples[i] = static_cast<int16_t>(std::min(std::max(mix_buffer[i], -32768), 32767));
+
+	if (write_failed || audio_samples.empty()) return;
+
+	if (fwrite(audio_samples.data(), audio_samples.size() * sizeof(int16_t), 1, audio_file) != 1) write_failed = true;
+
+	audio_bytes_written += audio_samples.size() * sizeof(int16_t);
+}
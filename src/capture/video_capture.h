@@ -0,0 +1,298 @@
+/*
+@file
+
+	video_capture.h
+
+@purpose
+
+	Recording gameplay into a video (raw Y4M) and an audio track (WAV) next to it, for bug reports
+	and attract loops. The game thread only copies each frame into a free buffer (or lends it, when
+	the pixels stay valid for a while anyway), converting and writing happens on a background thread
+
+@format
+
+	video: YUV4MPEG2, 4:2:0 full range (C420jpeg), at the size and frame rate passed to open().
+	       Every recorded frame is one video frame, a frame the writer had no buffer for repeats
+	       the one before. Frames of another size (after a video mode change) get cropped or
+	       padded with black
+	audio: WAV, 16 bit stereo PCM at 44.1kHz, the sounds played while recording mixed together
+	       (starting at the frame they were played in)
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "misc/spsc_queue.h"
+
+namespace retrogames
+{
+
+	class video_recorder_t final
+	{
+
+	protected:
+
+
+
+	private:
+
+		// Frames waiting to be written at most, recording drops frames (repeats the last one) beyond that
+		static const uint32_t buffer_count = 8;
+
+		struct buffer_t final
+		{
+
+			// RGBA
+			std::vector<uint8_t> pixels;
+
+			// The caller's pixels instead of ours (see lend_frame), nullptr once they're back
+			const uint8_t* lent;
+
+			int width, height;
+
+			// Rows go from the bottom to the top (OpenGL)
+			bool bottom_up;
+
+		};
+
+		struct frame_t final
+		{
+
+			uint32_t buffer;
+
+			// How often the frame before this one has to be repeated first (frames we had no buffer for)
+			uint32_t repeats;
+
+		};
+
+		// A .wav file's samples, in the format we write
+		struct sound_t final
+		{
+
+			std::vector<int16_t> samples;
+
+			// How far to move through the samples per output sample (their sample rate / ours)
+			double step;
+
+		};
+
+		struct sound_event_t final
+		{
+
+			// The video frame the sound starts in
+			uint64_t frame;
+
+			uint32_t id;
+
+			float volume;
+
+		};
+
+		// A sound being mixed into the audio track
+		struct voice_t final
+		{
+
+			const sound_t* sound;
+
+			double position;
+
+			float volume;
+
+		};
+
+		FILE* video_file;
+		FILE* audio_file;
+
+		uint32_t fps;
+
+		std::array<buffer_t, buffer_count> buffers;
+
+		// Game thread -> writer thread
+		spsc_queue_t<frame_t, buffer_count * 2> frames;
+
+		// Writer thread -> game thread
+		spsc_queue_t<uint32_t, buffer_count> free_buffers;
+
+		std::thread thread;
+
+		std::mutex mutex;
+
+		std::condition_variable condition;
+
+		bool stopping;
+
+		// Game thread only: frames dropped since the last one that got a buffer
+		uint32_t pending_repeats;
+
+		// Game thread only: frames handed out by lend_frame()
+		uint64_t frames_lent;
+
+		// Lent frames the writer is done with (in the order they got lent)
+		std::atomic<uint64_t> frames_returned;
+
+		std::condition_variable returned_condition;
+
+		// The frame the next call to add_frame() records (stamps sound events)
+		std::atomic<uint64_t> next_frame;
+
+		std::atomic<uint64_t> dropped_frames;
+
+		std::vector<sound_t> sounds;
+
+		std::mutex sound_events_mutex;
+
+		std::vector<sound_event_t> sound_events;
+
+		int video_width, video_height;
+
+		// Writer thread only
+		std::vector<uint8_t> yuv;
+
+		std::vector<uint8_t> padded_row;
+
+		std::vector<voice_t> voices;
+
+		std::vector<int32_t> mix_buffer;
+		std::vector<int16_t> audio_samples;
+
+		uint64_t frames_written;
+		uint64_t audio_bytes_written;
+
+		bool write_failed;
+
+		/*
+		@brief
+
+			Queues a frame of @width x @height RGBA pixels, copied into a free buffer unless @lend is set
+		*/
+		bool queue_frame(const void* pixels, int width, int height, bool bottom_up, bool lend);
+
+		/*
+		@brief
+
+			The writer thread's main loop
+		*/
+		void run(void);
+
+		/*
+		@brief
+
+			Converts @buffer into our YUV frame
+		*/
+		void convert(const buffer_t& buffer);
+
+		/*
+		@brief
+
+			Writes the current YUV frame and the audio that goes with it
+		*/
+		void write_frame(void);
+
+		/*
+		@brief
+
+			Mixes the audio of the frame we're about to write
+		*/
+		void write_audio(void);
+
+	public:
+
+		/*
+		@brief
+
+			Constructor
+		*/
+		video_recorder_t();
+
+		/*
+		@brief
+
+			Destructor, finishes recording
+		*/
+		~video_recorder_t();
+
+		/*
+		@brief
+
+			Makes the .wav file @data (of @size bytes, 16 bit PCM) available as sound @id.
+			Has to be called before open()
+		*/
+		bool set_sound(uint32_t id, const uint8_t* data, size_t size);
+
+		/*
+		@brief
+
+			Creates (or truncates) the video at @path (@width x @height) and the audio track next to it
+			(@path with .wav as its extension), then starts the writer thread
+		*/
+		bool open(const std::string& path, uint32_t fps, int width, int height, std::string* error = nullptr);
+
+		/*
+		@brief
+
+			Records a frame of @width x @height RGBA pixels (game thread). Only copies them, returns
+			false if the writer is behind and the frame got dropped
+		*/
+		bool add_frame(const void* pixels, int width, int height, bool bottom_up = false);
+
+		/*
+		@brief
+
+			Like add_frame, without copying: the writer converts straight from @pixels, which have to
+			stay valid until wait_returned(@ticket). Returns false if the frame got dropped (nothing to wait for)
+		*/
+		bool lend_frame(const void* pixels, int width, int height, bool bottom_up, uint64_t& ticket);
+
+		/*
+		@brief
+
+			Waits until the writer is done with the pixels of lend_frame's @ticket (game thread)
+		*/
+		void wait_returned(uint64_t ticket);
+
+		/*
+		@brief
+
+			Mixes sound @id into the audio track, starting at the current frame (any thread)
+		*/
+		void play_sound(uint32_t id, float volume = 100.f);
+
+		/*
+		@brief
+
+			Writes everything still queued and closes the files
+		*/
+		bool close(std::string* error = nullptr);
+
+		/*
+		@brief
+
+			Checks if we're recording
+		*/
+		bool is_open(void) const { return video_file != nullptr; }
+
+		/*
+		@brief
+
+			Gets the amount of frames recorded so far (including dropped ones)
+		*/
+		uint64_t get_frame_count(void) const { return next_frame.load(std::memory_order_relaxed); }
+
+		/*
+		@brief
+
+			Gets the amount of frames dropped because the writer was behind
+		*/
+		uint64_t get_dropped_frames(void) const { return dropped_frames.load(std::memory_order_relaxed); }
+
+	};
+
+}
@@ -0,0 +1,782 @@
+/*
+@file
+
+	font_service.cpp
+
+@purpose
+
+	Owning every font in ImGui's atlas, with an on-disk cache of baked atlases
+*/
+
+#include "font_service.h"
+#include "imgui/imgui.h"
+#include "imgui/imgui_user.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#if defined(PLATFORM_LINUX)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif defined(PLATFORM_WINDOWS)
+#include <windows.h>
+#endif
+
+namespace
+{
+
+	const char magic[8] = { 'R', 'G', 'F', 'O', 'N', 'T', 'C', 'A' };
+
+	const uint32_t version = 1;
+
+	// How many atlases the cache file keeps (one per resolution we've used, pretty much)
+	const uint32_t max_cache_entries = 8;
+
+	// The only font we have (ImGui's embedded one)
+	const char font_name[] = "ProggyClean";
+
+	// The size the distance field font gets rasterized at. ProggyClean is drawn on a 13 pixel grid,
+	// with 4 texels per grid pixel its corners stay square even when scaled up to 4K sizes
+	const float distance_field_size = 52.f;
+
+	// How far (in texels) the distance field reaches past the outlines, enough to draw the font down to a quarter of that size
+	const int distance_field_spread = 4;
+
+	/*
+	@brief
+
+		A read-only view of a whole file, memory-mapped where we can
+	*/
+	class mapped_file_t final
+	{
+
+	private:
+
+		const uint8_t* data;
+
+		size_t size;
+
+#if defined(PLATFORM_WINDOWS)
+		HANDLE mapping;
+#elif !defined(PLATFORM_LINUX)
+		std::vector<uint8_t> buffer;
+#endif
+
+	public:
+
+		/*
+		@brief
+
+			Constructor, maps @path (check get_data() to see if that worked)
+		*/
+		mapped_file_t(const std::string& path) :
+			data(nullptr),
+			size(0)
+#if defined(PLATFORM_WINDOWS)
+			, mapping(nullptr)
+#endif
+		{
+#if defined(PLATFORM_LINUX)
+			auto fd = open(path.c_str(), O_RDONLY);
+
+			if (fd == -1) return;
+
+			struct stat info;
+
+			if (fstat(fd, &info) == 0 && info.st_size > 0)
+			{
+				auto mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+				if (mapped != MAP_FAILED)
+				{
+					data = static_cast<const uint8_t*>(mapped);
+					size = static_cast<size_t>(info.st_size);
+				}
+			}
+
+			// The mapping stays valid without the descriptor
+			close(fd);
+#elif defined(PLATFORM_WINDOWS)
+			auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+			if (file == INVALID_HANDLE_VALUE) return;
+
+			LARGE_INTEGER file_size;
+
+			if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+			{
+				mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+				if (mapping != nullptr)
+				{
+					data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+					size = data != nullptr ? static_cast<size_t>(file_size.QuadPart) : 0;
+				}
+			}
+
+			// Same here, the mapping keeps the file open
+			CloseHandle(file);
+#else
+			// No mapping on the other platforms, just read it
+			std::unique_ptr<FILE, int(*)(FILE*)> file(fopen(path.c_str(), "rb"), fclose);
+
+			if (file == nullptr) return;
+
+			uint8_t chunk[4096];
+			size_t read;
+
+			while ((read = fread(chunk, 1, sizeof(chunk), file.get())) != 0) buffer.insert(buffer.end(), chunk, chunk + read);
+
+			if (buffer.empty()) return;
+
+			data = buffer.data();
+			size = buffer.size();
+#endif
+		}
+
+		/*
+		@brief
+
+			Destructor, unmaps the file
+		*/
+		~mapped_file_t()
+		{
+#if defined(PLATFORM_LINUX)
+			if (data != nullptr) munmap(const_cast<uint8_t*>(data), size);
+#elif defined(PLATFORM_WINDOWS)
+			if (data != nullptr) UnmapViewOfFile(data);
+			if (mapping != nullptr) CloseHandle(mapping);
+#endif
+		}
+
+		mapped_file_t(const mapped_file_t&) = delete;
+		mapped_file_t& operator=(const mapped_file_t&) = delete;
+
+		/*
+		@brief
+
+			Gets the file's contents (nullptr if it couldn't be read)
+		*/
+		const uint8_t* get_data(void) const { return data; }
+
+		/*
+		@brief
+
+			Gets the file's size
+		*/
+		size_t get_size(void) const { return size; }
+
+	};
+
+	/*
+	@brief
+
+		Reads values out of a block of memory without running past its end
+	*/
+	class reader_t final
+	{
+
+	private:
+
+		const uint8_t* current, *end;
+
+	public:
+
+		/*
+		@brief
+
+			Constructor
+		*/
+		reader_t(const uint8_t* data, size_t size) :
+			current(data),
+			end(data + size) {}
+
+		/*
+		@brief
+
+			Returns the next @size bytes and skips them, nullptr if there aren't enough left
+		*/
+		const uint8_t* skip(size_t size)
+		{
+			if (static_cast<size_t>(end - current) < size) return nullptr;
+
+			auto data = current;
+
+			current += size;
+
+			return data;
+		}
+
+		/*
+		@brief
+
+			Copies the next @size bytes into @out, false if there aren't enough left
+		*/
+		bool read(void* out, size_t size)
+		{
+			auto data = skip(size);
+
+			if (data == nullptr) return false;
+
+			memcpy(out, data, size);
+
+			return true;
+		}
+
+		/*
+		@brief
+
+			Reads a single value
+		*/
+		template <typename T> bool read(T& out) { return read(&out, sizeof(T)); }
+
+	};
+
+	/*
+	@brief
+
+		Appends raw bytes to @out
+	*/
+	void append(std::vector<uint8_t>& out, const void* data, size_t size)
+	{
+		auto bytes = static_cast<const uint8_t*>(data);
+
+		out.insert(out.end(), bytes, bytes + size);
+	}
+
+	/*
+	@brief
+
+		Appends a single value to @out
+	*/
+	template <typename T> void append(std::vector<uint8_t>& out, const T& value) { append(out, &value, sizeof(T)); }
+
+}
+
+/*
+@brief
+
+	Constructor
+*/
+retrogames::font_service_t::font_service_t(const std::string& cache_path/* = ""*/) :
+	cache_path(cache_path),
+	dirty(true),
+	distance_field(false),
+	distance_field_ascent(0.f),
+	distance_field_descent(0.f) {}
+
+/*
+@brief
+
+	Requests the font @name at @size_pixels. The font gets created by the next build(),
+	the handle always points to the current font for @name (requesting it again with
+	another size, after a video mode change for example, keeps the handle)
+*/
+ImFont** retrogames::font_service_t::request(const std::string& name, float size_pixels)
+{
+	auto slot = slots.find(name);
+
+	if (slot == slots.end())
+	{
+		slot = slots.emplace(name, slot_t{ slots.size(), size_pixels, nullptr }).first;
+
+		dirty = true;
+	}
+	else if (slot->second.size != size_pixels)
+	{
+		slot->second.size = size_pixels;
+
+		dirty = true;
+	}
+
+	return &slot->second.font;
+}
+
+/*
+@brief
+
+	Puts all requested fonts into ImGui's atlas, from the cache if possible. Does nothing
+	if the atlas already holds them. Has to be called outside of a frame, the renderer
+	has to upload the atlas again afterwards unless it holds distance fields (the wrappers
+	do that after a video reset)
+*/
+void retrogames::font_service_t::build(void)
+{
+	auto atlas = ImGui::GetIO().Fonts;
+
+	// A video reset clears the atlas (or makes a new one), then we have to fill it again even if no size changed
+	if (!dirty && !atlas->Fonts.empty() && atlas->IsBuilt()) return;
+
+	// Measured text belongs to the fonts we're about to replace (or rescale)
+	ImGuiUser::clear_text_size_cache();
+
+	std::vector<const slot_t*> ordered_slots;
+
+	for (auto& slot : slots) ordered_slots.push_back(&slot.second);
+
+	std::sort(ordered_slots.begin(), ordered_slots.end(), [](const slot_t* a, const slot_t* b) { return a->order < b->order; });
+
+	// Slots asking for the same size share one font
+	std::vector<float> sizes;
+
+	for (auto slot : ordered_slots)
+	{
+		if (std::find(sizes.begin(), sizes.end(), slot->size) == sizes.end()) sizes.push_back(slot->size);
+	}
+
+	if (distance_field) build_distance_field(atlas, sizes);
+	else
+	{
+		atlas->Clear();
+		atlas->Flags &= ~ImFontAtlasFlags_SignedDistanceField;
+
+		if (!sizes.empty())
+		{
+			auto key = make_key(sizes);
+
+			if (!load_from_cache(atlas, key, sizes))
+			{
+				for (auto size : sizes)
+				{
+					ImFontConfig font_config;
+
+					font_config.SizePixels = size;
+
+					atlas->AddFontDefault(&font_config);
+				}
+
+				atlas->Build();
+
+				if (!cache_path.empty()) save_to_cache(key, save_atlas(atlas));
+			}
+		}
+	}
+
+	for (auto& slot : slots)
+	{
+		auto index = std::find(sizes.begin(), sizes.end(), slot.second.size) - sizes.begin();
+
+		slot.second.font = atlas->Fonts[static_cast<int>(index)];
+	}
+
+	dirty = false;
+}
+
+/*
+@brief
+
+	Makes the atlas hold the distance field font (unless it already does) and gives it one font per size in @sizes
+*/
+void retrogames::font_service_t::build_distance_field(ImFontAtlas* atlas, const std::vector<float>& sizes)
+{
+	if (sizes.empty()) return;
+
+	// The atlas only has to be made once, a resolution change keeps it (and so does recreating the
+	// ImGui context, the wrappers share their atlas between contexts)
+	if (!(atlas->Flags & ImFontAtlasFlags_SignedDistanceField) || !atlas->IsBuilt() || distance_field_glyphs.empty())
+	{
+		atlas->Clear();
+		atlas->Flags |= ImFontAtlasFlags_SignedDistanceField;
+		atlas->TexSdfSpread = distance_field_spread;
+
+		const std::vector<float> atlas_sizes = { distance_field_size };
+
+		auto key = make_key(atlas_sizes, distance_field_spread);
+
+		if (!load_from_cache(atlas, key, atlas_sizes))
+		{
+			ImFontConfig font_config;
+
+			font_config.SizePixels = distance_field_size;
+
+			atlas->AddFontDefault(&font_config);
+			atlas->Build();
+
+			if (!cache_path.empty()) save_to_cache(key, save_atlas(atlas));
+		}
+
+		auto font = atlas->Fonts[0];
+
+		distance_field_glyphs.assign(font->Glyphs.begin(), font->Glyphs.end());
+		distance_field_ascent = font->Ascent;
+		distance_field_descent = font->Descent;
+	}
+
+	// One font per size, they only differ in how much they scale the glyphs
+	auto first_font = atlas->Fonts[0];
+
+	while (atlas->Fonts.Size < static_cast<int>(sizes.size()))
+	{
+		auto font = IM_NEW(ImFont);
+
+		font->ContainerAtlas = atlas;
+		font->ConfigData = first_font->ConfigData;
+		font->ConfigDataCount = 1;
+		font->FallbackChar = first_font->FallbackChar;
+		font->EllipsisChar = first_font->EllipsisChar;
+
+		atlas->Fonts.push_back(font);
+	}
+
+	while (atlas->Fonts.Size > static_cast<int>(sizes.size()))
+	{
+		IM_DELETE(atlas->Fonts.back());
+
+		atlas->Fonts.pop_back();
+	}
+
+	for (auto i = 0u; i < sizes.size(); i++)
+	{
+		auto font = atlas->Fonts[static_cast<int>(i)];
+		auto scale = sizes[i] / distance_field_size;
+
+		font->FontSize = sizes[i];
+		font->Ascent = distance_field_ascent * scale;
+		font->Descent = distance_field_descent * scale;
+
+		// Like AddFontDefault() does
+		font->DisplayOffset = ImVec2(0.f, 1.f);
+
+		font->Glyphs.resize(static_cast<int>(distance_field_glyphs.size()));
+
+		for (auto j = 0u; j < distance_field_glyphs.size(); j++)
+		{
+			auto& glyph = font->Glyphs[static_cast<int>(j)];
+
+			glyph = distance_field_glyphs[j];
+			glyph.AdvanceX *= scale;
+			glyph.X0 *= scale;
+			glyph.Y0 *= scale;
+			glyph.X1 *= scale;
+			glyph.Y1 *= scale;
+		}
+
+		font->BuildLookupTable();
+	}
+}
+
+/*
+@brief
+
+	Builds the cache key for the atlas holding @sizes (as distance fields reaching @sdf_spread texels,
+	unless that's 0)
+*/
+std::string retrogames::font_service_t::make_key(const std::vector<float>& sizes, int sdf_spread/* = 0*/)
+{
+	// The glyphs only depend on the font and its sizes (which is what a resolution change changes),
+	// ImGui's version goes in too since the rasterizer might change with it
+	std::string key = std::string(font_name) + "/" IMGUI_VERSION;
+
+	if (sdf_spread != 0) key += "/sdf" + std::to_string(sdf_spread);
+
+	key += '@';
+
+	char size[32];
+
+	for (auto i = 0u; i < sizes.size(); i++)
+	{
+		snprintf(size, sizeof(size), i == 0 ? "%g" : ",%g", sizes[i]);
+
+		key += size;
+	}
+
+	return key;
+}
+
+/*
+@brief
+
+	Fills @atlas with the fonts from the cache entry @data (of @size bytes).
+	Returns false if the entry doesn't match @sizes
+*/
+bool retrogames::font_service_t::load_atlas(ImFontAtlas* atlas, const std::vector<float>& sizes, const uint8_t* data, size_t size)
+{
+	reader_t reader(data, size);
+
+	int32_t width, height, cursor_rect[5];
+	ImVec2 white_pixel;
+	uint32_t font_count;
+
+	if (!reader.read(width) || !reader.read(height) || !reader.read(white_pixel) || !reader.read(cursor_rect) || !reader.read(font_count)) return false;
+
+	if (width <= 0 || height <= 0 || font_count != sizes.size()) return false;
+
+	for (auto i = 0u; i < font_count; i++)
+	{
+		float font_size, ascent, descent;
+		uint32_t fallback_char, ellipsis_char, glyph_count;
+
+		if (!reader.read(font_size) || !reader.read(ascent) || !reader.read(descent) || !reader.read(fallback_char) || !reader.read(ellipsis_char) || !reader.read(glyph_count)) return false;
+
+		auto glyphs = reader.skip(static_cast<size_t>(glyph_count) * sizeof(ImFontGlyph));
+
+		if (font_size != sizes[i] || glyphs == nullptr || glyph_count == 0) return false;
+
+		// Only what the renderer needs, there's no font data to rebuild from
+		ImFontConfig font_config;
+
+		font_config.SizePixels = font_size;
+		font_config.EllipsisChar = static_cast<ImWchar>(ellipsis_char);
+
+		snprintf(font_config.Name, sizeof(font_config.Name), "%s, %dpx (cached)", font_name, static_cast<int>(font_size));
+
+		atlas->ConfigData.push_back(font_config);
+
+		auto font = IM_NEW(ImFont);
+
+		font->FontSize = font_size;
+		font->Ascent = ascent;
+		font->Descent = descent;
+		font->FallbackChar = static_cast<ImWchar>(fallback_char);
+		font->EllipsisChar = static_cast<ImWchar>(ellipsis_char);
+		font->ContainerAtlas = atlas;
+		font->Glyphs.resize(static_cast<int>(glyph_count));
+
+		memcpy(font->Glyphs.Data, glyphs, static_cast<size_t>(glyph_count) * sizeof(ImFontGlyph));
+
+		atlas->Fonts.push_back(font);
+	}
+
+	auto pixels = reader.skip(static_cast<size_t>(width) * static_cast<size_t>(height));
+
+	if (pixels == nullptr) return false;
+
+	// ConfigData is done growing, now its addresses are stable
+	for (auto i = 0; i < atlas->Fonts.Size; i++)
+	{
+		auto font = atlas->Fonts[i];
+
+		atlas->ConfigData[i].DstFont = font;
+
+		font->ConfigData = &atlas->ConfigData[i];
+		font->ConfigDataCount = 1;
+		font->BuildLookupTable();
+	}
+
+	// The mouse cursor shapes (only drawn by ImGui with io.MouseDrawCursor)
+	if (cursor_rect[0] != -1)
+	{
+		auto index = atlas->AddCustomRectRegular(static_cast<unsigned int>(cursor_rect[0]), cursor_rect[3], cursor_rect[4]);
+
+		atlas->CustomRects[index].X = static_cast<unsigned short>(cursor_rect[1]);
+		atlas->CustomRects[index].Y = static_cast<unsigned short>(cursor_rect[2]);
+		atlas->CustomRectIds[0] = index;
+	}
+
+	atlas->TexWidth = width;
+	atlas->TexHeight = height;
+	atlas->TexUvScale = ImVec2(1.f / static_cast<float>(width), 1.f / static_cast<float>(height));
+	atlas->TexUvWhitePixel = white_pixel;
+
+	// The atlas frees this with IM_FREE, so it can't point into the mapping
+	atlas->TexPixelsAlpha8 = static_cast<unsigned char*>(IM_ALLOC(static_cast<size_t>(width) * static_cast<size_t>(height)));
+
+	memcpy(atlas->TexPixelsAlpha8, pixels, static_cast<size_t>(width) * static_cast<size_t>(height));
+
+	return true;
+}
+
+/*
+@brief
+
+	Serializes the built @atlas into a cache entry
+*/
+std::vector<uint8_t> retrogames::font_service_t::save_atlas(ImFontAtlas* atlas)
+{
+	std::vector<uint8_t> entry;
+
+	unsigned char* pixels;
+	int width, height;
+
+	atlas->GetTexDataAsAlpha8(&pixels, &width, &height);
+
+	append(entry, static_cast<int32_t>(width));
+	append(entry, static_cast<int32_t>(height));
+	append(entry, atlas->TexUvWhitePixel);
+
+	int32_t cursor_rect[5] = { -1, -1, -1, -1, -1 };
+
+	if (atlas->CustomRectIds[0] >= 0)
+	{
+		auto& rect = atlas->CustomRects[atlas->CustomRectIds[0]];
+
+		cursor_rect[0] = static_cast<int32_t>(rect.ID);
+		cursor_rect[1] = rect.X;
+		cursor_rect[2] = rect.Y;
+		cursor_rect[3] = rect.Width;
+		cursor_rect[4] = rect.Height;
+	}
+
+	append(entry, cursor_rect);
+	append(entry, static_cast<uint32_t>(atlas->Fonts.Size));
+
+	for (auto font : atlas->Fonts)
+	{
+		append(entry, font->FontSize);
+		append(entry, font->Ascent);
+		append(entry, font->Descent);
+		append(entry, static_cast<uint32_t>(font->FallbackChar));
+		append(entry, static_cast<uint32_t>(font->EllipsisChar));
+		append(entry, static_cast<uint32_t>(font->Glyphs.Size));
+		append(entry, font->Glyphs.Data, static_cast<size_t>(font->Glyphs.size_in_bytes()));
+	}
+
+	append(entry, pixels, static_cast<size_t>(width) * static_cast<size_t>(height));
+
+	return entry;
+}
+
+/*
+@brief
+
+	Looks for @key in the cache file and loads that atlas into @atlas. A hit that isn't
+	the first entry moves to the front, so the cache stays in most recently used order
+*/
+bool retrogames::font_service_t::load_from_cache(ImFontAtlas* atlas, const std::string& key, const std::vector<float>& sizes)
+{
+	if (cache_path.empty()) return false;
+
+	// A copy of the entry we hit, if it has to move (unmapped before we write to the file again)
+	std::vector<uint8_t> hit;
+
+	{
+		mapped_file_t file(cache_path);
+
+		if (file.get_data() == nullptr) return false;
+
+		reader_t reader(file.get_data(), file.get_size());
+
+		char file_magic[sizeof(magic)];
+		uint32_t file_version, glyph_size, entry_count;
+
+		if (!reader.read(file_magic) || memcmp(file_magic, magic, sizeof(magic)) != 0) return false;
+		if (!reader.read(file_version) || !reader.read(glyph_size) || !reader.read(entry_count)) return false;
+		if (file_version != version || glyph_size != sizeof(ImFontGlyph)) return false;
+
+		auto i = 0u;
+
+		for (; i < entry_count; i++)
+		{
+			uint32_t key_length, data_length;
+
+			if (!reader.read(key_length)) return false;
+
+			auto entry_key = reader.skip(key_length);
+
+			if (entry_key == nullptr || !reader.read(data_length)) return false;
+
+			auto data = reader.skip(data_length);
+
+			if (data == nullptr) return false;
+
+			if (key_length != key.size() || memcmp(entry_key, key.data(), key_length) != 0) continue;
+
+			if (!load_atlas(atlas, sizes, data, data_length))
+			{
+				// Whatever made it in before we found out the entry is broken
+				atlas->Clear();
+
+				return false;
+			}
+
+			if (i != 0) hit.assign(data, data + data_length);
+
+			break;
+		}
+
+		if (i == entry_count) return false;
+	}
+
+	if (!hit.empty()) save_to_cache(key, hit);
+
+	return true;
+}
+
+/*
+@brief
+
+	Puts @entry into the cache file as @key (the most recently used entry goes first,
+	old ones get dropped once there's too many)
+*/
+void retrogames::font_service_t::save_to_cache(const std::string& key, const std::vector<uint8_t>& entry)
+{
+	std::vector<uint8_t> entries;
+	uint32_t entry_count = 1;
+
+	append(entries, static_cast<uint32_t>(key.size()));
+	append(entries, key.data(), key.size());
+	append(entries, static_cast<uint32_t>(entry.size()));
+	append(entries, entry.data(), entry.size());
+
+	// Keep the other atlases we've got (unmapped before we write to the file again)
+	{
+		mapped_file_t file(cache_path);
+
+		reader_t reader(file.get_data(), file.get_size());
+
+		char file_magic[sizeof(magic)];
+		uint32_t file_version, glyph_size, file_entry_count;
+
+		if (file.get_data() != nullptr &&
+			reader.read(file_magic) && memcmp(file_magic, magic, sizeof(magic)) == 0 &&
+			reader.read(file_version) && reader.read(glyph_size) && reader.read(file_entry_count) &&
+			file_version == version && glyph_size == sizeof(ImFontGlyph))
+		{
+			for (auto i = 0u; i < file_entry_count && entry_count < max_cache_entries; i++)
+			{
+				uint32_t key_length, data_length;
+
+				if (!reader.read(key_length)) break;
+
+				auto entry_key = reader.skip(key_length);
+
+				if (entry_key == nullptr || !reader.read(data_length)) break;
+
+				auto data = reader.skip(data_length);
+
+				if (data == nullptr) break;
+
+				if (key_length == key.size() && memcmp(entry_key, key.data(), key_length) == 0) continue;
+
+				append(entries, key_length);
+				append(entries, entry_key, key_length);
+				append(entries, data_length);
+				append(entries, data, data_length);
+
+				entry_count++;
+			}
+		}
+	}
+
+	// Write next to it first, so a crash can't leave a half-written cache behind
+	auto temporary_path = cache_path + ".tmp";
+
+	{
+		std::unique_ptr<FILE, int(*)(FILE*)> file(fopen(temporary_path.c_str(), "wb"), fclose);
+
+		if (file == nullptr) return;
+
+		const uint32_t header[] = { version, static_cast<uint32_t>(sizeof(ImFontGlyph)), entry_count };
+
+		if (fwrite(magic, sizeof(magic), 1, file.get()) != 1 ||
+			fwrite(header, sizeof(header), 1, file.get()) != 1 ||
+			fwrite(entries.data(), entries.size(), 1, file.get()) != 1)
+		{
+			file.reset();
+
+			std::remove(temporary_path.c_str());
+
+			return;
+		}
+	}
+
+#ifdef PLATFORM_WINDOWS
+	// rename() doesn't replace existing files on Windows
+	std::remove(cache_path.c_str());
+#endif
+
+	if (std::rename(temporary_path.c_str(), cache_path.c_str()) != 0) std::remove(temporary_path.c_str());
+}
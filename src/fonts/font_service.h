@@ -0,0 +1,180 @@
+/*
+@file
+
+	font_service.h
+
+@purpose
+
+	Owning every font in ImGui's atlas. The menu and the games request fonts by name
+	and size and get a handle that stays valid for the service's lifetime, requests
+	for the same size share one font, and baked atlases get cached on disk so starting
+	up (and changing the video mode) doesn't have to rasterize glyphs again.
+	With distance fields (for renderers that can draw them) the atlas holds a single
+	size and every font scales its glyphs, so changing sizes doesn't touch the atlas
+
+@format
+
+	The cache file, native byte order (it never leaves the machine that wrote it):
+
+	header:  "RGFONTCA", uint32 version, uint32 sizeof(ImFontGlyph), uint32 entry count
+	entries: uint32 key length, the key ("<font>[/sdf<spread>]@<size>,<size>,...", see make_key),
+	         uint32 data length, followed by the data:
+	         int32 atlas width, int32 atlas height, float white pixel uv (2),
+	         int32 mouse cursor rect id, x, y, width, height (all -1 if there is none),
+	         uint32 font count, and per font (in the order they were first requested):
+	         float size, ascent, descent, uint32 fallback char, ellipsis char,
+	         uint32 glyph count, the raw glyphs,
+	         and finally width * height alpha bytes (the atlas itself)
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "imgui/imgui.h"
+
+namespace retrogames
+{
+
+	class font_service_t final
+	{
+
+	protected:
+
+
+
+	private:
+
+		struct slot_t final
+		{
+
+			// When the slot got requested first, the fonts go into the atlas in that order
+			// (the first one is ImGui's default font)
+			size_t order;
+
+			float size;
+
+			ImFont* font;
+
+		};
+
+		// Never erased, so pointers to a slot's font can be handed out as handles
+		std::map<std::string, slot_t> slots;
+
+		// Where baked atlases get cached (empty disables the cache)
+		std::string cache_path;
+
+		// Set when a slot got added or changed its size since the last build
+		bool dirty;
+
+		// Every font is the distance field font scaled to its size (see set_distance_field)
+		bool distance_field;
+
+		// The distance field font's glyphs and metrics at the size it's in the atlas with, what the fonts get scaled from
+		std::vector<ImFontGlyph> distance_field_glyphs;
+
+		float distance_field_ascent, distance_field_descent;
+
+		/*
+		@brief
+
+			Builds the cache key for the atlas holding @sizes (as distance fields reaching @sdf_spread texels,
+			unless that's 0)
+		*/
+		static std::string make_key(const std::vector<float>& sizes, int sdf_spread = 0);
+
+		/*
+		@brief
+
+			Fills @atlas with the fonts from the cache entry @data (of @size bytes).
+			Returns false if the entry doesn't match @sizes
+		*/
+		static bool load_atlas(ImFontAtlas* atlas, const std::vector<float>& sizes, const uint8_t* data, size_t size);
+
+		/*
+		@brief
+
+			Serializes the built @atlas into a cache entry
+		*/
+		static std::vector<uint8_t> save_atlas(ImFontAtlas* atlas);
+
+		/*
+		@brief
+
+			Looks for @key in the cache file and loads that atlas into @atlas. A hit that isn't
+			the first entry moves to the front, so the cache stays in most recently used order
+		*/
+		bool load_from_cache(ImFontAtlas* atlas, const std::string& key, const std::vector<float>& sizes);
+
+		/*
+		@brief
+
+			Puts @entry into the cache file as @key (the most recently used entry goes first,
+			old ones get dropped once there's too many)
+		*/
+		void save_to_cache(const std::string& key, const std::vector<uint8_t>& entry);
+
+		/*
+		@brief
+
+			Makes the atlas hold the distance field font (unless it already does) and gives it one font per size in @sizes
+		*/
+		void build_distance_field(ImFontAtlas* atlas, const std::vector<float>& sizes);
+
+	public:
+
+		/*
+		@brief
+
+			Constructor
+		*/
+		font_service_t(const std::string& cache_path = "");
+
+		/*
+		@brief
+
+			Sets where baked atlases get cached (empty disables the cache)
+		*/
+		void set_cache_path(const std::string& cache_path) { this->cache_path = cache_path; }
+
+		/*
+		@brief
+
+			Makes every font share one signed distance field font in the atlas, which the renderer has to
+			support (ImFontAtlasFlags_SignedDistanceField). Changing sizes then only rescales glyphs,
+			the atlas and the renderer's texture of it stay as they are
+		*/
+		void set_distance_field(bool distance_field)
+		{
+			if (this->distance_field == distance_field) return;
+
+			this->distance_field = distance_field;
+
+			dirty = true;
+		}
+
+		/*
+		@brief
+
+			Requests the font @name at @size_pixels. The font gets created by the next build(),
+			the handle always points to the current font for @name (requesting it again with
+			another size, after a video mode change for example, keeps the handle)
+		*/
+		ImFont** request(const std::string& name, float size_pixels);
+
+		/*
+		@brief
+
+			Puts all requested fonts into ImGui's atlas, from the cache if possible. Does nothing
+			if the atlas already holds them. Has to be called outside of a frame, the renderer
+			has to upload the atlas again afterwards unless it holds distance fields (the wrappers
+			do that after a video reset)
+		*/
+		void build(void);
+
+	};
+
+}
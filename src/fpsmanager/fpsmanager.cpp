@@ -8,8 +8,24 @@
 	Limiting FPS to a given framerate
 */
 
+#include <algorithm>
+#include <cmath>
 #include <thread>
 #include "fpsmanager.h"
+#include "misc/clock.h"
+
+namespace
+{
+
+	// Frame times get counted in 50us buckets up to 4 frames, jitter in 10us buckets up to 2ms
+	const std::chrono::nanoseconds frame_time_bucket = std::chrono::microseconds(50);
+	const std::chrono::nanoseconds jitter_bucket = std::chrono::microseconds(10);
+	const size_t jitter_bucket_count = 200;
+
+	// Never spin less than this, in case sleeping suddenly overshoots more than it used to
+	const std::chrono::nanoseconds min_spin_margin = std::chrono::microseconds(20);
+
+}
 
 /*
 @brief
@@ -24,47 +40,196 @@ std::chrono::nanoseconds retrogames::fpsmanager_t::calculate_delay(uint16_t targ
 /*
 @brief
 
-	Constructor, calculates sleep_interval
+	Constructor
+*/
+retrogames::pacing_histogram_t::pacing_histogram_t(std::chrono::nanoseconds bucket_width, size_t bucket_count) :
+	bucket_width(bucket_width),
+	buckets(std::max<size_t>(bucket_count, 1), 0),
+	count(0),
+	max(0) {}
+
+/*
+@brief
+
+	Counts @duration (negative ones count as 0)
+*/
+void retrogames::pacing_histogram_t::add(std::chrono::nanoseconds duration)
+{
+	if (duration.count() < 0) duration = std::chrono::nanoseconds(0);
+
+	auto bucket = static_cast<size_t>(duration / bucket_width);
+
+	buckets[std::min(bucket, buckets.size() - 1)]++;
+
+	count++;
+
+	if (duration > max) max = duration;
+}
+
+/*
+@brief
+
+	Gets the upper end of the bucket the @percentile (0-1) of all durations fall into
+	(the longest duration for the last bucket)
+*/
+std::chrono::nanoseconds retrogames::pacing_histogram_t::get_percentile(double percentile) const
+{
+	if (count == 0) return std::chrono::nanoseconds(0);
+
+	auto rank = static_cast<uint64_t>(std::ceil(percentile * static_cast<double>(count)));
+	uint64_t counted = 0;
+
+	for (size_t i = 0; i < buckets.size() - 1; i++)
+	{
+		counted += buckets[i];
+
+		if (counted >= rank) return std::min(bucket_width * static_cast<int64_t>(i + 1), max);
+	}
+
+	return max;
+}
+
+/*
+@brief
+
+	Writes "<bucket start in us> <count>" for every bucket that counted something
 */
-retrogames::fpsmanager_t::fpsmanager_t(const uint16_t target_fps) :
-	zero_delay(target_fps == 0)
+void retrogames::pacing_histogram_t::write(FILE* file) const
+{
+	for (size_t i = 0; i < buckets.size(); i++)
+	{
+		if (buckets[i] == 0) continue;
+
+		auto start = std::chrono::duration<double, std::micro>(bucket_width * static_cast<int64_t>(i)).count();
+
+		fprintf(file, "%s%.0f %llu\n", i == buckets.size() - 1 ? ">=" : "", start, static_cast<unsigned long long>(buckets[i]));
+	}
+}
+
+/*
+@brief
+
+	Constructor, calculates sleep_interval. @precise sleeps until just before
+	each frame and spins for the rest, which costs a bit of CPU but hits the
+	deadline within microseconds (sleeping alone oversleeps by up to a millisecond)
+*/
+retrogames::fpsmanager_t::fpsmanager_t(const uint16_t target_fps, bool precise) :
+	update_interval(0),
+	update_time_set(false),
+	zero_delay(target_fps == 0),
+	precise(precise),
+	spin_margin(std::chrono::milliseconds(1)),
+	oversleep_average_ns(-1.),
+	oversleep_deviation_ns(0.),
+	frame_times(frame_time_bucket, target_fps == 0 ? 1 : static_cast<size_t>(calculate_delay(target_fps) * 4 / frame_time_bucket)),
+	jitter(jitter_bucket, jitter_bucket_count),
+	missed_frames(0)
 {
 	if (zero_delay) return;
 
 	update_interval = calculate_delay(target_fps);
-	update_time_set = false;
+	spin_margin = std::min<std::chrono::nanoseconds>(spin_margin, update_interval / 2);
 }
 
 /*
 @brief
 
-	Sleeps until the next frame
+	Sleeps until the next frame (blocking), in get_clock()'s time.
+	Doesn't wait on clocks that only move when stepped
 */
 void retrogames::fpsmanager_t::run(void)
 {
 	if (zero_delay) return;
 
+	auto& clock = get_clock();
+
 	if (!update_time_set)
 	{
 		update_time_set = true;
 
-		next_frame = std::chrono::high_resolution_clock::now() + update_interval;
+		next_frame = clock.now() + update_interval;
+		last_frame = std::chrono::high_resolution_clock::now();
 
 		return;
 	}
 
-	if (std::chrono::high_resolution_clock::now() > next_frame)
+	auto now = clock.now();
+
+	if (now >= next_frame)
 	{
-		//while (std::chrono::high_resolution_clock::now() > next_frame) next_frame += update_interval;
+		// We're late, start right away. The deadlines stay where they were, only the ones we've missed
+		// entirely get skipped (starting over from now would shift every frame after this one)
+		auto missed = (now - next_frame) / update_interval;
+
+		missed_frames += static_cast<uint64_t>(missed);
 
-		next_frame = std::chrono::high_resolution_clock::now() + update_interval;
+		jitter.add(now - next_frame);
+
+		next_frame += update_interval * (missed + 1);
+	}
+	else if (clock.get_rate() > 0.)
+	{
+		auto deadline = clock.to_wall_time(next_frame);
+
+		wait_until(deadline);
+
+		jitter.add(std::chrono::high_resolution_clock::now() - deadline);
+
+		next_frame += update_interval;
 	}
 	else
 	{
-		std::this_thread::sleep_until(next_frame);
+		next_frame += update_interval;
 	}
 
-	next_frame += update_interval;
+	auto frame_start = std::chrono::high_resolution_clock::now();
+
+	frame_times.add(frame_start - last_frame);
+
+	last_frame = frame_start;
+}
+
+/*
+@brief
+
+	Sleeps (and spins if precise) until @deadline on the wall clock
+*/
+void retrogames::fpsmanager_t::wait_until(const std::chrono::high_resolution_clock::time_point& deadline)
+{
+	if (!precise)
+	{
+		std::this_thread::sleep_until(deadline);
+
+		return;
+	}
+
+	auto wake_up = deadline - spin_margin;
+
+	if (wake_up > std::chrono::high_resolution_clock::now())
+	{
+		std::this_thread::sleep_until(wake_up);
+
+		// Calibrate the margin: the average oversleep plus a few deviations covers almost every wake up
+		auto oversleep = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - wake_up).count());
+
+		if (oversleep_average_ns < 0.)
+		{
+			oversleep_average_ns = oversleep;
+			oversleep_deviation_ns = oversleep * .5;
+		}
+		else
+		{
+			oversleep_average_ns += (oversleep - oversleep_average_ns) / 16.;
+			oversleep_deviation_ns += (std::abs(oversleep - oversleep_average_ns) - oversleep_deviation_ns) / 16.;
+		}
+
+		auto margin = std::chrono::nanoseconds(static_cast<int64_t>(oversleep_average_ns + oversleep_deviation_ns * 4.));
+
+		spin_margin = std::max<std::chrono::nanoseconds>(min_spin_margin, std::min<std::chrono::nanoseconds>(margin, update_interval / 2));
+	}
+
+	// Spin for the rest, yielding so we don't starve other threads on this core
+	while (std::chrono::high_resolution_clock::now() < deadline) std::this_thread::yield();
 }
 
 /*
@@ -80,12 +245,12 @@ bool retrogames::fpsmanager_t::should_run(void)
 	{
 		update_time_set = true;
 
-		next_frame = std::chrono::high_resolution_clock::now() + update_interval;
+		next_frame = get_clock().now() + update_interval;
 
 		return true;
 	}
 
-	auto now = std::chrono::high_resolution_clock::now();
+	auto now = get_clock().now();
 
 	if (now >= next_frame)
 	{
@@ -105,4 +270,55 @@ bool retrogames::fpsmanager_t::should_run(void)
 void retrogames::fpsmanager_t::reset(void)
 {
 	update_time_set = false;
-}
\ No newline at end of file
+}
+
+/*
+@brief
+
+	Gets a one line summary of the frame times and jitter
+*/
+std::string retrogames::fpsmanager_t::get_summary(void) const
+{
+	auto to_ms = [](std::chrono::nanoseconds duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+
+	char summary[320];
+
+	snprintf(summary, sizeof(summary),
+		"pacing (%s, ms p50/p99/max): frame time %.3f/%.3f/%.3f, jitter %.3f/%.3f/%.3f, %llu frames, %llu missed, spin margin %.3f",
+		precise ? "precise" : "sleep",
+		to_ms(frame_times.get_percentile(.5)), to_ms(frame_times.get_percentile(.99)), to_ms(frame_times.get_max()),
+		to_ms(jitter.get_percentile(.5)), to_ms(jitter.get_percentile(.99)), to_ms(jitter.get_max()),
+		static_cast<unsigned long long>(frame_times.get_count()), static_cast<unsigned long long>(missed_frames),
+		precise ? to_ms(spin_margin) : 0.);
+
+	return summary;
+}
+
+/*
+@brief
+
+	Writes both histograms into the file at @path
+*/
+bool retrogames::fpsmanager_t::write_histograms(const std::string& path, std::string* error) const
+{
+	auto file = fopen(path.c_str(), "w");
+
+	if (file == nullptr)
+	{
+		if (error != nullptr) *error = "Failed to open " + path + " for writing";
+
+		return false;
+	}
+
+	fprintf(file, "# %s\n# frame time (us, count)\n", get_summary().c_str());
+
+	frame_times.write(file);
+
+	fprintf(file, "# jitter (us, count)\n");
+
+	jitter.write(file);
+
+	fclose(file);
+
+	return true;
+}
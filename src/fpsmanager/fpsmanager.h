@@ -11,10 +11,79 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
 
 namespace retrogames
 {
 
+	// Counts durations in buckets of a fixed width (the last bucket takes everything longer)
+	class pacing_histogram_t final
+	{
+
+	protected:
+
+
+
+	private:
+
+		std::chrono::nanoseconds bucket_width;
+
+		std::vector<uint64_t> buckets;
+
+		uint64_t count;
+
+		std::chrono::nanoseconds max;
+
+	public:
+
+		/*
+		@brief
+
+			Constructor
+		*/
+		pacing_histogram_t(std::chrono::nanoseconds bucket_width, size_t bucket_count);
+
+		/*
+		@brief
+
+			Counts @duration (negative ones count as 0)
+		*/
+		void add(std::chrono::nanoseconds duration);
+
+		/*
+		@brief
+
+			Gets the upper end of the bucket the @percentile (0-1) of all durations fall into
+			(the longest duration for the last bucket)
+		*/
+		std::chrono::nanoseconds get_percentile(double percentile) const;
+
+		/*
+		@brief
+
+			Writes "<bucket start in us> <count>" for every bucket that counted something
+		*/
+		void write(FILE* file) const;
+
+		/*
+		@brief
+
+			Gets how many durations got counted
+		*/
+		uint64_t get_count(void) const { return count; }
+
+		/*
+		@brief
+
+			Gets the longest duration counted
+		*/
+		const std::chrono::nanoseconds& get_max(void) const { return max; }
+
+	};
+
 	class fpsmanager_t final
 	{
 
@@ -30,22 +99,56 @@ namespace retrogames
 		bool update_time_set;
 		bool zero_delay;
 
+		// Sleep until just before the deadline and spin for the rest (see run)
+		bool precise;
+
+		// How much earlier than the deadline we wake up when precise, calibrated from how much
+		// sleeping overshoots (a running average of the overshoot and of its deviation)
+		std::chrono::nanoseconds spin_margin;
+		double oversleep_average_ns, oversleep_deviation_ns;
+
+		// The time between two frames, and how late we woke up for a frame
+		pacing_histogram_t frame_times, jitter;
+
+		// When the last frame started (for frame_times)
+		std::chrono::high_resolution_clock::time_point last_frame;
+
+		// Frames that started a whole interval (or more) late
+		uint64_t missed_frames;
+
+		/*
+		@brief
+
+			Sleeps (and spins if precise) until @deadline on the wall clock
+		*/
+		void wait_until(const std::chrono::high_resolution_clock::time_point& deadline);
+
 	public:
 
 		/*
 		@brief
 
-			Constructor, calculates sleep_interval
+			Constructor, calculates sleep_interval. @precise sleeps until just before
+			each frame and spins for the rest, which costs a bit of CPU but hits the
+			deadline within microseconds (sleeping alone oversleeps by up to a millisecond)
 		*/
-		fpsmanager_t(const uint16_t target_fps);
+		fpsmanager_t(const uint16_t target_fps, bool precise = false);
 
 		/*
 		@brief
 
-			Sleeps until the next frame (blocking)
+			Sleeps until the next frame (blocking), in get_clock()'s time.
+			Doesn't wait on clocks that only move when stepped
 		*/
 		void run(void);
 
+		/*
+		@brief
+
+			Turns spinning for the last bit of the wait on or off (see the constructor)
+		*/
+		void set_precise(bool precise) { this->precise = precise; }
+
 		/*
 		@brief
 
@@ -81,6 +184,41 @@ namespace retrogames
 		*/
 		const std::chrono::nanoseconds& get_update_interval(void) const { return update_interval; }
 
+		/*
+		@brief
+
+			Gets the histogram of the time between two frames
+		*/
+		const pacing_histogram_t& get_frame_times(void) const { return frame_times; }
+
+		/*
+		@brief
+
+			Gets the histogram of how late we woke up for a frame
+		*/
+		const pacing_histogram_t& get_jitter(void) const { return jitter; }
+
+		/*
+		@brief
+
+			Gets how many frames started a whole interval (or more) late
+		*/
+		uint64_t get_missed_frames(void) const { return missed_frames; }
+
+		/*
+		@brief
+
+			Gets a one line summary of the frame times and jitter
+		*/
+		std::string get_summary(void) const;
+
+		/*
+		@brief
+
+			Writes both histograms into the file at @path
+		*/
+		bool write_histograms(const std::string& path, std::string* error = nullptr) const;
+
 	};
 
 }
\ No newline at end of file
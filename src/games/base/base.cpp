@@ -9,20 +9,21 @@
 */
 
 #include "base.h"
+#include "capture/latency_probe.h"
 #include "imgui/imgui_user.h"
 #include "imgui/imgui_internal.h"
 
 /*
 @brief
 
-    Returns the time elapsed since a chrono::high_resolution_clock::time_point.
+    Returns the time elapsed since a chrono::high_resolution_clock::time_point (at the frame's time).
     Hours, minutes, seconds, milliseconds
 */
 retrogames::game_base_t::playtime_t retrogames::game_base_t::get_playtime_elapsed(const std::chrono::high_resolution_clock::time_point& point)
 {
     uint16_t time_elapsed_ms, time_elapsed_seconds, time_elapsed_minutes, time_elapsed_hours;
 
-    auto total_time_elapsed_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - point).count());
+    auto total_time_elapsed_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(get_clock().get_frame_time() - point).count());
     auto total_time_elapsed_ms = total_time_elapsed_ns / 1000000.0; // to microseconds to milliseconds
     auto total_time_elapsed_seconds = total_time_elapsed_ms / 1000.0; // to seconds
     auto total_time_elapsed_minutes = total_time_elapsed_seconds / 60.0; // to minutes
@@ -56,7 +57,7 @@ bool retrogames::game_base_t::draw_pause_menu(ImFont* font)
 
         if (!confirming_main_menu)
         {
-            auto button_size = ImVec2{ImGui::CalcTextSize("Back to main menu").x+ImGui::GetStyle().FramePadding.x*2.f,0.f};
+            auto button_size = ImVec2{ImGuiUser::calc_text_size("Back to main menu").x+ImGui::GetStyle().FramePadding.x*2.f,0.f};
 
             if (ImGui::Button("Continue",button_size)) unpause();
             if (ImGui::Button("Back to main menu",button_size)) confirming_main_menu = true;
@@ -65,7 +66,7 @@ bool retrogames::game_base_t::draw_pause_menu(ImFont* font)
         {
             ImGui::TextUnformatted("Are you sure?");
 
-            auto button_size = ImVec2{((ImGui::CalcTextSize("Are you sure?").x+ImGui::GetStyle().FramePadding.x*2.f)*.5f)-ImGui::GetStyle().ItemInnerSpacing.x*2.f,0.f};
+            auto button_size = ImVec2{((ImGuiUser::calc_text_size("Are you sure?").x+ImGui::GetStyle().FramePadding.x*2.f)*.5f)-ImGui::GetStyle().ItemInnerSpacing.x*2.f,0.f};
 
             if (ImGui::Button("Yes", button_size)) { confirming_main_menu = false; result = true; }
 
@@ -112,7 +113,7 @@ bool retrogames::game_base_t::base_draw(bool render)
 
         if (!render)
         {
-            base_static_vars.render_pause_begin = std::chrono::high_resolution_clock::now();
+            base_static_vars.render_pause_begin = get_clock().get_frame_time();
         }
         else
         {
@@ -252,6 +253,33 @@ bool retrogames::game_base_t::base_draw(bool render)
         ImGui::PopFont();
     }
 
+    // Draw the input latency under that line if we're measuring it
+    latency_probe_t::percentiles_t latency;
+
+    if (get_latency_probe().get_overlay(latency))
+    {
+        ImGui::PushFont(get_default_font_small());
+
+        char latency_text[80];
+
+        sprintf(latency_text, "input: %.1fms p50 - %.1fms p99", latency.p50, latency.p99);
+
+        auto alignment = settings->get(gamename + "_draw_position_alignment").get<std::string>();
+
+        ImVec2 draw_pos{0.f, ImGui::GetFontSize()};
+
+        if (alignment.length() >= 7)
+        {
+            if (alignment.substr(alignment.length() - 5).compare("right") == 0) draw_pos.x = std::floor(static_cast<float>(base_resolution_area.width) - ImGui::CalcTextSize(latency_text).x);
+            else if (alignment.substr(alignment.length() - 6).compare("center") == 0) draw_pos.x = std::floor(static_cast<float>(base_resolution_area.width) * .5f - ImGui::CalcTextSize(latency_text).x * .5f);
+
+            if (alignment.substr(0, 6).compare("bottom") == 0) draw_pos.y = std::floor(static_cast<float>(base_resolution_area.height) - ImGui::GetFontSize() * 2.f);
+        }
+
+        ImGui::GetForegroundDrawList()->AddText(draw_pos, ImGui::GetColorU32(ImGui::GetStyleColorVec4(ImGuiCol_TextDisabled)), latency_text);
+        ImGui::PopFont();
+    }
+
     return ret;
 }
 
@@ -14,6 +14,8 @@
 #include <chrono>
 #include <stdint.h>
 #include "imgui/imgui.h"
+#include "fonts/font_service.h"
+#include "primitive_batch.h"
 #include "misc/settings.h"
 #include "misc/timer.h"
 #include "imgui/imgui.h"
@@ -117,6 +119,10 @@ namespace retrogames
 
         uint8_t timeout_time;
 
+        font_service_t* font_service;
+
+        primitive_batch_t primitives;
+
         ImFont** default_font_small, **default_font_big, **default_font_mid;
 
         cfgvalue_t& timeout_cfgvalue;
@@ -202,6 +208,21 @@ namespace retrogames
         */
         ImFont* get_default_font_big(void) { return *default_font_big; }
 
+        /*
+        @brief
+
+            Gets the font service, for games that need fonts of their own
+        */
+        font_service_t* get_font_service(void) { return font_service; }
+
+        /*
+        @brief
+
+            Gets the batch games draw their rectangles and lines into
+            (begin() it, add the shapes, flush() it into a draw list)
+        */
+        primitive_batch_t& get_primitives(void) { return primitives; }
+
         /*
         @brief
 
@@ -281,7 +302,7 @@ namespace retrogames
         /*
         @brief
 
-            Returns the time elapsed since a chrono::high_resolution_clock::time_point.
+            Returns the time elapsed since a chrono::high_resolution_clock::time_point (at the frame's time).
             Hours, minutes, seconds, milliseconds
         */
         playtime_t get_playtime_elapsed(const std::chrono::high_resolution_clock::time_point& point);
@@ -300,7 +321,7 @@ namespace retrogames
 
             Constructor
         */
-        game_base_t(const game_information_t& game_info, settings_t* settings, ImFont** default_font_small, ImFont** default_font_mid, ImFont** default_font_big, uint8_t timeout_time = 3) :
+        game_base_t(const game_information_t& game_info, settings_t* settings, font_service_t* font_service, ImFont** default_font_small, ImFont** default_font_mid, ImFont** default_font_big, uint8_t timeout_time = 3) :
             game_info(game_info),
             settings(settings),
             pause_state(PAUSE_STATE::PAUSE_STATE_NONE),
@@ -309,6 +330,7 @@ namespace retrogames
             timeout_time(timeout_time),
             base_static_vars(timeout_time),
             paused(false),
+            font_service(font_service),
             default_font_small(default_font_small),
             default_font_mid(default_font_mid),
             default_font_big(default_font_big),
@@ -378,6 +400,13 @@ namespace retrogames
         */
         virtual void draw_information(float scaling) = 0;
 
+        /*
+        @brief
+
+            Describes how the game went so far (the score, who won), for run summaries
+        */
+        virtual std::string get_outcome(void) = 0;
+
         /*
         @brief
 
@@ -0,0 +1,120 @@
+/*
+@file
+
+    primitive_batch.cpp
+
+@purpose
+
+    Collecting a game's rectangles and lines for a frame and handing them to an ImDrawList
+    all at once
+*/
+
+#include "primitive_batch.h"
+#include "imgui/imgui_internal.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+    // Quads written per PrimReserve, keeps a single reservation well within 16-bit indices
+    const size_t max_quads_per_reserve = 8192;
+
+}
+
+/*
+@brief
+
+    Adds a 1 pixel rectangle outline inside of @pos and @size
+    (same pixels as ImDrawList::AddRect on whole pixels)
+*/
+void retrogames::primitive_batch_t::add_rect(const ImVec2& pos, const ImVec2& size, ImU32 color)
+{
+    if ((color & IM_COL32_A_MASK) == 0) return;
+
+    auto max = ImVec2(pos.x + size.x, pos.y + size.y);
+
+    // Top and bottom span the whole width, the sides fill in between (no overlaps, so
+    // translucent outlines don't get darker corners)
+    add_quad(pos, ImVec2(max.x, pos.y + 1.f), color);
+    add_quad(ImVec2(pos.x, max.y - 1.f), max, color);
+    add_quad(ImVec2(pos.x, pos.y + 1.f), ImVec2(pos.x + 1.f, max.y - 1.f), color);
+    add_quad(ImVec2(max.x - 1.f, pos.y + 1.f), ImVec2(max.x, max.y - 1.f), color);
+}
+
+/*
+@brief
+
+    Adds a line from @pos_1 to @pos_2 (same placement as ImDrawList::AddLine,
+    without the anti-aliased fringe)
+*/
+void retrogames::primitive_batch_t::add_line(const ImVec2& pos_1, const ImVec2& pos_2, ImU32 color, float thickness/* = 1.f*/)
+{
+    if ((color & IM_COL32_A_MASK) == 0) return;
+
+    auto dx = pos_2.x - pos_1.x;
+    auto dy = pos_2.y - pos_1.y;
+    auto length = std::sqrt(dx * dx + dy * dy);
+
+    if (length <= 0.f) return;
+
+    // ImGui strokes through the pixel centers, widen the line by half the thickness on both sides.
+    // Along the line it covers the pixels from the lower end up to (not including) the upper one
+    // (whichever way it goes), so the quad moves half a pixel towards the lower end to cover exactly those
+    auto direction = ImVec2(dx / length, dy / length);
+    auto half_thickness = thickness * .5f;
+    auto normal = ImVec2(-direction.y * half_thickness, direction.x * half_thickness);
+    auto shift = ImVec2(.5f - std::fabs(direction.x) * .5f, .5f - std::fabs(direction.y) * .5f);
+    auto start = ImVec2(origin.x + pos_1.x + shift.x, origin.y + pos_1.y + shift.y);
+    auto end = ImVec2(origin.x + pos_2.x + shift.x, origin.y + pos_2.y + shift.y);
+
+    quads.push_back(quad_t{ { ImVec2(start.x + normal.x, start.y + normal.y), ImVec2(end.x + normal.x, end.y + normal.y), ImVec2(end.x - normal.x, end.y - normal.y), ImVec2(start.x - normal.x, start.y - normal.y) }, color });
+}
+
+/*
+@brief
+
+    Writes everything into @draw_list and starts over
+*/
+void retrogames::primitive_batch_t::flush(ImDrawList* draw_list)
+{
+    auto uv = draw_list->_Data->TexUvWhitePixel;
+
+    for (size_t first = 0; first < quads.size(); first += max_quads_per_reserve)
+    {
+        auto count = std::min(max_quads_per_reserve, quads.size() - first);
+
+        draw_list->PrimReserve(static_cast<int>(count * 6), static_cast<int>(count * 4));
+
+        auto vertex = draw_list->_VtxWritePtr;
+        auto index = draw_list->_IdxWritePtr;
+        auto current_index = draw_list->_VtxCurrentIdx;
+
+        for (auto quad = quads.data() + first, quads_end = quad + count; quad != quads_end; ++quad)
+        {
+            for (auto i = 0; i < 4; i++)
+            {
+                vertex[i].pos = quad->corners[i];
+                vertex[i].uv = uv;
+                vertex[i].col = quad->color;
+            }
+
+            index[0] = static_cast<ImDrawIdx>(current_index);
+            index[1] = static_cast<ImDrawIdx>(current_index + 1);
+            index[2] = static_cast<ImDrawIdx>(current_index + 2);
+            index[3] = static_cast<ImDrawIdx>(current_index);
+            index[4] = static_cast<ImDrawIdx>(current_index + 2);
+            index[5] = static_cast<ImDrawIdx>(current_index + 3);
+
+            vertex += 4;
+            index += 6;
+            current_index += 4;
+        }
+
+        draw_list->_VtxWritePtr = vertex;
+        draw_list->_IdxWritePtr = index;
+        draw_list->_VtxCurrentIdx = current_index;
+    }
+
+    quads.clear();
+}
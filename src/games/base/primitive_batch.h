@@ -0,0 +1,114 @@
+/*
+@file
+
+    primitive_batch.h
+
+@purpose
+
+    Collecting a game's rectangles and lines for a frame and handing them to an ImDrawList
+    all at once, instead of one AddRectFilled/AddRect/AddLine call (each with its own
+    bookkeeping) per shape
+*/
+
+#pragma once
+
+#include <vector>
+#include "imgui/imgui.h"
+
+namespace retrogames
+{
+
+    class primitive_batch_t final
+    {
+
+    protected:
+
+
+
+    private:
+
+        // Everything ends up as a quad (outlines are four of them), in the order it got added
+        struct quad_t final
+        {
+
+            ImVec2 corners[4];
+
+            ImU32 color;
+
+        };
+
+        std::vector<quad_t> quads;
+
+        // Added to every position (the window's position when drawing into a window)
+        ImVec2 origin;
+
+        /*
+        @brief
+
+            Adds an axis-aligned quad from @min to @max
+        */
+        void add_quad(const ImVec2& min, const ImVec2& max, ImU32 color)
+        {
+            quads.push_back(quad_t{ { ImVec2(origin.x + min.x, origin.y + min.y), ImVec2(origin.x + max.x, origin.y + min.y), ImVec2(origin.x + max.x, origin.y + max.y), ImVec2(origin.x + min.x, origin.y + max.y) }, color });
+        }
+
+    public:
+
+        /*
+        @brief
+
+            Constructor
+        */
+        primitive_batch_t() : origin(0.f, 0.f) {}
+
+        /*
+        @brief
+
+            Starts a new batch, positions are relative to @origin from now on
+        */
+        void begin(const ImVec2& origin = ImVec2(0.f, 0.f))
+        {
+            quads.clear();
+
+            this->origin = origin;
+        }
+
+        /*
+        @brief
+
+            Adds a filled rectangle at @pos with @size (same pixels as ImDrawList::AddRectFilled).
+            Colors are ImU32s so they can be converted once, not once per shape
+        */
+        void add_filled_rect(const ImVec2& pos, const ImVec2& size, ImU32 color)
+        {
+            if ((color & IM_COL32_A_MASK) == 0) return;
+
+            add_quad(pos, ImVec2(pos.x + size.x, pos.y + size.y), color);
+        }
+
+        /*
+        @brief
+
+            Adds a 1 pixel rectangle outline inside of @pos and @size
+            (same pixels as ImDrawList::AddRect on whole pixels)
+        */
+        void add_rect(const ImVec2& pos, const ImVec2& size, ImU32 color);
+
+        /*
+        @brief
+
+            Adds a line from @pos_1 to @pos_2 (same placement as ImDrawList::AddLine,
+            without the anti-aliased fringe)
+        */
+        void add_line(const ImVec2& pos_1, const ImVec2& pos_2, ImU32 color, float thickness = 1.f);
+
+        /*
+        @brief
+
+            Writes everything into @draw_list and starts over
+        */
+        void flush(ImDrawList* draw_list);
+
+    };
+
+}
@@ -36,6 +36,9 @@ namespace retrogames
         // pointer to the current game
         game_base_t* current_game;
 
+        // where games get their own fonts from
+        font_service_t* font_service;
+
         // pointers to pointers to default fonts
         ImFont** default_font_small, **default_font_big, **default_font_mid;
 
@@ -46,9 +49,10 @@ namespace retrogames
 
             Constructor, saves the settings pointer
         */
-        games_manager_t(settings_t* settings, ImFont** default_font_small, ImFont **default_font_mid, ImFont **default_font_big) :
+        games_manager_t(settings_t* settings, font_service_t* font_service, ImFont** default_font_small, ImFont **default_font_mid, ImFont **default_font_big) :
             settings(settings),
             current_game(nullptr),
+            font_service(font_service),
             default_font_small(default_font_small),
             default_font_mid(default_font_mid),
             default_font_big(default_font_big) {}
@@ -76,7 +80,7 @@ namespace retrogames
             settings->create(name + "_lostfocus_timeout_time", main_settings.timeout_time->get<uint32_t>());
             settings->create(name + "_sound_effect_volume", main_settings.sound_effect_volume->get<float>());
 
-            games[name] = new T(settings, name, default_font_small, default_font_mid, default_font_big, version, icon);
+            games[name] = new T(settings, name, font_service, default_font_small, default_font_mid, default_font_big, version, icon);
         }
 
         /*
@@ -9,6 +9,7 @@
 */
 
 #include "pingpong.h"
+#include "capture/latency_probe.h"
 #include "imgui/imgui_user.h"
 #include "misc/macros.h"
 
@@ -44,8 +45,8 @@ namespace retrogames
 
     Constructor
 */
-retrogames::games::pingpong_t::pingpong_t(settings_t* settings, const std::string& name, ImFont** default_font_small, ImFont** default_font_mid, ImFont** default_font_big, const std::string& version, uint8_t* icon) :
-    game_base_t(game_information_t::create(name, version, icon), settings, default_font_small, default_font_mid, default_font_big),
+retrogames::games::pingpong_t::pingpong_t(settings_t* settings, const std::string& name, font_service_t* font_service, ImFont** default_font_small, ImFont** default_font_mid, ImFont** default_font_big, const std::string& version, uint8_t* icon) :
+    game_base_t(game_information_t::create(name, version, icon), settings, font_service, default_font_small, default_font_mid, default_font_big),
     cfgvalue_ping_scale_x(settings->create("pingpong_ping_scale_x", 1.f)),
     cfgvalue_ping_scale_y(settings->create("pingpong_ping_scale_y", 1.f)),
     cfgvalue_initial_paddle_speed(settings->create("pingpong_initial_paddle_speed", 1000.f)),
@@ -56,8 +57,10 @@ retrogames::games::pingpong_t::pingpong_t(settings_t* settings, const std::strin
     settings(settings),
     left_paddle(nullptr),
     right_paddle(nullptr),
+    latency_sample(0),
     time_scale(0.1),
     main_font(nullptr),
+    resuming(false),
     difficultymanager(nullptr)
 {
     reset(settings, true);
@@ -106,10 +109,17 @@ void retrogames::games::pingpong_t::create_ball(void)
 */
 bool retrogames::games::pingpong_t::draw(bool render)
 {
-    if (!render) return false;
+    if (!render)
+    {
+        resuming = true;
+
+        return false;
+    }
 
-    // set the time scale
-    time_scale = ImGui::GetIO().DeltaTime * (static_cast<float>(resolution_area.width) / 1280.f);
+    // set the time scale. The first frame after not drawing for a while (in the background, frames
+    // are far apart) would move everything by the whole gap, it doesn't move anything instead
+    time_scale = resuming ? 0. : ImGui::GetIO().DeltaTime * (static_cast<float>(resolution_area.width) / 1280.f);
+    resuming = false;
 
     // function to move our ball
     // returns true if one side
@@ -357,6 +367,15 @@ bool retrogames::games::pingpong_t::draw(bool render)
 
         move_paddle(right_paddle.get(), .5, 1., right_paddle_move_to_calculated_position);
 
+        // the paddles moved for the last key, and this frame shows it
+        if (latency_sample != 0)
+        {
+            get_latency_probe().took_effect(latency_sample, get_latency_probe().get_frame());
+            get_latency_probe().submitted(latency_sample);
+
+            latency_sample = 0;
+        }
+
         // move the ball
         auto old_left_points = left_paddle->points;
         auto old_right_points = right_paddle->points;
@@ -494,15 +513,20 @@ bool retrogames::games::pingpong_t::draw(bool render)
         ImGui::GetBackgroundDrawList()->AddText(ImVec2{static_cast<float>(target_x), static_cast<float>(target_y)}, ImGuiUser::color_to_imgui_color_u32(color_t(200, 200, 200)), score.c_str());
     };
 
-    ImGui::PushFont(main_font);
+    ImGui::PushFont(*main_font);
 
     draw_score(left_paddle.get());
     draw_score(right_paddle.get());
 
     ImGui::PopFont();
 
+    // the middle line, ball and paddles go into one batch
+    auto& primitives = get_primitives();
+
+    primitives.begin();
+
     // draw the middle line
-    static auto draw_dashline = [](float x0, float y0, float x1, float y1, float* spacing, int spacing_size, int line_width, color_t color) 
+    static auto draw_dashline = [](primitive_batch_t& primitives, float x0, float y0, float x1, float y1, float* spacing, int spacing_size, int line_width, color_t color) 
     { 
         auto lerp = [](float a, float b, float f)
         {
@@ -515,8 +539,9 @@ bool retrogames::games::pingpong_t::draw(bool render)
         };
 
         auto distance = dist(x0, y0, x1, y1);
-        auto x_spacing = new float[spacing_size];
-        auto y_spacing = new float[spacing_size];
+        auto x_spacing = std::vector<float>(spacing_size);
+        auto y_spacing = std::vector<float>(spacing_size);
+        auto line_color = ImGuiUser::color_to_imgui_color_u32(color);
 
         float drawn = 0.f;
         
@@ -537,7 +562,7 @@ bool retrogames::games::pingpong_t::draw(bool render)
             while (drawn < distance) 
             { 
                 //if (draw_line) line(x0, y0, x0 + x_spacing[i], y0 + y_spacing[i]);
-                if (draw_line) ImGui::GetBackgroundDrawList()->AddLine({x0, y0}, {x0+x_spacing[i],y0+y_spacing[i]}, ImGuiUser::color_to_imgui_color_u32(color), line_width);
+                if (draw_line) primitives.add_line({x0, y0}, {x0+x_spacing[i],y0+y_spacing[i]}, line_color, line_width);
 
                 x0 += x_spacing[i];
                 y0 += y_spacing[i];
@@ -558,12 +583,14 @@ bool retrogames::games::pingpong_t::draw(bool render)
     auto dash_line_start = ImVec2{static_cast<float>(resolution_area.width / 2), 0.f};
     auto dash_line_end = ImVec2{static_cast<float>(resolution_area.width / 2), static_cast<float>(resolution_area.height)};
 
-    draw_dashline(dash_line_start.x, dash_line_start.y, dash_line_end.x, dash_line_end.y, pattern, 2, static_cast<int32_t>(static_cast<float>(resolution_area.width) / 200.f), color_t(200, 200, 200));
+    draw_dashline(primitives, dash_line_start.x, dash_line_start.y, dash_line_end.x, dash_line_end.y, pattern, 2, static_cast<int32_t>(static_cast<float>(resolution_area.width) / 200.f), color_t(200, 200, 200));
 
     // draw the ball and paddles
-    ball->draw();
-    left_paddle->draw();
-    right_paddle->draw();
+    ball->draw(primitives);
+    left_paddle->draw(primitives);
+    right_paddle->draw(primitives);
+
+    primitives.flush(ImGui::GetBackgroundDrawList());
 
     // draw the modal for winning
     if (winner_paddle != nullptr)
@@ -575,7 +602,7 @@ bool retrogames::games::pingpong_t::draw(bool render)
         {
             if (!confirm_exit_game)
             {
-                auto button_size = ImVec2{ImGui::CalcTextSize("Back to main menu").x+ImGui::GetStyle().FramePadding.x*2.f,0.f};
+                auto button_size = ImVec2{ImGuiUser::calc_text_size("Back to main menu").x+ImGui::GetStyle().FramePadding.x*2.f,0.f};
 
                 ImGui::Text("%s side won!", (winner_paddle->left ? "Left" : "Right"));
 
@@ -603,7 +630,7 @@ bool retrogames::games::pingpong_t::draw(bool render)
             {
                 ImGui::TextUnformatted("Are you sure?");
 
-                auto button_size = ImVec2{((ImGui::CalcTextSize("Are you sure?").x+ImGui::GetStyle().FramePadding.x*2.f)*.5f)-ImGui::GetStyle().ItemInnerSpacing.x*2.f,0.f};
+                auto button_size = ImVec2{((ImGuiUser::calc_text_size("Are you sure?").x+ImGui::GetStyle().FramePadding.x*2.f)*.5f)-ImGui::GetStyle().ItemInnerSpacing.x*2.f,0.f};
 
                 if (ImGui::Button("Yes", button_size)) should_exit = true;
 
@@ -636,6 +663,11 @@ void retrogames::games::pingpong_t::handle_key(ImGuiKey key, bool pressed)
 
             timer.stop();
             timer.start();
+
+            // the paddles move for it with the next frame
+            get_latency_probe().discard(latency_sample);
+
+            latency_sample = get_latency_probe().accept();
         }
     }
     else if (key == ImGuiKey_Escape && pressed)
@@ -766,16 +798,30 @@ void retrogames::games::pingpong_t::draw_information(float scaling)
 
 }
 
+/*
+@brief
+
+    Describes how the game went so far (the score, who won), for run summaries
+*/
+std::string retrogames::games::pingpong_t::get_outcome(void)
+{
+    auto outcome = std::to_string(left_paddle->points) + ":" + std::to_string(right_paddle->points);
+
+    if (winner_paddle != nullptr) outcome += winner_paddle->left ? ", left won" : ", right won";
+
+    return outcome;
+}
+
 /*
 @brief
 
     Draws the ball
 */
-void retrogames::games::pingpong_t::ball_t::draw(void)
+void retrogames::games::pingpong_t::ball_t::draw(primitive_batch_t& primitives)
 {
     static auto ball_color = color_t(200, 200, 200);
 
-    ImGui::GetBackgroundDrawList()->AddRectFilled(ImVec2{static_cast<float>(x)-static_cast<float>(size / 2), static_cast<float>(y)-static_cast<float>(size / 2)}, ImVec2{static_cast<float>(x+static_cast<float>(size / 2)),static_cast<float>(y+static_cast<float>(size / 2))}, ImGuiUser::color_to_imgui_color_u32(ball_color));
+    primitives.add_filled_rect(ImVec2{static_cast<float>(x)-static_cast<float>(size / 2), static_cast<float>(y)-static_cast<float>(size / 2)}, ImVec2{static_cast<float>(size / 2 * 2), static_cast<float>(size / 2 * 2)}, ImGuiUser::color_to_imgui_color_u32(ball_color));
 }
 
 /*
@@ -783,28 +829,24 @@ void retrogames::games::pingpong_t::ball_t::draw(void)
 
     Draws a paddle
 */
-void retrogames::games::pingpong_t::paddle_t::draw(void)
+void retrogames::games::pingpong_t::paddle_t::draw(primitive_batch_t& primitives)
 {
     static auto paddle_color = color_t(220, 220, 220);
     //static auto paddle_color_moving_to_position = color_t(220, 50, 50);
 
     auto current_paddle_color = /*moving_to_calculated_position ? paddle_color_moving_to_position : */paddle_color;
 
-    ImGui::GetBackgroundDrawList()->AddRectFilled(ImVec2{static_cast<float>(x), static_cast<float>(y)}, ImVec2{static_cast<float>(x + static_cast<double>(size.width)), static_cast<float>(y + static_cast<double>(size.height))}, ImGuiUser::color_to_imgui_color_u32(current_paddle_color));
+    primitives.add_filled_rect(ImVec2{static_cast<float>(x), static_cast<float>(y)}, ImVec2{static_cast<float>(size.width), static_cast<float>(size.height)}, ImGuiUser::color_to_imgui_color_u32(current_paddle_color));
 }
 
 /*
 @brief
 
-    Creates the main font
+    Requests the main font (the font service creates it)
 */
 void retrogames::games::pingpong_t::create_main_font(float scaling)
 {
-    ImFontConfig font_config;
-
-    font_config.SizePixels = std::ceil((static_cast<float>(resolution_area.height) / 10.f) * scaling);
-
-    main_font = ImGui::GetIO().Fonts->AddFontDefault(&font_config);
+    main_font = get_font_service()->request(get_information().name + "_main", std::ceil((static_cast<float>(resolution_area.height) / 10.f) * scaling));
 }
 
 /*
@@ -317,7 +317,7 @@ namespace retrogames
 
                     Draws the ball
                 */
-                void draw(void);
+                void draw(primitive_batch_t& primitives);
 
             };
 
@@ -390,7 +390,7 @@ namespace retrogames
 
                     Draws a paddle
                 */
-                void draw(void);
+                void draw(primitive_batch_t& primitives);
 
             };
 
@@ -405,6 +405,9 @@ namespace retrogames
 
             control_keys_t control_keys;
 
+            // The newest movement key the paddles didn't move for yet (see capture/latency_probe.h)
+            uint32_t latency_sample;
+
             cfgvalue_t& cfgvalue_ping_scale_x;
             cfgvalue_t& cfgvalue_ping_scale_y;
             cfgvalue_t& cfgvalue_initial_paddle_speed;
@@ -418,15 +421,19 @@ namespace retrogames
             double ball_scale;
             double time_scale;
 
-            ImFont* main_font;
+            // Handle from the font service (see create_main_font)
+            ImFont** main_font;
 
             bool should_exit;
             bool confirm_exit_game;
 
+            // Set while we're not drawing (in the background), the first frame back doesn't move anything
+            bool resuming;
+
             /*
             @brief
 
-                Creates the main font
+                Requests the main font (the font service creates it)
             */
             void create_main_font(float scaling);
 
@@ -451,7 +458,7 @@ namespace retrogames
 
                 Constructor
             */
-            pingpong_t(settings_t* settings, const std::string& name, ImFont** default_font_small, ImFont** default_font_mid, ImFont** default_font_big, const std::string& version = "1.0", uint8_t* icon = nullptr);
+            pingpong_t(settings_t* settings, const std::string& name, font_service_t* font_service, ImFont** default_font_small, ImFont** default_font_mid, ImFont** default_font_big, const std::string& version = "1.0", uint8_t* icon = nullptr);
 
             /*
             @brief
@@ -495,6 +502,13 @@ namespace retrogames
             */
             virtual void draw_information(float scaling) override;
 
+            /*
+            @brief
+
+                Describes how the game went so far (the score, who won), for run summaries
+            */
+            virtual std::string get_outcome(void) override;
+
         };
 
     }
@@ -13,6 +13,7 @@
 #include <random>
 #include <algorithm>
 #include "snake.h"
+#include "capture/latency_probe.h"
 #include "misc/area_size.h"
 #include "misc/macros.h"
 #include "imgui/imgui_user.h"
@@ -25,7 +26,16 @@
 */
 bool retrogames::games::snake_t::draw(bool render)
 {
-    if (!render) return false;
+    if (!render)
+    {
+        // don't move the snake while nobody sees it
+        simulation.set_active(false);
+
+        return false;
+    }
+
+    // the snake moves on its own thread (see @start_simulation)
+    if (!simulation.is_started()) start_simulation();
 
     // calculate the space we have available to the right and left of the actual snake playing field.
     // we have a 16:9 resolution so we won't have a perfect square.
@@ -76,6 +86,9 @@ bool retrogames::games::snake_t::draw(bool render)
     {
         should_exit = false;
 
+        // we're going back to the main menu, the simulation thread isn't needed until we come back
+        simulation.stop();
+
         return true;
     }
 
@@ -85,24 +98,58 @@ bool retrogames::games::snake_t::draw(bool render)
 /*
 @brief
 
-    Draws the snake playing field and handles all the logic
+    Draws the snake playing field from the latest snapshot
 */
 void retrogames::games::snake_t::draw_field(void)
 {
+    // run the simulation on this thread if there's no simulation thread, then grab its latest snapshot
+    simulation.pump();
+    snapshots.update();
+
+    // the snapshot is ours until the next update, so the death animation below may change it
+    auto& snapshot = snapshots.get_front();
+
+    // this frame shows the keys the snapshot's move applied
+    get_latency_probe().submitted(snapshot.latency_sample);
+
+    // pause right away, the snake finishes the move it's animating and stops there
+    if (hit_pause)
+    {
+        toggle_pause();
+
+        hit_pause = false;
+    }
+
+    // the snake only moves while the game runs
+    simulation.set_active(can_continue() && !snapshot.dead);
+
+    // play the eat sound here, the simulation thread doesn't touch the sound library
+    if (static_vars.last_eat_counter != snapshot.eat_counter)
+    {
+        static_vars.last_eat_counter = snapshot.eat_counter;
+
+        play_sound_effect(snd_t::sounds_e::SOUND_EAT);
+    }
+
     // get the window size
     auto window_size = ImVec2(resolution_area.height, resolution_area.height);
 
+    // the whole field goes into one batch, which gets written into the window's draw list at the end
+    auto& primitives = get_primitives();
+
+    primitives.begin(ImGui::GetWindowPos());
+
     // fill the playing field background
-    draw_filled_rect(ImVec2(0, 0), window_size, color_t(0, 0, 0));
+    primitives.add_filled_rect(ImVec2(0, 0), window_size, ImGuiUser::color_to_imgui_color_u32(color_t(0, 0, 0)));
 
     // list of parts for the snake, so we can first draw the outline and then the snake on top
-    static std::deque<std::tuple<ImVec2, color_t, color_t>> parts;
+    static std::deque<std::tuple<ImVec2, ImU32, ImU32>> parts;
 
     // clear the parts list
     parts.clear();
 
     // helper function to add a snake part to the draw list
-    static auto add_part = [this](const ImVec2& box_position, const float& offset, const DIRECTION& direction, color_t fill_color, color_t outline_color)
+    static auto add_part = [this](const ImVec2& box_position, const float& offset, const DIRECTION& direction, ImU32 fill_color, ImU32 outline_color)
     {
         auto pos = ImVec2(box_position.x * static_cast<float>(box_size), box_position.y * static_cast<float>(box_size));
 
@@ -137,154 +184,128 @@ void retrogames::games::snake_t::draw_field(void)
     static auto snake_color = color_t(0, 200, 0);
     static auto snake_head_color = color_t(0, 150, 0);
 
-    if (dead)
+    if (snapshot.dead)
     {
-        // we died, pulsate the outline color instead (every second)
-        auto ms_elapsed = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - death_time).count());
+        // we died, pulsate the outline color instead (every second). The simulation may have killed us
+        // after this frame started, so don't go below 0
+        auto ms_elapsed = static_cast<uint64_t>(std::max<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(get_clock().get_frame_time() - snapshot.death_time).count(), 0));
         auto angle = (static_cast<double>(static_cast<double>(ms_elapsed) - std::floor(static_cast<double>(ms_elapsed) / 1000.0) * 1000.0) / 1000.0) * 360.0;
         auto scale = 0.5 + std::sin(angle * 0.0174533) * 0.5; // 0.f to 1.f
 
         outline_color = color_t(255 / 2 + static_cast<uint8_t>(scale * (255 / 2)), 0, 0);
     }
 
+    // convert the colors once instead of once per shape
+    auto outline_color_u32 = ImGuiUser::color_to_imgui_color_u32(outline_color);
+    auto outline_color_original_u32 = ImGuiUser::color_to_imgui_color_u32(outline_color_original);
+    auto snake_color_u32 = ImGuiUser::color_to_imgui_color_u32(snake_color);
+    auto snake_head_color_u32 = ImGuiUser::color_to_imgui_color_u32(snake_head_color);
+
     // draw the valid snake positions
-    auto positions_color = color_t(100, 100, 100, 100);
+    auto positions_color = ImGuiUser::color_to_imgui_color_u32(color_t(100, 100, 100, 100));
 
     for (uint32_t i = 1; i < box_amount; i++)
     {
-        draw_line(ImVec2(0.f, static_cast<float>(i * box_size)), ImVec2(resolution_area.height, static_cast<float>(i * box_size)), positions_color);
-        draw_line(ImVec2(static_cast<float>(i * box_size), 0.f), ImVec2(static_cast<float>(i * box_size), resolution_area.height), positions_color);
+        primitives.add_line(ImVec2(0.f, static_cast<float>(i * box_size)), ImVec2(resolution_area.height, static_cast<float>(i * box_size)), positions_color);
+        primitives.add_line(ImVec2(static_cast<float>(i * box_size), 0.f), ImVec2(static_cast<float>(i * box_size), resolution_area.height), positions_color);
     }
 
-    // calculate the delay between snake move-frames
-    // also check if we're able to move or not (not mid-animation)
+    // interpolate from the last move towards the next one
     float scale = 0.f;
-    bool can_move = false;
     {
-        auto& update_interval = fpsmanager.get_update_interval();
-        auto& next_frame = fpsmanager.get_next_frame_time_point();
-        auto now = std::chrono::high_resolution_clock::now();
+        auto& update_interval = simulation.get_tick_interval();
+        auto elapsed = get_clock().get_frame_time() - snapshot.move_time;
 
-        if (now < next_frame)
-        {
-            scale = 1.f - (static_cast<float>((next_frame - now).count()) / static_cast<float>(update_interval.count()));
-        }
-        else
-        {
-            can_move = true;
-        }
+        scale = std::min(1.f, std::max(0.f, static_cast<float>(elapsed.count()) / static_cast<float>(update_interval.count())));
     }
 
-    // move the snake if need be, also remember if we've moved or not (needed later)
-    bool moved = false;
-
-    if (can_move)
-    {
-        if (hit_pause)
-        {
-            toggle_pause();
-
-            hit_pause = false;
-        }
-
-        if (!is_paused())
-        {
-            auto dir = think();
-
-            if (dir != DIRECTION::SNAKE_DIRECTION_NONE)
-            {
-                static_vars.direction = dir;
-
-                moved = true;
-            }
-        }
-        else
-        {
-            scale = 1.f;
-        }
-    }
-    else if (is_in_timeout())
-    {
-        scale = 0.f;
-    }
+    if (is_in_timeout()) scale = 0.f;
 
     // move one more time if we died (since we're one frame behind)
     if (static_vars.last_dead_needs_reset)
     {
-        static_vars.last_dead = dead;
+        static_vars.last_dead = snapshot.dead;
         static_vars.last_dead_needs_reset = false;
     }
 
-    if (static_vars.last_dead != dead)
+    if (static_vars.last_dead != snapshot.dead)
     {
-        static_vars.last_dead = dead;
+        static_vars.last_dead = snapshot.dead;
+
+        if (snapshot.dead)
+        {
+            static_vars.interpolate_last_time = true;
 
-        if (dead) static_vars.interpolate_last_time = true;
+            death_state = DEATH_STATE::DEATH_STATE_MAIN;
+        }
     }
 
-    if (dead)
+    if (snapshot.dead)
     {
         if (!static_vars.interpolate_last_time) scale = 0.f;
         else
         {
-            if (scale == 0.f)
+            if (scale >= 1.f)
             {
-                last_head = head;
+                // no more snapshots come in until we retry, so this sticks
+                snapshot.last_head = snapshot.head;
 
                 static_vars.interpolate_last_time = false;
+
+                scale = 0.f;
             }
         }
     }
 
     // add the snake parts
-    for (int32_t i = static_cast<int32_t>(last_position_history.size()); i >= 0; i--)
+    for (int32_t i = static_cast<int32_t>(snapshot.last_position_history.size()); i >= 0; i--)
     {
         auto dir = DIRECTION::SNAKE_DIRECTION_DEFAULT;
 
-        if (i == last_position_history.size())
+        if (i == snapshot.last_position_history.size())
         {
             // fill in corners
-            if (!last_position_history.empty()) add_part(last_head, 0.f, dir, snake_color, outline_color);
+            if (!snapshot.last_position_history.empty()) add_part(snapshot.last_head, 0.f, dir, snake_color_u32, outline_color_u32);
 
             // add the head (interpolated)
-            add_part(last_head, static_vars.direction == DIRECTION::SNAKE_DIRECTION_NONE ? 0.f : scale, static_vars.direction, snake_head_color, outline_color);
+            add_part(snapshot.last_head, snapshot.direction == DIRECTION::SNAKE_DIRECTION_NONE ? 0.f : scale, snapshot.direction, snake_head_color_u32, outline_color_u32);
 
             continue;
         }
-        else if (i == 0 && !last_position_history.empty() && move_eat_counter == move_counter)
+        else if (i == 0 && !snapshot.last_position_history.empty() && snapshot.move_eat_counter == snapshot.move_counter)
         {
             // we've just eaten and this is the tail, smooth out the animation of it popping out.
             ImVec2 next_box_position{}; // One block after our tail
 
-            if (last_position_history.size() > 1)
+            if (snapshot.last_position_history.size() > 1)
             {
-                auto& pos = last_position_history[static_cast<uint64_t>(i) + 1];
+                auto& pos = snapshot.last_position_history[static_cast<uint64_t>(i) + 1];
 
                 next_box_position = ImVec2{ static_cast<float>(pos.first), static_cast<float>(pos.second) };
             }
             else
             {
-                next_box_position = last_head;
+                next_box_position = snapshot.last_head;
             }
 
-            add_part(next_box_position, 0.f, dir, snake_color, outline_color);
+            add_part(next_box_position, 0.f, dir, snake_color_u32, outline_color_u32);
 
             continue;
         }
 
-        auto& pos = last_position_history[i];
+        auto& pos = snapshot.last_position_history[i];
         auto box_position = ImVec2{ static_cast<float>(pos.first), static_cast<float>(pos.second) };
 
-        if (i == last_position_history.size() - 1)
+        if (i == snapshot.last_position_history.size() - 1)
         {
-            if (last_head.x == box_position.x + 1) dir = DIRECTION::SNAKE_DIRECTION_RIGHT;
-            else if (last_head.x == box_position.x - 1) dir = DIRECTION::SNAKE_DIRECTION_LEFT;
-            else if (last_head.y == box_position.y + 1) dir = DIRECTION::SNAKE_DIRECTION_DOWN;
-            else if (last_head.y == box_position.y - 1) dir = DIRECTION::SNAKE_DIRECTION_UP;
+            if (snapshot.last_head.x == box_position.x + 1) dir = DIRECTION::SNAKE_DIRECTION_RIGHT;
+            else if (snapshot.last_head.x == box_position.x - 1) dir = DIRECTION::SNAKE_DIRECTION_LEFT;
+            else if (snapshot.last_head.y == box_position.y + 1) dir = DIRECTION::SNAKE_DIRECTION_DOWN;
+            else if (snapshot.last_head.y == box_position.y - 1) dir = DIRECTION::SNAKE_DIRECTION_UP;
         }
         else
         {
-            auto& next_pos = last_position_history[static_cast<uint64_t>(i) + 1];
+            auto& next_pos = snapshot.last_position_history[static_cast<uint64_t>(i) + 1];
             auto next_box_position = ImVec2{ static_cast<float>(next_pos.first), static_cast<float>(next_pos.second) };
 
             if (next_box_position.x == box_position.x + 1) dir = DIRECTION::SNAKE_DIRECTION_RIGHT;
@@ -293,10 +314,10 @@ void retrogames::games::snake_t::draw_field(void)
             else if (next_box_position.y == box_position.y - 1) dir = DIRECTION::SNAKE_DIRECTION_UP;
 
             // to fill in corners (looks kinda trippy otherwise)
-            add_part(next_box_position, 0.f, dir, snake_color, outline_color);
+            add_part(next_box_position, 0.f, dir, snake_color_u32, outline_color_u32);
         }
 
-        add_part(box_position, scale, dir, snake_color, outline_color);
+        add_part(box_position, scale, dir, snake_color_u32, outline_color_u32);
     }
 
     // helper function to get outline position and size
@@ -329,52 +350,42 @@ void retrogames::games::snake_t::draw_field(void)
     };
 
     // helper function to draw an outline
-    const auto draw_outline = [this, get_outline_pos_and_size](const ImVec2& pos, const color_t& color)
+    const auto draw_outline = [&primitives, get_outline_pos_and_size](const ImVec2& pos, ImU32 color)
     {
         auto _pos = get_outline_pos_and_size(pos);
 
-        draw_rect(_pos.first, _pos.second, color);
+        primitives.add_rect(_pos.first, _pos.second, color);
     };
 
     // draw foods
-    static const auto food_color = color_t(200, 0, 0);
+    auto food_color = ImGuiUser::color_to_imgui_color_u32(color_t(200, 0, 0));
 
     // outline
-    for (const auto& food : foods)
+    for (const auto& food : snapshot.foods)
     {
-        draw_outline(ImVec2(static_cast<float>(std::get<0>(food) * box_size), static_cast<float>(std::get<1>(food) * box_size)), outline_color_original);
+        draw_outline(ImVec2(static_cast<float>(std::get<0>(food) * box_size), static_cast<float>(std::get<1>(food) * box_size)), outline_color_original_u32);
     }
 
     // fill
-    for (const auto& food : foods)
+    for (const auto& food : snapshot.foods)
     {
-        draw_filled_rect(ImVec2(static_cast<float>(std::get<0>(food) * box_size), static_cast<float>(std::get<1>(food) * box_size)), ImVec2(static_cast<float>(box_size), static_cast<float>(box_size)), food_color);
+        primitives.add_filled_rect(ImVec2(static_cast<float>(std::get<0>(food) * box_size), static_cast<float>(std::get<1>(food) * box_size)), ImVec2(static_cast<float>(box_size), static_cast<float>(box_size)), food_color);
     }
 
     // cached foods (to smooth out the animation of eating the food)
-    if (!cached_foods.empty())
+    // (the simulation only keeps the ones eaten by the last move)
+    if (!snapshot.cached_foods.empty())
     {
         // outline
-        for (const auto& food : cached_foods)
+        for (const auto& food : snapshot.cached_foods)
         {
-            draw_outline(ImVec2(static_cast<float>(std::get<0>(food) * box_size), static_cast<float>(std::get<1>(food) * box_size)), outline_color_original);
+            draw_outline(ImVec2(static_cast<float>(std::get<0>(food) * box_size), static_cast<float>(std::get<1>(food) * box_size)), outline_color_original_u32);
         }
 
         // fill
-        for (auto it = cached_foods.begin(); it != cached_foods.end();)
+        for (const auto& food : snapshot.cached_foods)
         {
-            auto food = *it;
-
-            if (std::get<2>(food) == move_counter)
-            {
-                draw_filled_rect(ImVec2(static_cast<float>(std::get<0>(food) * box_size), static_cast<float>(std::get<1>(food) * box_size)), ImVec2(static_cast<float>(box_size), static_cast<float>(box_size)), food_color);
-
-                it++;
-            }
-            else
-            {
-                it = cached_foods.erase(it);
-            }
+            primitives.add_filled_rect(ImVec2(static_cast<float>(std::get<0>(food) * box_size), static_cast<float>(std::get<1>(food) * box_size)), ImVec2(static_cast<float>(box_size), static_cast<float>(box_size)), food_color);
         }
     }
 
@@ -393,7 +404,7 @@ void retrogames::games::snake_t::draw_field(void)
         draw_outline(pos, outline_color);
 
         // check if we have an outside snake part if we're dead (due to the rendering order)
-        if (dead)
+        if (snapshot.dead)
         {
             const auto outside_pos = static_cast<float>(box_size) * (static_cast<float>(box_amount) - 1.f);
 
@@ -407,11 +418,11 @@ void retrogames::games::snake_t::draw_field(void)
         const auto& pos = std::get<0>(part);
         const auto& fill_color = std::get<1>(part);
 
-        draw_filled_rect(pos, ImVec2(static_cast<float>(box_size), static_cast<float>(box_size)), fill_color);
+        primitives.add_filled_rect(pos, ImVec2(static_cast<float>(box_size), static_cast<float>(box_size)), fill_color);
     }
     
     // draw the field outline
-    draw_rect(ImVec2(0.f, 0.f), window_size, outline_color_original);
+    primitives.add_rect(ImVec2(0.f, 0.f), window_size, outline_color_original_u32);
 
     // replace parts of the field outline with flashing red if we died
     if (!outside_parts.empty())
@@ -421,54 +432,19 @@ void retrogames::games::snake_t::draw_field(void)
             const auto outside_pos = static_cast<float>(box_size) * (static_cast<float>(box_amount) - 1.f);
             const auto outside_draw_pos = window_size.y - 1.f;
 
-            if (pos.first == 0.f) draw_line(ImVec2(0.f, static_cast<float>(pos.second)), ImVec2(0.f, static_cast<float>(pos.second) + static_cast<float>(box_size)), outline_color);
-            else if (pos.first == outside_pos) draw_line(ImVec2(outside_draw_pos, static_cast<float>(pos.second)), ImVec2(outside_draw_pos, static_cast<float>(pos.second) + static_cast<float>(box_size)), outline_color);
+            if (pos.first == 0.f) primitives.add_line(ImVec2(0.f, static_cast<float>(pos.second)), ImVec2(0.f, static_cast<float>(pos.second) + static_cast<float>(box_size)), outline_color_u32);
+            else if (pos.first == outside_pos) primitives.add_line(ImVec2(outside_draw_pos, static_cast<float>(pos.second)), ImVec2(outside_draw_pos, static_cast<float>(pos.second) + static_cast<float>(box_size)), outline_color_u32);
 
-            if (pos.second == 0.f) draw_line(ImVec2(static_cast<float>(pos.first), 0.f), ImVec2(static_cast<float>(pos.first) + static_cast<float>(box_size), 0.f), outline_color);
-            else if (pos.second == outside_pos) draw_line(ImVec2(static_cast<float>(pos.first), outside_draw_pos), ImVec2(static_cast<float>(pos.first) + static_cast<float>(box_size), outside_draw_pos), outline_color);
+            if (pos.second == 0.f) primitives.add_line(ImVec2(static_cast<float>(pos.first), 0.f), ImVec2(static_cast<float>(pos.first) + static_cast<float>(box_size), 0.f), outline_color_u32);
+            else if (pos.second == outside_pos) primitives.add_line(ImVec2(static_cast<float>(pos.first), outside_draw_pos), ImVec2(static_cast<float>(pos.first) + static_cast<float>(box_size), outside_draw_pos), outline_color_u32);
         }
     }
 
+    primitives.flush(ImGui::GetWindowDrawList());
+
     // if the player is dead, draw the death menu
     // and if the game is paused, draw a pause menu
-    if (dead) draw_death_menu();
-}
-
-/*
-@brief
-
-    Draws a filled rectangle at the @pos and @size in the current ImGui window
-*/
-void retrogames::games::snake_t::draw_filled_rect(const ImVec2& pos, const ImVec2& size, color_t color)
-{
-    auto window_pos = ImGui::GetWindowPos();
-
-    ImGui::GetWindowDrawList()->AddRectFilled(ImVec2(window_pos.x + pos.x, window_pos.y + pos.y), ImVec2(window_pos.x + pos.x + size.x, window_pos.y + pos.y + size.y), ImGuiUser::color_to_imgui_color_u32(color));
-}
-
-/*
-@brief
-
-    Draws a rectangle at the @pos and @size in the current ImGui window
-*/
-void retrogames::games::snake_t::draw_rect(const ImVec2& pos, const ImVec2& size, color_t color)
-{
-    auto window_pos = ImGui::GetWindowPos();
-
-    ImGui::GetWindowDrawList()->AddRect(ImVec2(window_pos.x + pos.x, window_pos.y + pos.y), ImVec2(window_pos.x + pos.x + size.x, window_pos.y + pos.y + size.y), ImGuiUser::color_to_imgui_color_u32(color));
-}
-
-/*
-@brief
-
-    Draws a line between @pos_1 and @pos_2 given the @thickness
-    in the current ImGui window
-*/
-void retrogames::games::snake_t::draw_line(const ImVec2& pos_1, const ImVec2& pos_2, color_t color, float thickness/* = 1.f*/)
-{
-    auto window_pos = ImGui::GetWindowPos();
-
-    ImGui::GetWindowDrawList()->AddLine(ImVec2(window_pos.x + pos_1.x, window_pos.y + pos_1.y), ImVec2(window_pos.x + pos_2.x, window_pos.y + pos_2.y), ImGuiUser::color_to_imgui_color_u32(color), thickness);
+    if (snapshot.dead) draw_death_menu();
 }
 
 /*
@@ -481,57 +457,33 @@ void retrogames::games::snake_t::handle_key(ImGuiKey key, bool pressed)
     if (!pressed) return;
 
     // escape toggles pause
-    if (key == ImGuiKey_Escape && !dead) hit_pause = true;
+    if (key == ImGuiKey_Escape && !snapshots.get_front().dead) hit_pause = true;
     if (is_paused() || (!is_paused() && hit_pause)) return;
 
-    // helper function to add a direction to our direction stack (thread-safe)
-    static auto add_direction = [this](DIRECTION dir)
-    {
-        // determine the current direction
-        auto current_dir = force_direction == DIRECTION::SNAKE_DIRECTION_NONE ? direction_stack.at(0) : force_direction;
-
-        // already set
-        if (dir == current_dir) return;
-
-        // check if it goes against itself
-        if ((dir == DIRECTION::SNAKE_DIRECTION_RIGHT && current_dir == DIRECTION::SNAKE_DIRECTION_LEFT ||
-            dir == DIRECTION::SNAKE_DIRECTION_LEFT && current_dir == DIRECTION::SNAKE_DIRECTION_RIGHT ||
-            dir == DIRECTION::SNAKE_DIRECTION_UP && current_dir == DIRECTION::SNAKE_DIRECTION_DOWN ||
-            dir == DIRECTION::SNAKE_DIRECTION_DOWN && current_dir == DIRECTION::SNAKE_DIRECTION_UP))
-        {
-            if (!position_history.empty()) return;
-        }
-
-        // all good, add the direction to our stack
-        direction_stack.push_back(dir);
-
-        // we can now reset the force direction because we have a stack
-        force_direction = DIRECTION::SNAKE_DIRECTION_NONE;
-    };
-
+    // the simulation thread picks the direction up with its next move (see @add_direction)
     switch (key)
     {
 		case ImGuiKey_LeftArrow: case ImGuiKey_A:
 		{
-			add_direction(DIRECTION::SNAKE_DIRECTION_LEFT);
+			direction_queue.push({ DIRECTION::SNAKE_DIRECTION_LEFT, get_latency_probe().accept() });
 
 			break;
 		}
 		case ImGuiKey_RightArrow: case ImGuiKey_D:
 		{
-			add_direction(DIRECTION::SNAKE_DIRECTION_RIGHT);
+			direction_queue.push({ DIRECTION::SNAKE_DIRECTION_RIGHT, get_latency_probe().accept() });
 
 			break;
 		}
 		case ImGuiKey_UpArrow: case ImGuiKey_W:
 		{
-			add_direction(DIRECTION::SNAKE_DIRECTION_UP);
+			direction_queue.push({ DIRECTION::SNAKE_DIRECTION_UP, get_latency_probe().accept() });
 
 			break;
 		}
 		case ImGuiKey_DownArrow: case ImGuiKey_S:
 		{
-			add_direction(DIRECTION::SNAKE_DIRECTION_DOWN);
+			direction_queue.push({ DIRECTION::SNAKE_DIRECTION_DOWN, get_latency_probe().accept() });
 
 			break;
 		}
@@ -550,14 +502,108 @@ void retrogames::games::snake_t::handle_key(ImGuiKey key, bool pressed)
 void retrogames::games::snake_t::kill(void)
 {
     dead = true;
-    death_time = std::chrono::high_resolution_clock::now();
-    death_state = DEATH_STATE::DEATH_STATE_MAIN;
+    death_time = get_clock().now();
+}
+
+/*
+@brief
+
+    Adds a direction to our direction stack, unless it's where we're going already
+    or it would turn the snake back into itself (simulation thread)
+*/
+bool retrogames::games::snake_t::add_direction(DIRECTION dir)
+{
+    // determine the current direction
+    auto current_dir = force_direction == DIRECTION::SNAKE_DIRECTION_NONE ? direction_stack.at(0) : force_direction;
+
+    // already set
+    if (dir == current_dir) return false;
+
+    // check if it goes against itself
+    if ((dir == DIRECTION::SNAKE_DIRECTION_RIGHT && current_dir == DIRECTION::SNAKE_DIRECTION_LEFT ||
+        dir == DIRECTION::SNAKE_DIRECTION_LEFT && current_dir == DIRECTION::SNAKE_DIRECTION_RIGHT ||
+        dir == DIRECTION::SNAKE_DIRECTION_UP && current_dir == DIRECTION::SNAKE_DIRECTION_DOWN ||
+        dir == DIRECTION::SNAKE_DIRECTION_DOWN && current_dir == DIRECTION::SNAKE_DIRECTION_UP))
+    {
+        if (!position_history.empty()) return false;
+    }
+
+    // all good, add the direction to our stack
+    direction_stack.push_back(dir);
+
+    // we can now reset the force direction because we have a stack
+    force_direction = DIRECTION::SNAKE_DIRECTION_NONE;
+
+    return true;
+}
+
+/*
+@brief
+
+    Starts moving the snake on the simulation thread
+*/
+void retrogames::games::snake_t::start_simulation(void)
+{
+    simulation.start(snake_fps, [this]() { tick(); });
 }
 
 /*
 @brief
 
-    Resets all the variables associated with the snake
+    One step of the simulation: applies queued direction keys, moves the snake
+    and publishes a snapshot if it moved (simulation thread)
+*/
+void retrogames::games::snake_t::tick(void)
+{
+    queued_direction_t queued;
+
+    while (direction_queue.pop(queued))
+    {
+        if (add_direction(queued.direction)) latency_samples.push_back(queued.latency_sample);
+        else get_latency_probe().discard(queued.latency_sample);
+    }
+
+    if (think() == DIRECTION::SNAKE_DIRECTION_NONE) return;
+
+    // the keys we've applied show with this move
+    for (auto sample : latency_samples) get_latency_probe().took_effect(sample, simulation.get_tick_count());
+
+    publish_snapshot();
+}
+
+/*
+@brief
+
+    Copies everything needed for drawing into a snapshot and hands it to the render thread
+*/
+void retrogames::games::snake_t::publish_snapshot(void)
+{
+    auto& snapshot = snapshots.get_back();
+
+    snapshot.head = head;
+    snapshot.last_head = last_head;
+    snapshot.direction = last_direction;
+    snapshot.last_position_history = last_position_history;
+    snapshot.foods = foods;
+    snapshot.cached_foods = cached_foods;
+    snapshot.move_counter = move_counter;
+    snapshot.move_eat_counter = move_eat_counter;
+    snapshot.eat_counter = eat_counter;
+    snapshot.score = position_history.size();
+    snapshot.dead = dead;
+    snapshot.death_time = death_time;
+    snapshot.move_time = get_clock().now();
+    snapshot.latency_sample = latency_samples.empty() ? 0 : latency_samples.back();
+
+    latency_samples.clear();
+
+    snapshots.publish();
+}
+
+/*
+@brief
+
+    Resets all the variables associated with the snake (only while the simulation is stopped)
 */
 void retrogames::games::snake_t::do_reset(void)
 {
@@ -568,6 +614,17 @@ void retrogames::games::snake_t::do_reset(void)
 
         // clear the direction stack
         direction_stack.clear();
+
+        // and drop keys the simulation didn't get to anymore
+        queued_direction_t queued;
+
+        while (direction_queue.pop(queued)) get_latency_probe().discard(queued.latency_sample);
+
+        for (auto sample : latency_samples) get_latency_probe().discard(sample);
+
+        latency_samples.clear();
+
+        last_direction = DIRECTION::SNAKE_DIRECTION_DEFAULT;
     }
 
     // clear the position history
@@ -589,17 +646,20 @@ void retrogames::games::snake_t::do_reset(void)
     // didn't hit false
     hit_pause = false;
 
-    // and finally, reset our fps manager
-    fpsmanager.reset();
-
     // no foods anymore
     foods.clear();
+    cached_foods.clear();
 
     // didn't move yet
     move_counter = move_eat_counter = 0;
 
     // we just started
     just_started = true;
+
+    // and finally, show the render thread the fresh snake
+    publish_snapshot();
+
+    snapshots.update();
 }
 
 /*
@@ -607,8 +667,8 @@ void retrogames::games::snake_t::do_reset(void)
 
     Constructor, loads settings among other things
 */
-retrogames::games::snake_t::snake_t(settings_t* settings, const std::string& name, ImFont** default_font_small, ImFont** default_font_mid, ImFont** default_font_big, const std::string& version/* = "1.0"*/, uint8_t* icon/* = nullptr*/) :
-    game_base_t(game_information_t::create(name, version, icon), settings, default_font_small, default_font_mid, default_font_big),
+retrogames::games::snake_t::snake_t(settings_t* settings, const std::string& name, font_service_t* font_service, ImFont** default_font_small, ImFont** default_font_mid, ImFont** default_font_big, const std::string& version/* = "1.0"*/, uint8_t* icon/* = nullptr*/) :
+    game_base_t(game_information_t::create(name, version, icon), settings, font_service, default_font_small, default_font_mid, default_font_big),
     eaten(false),
     just_started(true),
     death_state(DEATH_STATE::DEATH_STATE_MAIN),
@@ -616,11 +676,12 @@ retrogames::games::snake_t::snake_t(settings_t* settings, const std::string& nam
     hit_pause(false),
     move_counter(0),
     move_eat_counter(0),
+    eat_counter(0),
+    last_direction(DIRECTION::SNAKE_DIRECTION_DEFAULT),
     resolution_area(settings->get_main_settings().resolution_area),
     setting_field_size(settings->create("snake_field_size", 10u)),
     setting_speed(settings->create("snake_speed", 10u)),
     snake_fps(static_cast<uint8_t>(setting_speed.get<uint32_t>())),
-    fpsmanager(snake_fps),
     box_amount(setting_field_size.get<uint32_t>() * 2),
     positions(setting_field_size.get<uint32_t>() * 2, setting_field_size.get<uint32_t>() * 2)
 {
@@ -639,6 +700,11 @@ retrogames::games::snake_t::snake_t(settings_t* settings, const std::string& nam
     // reset the direction (default)
     force_direction = DIRECTION::SNAKE_DIRECTION_DEFAULT;
 
+    // give the render thread something to draw before the simulation runs
+    publish_snapshot();
+
+    snapshots.update();
+
     // set the ImGui style we want
     auto& style = ImGui::GetStyle();
 
@@ -654,7 +720,8 @@ retrogames::games::snake_t::snake_t(settings_t* settings, const std::string& nam
 */
 retrogames::games::snake_t::~snake_t()
 {
-
+    // the simulation thread uses our members, stop it before they go away
+    simulation.stop();
 }
 
 /*
@@ -664,8 +731,8 @@ retrogames::games::snake_t::~snake_t()
 */
 void retrogames::games::snake_t::eat(void)
 {
-    // play the eat sound
-    play_sound_effect(snd_t::sounds_e::SOUND_EAT);
+    // the render thread plays the eat sound when it sees this change
+    eat_counter++;
 
     // we just ate (@move() will make use of this)
     eaten = true;
@@ -702,13 +769,9 @@ void retrogames::games::snake_t::eat(void)
 */
 retrogames::games::snake_t::DIRECTION retrogames::games::snake_t::think(void)
 {
-    // check for timeout
-    if (is_in_timeout()) return DIRECTION::SNAKE_DIRECTION_NONE;
-
-    // check if we want to move our snake. We don't want to do that every frame
-    // (60 moves a second would be too fast)
-    // also check if we're dead, the game is paused or we're in the start timeout
-    if (!fpsmanager.should_run() || dead || is_paused()) return DIRECTION::SNAKE_DIRECTION_NONE;
+    // we only get called at the snake's speed and while the game runs (see @draw_field),
+    // but the render thread might not have seen that we're dead yet
+    if (dead) return DIRECTION::SNAKE_DIRECTION_NONE;
 
     // if we just started, generate food
     if (just_started)
@@ -732,6 +795,8 @@ retrogames::games::snake_t::DIRECTION retrogames::games::snake_t::think(void)
         if (direction_stack.empty()) force_direction = direction;
     }
 
+    last_direction = direction;
+
     // move the snake
     if (move(direction))
     {
@@ -742,6 +807,9 @@ retrogames::games::snake_t::DIRECTION retrogames::games::snake_t::think(void)
         if (!last_position_history.empty()) last_position_history.erase(last_position_history.begin());
     }
 
+    // only keep the foods eaten by this move, the ones before have been animated
+    cached_foods.erase(std::remove_if(cached_foods.begin(), cached_foods.end(), [this](const cached_food_type& food) { return std::get<2>(food) != move_counter; }), cached_foods.end());
+
     return direction;
 }
 
@@ -850,20 +918,22 @@ bool retrogames::games::snake_t::move(const DIRECTION dir)
 */
 void retrogames::games::snake_t::draw_left_window(void)
 {
-    if (static_vars.last_death != dead)
+    const auto& snapshot = snapshots.get_front();
+
+    if (static_vars.last_death != snapshot.dead)
     {
-        static_vars.last_death = dead;
+        static_vars.last_death = snapshot.dead;
 
-        if (dead) time_survived = get_playtime();
+        if (snapshot.dead) time_survived = get_playtime();
     }
 
-    if (!dead && !is_paused() && !is_in_timeout())
+    if (!snapshot.dead && !is_paused() && !is_in_timeout())
     {
         time_survived = get_playtime();
     }
 
     // display the score
-    ImGui::Text("Score: %i", static_cast<int32_t>(position_history.size()));
+    ImGui::Text("Score: %i", static_cast<int32_t>(snapshot.score));
 }
 
 /*
@@ -890,7 +960,7 @@ void retrogames::games::snake_t::draw_death_menu(void)
     {
         if (death_state == DEATH_STATE::DEATH_STATE_MAIN)
         {
-            auto button_size = ImVec2{ImGui::CalcTextSize("Back to main menu").x+ImGui::GetStyle().FramePadding.x*2.f,0.f};
+            auto button_size = ImVec2{ImGuiUser::calc_text_size("Back to main menu").x+ImGui::GetStyle().FramePadding.x*2.f,0.f};
 
             ImGui::Text("You died.");
             ImGui::Text("Time alive:");
@@ -898,9 +968,13 @@ void retrogames::games::snake_t::draw_death_menu(void)
 
             if (ImGui::Button("Retry", button_size))
             {
-                // reset all variables in case we've already played
+                // reset all variables in case we've already played (they're ours while the simulation is stopped)
+                simulation.stop();
+
                 do_reset();
 
+                start_simulation();
+
                 // time out again
                 start_timeout();
 
@@ -921,7 +995,7 @@ void retrogames::games::snake_t::draw_death_menu(void)
         {
             ImGui::Text("Are you sure?");
 
-            auto button_size = ImVec2{((ImGui::CalcTextSize("Are you sure?").x+ImGui::GetStyle().FramePadding.x*2.f)*.5f)-ImGui::GetStyle().ItemInnerSpacing.x*2.f,0.f};
+            auto button_size = ImVec2{((ImGuiUser::calc_text_size("Are you sure?").x+ImGui::GetStyle().FramePadding.x*2.f)*.5f)-ImGui::GetStyle().ItemInnerSpacing.x*2.f,0.f};
 
             if (ImGui::Button("Yes", button_size))
             {
@@ -979,12 +1053,14 @@ void retrogames::games::snake_t::generate_food(void)
 */
 void retrogames::games::snake_t::reset(settings_t* settings, bool create_fonts)
 {
+    // the simulation's state is ours until we start it again
+    simulation.stop();
+
     // reset everything that has to do with video settings
     resolution_area = settings->get_main_settings().resolution_area;
     resolution = static_cast<uint16_t>(resolution_area.height);
     box_size = static_cast<float>(resolution) / (static_cast<float>(setting_field_size.get<uint32_t>() * 2));
     snake_fps = static_cast<uint8_t>(setting_speed.get<uint32_t>());
-    fpsmanager = fpsmanager_t(snake_fps);
     box_amount = setting_field_size.get<uint32_t>() * 2;
     positions = unique_ptr_array_matrix_t<POSITION_STATE>(setting_field_size.get<uint32_t>() * 2, setting_field_size.get<uint32_t>() * 2);
 
@@ -999,6 +1075,9 @@ void retrogames::games::snake_t::reset(settings_t* settings, bool create_fonts)
     do_reset();
 
     static_vars.reset();
+
+    // and move the snake again (at the new speed)
+    start_simulation();
 }
 
 /*
@@ -1034,4 +1113,16 @@ void retrogames::games::snake_t::draw_information(float scaling)
     ImGui::TextWrapped("Gameplay");
     ImGui::Separator();
     ImGui::TextWrapped("The player controls a dot, square, or object on a bordered plane. As it moves forward, it leaves a trail behind, resembling a moving snake. In some games, the end of the trail is in a fixed position, so the snake continually gets longer as it moves. In another common scheme, the snake has a specific length, so there is a moving tail a fixed number of units away from the head. The player loses when the snake runs into the screen border, a trail or other obstacle, or itself.");
+}
+
+/*
+@brief
+
+    Describes how the game went so far (the score, who won), for run summaries
+*/
+std::string retrogames::games::snake_t::get_outcome(void)
+{
+    auto& snapshot = snapshots.get_front();
+
+    return "score " + std::to_string(snapshot.score) + (snapshot.dead ? ", died" : ", alive");
 }
\ No newline at end of file
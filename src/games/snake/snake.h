@@ -16,12 +16,15 @@
 #include <chrono>
 #include <tuple>
 #include <deque>
+#include <vector>
 #include "misc/color.h"
 #include "imgui/imgui.h"
-#include "fpsmanager/fpsmanager.h"
 #include "misc/unique_ptr_array_matrix.h"
 #include "misc/settings.h"
+#include "misc/spsc_queue.h"
 #include "misc/timer.h"
+#include "misc/triple_buffer.h"
+#include "simulation/simulation_thread.h"
 #include "games/base/base.h"
 
 namespace retrogames
@@ -77,25 +80,74 @@ namespace retrogames
 
             };
 
-            // Static vars
-            struct static_vars_t final
+            // A direction key on its way to the simulation thread
+            struct queued_direction_t final
+            {
+
+                DIRECTION direction;
+
+                // The key's input for the latency probe (0 if it isn't measuring)
+                uint32_t latency_sample;
+
+            };
+
+            // For drawing all the foods
+            using food_type = std::tuple<int16_t, int16_t, timer_t>;
+            using cached_food_type = std::tuple<uint16_t, uint16_t, uint64_t>;
+
+            // Everything the render thread needs to draw the snake, published by the simulation thread after every move
+            struct snapshot_t final
             {
 
+                ImVec2 head, last_head;
+
+                // The direction of the last move
                 DIRECTION direction;
 
+                std::deque<std::pair<int16_t, int16_t>> last_position_history;
+
+                // Foods on the field, and the ones we've just eaten (to smooth out the animation of eating them)
+            std::deque<food_type> foods;
+                std::deque<cached_food_type> cached_foods;
+
+                uint64_t move_counter;
+                uint16_t move_eat_counter;
+
+                // How many times we've eaten since the game got created (to play the sound on the render thread)
+                uint64_t eat_counter;
+
+                uint64_t score;
+
+                bool dead;
+
+                std::chrono::high_resolution_clock::time_point death_time;
+
+                // When the move happened (to interpolate towards the next one)
+                std::chrono::high_resolution_clock::time_point move_time;
+
+                // The newest input this move shows, for the latency probe (0 if none)
+                uint32_t latency_sample;
+
+            };
+
+            // Static vars
+            struct static_vars_t final
+            {
+
                 bool last_dead, last_dead_needs_reset;
                 bool last_death, last_death_needs_reset;
                 bool last_render;
                 bool interpolate_last_time;
 
+                uint64_t last_eat_counter;
+
                 void reset(void)
                 {
                     last_render = true;
                     interpolate_last_time = false;
-                    direction = DIRECTION::SNAKE_DIRECTION_DEFAULT;
                 }
 
-                static_vars_t() { reset(); }
+                static_vars_t() : last_eat_counter(0) { reset(); }
 
             };
 
@@ -107,20 +159,20 @@ namespace retrogames
             // The target FPS of our snake moving
             uint8_t snake_fps;
 
-            // We don't want to move the snake 60 times a second, so
-            // we create another fpsmanager to be able to see at every draw frame
-            // if we want to move.
-            fpsmanager_t fpsmanager;
-
-            // Used to pulsate colors
-            std::chrono::high_resolution_clock::time_point death_time;
-
             // How many boxes we have per axis
             uint32_t box_amount;
 
             // The size of our boxes
             float box_size;
 
+            // We don't want to move the snake 60 times a second, and we don't want a slow frame
+            // to delay a move either, so the snake moves on its own thread.
+            // Everything from here up to @snapshots belongs to that thread while it runs
+            simulation_thread_t simulation;
+
+            // Used to pulsate colors
+            std::chrono::high_resolution_clock::time_point death_time;
+
             // Head position of our snake
             ImVec2 head;
 
@@ -133,6 +185,9 @@ namespace retrogames
             // Needed in order to not skip a frame when we choose a direction
             DIRECTION force_direction;
 
+            // The direction of the last move
+            DIRECTION last_direction;
+
             // Array of snake positions
             unique_ptr_array_matrix_t<POSITION_STATE> positions;
 
@@ -142,10 +197,6 @@ namespace retrogames
             // Last position history of our snake (used for interpolating)
             std::deque<std::pair<int16_t, int16_t>> last_position_history;
 
-            // For drawing all the foods
-            using food_type = std::tuple<int16_t, int16_t, timer_t>;
-            using cached_food_type = std::tuple<uint16_t, uint16_t, uint64_t>;
-
             std::deque<food_type> foods;
             std::deque<cached_food_type> cached_foods;
 
@@ -158,6 +209,24 @@ namespace retrogames
             // Did we just eat?
             bool eaten;
 
+            // How many times we moved
+            uint64_t move_counter;
+
+            // The last frame we ate at
+            uint16_t move_eat_counter;
+
+            // How many times we've eaten since the game got created
+            uint64_t eat_counter;
+
+            // Inputs applied since the last move, they take effect with the next one (see capture/latency_probe.h)
+            std::vector<uint32_t> latency_samples;
+
+            // Snapshots of the simulation for the render thread
+            triple_buffer_t<snapshot_t> snapshots;
+
+            // Direction keys going to the simulation thread
+            spsc_queue_t<queued_direction_t, 32> direction_queue;
+
             // Should we exit the application?
             bool should_exit;
 
@@ -167,58 +236,61 @@ namespace retrogames
             // Did we hit pause?
             bool hit_pause;
 
-            // How many times we moved
-            uint64_t move_counter;
-
-            // The last frame we ate at
-            uint16_t move_eat_counter;
-
             // The resolution of our playing field
             uint16_t resolution;
 
             // Resolution area
             area_size_t resolution_area;
 
+            /*
+            @brief
+            
+                Kills the snake
+            */
+            void kill(void);
+
             /*
             @brief
 
-                Draws a filled rectangle at the @pos and @size in the current ImGui window
+                Resets all the variables associated with the snake (only while the simulation is stopped)
             */
-            void draw_filled_rect(const ImVec2& pos, const ImVec2& size, color_t color);
+            void do_reset(void);
 
             /*
             @brief
 
-                Draws a rectangle at the @pos and @size in the current ImGui window
+                Starts moving the snake on the simulation thread
             */
-            void draw_rect(const ImVec2& pos, const ImVec2& size, color_t color);
+            void start_simulation(void);
 
             /*
             @brief
 
-                Draws a line between @pos_1 and @pos_2 given the @thickness
-                in the current ImGui window
+                One step of the simulation: applies queued direction keys, moves the snake
+                and publishes a snapshot if it moved (simulation thread)
             */
-            void draw_line(const ImVec2& pos_1, const ImVec2& pos_2, color_t color, float thickness = 1.f);
+            void tick(void);
 
             /*
             @brief
-            
-                Kills the snake
+
+                Copies everything needed for drawing into a snapshot and hands it to the render thread
             */
-            void kill(void);
+            void publish_snapshot(void);
 
             /*
             @brief
 
-                Resets all the variables associated with the snake
+                Adds a direction to our direction stack, unless it's where we're going already
+                or it would turn the snake back into itself (simulation thread).
+                Returns false if it didn't get added
             */
-            void do_reset(void);
+            bool add_direction(DIRECTION dir);
 
             /*
             @brief
 
-                Draws the snake playing field and handles all the logic
+                Draws the snake playing field from the latest snapshot
             */
             void draw_field(void);
 
@@ -281,7 +353,7 @@ namespace retrogames
 
                 Constructor
             */
-            snake_t(settings_t* settings, const std::string& name, ImFont** default_font_small, ImFont** default_font_mid, ImFont** default_font_big, const std::string& version = "1.0", uint8_t* icon = nullptr);
+            snake_t(settings_t* settings, const std::string& name, font_service_t* font_service, ImFont** default_font_small, ImFont** default_font_mid, ImFont** default_font_big, const std::string& version = "1.0", uint8_t* icon = nullptr);
 
             /*
             @brief
@@ -332,6 +404,13 @@ namespace retrogames
             */
             virtual void draw_information(float scaling) override;
 
+            /*
+            @brief
+
+                Describes how the game went so far (the score, who won), for run summaries
+            */
+            virtual std::string get_outcome(void) override;
+
         };
 
     }
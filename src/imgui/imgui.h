@@ -1970,7 +1970,8 @@ enum ImDrawListFlags_
     ImDrawListFlags_None             = 0,
     ImDrawListFlags_AntiAliasedLines = 1 << 0,  // Lines are anti-aliased (*2 the number of triangles for 1.0f wide line, otherwise *3 the number of triangles)
     ImDrawListFlags_AntiAliasedFill  = 1 << 1,  // Filled shapes have anti-aliased edges (*2 the number of vertices)
-    ImDrawListFlags_AllowVtxOffset   = 1 << 2   // Can emit 'VtxOffset > 0' to allow large meshes. Set when 'ImGuiBackendFlags_RendererHasVtxOffset' is enabled.
+    ImDrawListFlags_AllowVtxOffset   = 1 << 2,  // Can emit 'VtxOffset > 0' to allow large meshes. Set when 'ImGuiBackendFlags_RendererHasVtxOffset' is enabled.
+    ImDrawListFlags_CrispLines       = 1 << 3   // Axis-aligned AddLine()/AddRect() are always emitted as plain quads without anti-aliased fringe, at any thickness or position (1.0f wide ones on whole pixels always are, they look the same). Reset every frame like the other flags, set it after Begin().
 };
 
 // Draw command list
@@ -2180,9 +2181,10 @@ struct ImFontAtlasCustomRect
 
 enum ImFontAtlasFlags_
 {
-    ImFontAtlasFlags_None               = 0,
-    ImFontAtlasFlags_NoPowerOfTwoHeight = 1 << 0,   // Don't round the height to next power of two
-    ImFontAtlasFlags_NoMouseCursors     = 1 << 1    // Don't build software mouse cursors into the atlas
+    ImFontAtlasFlags_None                = 0,
+    ImFontAtlasFlags_NoPowerOfTwoHeight  = 1 << 0,  // Don't round the height to next power of two
+    ImFontAtlasFlags_NoMouseCursors      = 1 << 1,  // Don't build software mouse cursors into the atlas
+    ImFontAtlasFlags_SignedDistanceField = 1 << 2   // Store glyphs as signed distance fields (see TexSdfSpread) so one size can be drawn at any scale. The renderer has to threshold the font texture instead of using it as coverage.
 };
 
 // Load and rasterize multiple TTF/OTF fonts into a same texture. The font atlas will build a single texture holding:
@@ -2270,6 +2272,7 @@ struct ImFontAtlas
     ImTextureID                 TexID;              // User data to refer to the texture once it has been uploaded to user's graphic systems. It is passed back to you during rendering via the ImDrawCmd structure.
     int                         TexDesiredWidth;    // Texture width desired by user before Build(). Must be a power-of-two. If have many glyphs your graphics API have texture size restrictions you may want to increase texture width to decrease height.
     int                         TexGlyphPadding;    // Padding between glyphs within texture in pixels. Defaults to 1. If your rendering method doesn't rely on bilinear filtering you may set this to 0.
+    int                         TexSdfSpread;       // With ImFontAtlasFlags_SignedDistanceField: how many texels the field reaches past the outlines. 128 is on an outline, 0 and 255 are TexSdfSpread texels outside and inside. Defaults to 4.
 
     // [Internal]
     // NB: Access texture data via GetTexData*() calls! Which will setup a default font for you.
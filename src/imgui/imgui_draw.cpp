@@ -1008,10 +1008,44 @@ void ImDrawList::PathRect(const ImVec2& a, const ImVec2& b, float rounding, ImDr
     }
 }
 
+// Axis-aligned lines/rectangles don't need the anti-aliased path when they are 1.0f wide and on whole pixels: the stroke goes through
+// the pixel centers and its fringe fades out exactly at the neighboring pixel centers, so a plain quad covers the same pixels with
+// fewer vertices (4 instead of 6 for a line, 8 instead of 12 for a rectangle). ImDrawListFlags_CrispLines opts into quads for any of them.
+static inline bool ImIsWholePixel(const ImVec2& p)
+{
+    return p.x == ImFloor(p.x) && p.y == ImFloor(p.y);
+}
+
+static inline bool ImDrawListUseCrispPath(const ImDrawList* draw_list, const ImVec2& a, const ImVec2& b, float thickness)
+{
+    if (draw_list->Flags & ImDrawListFlags_CrispLines)
+        return true;
+    return (draw_list->Flags & ImDrawListFlags_AntiAliasedLines) && thickness == 1.0f && ImIsWholePixel(a) && ImIsWholePixel(b);
+}
+
 void ImDrawList::AddLine(const ImVec2& p1, const ImVec2& p2, ImU32 col, float thickness)
 {
     if ((col & IM_COL32_A_MASK) == 0)
         return;
+    if ((p1.x == p2.x) != (p1.y == p2.y) && ImDrawListUseCrispPath(this, p1, p2, thickness))
+    {
+        // Same pixels as the stroke below: through the pixel centers, the lower end included and the upper one not (whichever way the line goes)
+        const float half_thickness = thickness * 0.5f;
+        ImVec2 a, c;
+        if (p1.y == p2.y)
+        {
+            a = ImVec2(ImMin(p1.x, p2.x), p1.y + 0.5f - half_thickness);
+            c = ImVec2(ImMax(p1.x, p2.x), p1.y + 0.5f + half_thickness);
+        }
+        else
+        {
+            a = ImVec2(p1.x + 0.5f - half_thickness, ImMin(p1.y, p2.y));
+            c = ImVec2(p1.x + 0.5f + half_thickness, ImMax(p1.y, p2.y));
+        }
+        PrimReserve(6, 4);
+        PrimRect(a, c, col);
+        return;
+    }
     PathLineTo(p1 + ImVec2(0.5f, 0.5f));
     PathLineTo(p2 + ImVec2(0.5f, 0.5f));
     PathStroke(col, false, thickness);
@@ -1023,6 +1057,38 @@ void ImDrawList::AddRect(const ImVec2& p_min, const ImVec2& p_max, ImU32 col, fl
 {
     if ((col & IM_COL32_A_MASK) == 0)
         return;
+    if ((rounding <= 0.0f || rounding_corners == 0) && ImDrawListUseCrispPath(this, p_min, p_max, thickness))
+    {
+        // A frame between the outer and inner edge of the stroke (same placement as below), 4 quads sharing their corners
+        const float half_thickness = thickness * 0.5f;
+        const ImVec2 outer_min(p_min.x + 0.5f - half_thickness, p_min.y + 0.5f - half_thickness), outer_max(p_max.x - 0.5f + half_thickness, p_max.y - 0.5f + half_thickness);
+        const ImVec2 inner_min(p_min.x + 0.5f + half_thickness, p_min.y + 0.5f + half_thickness), inner_max(p_max.x - 0.5f - half_thickness, p_max.y - 0.5f - half_thickness);
+        if (inner_min.x >= inner_max.x || inner_min.y >= inner_max.y)
+        {
+            // Nothing left inside
+            PrimReserve(6, 4);
+            PrimRect(outer_min, outer_max, col);
+            return;
+        }
+        const ImVec2 uv = _Data->TexUvWhitePixel;
+        const ImVec2 pos[8] = { outer_min, ImVec2(outer_max.x, outer_min.y), outer_max, ImVec2(outer_min.x, outer_max.y), inner_min, ImVec2(inner_max.x, inner_min.y), inner_max, ImVec2(inner_min.x, inner_max.y) };
+        PrimReserve(24, 8);
+        ImDrawIdx idx = (ImDrawIdx)_VtxCurrentIdx;
+        for (int i = 0; i < 8; i++)
+        {
+            _VtxWritePtr[i].pos = pos[i]; _VtxWritePtr[i].uv = uv; _VtxWritePtr[i].col = col;
+        }
+        for (int side = 0; side < 4; side++)
+        {
+            const int next = (side + 1) & 3;
+            _IdxWritePtr[0] = (ImDrawIdx)(idx + side); _IdxWritePtr[1] = (ImDrawIdx)(idx + next); _IdxWritePtr[2] = (ImDrawIdx)(idx + 4 + next);
+            _IdxWritePtr[3] = (ImDrawIdx)(idx + side); _IdxWritePtr[4] = (ImDrawIdx)(idx + 4 + next); _IdxWritePtr[5] = (ImDrawIdx)(idx + 4 + side);
+            _IdxWritePtr += 6;
+        }
+        _VtxWritePtr += 8;
+        _VtxCurrentIdx += 8;
+        return;
+    }
     if (Flags & ImDrawListFlags_AntiAliasedLines)
         PathRect(p_min + ImVec2(0.50f,0.50f), p_max - ImVec2(0.50f,0.50f), rounding, rounding_corners);
     else
@@ -1595,6 +1661,7 @@ ImFontAtlas::ImFontAtlas()
     TexID = (ImTextureID)NULL;
     TexDesiredWidth = 0;
     TexGlyphPadding = 1;
+    TexSdfSpread = 4;
 
     TexPixelsAlpha8 = NULL;
     TexPixelsRGBA32 = NULL;
@@ -1946,6 +2013,112 @@ static void UnpackBitVectorToFlatIndexList(const ImBitVector* in, ImVector<int>*
                     out->push_back((int)(((it - it_begin) << 5) + bit_n));
 }
 
+// Buffers for rendering distance fields, reused between glyphs
+struct ImFontSdfScratch
+{
+    ImVector<unsigned char> Coverage;
+    ImVector<float>         DistanceInside;     // Squared distance to the nearest pixel outside of the glyph (0 outside)
+    ImVector<float>         DistanceOutside;    // Squared distance to the nearest pixel inside of the glyph (0 inside)
+    ImVector<float>         F, D, Z;
+    ImVector<int>           V;
+};
+
+// Squared euclidean distance transform of n samples (Felzenszwalb & Huttenlocher): d[q] = min over p of (q - p)^2 + f[p]
+static void ImFontAtlasBuildDistanceTransform1D(const float* f, float* d, int* v, float* z, int n)
+{
+    int k = 0;
+    v[0] = 0;
+    z[0] = -FLT_MAX;
+    z[1] = FLT_MAX;
+    for (int q = 1; q < n; q++)
+    {
+        float s = ((f[q] + (float)(q * q)) - (f[v[k]] + (float)(v[k] * v[k]))) / (float)(2 * q - 2 * v[k]);
+        while (s <= z[k])
+        {
+            k--;
+            s = ((f[q] + (float)(q * q)) - (f[v[k]] + (float)(v[k] * v[k]))) / (float)(2 * q - 2 * v[k]);
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = FLT_MAX;
+    }
+    k = 0;
+    for (int q = 0; q < n; q++)
+    {
+        while (z[k + 1] < (float)q)
+            k++;
+        d[q] = (float)((q - v[k]) * (q - v[k])) + f[v[k]];
+    }
+}
+
+// Squared distance of every pixel to the nearest pixel that is (inside == true) or isn't (inside == false) covered
+static void ImFontAtlasBuildDistanceTransform2D(ImFontSdfScratch& scratch, bool inside, float* out, int w, int h)
+{
+    const float far_away = (float)(w * w + h * h);
+    for (int i = 0; i < w * h; i++)
+        out[i] = ((scratch.Coverage[i] >= 128) == inside) ? 0.0f : far_away;
+    for (int x = 0; x < w; x++)
+    {
+        for (int y = 0; y < h; y++)
+            scratch.F[y] = out[y * w + x];
+        ImFontAtlasBuildDistanceTransform1D(scratch.F.Data, scratch.D.Data, scratch.V.Data, scratch.Z.Data, h);
+        for (int y = 0; y < h; y++)
+            out[y * w + x] = scratch.D[y];
+    }
+    for (int y = 0; y < h; y++)
+    {
+        memcpy(scratch.F.Data, out + y * w, (size_t)w * sizeof(float));
+        ImFontAtlasBuildDistanceTransform1D(scratch.F.Data, out + y * w, scratch.V.Data, scratch.Z.Data, w);
+    }
+}
+
+// Renders the signed distance field of a glyph into the out_w * out_h texels at out, (out_x, out_y) being where they start in the glyph's bitmap space.
+// The field is measured on an oversampled coverage bitmap, unlike stbtt_GetGlyphSDF() that measures it to the outlines. Outlines that touch or
+// overlap (pixel fonts like ProggyClean are made of a square per pixel) would put edges in the middle of strokes.
+static void ImFontAtlasBuildRenderSdfGlyph(const stbtt_fontinfo* info, int glyph, float scale, int spread, int out_x, int out_y, int out_w, int out_h, unsigned char* out, int out_stride, ImFontSdfScratch& scratch)
+{
+    const int oversample = 4;
+    const int w = out_w * oversample;
+    const int h = out_h * oversample;
+    scratch.Coverage.resize(w * h);
+    memset(scratch.Coverage.Data, 0, (size_t)scratch.Coverage.size_in_bytes());
+    scratch.DistanceInside.resize(w * h);
+    scratch.DistanceOutside.resize(w * h);
+    scratch.F.resize(ImMax(w, h));
+    scratch.D.resize(ImMax(w, h));
+    scratch.Z.resize(ImMax(w, h) + 1);
+    scratch.V.resize(ImMax(w, h));
+
+    // The oversampled box starts at or after the one at atlas resolution and ends at or before it, so it fits
+    int x0, y0, x1, y1;
+    stbtt_GetGlyphBitmapBox(info, glyph, scale * oversample, scale * oversample, &x0, &y0, &x1, &y1);
+    const int offset_x = x0 - out_x * oversample;
+    const int offset_y = y0 - out_y * oversample;
+    IM_ASSERT(offset_x >= 0 && offset_y >= 0 && offset_x + (x1 - x0) <= w && offset_y + (y1 - y0) <= h);
+    stbtt_MakeGlyphBitmap(info, scratch.Coverage.Data + offset_y * w + offset_x, x1 - x0, y1 - y0, w, scale * oversample, scale * oversample, glyph);
+
+    ImFontAtlasBuildDistanceTransform2D(scratch, false, scratch.DistanceInside.Data, w, h);
+    ImFontAtlasBuildDistanceTransform2D(scratch, true, scratch.DistanceOutside.Data, w, h);
+
+    // The outline runs between the centers of a covered and an uncovered pixel. A texel's center lies between four oversampled pixels, average them.
+    // 128 is on the outline, each texel of distance moves 128 / spread away from that (up inside, down outside).
+    const float value_per_pixel = 128.0f / (spread * oversample);
+    for (int y = 0; y < out_h; y++)
+        for (int x = 0; x < out_w; x++)
+        {
+            float distance = 0.0f;
+            for (int j = 0; j < 2; j++)
+                for (int i = 0; i < 2; i++)
+                {
+                    const int n = (y * oversample + oversample / 2 - 1 + j) * w + (x * oversample + oversample / 2 - 1 + i);
+                    distance += (scratch.Coverage[n] >= 128) ? ImSqrt(scratch.DistanceInside[n]) - 0.5f : 0.5f - ImSqrt(scratch.DistanceOutside[n]);
+                }
+            const float value = 128.0f + distance * 0.25f * value_per_pixel;
+            out[y * out_stride + x] = (unsigned char)ImClamp(value + 0.5f, 0.0f, 255.0f);
+        }
+}
+
 bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
 {
     IM_ASSERT(atlas->ConfigData.Size > 0);
@@ -2080,9 +2253,19 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
             int x0, y0, x1, y1;
             const int glyph_index_in_font = stbtt_FindGlyphIndex(&src_tmp.FontInfo, src_tmp.GlyphsList[glyph_i]);
             IM_ASSERT(glyph_index_in_font != 0);
-            stbtt_GetGlyphBitmapBoxSubpixel(&src_tmp.FontInfo, glyph_index_in_font, scale * cfg.OversampleH, scale * cfg.OversampleV, 0, 0, &x0, &y0, &x1, &y1);
-            src_tmp.Rects[glyph_i].w = (stbrp_coord)(x1 - x0 + padding + cfg.OversampleH - 1);
-            src_tmp.Rects[glyph_i].h = (stbrp_coord)(y1 - y0 + padding + cfg.OversampleV - 1);
+            if (atlas->Flags & ImFontAtlasFlags_SignedDistanceField)
+            {
+                // Distance fields aren't oversampled, they need room for the field around the glyph instead
+                stbtt_GetGlyphBitmapBox(&src_tmp.FontInfo, glyph_index_in_font, scale, scale, &x0, &y0, &x1, &y1);
+                src_tmp.Rects[glyph_i].w = (stbrp_coord)(x1 - x0 + atlas->TexSdfSpread * 2 + padding);
+                src_tmp.Rects[glyph_i].h = (stbrp_coord)(y1 - y0 + atlas->TexSdfSpread * 2 + padding);
+            }
+            else
+            {
+                stbtt_GetGlyphBitmapBoxSubpixel(&src_tmp.FontInfo, glyph_index_in_font, scale * cfg.OversampleH, scale * cfg.OversampleV, 0, 0, &x0, &y0, &x1, &y1);
+                src_tmp.Rects[glyph_i].w = (stbrp_coord)(x1 - x0 + padding + cfg.OversampleH - 1);
+                src_tmp.Rects[glyph_i].h = (stbrp_coord)(y1 - y0 + padding + cfg.OversampleV - 1);
+            }
             total_surface += src_tmp.Rects[glyph_i].w * src_tmp.Rects[glyph_i].h;
         }
     }
@@ -2129,6 +2312,7 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     spc.height = atlas->TexHeight;
 
     // 8. Render/rasterize font characters into the texture
+    ImFontSdfScratch sdf_scratch;
     for (int src_i = 0; src_i < src_tmp_array.Size; src_i++)
     {
         ImFontConfig& cfg = atlas->ConfigData[src_i];
@@ -2136,6 +2320,44 @@ bool    ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
         if (src_tmp.GlyphsCount == 0)
             continue;
 
+        if (atlas->Flags & ImFontAtlasFlags_SignedDistanceField)
+        {
+            // Render the distance fields ourselves and fill in what stbtt_PackFontRangesRenderIntoRects() would have
+            const float scale = (cfg.SizePixels > 0) ? stbtt_ScaleForPixelHeight(&src_tmp.FontInfo, cfg.SizePixels) : stbtt_ScaleForMappingEmToPixels(&src_tmp.FontInfo, -cfg.SizePixels);
+            const int spread = atlas->TexSdfSpread;
+            for (int glyph_i = 0; glyph_i < src_tmp.GlyphsCount; glyph_i++)
+            {
+                const stbrp_rect& r = src_tmp.Rects[glyph_i];
+                stbtt_packedchar& pc = src_tmp.PackedChars[glyph_i];
+                const int glyph_index_in_font = stbtt_FindGlyphIndex(&src_tmp.FontInfo, src_tmp.GlyphsList[glyph_i]);
+                int advance, left_side_bearing;
+                stbtt_GetGlyphHMetrics(&src_tmp.FontInfo, glyph_index_in_font, &advance, &left_side_bearing);
+                pc.xadvance = scale * advance;
+                if (!r.was_packed)
+                    continue;
+
+                // Empty glyphs (space) have no field, their quad stays empty too
+                int x0, y0, x1, y1;
+                stbtt_GetGlyphBitmapBox(&src_tmp.FontInfo, glyph_index_in_font, scale, scale, &x0, &y0, &x1, &y1);
+                if (x0 == x1 || y0 == y1)
+                    continue;
+                const int w = x1 - x0 + spread * 2;
+                const int h = y1 - y0 + spread * 2;
+                ImFontAtlasBuildRenderSdfGlyph(&src_tmp.FontInfo, glyph_index_in_font, scale, spread, x0 - spread, y0 - spread, w, h, atlas->TexPixelsAlpha8 + r.y * atlas->TexWidth + r.x, atlas->TexWidth, sdf_scratch);
+
+                pc.x0 = (unsigned short)r.x;
+                pc.y0 = (unsigned short)r.y;
+                pc.x1 = (unsigned short)(r.x + w);
+                pc.y1 = (unsigned short)(r.y + h);
+                pc.xoff = (float)(x0 - spread);
+                pc.yoff = (float)(y0 - spread);
+                pc.xoff2 = (float)(x1 + spread);
+                pc.yoff2 = (float)(y1 + spread);
+            }
+            src_tmp.Rects = NULL;
+            continue;
+        }
+
         stbtt_PackFontRangesRenderIntoRects(&spc, &src_tmp.FontInfo, &src_tmp.PackRange, 1, src_tmp.Rects);
 
         // Apply multiply operator
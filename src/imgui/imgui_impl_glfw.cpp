@@ -1,4 +1,4 @@
-#ifdef PLATFORM_LINUX
+#if defined(PLATFORM_LINUX) && !defined(LINUX_IMGUI_SOFTWARE_RENDERING)
 // dear imgui: Platform Binding for GLFW
 // This needs to be used along with a Renderer (e.g. OpenGL3, Vulkan..)
 // (Info: GLFW is a cross-platform general purpose library for handling windows, inputs, OpenGL/Vulkan graphics context creation, etc.)
@@ -1,4 +1,4 @@
-#if defined(PLATFORM_LINUX) || defined(PLATFORM_NS) || defined(PLATFORM_EMSCRIPTEN)
+#if (defined(PLATFORM_LINUX) && !defined(LINUX_IMGUI_SOFTWARE_RENDERING)) || defined(PLATFORM_NS) || defined(PLATFORM_EMSCRIPTEN)
 // dear imgui: Renderer for modern OpenGL with shaders / programmatic pipeline
 // - Desktop GL: 2.x 3.x 4.x
 // - Embedded GL: ES 2.0 (WebGL 1.0), ES 3.0 (WebGL 2.0)
@@ -7,6 +7,7 @@
 // Implemented features:
 //  [X] Renderer: User texture binding. Use 'GLuint' OpenGL texture identifier as void*/ImTextureID. Read the FAQ about ImTextureID!
 //  [x] Renderer: Desktop GL only: Support for large meshes (64k+ vertices) with 16-bit indices.
+//  [x] Renderer: One upload per frame into streaming buffers (ring buffer or persistently mapped), see ImGui_ImplOpenGL3_SetStreamingMode().
 
 // You can copy and use unmodified imgui_impl_* files in your project. See main.cpp for an example of using this.
 // If you are new to dear imgui, read examples/README.txt and read the documentation at the top of imgui.cpp.
@@ -140,14 +141,51 @@ using namespace gl;
 #define IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET   1
 #endif
 
+// Desktop GL 3.0+ and GL ES 3.0 have glMapBufferRange(), GL 4.4 has glBufferStorage() for persistent mapping.
+#if !defined(IMGUI_IMPL_OPENGL_ES2) && defined(GL_MAP_UNSYNCHRONIZED_BIT)
+#define IMGUI_IMPL_OPENGL_MAY_HAVE_MAP_BUFFER_RANGE 1
+#else
+#define IMGUI_IMPL_OPENGL_MAY_HAVE_MAP_BUFFER_RANGE 0
+#endif
+#if !defined(IMGUI_IMPL_OPENGL_ES2) && !defined(IMGUI_IMPL_OPENGL_ES3) && defined(GL_MAP_PERSISTENT_BIT)
+#define IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE   1
+#else
+#define IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE   0
+#endif
+
+// Persistently mapped buffers are split into this many regions, so we never write into one the GPU may still read from.
+#define IMGUI_IMPL_OPENGL_STREAM_REGIONS    3
+
 // OpenGL Data
 static GLuint       g_GlVersion = 0;                // Extracted at runtime using GL_MAJOR_VERSION, GL_MINOR_VERSION queries.
 static char         g_GlslVersionString[32] = "";   // Specified by user or detected based on compile time GL settings.
 static GLuint       g_FontTexture = 0;
 static GLuint       g_ShaderHandle = 0, g_VertHandle = 0, g_FragHandle = 0;
 static int          g_AttribLocationTex = 0, g_AttribLocationProjMtx = 0;                                // Uniforms location
+static int          g_AttribLocationDistanceField = 0;                                                  // Set while drawing with a signed distance field font atlas
 static int          g_AttribLocationVtxPos = 0, g_AttribLocationVtxUV = 0, g_AttribLocationVtxColor = 0; // Vertex attributes location
-static unsigned int g_VboHandle = 0, g_ElementsHandle = 0;
+
+// Streaming vertex/index buffers. Every frame gets appended to them with a single upload per buffer.
+struct ImGui_ImplOpenGL3_StreamBuffer
+{
+    GLuint      Handle;
+    GLenum      Target;
+    size_t      ElementSize;
+    size_t      Capacity;       // In elements (per region when persistently mapped)
+    size_t      Head;           // Next free element of the ring buffer
+    size_t      Base;           // First element of the current frame
+    char*       Mapped;         // Persistently mapped storage
+};
+static ImGui_ImplOpenGL3_StreamBuffer   g_VertexStream = { 0, GL_ARRAY_BUFFER, sizeof(ImDrawVert), 0, 0, 0, NULL };
+static ImGui_ImplOpenGL3_StreamBuffer   g_IndexStream = { 0, GL_ELEMENT_ARRAY_BUFFER, sizeof(ImDrawIdx), 0, 0, 0, NULL };
+static ImGui_ImplOpenGL3_StreamingMode  g_StreamingMode = ImGui_ImplOpenGL3_StreamingMode_Auto;        // Requested by the user
+static ImGui_ImplOpenGL3_StreamingMode  g_ActiveStreamingMode = ImGui_ImplOpenGL3_StreamingMode_Auto;  // What the buffers are set up for (Auto = nothing yet)
+static bool                             g_PersistentMappingFailed = false;
+static ImVector<char>                   g_StagingBuffer;    // Used when the buffers can't be mapped
+#if IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE
+static GLsync                           g_RegionFences[IMGUI_IMPL_OPENGL_STREAM_REGIONS] = {};
+static int                              g_Region = 0;
+#endif
 
 // Functions
 bool    ImGui_ImplOpenGL3_Init(const char* glsl_version)
@@ -157,16 +195,16 @@ bool    ImGui_ImplOpenGL3_Init(const char* glsl_version)
     GLint major, minor;
     glGetIntegerv(GL_MAJOR_VERSION, &major);
     glGetIntegerv(GL_MINOR_VERSION, &minor);
-    g_GlVersion = major * 1000 + minor;
+    g_GlVersion = (GLuint)(major * 100 + minor * 10); // e.g. 320 for GL 3.2 (used to be major * 1000 + minor, which the 3.2 check below never matched)
 #else
-    g_GlVersion = 2000; // GLES 2
+    g_GlVersion = 200; // GLES 2
 #endif
 
     // Setup back-end capabilities flags
     ImGuiIO& io = ImGui::GetIO();
     io.BackendRendererName = "imgui_impl_opengl3";
 #if IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET
-    if (g_GlVersion >= 3200)
+    if (g_GlVersion >= 320)
         io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;  // We can honor the ImDrawCmd::VtxOffset field, allowing for large meshes.
 #endif
 
@@ -239,6 +277,14 @@ GLuint get_shader_handle()
     return g_ShaderHandle;
 }
 
+// Points the vertex attributes at the ImDrawVert starting 'vtx_offset' bytes into the vertex buffer
+static void ImGui_ImplOpenGL3_SetupVertexAttribs(size_t vtx_offset)
+{
+    glVertexAttribPointer(g_AttribLocationVtxPos,   2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)(vtx_offset + IM_OFFSETOF(ImDrawVert, pos)));
+    glVertexAttribPointer(g_AttribLocationVtxUV,    2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)(vtx_offset + IM_OFFSETOF(ImDrawVert, uv)));
+    glVertexAttribPointer(g_AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE,  sizeof(ImDrawVert), (GLvoid*)(vtx_offset + IM_OFFSETOF(ImDrawVert, col)));
+}
+
 static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_width, int fb_height, GLuint vertex_array_object)
 {
     // Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled, polygon fill
@@ -269,6 +315,7 @@ static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_wid
     glUseProgram(g_ShaderHandle);
     //clear
     glUniform1i(g_AttribLocationTex, 0);
+    glUniform1i(g_AttribLocationDistanceField, 0);
     glUniformMatrix4fv(g_AttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
 #ifdef GL_SAMPLER_BINDING
     glBindSampler(0, 0); // We use combined texture/sampler state. Applications using GL 3.3 may set that otherwise.
@@ -280,14 +327,187 @@ static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_wid
 #endif
 
     // Bind vertex/index buffers and setup attributes for ImDrawVert
-    glBindBuffer(GL_ARRAY_BUFFER, g_VboHandle);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_ElementsHandle);
+    glBindBuffer(GL_ARRAY_BUFFER, g_VertexStream.Handle);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_IndexStream.Handle);
     glEnableVertexAttribArray(g_AttribLocationVtxPos);
     glEnableVertexAttribArray(g_AttribLocationVtxUV);
     glEnableVertexAttribArray(g_AttribLocationVtxColor);
-    glVertexAttribPointer(g_AttribLocationVtxPos,   2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, pos));
-    glVertexAttribPointer(g_AttribLocationVtxUV,    2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, uv));
-    glVertexAttribPointer(g_AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE,  sizeof(ImDrawVert), (GLvoid*)IM_OFFSETOF(ImDrawVert, col));
+    ImGui_ImplOpenGL3_SetupVertexAttribs(0);
+}
+
+void ImGui_ImplOpenGL3_SetStreamingMode(ImGui_ImplOpenGL3_StreamingMode mode)
+{
+    g_StreamingMode = mode;
+}
+
+ImGui_ImplOpenGL3_StreamingMode ImGui_ImplOpenGL3_GetStreamingMode()
+{
+    return g_ActiveStreamingMode;
+}
+
+static ImGui_ImplOpenGL3_StreamingMode ImGui_ImplOpenGL3_ResolveStreamingMode()
+{
+    bool can_persist = IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE && g_GlVersion >= 440 && !g_PersistentMappingFailed;
+    ImGui_ImplOpenGL3_StreamingMode mode = g_StreamingMode;
+    if (mode == ImGui_ImplOpenGL3_StreamingMode_Persistent && !can_persist)
+        mode = ImGui_ImplOpenGL3_StreamingMode_Auto;
+    if (mode == ImGui_ImplOpenGL3_StreamingMode_Auto)
+        mode = can_persist ? ImGui_ImplOpenGL3_StreamingMode_Persistent : ImGui_ImplOpenGL3_StreamingMode_Ring;
+    return mode;
+}
+
+// Deletes the stream buffers (and their fences), and creates empty ones if 'recreate' is set
+static void ImGui_ImplOpenGL3_ResetStreamBuffers(bool recreate)
+{
+#if IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE
+    for (int n = 0; n < IMGUI_IMPL_OPENGL_STREAM_REGIONS; n++)
+        if (g_RegionFences[n]) { glDeleteSync(g_RegionFences[n]); g_RegionFences[n] = 0; }
+    g_Region = 0;
+#endif
+    ImGui_ImplOpenGL3_StreamBuffer* streams[] = { &g_VertexStream, &g_IndexStream };
+    for (int n = 0; n < IM_ARRAYSIZE(streams); n++)
+    {
+        ImGui_ImplOpenGL3_StreamBuffer* stream = streams[n];
+        if (stream->Handle) glDeleteBuffers(1, &stream->Handle); // Also unmaps persistently mapped storage
+        stream->Handle = 0;
+        stream->Capacity = stream->Head = stream->Base = 0;
+        stream->Mapped = NULL;
+        if (recreate) glGenBuffers(1, &stream->Handle);
+    }
+}
+
+// Copies every draw list's vertices (or indices) one after the other into 'dst'
+static void ImGui_ImplOpenGL3_CopyDrawData(ImDrawData* draw_data, const ImGui_ImplOpenGL3_StreamBuffer* stream, char* dst)
+{
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        if (stream == &g_VertexStream)
+        {
+            memcpy(dst, cmd_list->VtxBuffer.Data, (size_t)cmd_list->VtxBuffer.size_in_bytes());
+            dst += cmd_list->VtxBuffer.size_in_bytes();
+        }
+        else
+        {
+            memcpy(dst, cmd_list->IdxBuffer.Data, (size_t)cmd_list->IdxBuffer.size_in_bytes());
+            dst += cmd_list->IdxBuffer.size_in_bytes();
+        }
+    }
+}
+
+// Ring buffer: append the frame after the previous one. When it doesn't fit anymore the buffer gets orphaned,
+// so the driver hands us fresh storage instead of waiting for the GPU to finish with the old one.
+// Nothing we write ever overlaps data of a frame in flight, which is what makes unsynchronized mapping safe.
+static void ImGui_ImplOpenGL3_UploadRing(ImDrawData* draw_data, ImGui_ImplOpenGL3_StreamBuffer* stream, size_t count)
+{
+    glBindBuffer(stream->Target, stream->Handle);
+    if (count > stream->Capacity)
+    {
+        // Room for a few frames, so we orphan every few frames instead of every frame
+        stream->Capacity = 4096;
+        while (stream->Capacity < count * 4)
+            stream->Capacity *= 2;
+        stream->Head = stream->Capacity;
+    }
+    if (stream->Head + count > stream->Capacity)
+    {
+        glBufferData(stream->Target, (GLsizeiptr)(stream->Capacity * stream->ElementSize), NULL, GL_STREAM_DRAW);
+        stream->Head = 0;
+    }
+    stream->Base = stream->Head;
+    stream->Head += count;
+
+    GLintptr offset = (GLintptr)(stream->Base * stream->ElementSize);
+    GLsizeiptr size = (GLsizeiptr)(count * stream->ElementSize);
+#if IMGUI_IMPL_OPENGL_MAY_HAVE_MAP_BUFFER_RANGE
+    if (g_GlVersion >= 300)
+    {
+        void* dst = glMapBufferRange(stream->Target, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (dst != NULL)
+        {
+            ImGui_ImplOpenGL3_CopyDrawData(draw_data, stream, (char*)dst);
+            if (glUnmapBuffer(stream->Target))
+                return;
+        }
+    }
+#endif
+    // No mapping (GL ES 2.0 / WebGL 1.0): gather the frame on our side and upload it in one call
+    g_StagingBuffer.resize((int)size);
+    ImGui_ImplOpenGL3_CopyDrawData(draw_data, stream, g_StagingBuffer.Data);
+    glBufferSubData(stream->Target, offset, size, g_StagingBuffer.Data);
+}
+
+#if IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE
+// (Re)creates a persistently mapped buffer with IMGUI_IMPL_OPENGL_STREAM_REGIONS regions of at least 'count' elements
+static bool ImGui_ImplOpenGL3_CreatePersistentBuffer(ImGui_ImplOpenGL3_StreamBuffer* stream, size_t count)
+{
+    // Buffer storage is immutable, growing means starting over with a new buffer
+    if (stream->Handle) glDeleteBuffers(1, &stream->Handle);
+    glGenBuffers(1, &stream->Handle);
+    glBindBuffer(stream->Target, stream->Handle);
+
+    stream->Capacity = 4096;
+    while (stream->Capacity < count * 2)
+        stream->Capacity *= 2;
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLsizeiptr size = (GLsizeiptr)(stream->Capacity * stream->ElementSize * IMGUI_IMPL_OPENGL_STREAM_REGIONS);
+    glBufferStorage(stream->Target, size, NULL, flags);
+    stream->Mapped = (char*)glMapBufferRange(stream->Target, 0, size, flags);
+    return stream->Mapped != NULL;
+}
+#endif
+
+// Gets the frame's vertices and indices to the GPU, with one upload (or copy) per buffer. Afterwards the frame's data
+// starts at g_VertexStream.Base and g_IndexStream.Base (in elements). Legacy mode uploads while drawing instead.
+static void ImGui_ImplOpenGL3_UploadDrawData(ImDrawData* draw_data)
+{
+    ImGui_ImplOpenGL3_StreamingMode mode = ImGui_ImplOpenGL3_ResolveStreamingMode();
+    if (mode != g_ActiveStreamingMode)
+    {
+        ImGui_ImplOpenGL3_ResetStreamBuffers(true);
+        g_ActiveStreamingMode = mode;
+    }
+
+    g_VertexStream.Base = g_IndexStream.Base = 0;
+    size_t vtx_count = (size_t)draw_data->TotalVtxCount, idx_count = (size_t)draw_data->TotalIdxCount;
+    if (mode == ImGui_ImplOpenGL3_StreamingMode_Legacy || vtx_count == 0 || idx_count == 0)
+        return;
+
+#if IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE
+    if (mode == ImGui_ImplOpenGL3_StreamingMode_Persistent)
+    {
+        bool mapped = true;
+        if (vtx_count > g_VertexStream.Capacity)
+            mapped &= ImGui_ImplOpenGL3_CreatePersistentBuffer(&g_VertexStream, vtx_count);
+        if (idx_count > g_IndexStream.Capacity)
+            mapped &= ImGui_ImplOpenGL3_CreatePersistentBuffer(&g_IndexStream, idx_count);
+        if (!mapped)
+        {
+            // Stick to the ring buffer from now on
+            g_PersistentMappingFailed = true;
+            ImGui_ImplOpenGL3_UploadDrawData(draw_data);
+            return;
+        }
+
+        // Wait until the GPU is done with the frame that used this region last (normally long ago)
+        if (GLsync fence = g_RegionFences[g_Region])
+        {
+            while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED) {}
+            glDeleteSync(fence);
+            g_RegionFences[g_Region] = 0;
+        }
+
+        g_VertexStream.Base = g_Region * g_VertexStream.Capacity;
+        g_IndexStream.Base = g_Region * g_IndexStream.Capacity;
+        ImGui_ImplOpenGL3_CopyDrawData(draw_data, &g_VertexStream, g_VertexStream.Mapped + g_VertexStream.Base * g_VertexStream.ElementSize);
+        ImGui_ImplOpenGL3_CopyDrawData(draw_data, &g_IndexStream, g_IndexStream.Mapped + g_IndexStream.Base * g_IndexStream.ElementSize);
+        return;
+    }
+#endif
+
+    ImGui_ImplOpenGL3_UploadRing(draw_data, &g_VertexStream, vtx_count);
+    ImGui_ImplOpenGL3_UploadRing(draw_data, &g_IndexStream, idx_count);
 }
 
 // OpenGL3 Render function.
@@ -341,21 +561,41 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
     GLuint vertex_array_object = 0;
 #ifndef IMGUI_IMPL_OPENGL_ES2
     glGenVertexArrays(1, &vertex_array_object);
+    glBindVertexArray(vertex_array_object); // Uploading binds the index buffer, which is part of the VAO state
 #endif
+    ImGui_ImplOpenGL3_UploadDrawData(draw_data);
     ImGui_ImplOpenGL3_SetupRenderState(draw_data, fb_width, fb_height, vertex_array_object);
+    bool legacy_upload = g_ActiveStreamingMode == ImGui_ImplOpenGL3_StreamingMode_Legacy;
+
+    // With glDrawElementsBaseVertex() we can point at each draw list's vertices when drawing, otherwise the attributes have to move
+    bool use_base_vertex = false;
+#if IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET
+    use_base_vertex = g_GlVersion >= 320;
+#endif
 
     // Will project scissor/clipping rectangles into framebuffer space
     ImVec2 clip_off = draw_data->DisplayPos;         // (0,0) unless using multi-viewports
     ImVec2 clip_scale = draw_data->FramebufferScale; // (1,1) unless using retina display which are often (2,2)
 
+    // A signed distance field font atlas has to be drawn with the shader's distance field path
+    ImFontAtlas* font_atlas = ImGui::GetIO().Fonts;
+    ImTextureID distance_field_texture = (font_atlas->Flags & ImFontAtlasFlags_SignedDistanceField) ? font_atlas->TexID : (ImTextureID)NULL;
+    bool distance_field = false;
+
     // Render command lists
+    size_t vtx_base = g_VertexStream.Base, idx_base = g_IndexStream.Base; // Where the current draw list starts in the stream buffers
     for (int n = 0; n < draw_data->CmdListsCount; n++)
     {
         const ImDrawList* cmd_list = draw_data->CmdLists[n];
 
         // Upload vertex/index buffers
-        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert), (const GLvoid*)cmd_list->VtxBuffer.Data, GL_STREAM_DRAW);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx), (const GLvoid*)cmd_list->IdxBuffer.Data, GL_STREAM_DRAW);
+        if (legacy_upload)
+        {
+            glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)cmd_list->VtxBuffer.Size * sizeof(ImDrawVert), (const GLvoid*)cmd_list->VtxBuffer.Data, GL_STREAM_DRAW);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx), (const GLvoid*)cmd_list->IdxBuffer.Data, GL_STREAM_DRAW);
+        }
+        else if (!use_base_vertex)
+            ImGui_ImplOpenGL3_SetupVertexAttribs(vtx_base * sizeof(ImDrawVert));
 
         for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
         {
@@ -365,7 +605,12 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
                 // User callback, registered via ImDrawList::AddCallback()
                 // (ImDrawCallback_ResetRenderState is a special callback value used by the user to request the renderer to reset render state.)
                 if (pcmd->UserCallback == ImDrawCallback_ResetRenderState)
+                {
                     ImGui_ImplOpenGL3_SetupRenderState(draw_data, fb_width, fb_height, vertex_array_object);
+                    distance_field = false;
+                    if (!legacy_upload && !use_base_vertex)
+                        ImGui_ImplOpenGL3_SetupVertexAttribs(vtx_base * sizeof(ImDrawVert));
+                }
                 else
                     pcmd->UserCallback(cmd_list, pcmd);
             }
@@ -388,17 +633,38 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
 
                     // Bind texture, Draw
                     glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->TextureId);
+                    if ((distance_field_texture != NULL && pcmd->TextureId == distance_field_texture) != distance_field)
+                    {
+                        distance_field = !distance_field;
+                        glUniform1i(g_AttribLocationDistanceField, distance_field ? 1 : 0);
+                    }
+                    void* idx_offset = (void*)(intptr_t)((idx_base + pcmd->IdxOffset) * sizeof(ImDrawIdx));
 #if IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET
-                    if (g_GlVersion >= 3200)
-                        glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx)), (GLint)pcmd->VtxOffset);
+                    if (use_base_vertex)
+                        glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, idx_offset, (GLint)(vtx_base + pcmd->VtxOffset));
                     else
 #endif
-                    glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx)));
+                    glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, idx_offset);
                 }
             }
         }
+
+        if (!legacy_upload)
+        {
+            vtx_base += (size_t)cmd_list->VtxBuffer.Size;
+            idx_base += (size_t)cmd_list->IdxBuffer.Size;
+        }
     }
 
+#if IMGUI_IMPL_OPENGL_MAY_HAVE_BUFFER_STORAGE
+    // Remember when the GPU is done with this frame's region, we'll write into it again IMGUI_IMPL_OPENGL_STREAM_REGIONS frames from now
+    if (g_ActiveStreamingMode == ImGui_ImplOpenGL3_StreamingMode_Persistent && draw_data->TotalVtxCount > 0 && draw_data->TotalIdxCount > 0)
+    {
+        g_RegionFences[g_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        g_Region = (g_Region + 1) % IMGUI_IMPL_OPENGL_STREAM_REGIONS;
+    }
+#endif
+
     // Destroy the temporary VAO
 #ifndef IMGUI_IMPL_OPENGL_ES2
     glDeleteVertexArrays(1, &vertex_array_object);
@@ -576,47 +842,77 @@ bool    ImGui_ImplOpenGL3_CreateDeviceObjects()
         "    gl_Position = ProjMtx * vec4(Position.xy,0,1);\n"
         "}\n";
 
+    // With a signed distance field font atlas the font texture's alpha is the distance to the glyph outlines (0.5 on them),
+    // dividing by how much it changes per pixel gives the distance in pixels, which covers the pixels within half a pixel of the outline.
+    // GLSL ES 1.00 only has the derivatives with GL_OES_standard_derivatives, without them it falls back to a fixed edge.
     const GLchar* fragment_shader_glsl_120 =
+        "#if defined(GL_ES) && defined(GL_OES_standard_derivatives)\n"
+        "#extension GL_OES_standard_derivatives : enable\n"
+        "#endif\n"
         "#ifdef GL_ES\n"
         "    precision mediump float;\n"
         "#endif\n"
         "uniform sampler2D Texture;\n"
+        "uniform bool DistanceField;\n"
         "varying vec2 Frag_UV;\n"
         "varying vec4 Frag_Color;\n"
         "void main()\n"
         "{\n"
-        "    gl_FragColor = Frag_Color * texture2D(Texture, Frag_UV.st);\n"
+        "    vec4 texel = texture2D(Texture, Frag_UV.st);\n"
+        "#if !defined(GL_ES) || defined(GL_OES_standard_derivatives)\n"
+        "    float width = length(vec2(dFdx(texel.a), dFdy(texel.a)));\n"
+        "#else\n"
+        "    float width = 0.05;\n"
+        "#endif\n"
+        "    if (DistanceField)\n"
+        "        texel.a = clamp((texel.a - 0.5019608) / max(width, 0.0001) + 0.5, 0.0, 1.0);\n"
+        "    gl_FragColor = Frag_Color * texel;\n"
         "}\n";
 
     const GLchar* fragment_shader_glsl_130 =
         "uniform sampler2D Texture;\n"
+        "uniform bool DistanceField;\n"
         "in vec2 Frag_UV;\n"
         "in vec4 Frag_Color;\n"
         "out vec4 Out_Color;\n"
         "void main()\n"
         "{\n"
-        "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+        "    vec4 texel = texture(Texture, Frag_UV.st);\n"
+        "    float width = length(vec2(dFdx(texel.a), dFdy(texel.a)));\n"
+        "    if (DistanceField)\n"
+        "        texel.a = clamp((texel.a - 0.5019608) / max(width, 0.0001) + 0.5, 0.0, 1.0);\n"
+        "    Out_Color = Frag_Color * texel;\n"
         "}\n";
 
     const GLchar* fragment_shader_glsl_300_es =
         "precision mediump float;\n"
         "uniform sampler2D Texture;\n"
+        "uniform bool DistanceField;\n"
         "in vec2 Frag_UV;\n"
         "in vec4 Frag_Color;\n"
         "layout (location = 0) out vec4 Out_Color;\n"
         "void main()\n"
         "{\n"
-        "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+        "    vec4 texel = texture(Texture, Frag_UV.st);\n"
+        "    float width = length(vec2(dFdx(texel.a), dFdy(texel.a)));\n"
+        "    if (DistanceField)\n"
+        "        texel.a = clamp((texel.a - 0.5019608) / max(width, 0.0001) + 0.5, 0.0, 1.0);\n"
+        "    Out_Color = Frag_Color * texel;\n"
         "}\n";
 
     const GLchar* fragment_shader_glsl_410_core =
         "in vec2 Frag_UV;\n"
         "in vec4 Frag_Color;\n"
         "uniform sampler2D Texture;\n"
+        "uniform bool DistanceField;\n"
         "layout (location = 0) out vec4 Out_Color;\n"
         "void main()\n"
         "{\n"
-        "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+        "    vec4 texel = texture(Texture, Frag_UV.st);\n"
+        "    float width = length(vec2(dFdx(texel.a), dFdy(texel.a)));\n"
+        "    if (DistanceField)\n"
+        "        texel.a = clamp((texel.a - 0.5019608) / max(width, 0.0001) + 0.5, 0.0, 1.0);\n"
+        "    Out_Color = Frag_Color * texel;\n"
         "}\n";
 
     // Select shaders matching our GLSL versions
@@ -664,13 +960,14 @@ bool    ImGui_ImplOpenGL3_CreateDeviceObjects()
 
     g_AttribLocationTex = glGetUniformLocation(g_ShaderHandle, "Texture");
     g_AttribLocationProjMtx = glGetUniformLocation(g_ShaderHandle, "ProjMtx");
+    g_AttribLocationDistanceField = glGetUniformLocation(g_ShaderHandle, "DistanceField");
     g_AttribLocationVtxPos = glGetAttribLocation(g_ShaderHandle, "Position");
     g_AttribLocationVtxUV = glGetAttribLocation(g_ShaderHandle, "UV");
     g_AttribLocationVtxColor = glGetAttribLocation(g_ShaderHandle, "Color");
 
     // Create buffers
-    glGenBuffers(1, &g_VboHandle);
-    glGenBuffers(1, &g_ElementsHandle);
+    ImGui_ImplOpenGL3_ResetStreamBuffers(true);
+    g_ActiveStreamingMode = ImGui_ImplOpenGL3_StreamingMode_Auto;
 
     ImGui_ImplOpenGL3_CreateFontsTexture();
 
@@ -686,8 +983,8 @@ bool    ImGui_ImplOpenGL3_CreateDeviceObjects()
 
 void    ImGui_ImplOpenGL3_DestroyDeviceObjects()
 {
-    if (g_VboHandle)        { glDeleteBuffers(1, &g_VboHandle); g_VboHandle = 0; }
-    if (g_ElementsHandle)   { glDeleteBuffers(1, &g_ElementsHandle); g_ElementsHandle = 0; }
+    ImGui_ImplOpenGL3_ResetStreamBuffers(false);
+    g_ActiveStreamingMode = ImGui_ImplOpenGL3_StreamingMode_Auto;
     if (g_ShaderHandle && g_VertHandle) { glDetachShader(g_ShaderHandle, g_VertHandle); }
     if (g_ShaderHandle && g_FragHandle) { glDetachShader(g_ShaderHandle, g_FragHandle); }
     if (g_VertHandle)       { glDeleteShader(g_VertHandle); g_VertHandle = 0; }
@@ -43,6 +43,17 @@ IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyFontsTexture();
 IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_CreateDeviceObjects();
 IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyDeviceObjects();
 
+// (Optional) How vertices and indices get to the GPU. Every mode but Legacy uploads a whole frame at once.
+enum ImGui_ImplOpenGL3_StreamingMode
+{
+    ImGui_ImplOpenGL3_StreamingMode_Auto,       // Persistent when GL 4.4 is available, Ring otherwise
+    ImGui_ImplOpenGL3_StreamingMode_Legacy,     // glBufferData() for every draw list, like upstream
+    ImGui_ImplOpenGL3_StreamingMode_Ring,       // Ring buffer, orphaned when it wraps (mapped with GL 3.0 / ES 3.0, glBufferSubData() otherwise)
+    ImGui_ImplOpenGL3_StreamingMode_Persistent  // Persistently mapped buffers, one region per frame in flight (GL 4.4)
+};
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetStreamingMode(ImGui_ImplOpenGL3_StreamingMode mode);
+IMGUI_IMPL_API ImGui_ImplOpenGL3_StreamingMode ImGui_ImplOpenGL3_GetStreamingMode(); // The mode the last frame was rendered with (Auto before the first one)
+
 #define IMGUI_IMPL_OPENGL_LOADER_GLAD
 #endif
 #else
@@ -60,6 +71,17 @@ IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyFontsTexture();
 IMGUI_IMPL_API bool     ImGui_ImplOpenGL3_CreateDeviceObjects();
 IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyDeviceObjects();
 
+// (Optional) How vertices and indices get to the GPU. Every mode but Legacy uploads a whole frame at once.
+enum ImGui_ImplOpenGL3_StreamingMode
+{
+    ImGui_ImplOpenGL3_StreamingMode_Auto,       // Persistent when GL 4.4 is available, Ring otherwise
+    ImGui_ImplOpenGL3_StreamingMode_Legacy,     // glBufferData() for every draw list, like upstream
+    ImGui_ImplOpenGL3_StreamingMode_Ring,       // Ring buffer, orphaned when it wraps (mapped with GL 3.0 / ES 3.0, glBufferSubData() otherwise)
+    ImGui_ImplOpenGL3_StreamingMode_Persistent  // Persistently mapped buffers, one region per frame in flight (GL 4.4)
+};
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetStreamingMode(ImGui_ImplOpenGL3_StreamingMode mode);
+IMGUI_IMPL_API ImGui_ImplOpenGL3_StreamingMode ImGui_ImplOpenGL3_GetStreamingMode(); // The mode the last frame was rendered with (Auto before the first one)
+
 // Specific OpenGL versions
 //#define IMGUI_IMPL_OPENGL_ES2     // Auto-detected on Emscripten
 //#define IMGUI_IMPL_OPENGL_ES3     // Auto-detected on iOS/Android
@@ -5,12 +5,27 @@
 //   publish, and distribute this file as you see fit.
 #include "imgui_sw.h"
 
-#ifdef NS_IMGUI_SOFTWARE_RENDERING
+#ifdef IMGUI_SOFTWARE_RENDERING
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include "imgui.h"
 
+// The SSE2/AVX2 span kernels need GCC/Clang on x86 and the default ImGui color packing
+// (they assume red lives in the lowest byte of a pixel).
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && IM_COL32_R_SHIFT == 0 && IM_COL32_B_SHIFT == 16
+#define IMGUI_SW_X86_KERNELS
+#include <immintrin.h>
+#endif
+
 namespace imgui_sw {
 namespace internal {
 
@@ -45,25 +60,54 @@ struct Stats
 	int    textured_triangle_pixels           = 0;
 	int    gradient_triangle_pixels           = 0;
 	int    font_pixels                        = 0;
+	int    image_pixels                       = 0;
 	double uniform_rectangle_pixels           = 0;
 	double textured_rectangle_pixels          = 0;
 	double gradient_rectangle_pixels          = 0;
 	double gradient_textured_rectangle_pixels = 0;
+	int    repainted_tiles                    = 0;
+	int    total_tiles                        = 0;
+	double paint_ms                           = 0; // Wall time of the last paint call.
 };
 
 struct Texture
 {
-	const uint8_t* pixels; // 8-bit.
-	int            width;
-	int            height;
+	const uint8_t*        pixels; // 8-bit alpha for the font, RGBA (ImGui packing) when rgba is set.
+	int                   width;
+	int                   height;
+	bool                  rgba    = false;
+	TextureFilter         filter  = TextureFilter::Nearest;
+	uint32_t              version = 0; // Bumped by update_texture, so paint_imgui_changes notices.
+	int                   sdf_spread = 0; // A signed distance field font atlas (ImFontAtlas::TexSdfSpread) when set.
+	std::vector<uint32_t> storage;     // Owns the pixels of textures from create_texture.
+
+	Texture(const uint8_t* pixels_, int width_, int height_, bool rgba_ = false, TextureFilter filter_ = TextureFilter::Nearest)
+		: pixels(pixels_), width(width_), height(height_), rgba(rgba_), filter(filter_) {}
 };
 
+struct Kernels;
+
 struct PaintTarget
 {
-	uint32_t* pixels;
-	int       width;
-	int       height;
-	ImVec2    scale; // Multiply ImGui (point) coordinates with this to get pixel coordinates.
+	uint32_t*      pixels;
+	int            width;
+	int            height;
+	ImVec2         scale; // Multiply ImGui (point) coordinates with this to get pixel coordinates.
+	const Kernels* kernels; // Span kernels used to write to pixels.
+
+	// The part of pixels we may write to, [min, max). The whole buffer, or one tile.
+	int            min_x;
+	int            min_y;
+	int            max_x;
+	int            max_y;
+
+	// pixels holds the [origin, origin + stride) part of each row, which is usually all of it.
+	// A tile can instead be painted into a small buffer of its own, with origin at its corner.
+	int            stride;
+	int            origin_x;
+	int            origin_y;
+
+	uint32_t* at(int x, int y) const { return pixels + ((y - origin_y) * stride + (x - origin_x)); }
 };
 
 // ----------------------------------------------------------------------------
@@ -98,6 +142,424 @@ ColorInt blend(ColorInt target, ColorInt source)
 	return result;
 }
 
+// Blend two RGBA colors, t in [0, 256]. Does two channels at a time.
+inline uint32_t lerp_rgba(uint32_t a, uint32_t b, uint32_t t)
+{
+	const uint32_t rb = ((a & 0x00FF00FFu) * (256 - t) + (b & 0x00FF00FFu) * t) >> 8;
+	const uint32_t ga = ((a >> 8) & 0x00FF00FFu) * (256 - t) + ((b >> 8) & 0x00FF00FFu) * t;
+	return (rb & 0x00FF00FFu) | (ga & 0xFF00FF00u);
+}
+
+// Where a texture coordinate lands along one axis: the two texels to blend, and the weight of the second.
+struct TexelPair
+{
+	int      i0, i1;
+	uint32_t t; // [0, 256)
+};
+
+// ----------------------------------------------------------------------------
+// Span kernels: these blend a horizontal run of pixels and is where most of the fill rate goes.
+// The SIMD versions give exactly the same result as the scalar ones.
+
+// Blends color over every pixel in [pixels, pixels + count).
+using UniformSpanFn = void (*)(uint32_t* pixels, int count, const ColorInt& color);
+
+// Like UniformSpanFn, but the alpha of color is scaled by a per-pixel coverage (the font texture).
+// Full coverage writes color as-is, zero coverage leaves the pixel alone.
+using CoverageSpanFn = void (*)(uint32_t* pixels, const uint8_t* coverage, int count, uint32_t color);
+
+// Converts pixels to RGB565 (red in the top bits). x and y is where in the frame the span starts,
+// which picks the ordered dithering pattern.
+using Rgb565SpanFn = void (*)(const uint32_t* pixels, uint16_t* out, int count, int x, int y, bool dither);
+
+// out = a + (b - a) * t / 256 for every pixel, t in [0, 256). Used to blend two rows when upscaling.
+using LerpSpanFn = void (*)(const uint32_t* a, const uint32_t* b, uint32_t* out, int count, uint32_t t);
+
+// out[i] = lerp of row[columns[i].i0] and row[columns[i].i1] by columns[i].t. Samples a row when upscaling.
+using SampleRowFn = void (*)(const uint32_t* row, const TexelPair* columns, uint32_t* out, int count);
+
+struct Kernels
+{
+	UniformSpanFn  blend_uniform_span;
+	CoverageSpanFn blend_coverage_span;
+	Rgb565SpanFn   convert_span_rgb565;
+	LerpSpanFn     lerp_span;
+	SampleRowFn    sample_row;
+};
+
+void blend_uniform_span_scalar(uint32_t* pixels, int count, const ColorInt& color)
+{
+	if (count <= 0) { return; }
+
+	// We often blend the same colors over and over again, so optimize for this (saves 25% total cpu):
+	uint32_t last_target_pixel = pixels[0];
+	uint32_t last_output = blend(ColorInt(last_target_pixel), color).toUint32();
+
+	for (int x = 0; x < count; ++x) {
+		uint32_t& target_pixel = pixels[x];
+		if (target_pixel == last_target_pixel) {
+			target_pixel = last_output;
+			continue;
+		}
+		last_target_pixel = target_pixel;
+		target_pixel = blend(ColorInt(target_pixel), color).toUint32();
+		last_output = target_pixel;
+	}
+}
+
+void blend_coverage_span_scalar(uint32_t* pixels, const uint8_t* coverage, int count, uint32_t color)
+{
+	const ColorInt color_int = ColorInt(color);
+
+	for (int x = 0; x < count; ++x) {
+		const uint8_t texel = coverage[x];
+
+		// The font texture is all black or all white, so optimize for this:
+		if (texel == 0) { continue; }
+		if (texel == 255) {
+			pixels[x] = color;
+			continue;
+		}
+
+		// Other textured rectangles
+		ColorInt source_color = color_int;
+		source_color.a = source_color.a * texel / 255;
+		pixels[x] = blend(ColorInt(pixels[x]), source_color).toUint32();
+	}
+}
+
+// 4x4 Bayer matrix: the order in which the pixels of a block round up instead of down.
+const uint8_t kBayer4x4[4][4] = {
+	{ 0,  8,  2, 10},
+	{12,  4, 14,  6},
+	{ 3, 11,  1,  9},
+	{15,  7, 13,  5},
+};
+
+// How much to add before dividing by 255 for the pixel at x in a row of the Bayer matrix.
+// Without dithering this is plain rounding.
+inline uint32_t rgb565_bias(const uint8_t* bayer_row, int x, bool dither)
+{
+	return dither ? bayer_row[x & 3] * 16u + 8u : 127u;
+}
+
+void convert_span_rgb565_scalar(const uint32_t* pixels, uint16_t* out, int count, int x, int y, bool dither)
+{
+	const uint8_t* bayer_row = kBayer4x4[y & 3];
+	for (int i = 0; i < count; ++i) {
+		const uint32_t bias = rgb565_bias(bayer_row, x + i, dither);
+		const uint32_t r = (((pixels[i] >> IM_COL32_R_SHIFT) & 0xFFu) * 31 + bias) / 255;
+		const uint32_t g = (((pixels[i] >> IM_COL32_G_SHIFT) & 0xFFu) * 63 + bias) / 255;
+		const uint32_t b = (((pixels[i] >> IM_COL32_B_SHIFT) & 0xFFu) * 31 + bias) / 255;
+		out[i] = static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+}
+
+void lerp_span_scalar(const uint32_t* a, const uint32_t* b, uint32_t* out, int count, uint32_t t)
+{
+	for (int i = 0; i < count; ++i) {
+		out[i] = lerp_rgba(a[i], b[i], t);
+	}
+}
+
+void sample_row_scalar(const uint32_t* row, const TexelPair* columns, uint32_t* out, int count)
+{
+	for (int i = 0; i < count; ++i) {
+		out[i] = lerp_rgba(row[columns[i].i0], row[columns[i].i1], columns[i].t);
+	}
+}
+
+const Kernels kScalarKernels = { blend_uniform_span_scalar, blend_coverage_span_scalar, convert_span_rgb565_scalar, lerp_span_scalar, sample_row_scalar };
+
+#ifdef IMGUI_SW_X86_KERNELS
+// Exact x / 255 for every 16-bit lane with x in [0, 255 * 255].
+inline __m128i div255_epu16(__m128i x)
+{
+	return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_srli_epi16(x, 8)), 8);
+}
+
+void blend_uniform_span_sse2(uint32_t* pixels, int count, const ColorInt& color)
+{
+	// Two pixels per register with one 16-bit lane per channel. The alpha lane ends up as 0, just like blend().
+	const __m128i zero = _mm_setzero_si128();
+	const auto r = static_cast<int16_t>(color.r * color.a);
+	const auto g = static_cast<int16_t>(color.g * color.a);
+	const auto b = static_cast<int16_t>(color.b * color.a);
+	const auto inv_a = static_cast<int16_t>(255 - color.a);
+	const __m128i source = _mm_setr_epi16(r, g, b, 0, r, g, b, 0);
+	const __m128i inv_alpha = _mm_setr_epi16(inv_a, inv_a, inv_a, 0, inv_a, inv_a, inv_a, 0);
+
+	int x = 0;
+	for (; x + 4 <= count; x += 4) {
+		const __m128i target = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + x));
+		const __m128i lo = div255_epu16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(target, zero), inv_alpha), source));
+		const __m128i hi = div255_epu16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(target, zero), inv_alpha), source));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + x), _mm_packus_epi16(lo, hi));
+	}
+
+	blend_uniform_span_scalar(pixels + x, count - x, color);
+}
+
+void blend_coverage_span_sse2(uint32_t* pixels, const uint8_t* coverage, int count, uint32_t color)
+{
+	const ColorInt color_int = ColorInt(color);
+	const __m128i zero = _mm_setzero_si128();
+	const auto r = static_cast<int16_t>(color_int.r);
+	const auto g = static_cast<int16_t>(color_int.g);
+	const auto b = static_cast<int16_t>(color_int.b);
+	const __m128i rgb = _mm_setr_epi16(r, g, b, 0, r, g, b, 0);
+	const __m128i rgb_mask = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+	const __m128i color_alpha = _mm_set1_epi16(static_cast<int16_t>(color_int.a));
+	const __m128i opaque = _mm_set1_epi16(255);
+	const __m128i full = _mm_set1_epi32(255);
+	const __m128i color_vec = _mm_set1_epi32(static_cast<int>(color));
+
+	int x = 0;
+	for (; x + 4 <= count; x += 4) {
+		int32_t coverage4;
+		std::memcpy(&coverage4, coverage + x, sizeof(coverage4));
+		if (coverage4 == 0) { continue; } // Gaps between glyphs.
+
+		// Per-pixel alpha (color.a * coverage / 255), then spread over the channels of each pixel:
+		const __m128i coverage16 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(coverage4), zero);
+		const __m128i alpha16 = div255_epu16(_mm_mullo_epi16(coverage16, color_alpha));
+		const __m128i alpha_pairs = _mm_unpacklo_epi16(alpha16, alpha16);
+		const __m128i alpha_lo = _mm_unpacklo_epi32(alpha_pairs, alpha_pairs);
+		const __m128i alpha_hi = _mm_unpackhi_epi32(alpha_pairs, alpha_pairs);
+
+		const __m128i target = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + x));
+		const __m128i inv_lo = _mm_and_si128(_mm_sub_epi16(opaque, alpha_lo), rgb_mask);
+		const __m128i inv_hi = _mm_and_si128(_mm_sub_epi16(opaque, alpha_hi), rgb_mask);
+		const __m128i lo = div255_epu16(_mm_add_epi16(_mm_mullo_epi16(rgb, alpha_lo), _mm_mullo_epi16(_mm_unpacklo_epi8(target, zero), inv_lo)));
+		const __m128i hi = div255_epu16(_mm_add_epi16(_mm_mullo_epi16(rgb, alpha_hi), _mm_mullo_epi16(_mm_unpackhi_epi8(target, zero), inv_hi)));
+		const __m128i blended = _mm_packus_epi16(lo, hi);
+
+		// Zero coverage keeps the target, full coverage writes the color untouched:
+		const __m128i coverage32 = _mm_unpacklo_epi16(coverage16, zero);
+		const __m128i is_empty = _mm_cmpeq_epi32(coverage32, zero);
+		const __m128i is_full = _mm_cmpeq_epi32(coverage32, full);
+		__m128i result = _mm_or_si128(_mm_and_si128(is_empty, target), _mm_andnot_si128(is_empty, blended));
+		result = _mm_or_si128(_mm_and_si128(is_full, color_vec), _mm_andnot_si128(is_full, result));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + x), result);
+	}
+
+	blend_coverage_span_scalar(pixels + x, coverage + x, count - x, color);
+}
+
+void convert_span_rgb565_sse2(const uint32_t* pixels, uint16_t* out, int count, int x, int y, bool dither)
+{
+	// Four pixels at a time, the dithering pattern repeats every four pixels anyway.
+	// Two pixels per register with one 16-bit lane per channel, as in blend_uniform_span_sse2.
+	const uint8_t* bayer_row = kBayer4x4[y & 3];
+	const auto bias0 = static_cast<int16_t>(rgb565_bias(bayer_row, x + 0, dither));
+	const auto bias1 = static_cast<int16_t>(rgb565_bias(bayer_row, x + 1, dither));
+	const auto bias2 = static_cast<int16_t>(rgb565_bias(bayer_row, x + 2, dither));
+	const auto bias3 = static_cast<int16_t>(rgb565_bias(bayer_row, x + 3, dither));
+	const __m128i bias_lo = _mm_setr_epi16(bias0, bias0, bias0, bias0, bias1, bias1, bias1, bias1);
+	const __m128i bias_hi = _mm_setr_epi16(bias2, bias2, bias2, bias2, bias3, bias3, bias3, bias3);
+	const __m128i levels = _mm_setr_epi16(31, 63, 31, 0, 31, 63, 31, 0);
+	const __m128i shifts = _mm_setr_epi16(1 << 11, 1 << 5, 1, 0, 1 << 11, 1 << 5, 1, 0);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias32 = _mm_set1_epi32(0x8000);
+	const __m128i bias16 = _mm_set1_epi16(static_cast<int16_t>(0x8000));
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+		const __m128i lo = div255_epu16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(source, zero), levels), bias_lo));
+		const __m128i hi = div255_epu16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(source, zero), levels), bias_hi));
+
+		// Shift r and g into place and add them up in 32 bits: [rg, b] for each pixel, then rg + b.
+		const __m128i sums_lo = _mm_madd_epi16(lo, shifts);
+		const __m128i sums_hi = _mm_madd_epi16(hi, shifts);
+		const __m128i packed_lo = _mm_shuffle_epi32(_mm_add_epi32(sums_lo, _mm_srli_epi64(sums_lo, 32)), _MM_SHUFFLE(3, 1, 2, 0));
+		const __m128i packed_hi = _mm_shuffle_epi32(_mm_add_epi32(sums_hi, _mm_srli_epi64(sums_hi, 32)), _MM_SHUFFLE(3, 1, 2, 0));
+		const __m128i result32 = _mm_unpacklo_epi64(packed_lo, packed_hi);
+
+		// SSE2 can only pack with signed saturation, so move the 16-bit values into the signed range and back:
+		const __m128i result16 = _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(result32, bias32), zero), bias16);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), result16);
+	}
+
+	convert_span_rgb565_scalar(pixels + i, out + i, count - i, x + i, y, dither);
+}
+
+void lerp_span_sse2(const uint32_t* a, const uint32_t* b, uint32_t* out, int count, uint32_t t)
+{
+	// Two pixels per register with one 16-bit lane per channel. a * (256 - t) + b * t fits in 16 bits.
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i weight_a = _mm_set1_epi16(static_cast<int16_t>(256 - t));
+	const __m128i weight_b = _mm_set1_epi16(static_cast<int16_t>(t));
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+		const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+		const __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), weight_a), _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), weight_b)), 8);
+		const __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), weight_a), _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), weight_b)), 8);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(lo, hi));
+	}
+
+	lerp_span_scalar(a + i, b + i, out + i, count - i, t);
+}
+
+void sample_row_sse2(const uint32_t* row, const TexelPair* columns, uint32_t* out, int count)
+{
+	// Like lerp_span_sse2, with the pixels gathered from row and a weight per pixel.
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i full = _mm_set1_epi16(256);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const TexelPair* c = columns + i;
+		const __m128i va = _mm_setr_epi32(row[c[0].i0], row[c[1].i0], row[c[2].i0], row[c[3].i0]);
+		const __m128i vb = _mm_setr_epi32(row[c[0].i1], row[c[1].i1], row[c[2].i1], row[c[3].i1]);
+		const __m128i t = _mm_setr_epi32(c[0].t, c[1].t, c[2].t, c[3].t); // One 16-bit weight in every other lane.
+		const __m128i t_pairs = _mm_or_si128(t, _mm_slli_epi32(t, 16));
+		const __m128i weight_b_lo = _mm_unpacklo_epi32(t_pairs, t_pairs);
+		const __m128i weight_b_hi = _mm_unpackhi_epi32(t_pairs, t_pairs);
+		const __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), _mm_sub_epi16(full, weight_b_lo)), _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), weight_b_lo)), 8);
+		const __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), _mm_sub_epi16(full, weight_b_hi)), _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), weight_b_hi)), 8);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(lo, hi));
+	}
+
+	sample_row_scalar(row, columns + i, out + i, count - i);
+}
+
+#define IMGUI_SW_AVX2 __attribute__((target("avx2")))
+
+IMGUI_SW_AVX2 inline __m256i div255_epu16_avx2(__m256i x)
+{
+	return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(x, _mm256_set1_epi16(1)), _mm256_srli_epi16(x, 8)), 8);
+}
+
+IMGUI_SW_AVX2 void blend_uniform_span_avx2(uint32_t* pixels, int count, const ColorInt& color)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const auto r = static_cast<int16_t>(color.r * color.a);
+	const auto g = static_cast<int16_t>(color.g * color.a);
+	const auto b = static_cast<int16_t>(color.b * color.a);
+	const auto inv_a = static_cast<int16_t>(255 - color.a);
+	const __m256i source = _mm256_setr_epi16(r, g, b, 0, r, g, b, 0, r, g, b, 0, r, g, b, 0);
+	const __m256i inv_alpha = _mm256_setr_epi16(inv_a, inv_a, inv_a, 0, inv_a, inv_a, inv_a, 0, inv_a, inv_a, inv_a, 0, inv_a, inv_a, inv_a, 0);
+
+	int x = 0;
+	for (; x + 8 <= count; x += 8) {
+		const __m256i target = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + x));
+		const __m256i lo = div255_epu16_avx2(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(target, zero), inv_alpha), source));
+		const __m256i hi = div255_epu16_avx2(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(target, zero), inv_alpha), source));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels + x), _mm256_packus_epi16(lo, hi));
+	}
+
+	// The tail is legacy SSE code, so leave a clean upper state behind (avoids the SSE/AVX transition penalty):
+	_mm256_zeroupper();
+	blend_uniform_span_sse2(pixels + x, count - x, color);
+}
+
+IMGUI_SW_AVX2 void blend_coverage_span_avx2(uint32_t* pixels, const uint8_t* coverage, int count, uint32_t color)
+{
+	const ColorInt color_int = ColorInt(color);
+	const __m256i zero = _mm256_setzero_si256();
+	const auto r = static_cast<int16_t>(color_int.r);
+	const auto g = static_cast<int16_t>(color_int.g);
+	const auto b = static_cast<int16_t>(color_int.b);
+	const __m256i rgb = _mm256_setr_epi16(r, g, b, 0, r, g, b, 0, r, g, b, 0, r, g, b, 0);
+	const __m256i rgb_mask = _mm256_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0);
+	const __m256i color_alpha = _mm256_set1_epi16(static_cast<int16_t>(color_int.a));
+	const __m256i opaque = _mm256_set1_epi16(255);
+	const __m256i full = _mm256_set1_epi32(255);
+	const __m256i color_vec = _mm256_set1_epi32(static_cast<int>(color));
+
+	int x = 0;
+	for (; x + 8 <= count; x += 8) {
+		int64_t coverage8;
+		std::memcpy(&coverage8, coverage + x, sizeof(coverage8));
+		if (coverage8 == 0) { continue; } // Gaps between glyphs.
+
+		// One 32-bit lane per pixel, packed down to 16-bit within each 128-bit half so the
+		// alpha spreading lines up with unpacklo/unpackhi of the pixels (0,1 4,5 and 2,3 6,7):
+		const __m256i coverage32 = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(coverage + x)));
+		const __m256i coverage16 = _mm256_packus_epi32(coverage32, coverage32);
+		const __m256i alpha16 = div255_epu16_avx2(_mm256_mullo_epi16(coverage16, color_alpha));
+		const __m256i alpha_pairs = _mm256_unpacklo_epi16(alpha16, alpha16);
+		const __m256i alpha_lo = _mm256_unpacklo_epi32(alpha_pairs, alpha_pairs);
+		const __m256i alpha_hi = _mm256_unpackhi_epi32(alpha_pairs, alpha_pairs);
+
+		const __m256i target = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + x));
+		const __m256i inv_lo = _mm256_and_si256(_mm256_sub_epi16(opaque, alpha_lo), rgb_mask);
+		const __m256i inv_hi = _mm256_and_si256(_mm256_sub_epi16(opaque, alpha_hi), rgb_mask);
+		const __m256i lo = div255_epu16_avx2(_mm256_add_epi16(_mm256_mullo_epi16(rgb, alpha_lo), _mm256_mullo_epi16(_mm256_unpacklo_epi8(target, zero), inv_lo)));
+		const __m256i hi = div255_epu16_avx2(_mm256_add_epi16(_mm256_mullo_epi16(rgb, alpha_hi), _mm256_mullo_epi16(_mm256_unpackhi_epi8(target, zero), inv_hi)));
+		const __m256i blended = _mm256_packus_epi16(lo, hi);
+
+		// Zero coverage keeps the target, full coverage writes the color untouched:
+		const __m256i is_empty = _mm256_cmpeq_epi32(coverage32, zero);
+		const __m256i is_full = _mm256_cmpeq_epi32(coverage32, full);
+		__m256i result = _mm256_blendv_epi8(blended, target, is_empty);
+		result = _mm256_blendv_epi8(result, color_vec, is_full);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels + x), result);
+	}
+
+	_mm256_zeroupper();
+	blend_coverage_span_sse2(pixels + x, coverage + x, count - x, color);
+}
+
+IMGUI_SW_AVX2 void convert_span_rgb565_avx2(const uint32_t* pixels, uint16_t* out, int count, int x, int y, bool dither)
+{
+	// Eight pixels at a time, as in convert_span_rgb565_sse2. unpacklo/unpackhi work within each
+	// 128-bit half, so the halves hold pixels 0,1 4,5 and 2,3 6,7 and share the dithering biases.
+	const uint8_t* bayer_row = kBayer4x4[y & 3];
+	const auto bias0 = static_cast<int16_t>(rgb565_bias(bayer_row, x + 0, dither));
+	const auto bias1 = static_cast<int16_t>(rgb565_bias(bayer_row, x + 1, dither));
+	const auto bias2 = static_cast<int16_t>(rgb565_bias(bayer_row, x + 2, dither));
+	const auto bias3 = static_cast<int16_t>(rgb565_bias(bayer_row, x + 3, dither));
+	const __m256i bias_lo = _mm256_setr_epi16(bias0, bias0, bias0, bias0, bias1, bias1, bias1, bias1, bias0, bias0, bias0, bias0, bias1, bias1, bias1, bias1);
+	const __m256i bias_hi = _mm256_setr_epi16(bias2, bias2, bias2, bias2, bias3, bias3, bias3, bias3, bias2, bias2, bias2, bias2, bias3, bias3, bias3, bias3);
+	const __m256i levels = _mm256_setr_epi16(31, 63, 31, 0, 31, 63, 31, 0, 31, 63, 31, 0, 31, 63, 31, 0);
+	const __m256i shifts = _mm256_setr_epi16(1 << 11, 1 << 5, 1, 0, 1 << 11, 1 << 5, 1, 0, 1 << 11, 1 << 5, 1, 0, 1 << 11, 1 << 5, 1, 0);
+	const __m256i zero = _mm256_setzero_si256();
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const __m256i source = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + i));
+		const __m256i lo = div255_epu16_avx2(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(source, zero), levels), bias_lo));
+		const __m256i hi = div255_epu16_avx2(_mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(source, zero), levels), bias_hi));
+
+		const __m256i sums_lo = _mm256_madd_epi16(lo, shifts);
+		const __m256i sums_hi = _mm256_madd_epi16(hi, shifts);
+		const __m256i packed_lo = _mm256_shuffle_epi32(_mm256_add_epi32(sums_lo, _mm256_srli_epi64(sums_lo, 32)), _MM_SHUFFLE(3, 1, 2, 0));
+		const __m256i packed_hi = _mm256_shuffle_epi32(_mm256_add_epi32(sums_hi, _mm256_srli_epi64(sums_hi, 32)), _MM_SHUFFLE(3, 1, 2, 0));
+		const __m256i result32 = _mm256_unpacklo_epi64(packed_lo, packed_hi);
+
+		// Unlike SSE2, AVX2 packs with unsigned saturation. Then gather the two halves' pixels 0-3 and 4-7:
+		const __m256i result16 = _mm256_permute4x64_epi64(_mm256_packus_epi32(result32, result32), _MM_SHUFFLE(3, 1, 2, 0));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_castsi256_si128(result16));
+	}
+
+	_mm256_zeroupper();
+	convert_span_rgb565_sse2(pixels + i, out + i, count - i, x + i, y, dither);
+}
+
+#undef IMGUI_SW_AVX2
+#endif
+
+// Picks the widest kernels the CPU supports.
+Kernels detect_kernels()
+{
+#ifdef IMGUI_SW_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) { return Kernels{ blend_uniform_span_avx2, blend_coverage_span_avx2, convert_span_rgb565_avx2, lerp_span_sse2, sample_row_sse2 }; }
+	if (__builtin_cpu_supports("sse2")) { return Kernels{ blend_uniform_span_sse2, blend_coverage_span_sse2, convert_span_rgb565_sse2, lerp_span_sse2, sample_row_sse2 }; }
+#endif
+	return kScalarKernels;
+}
+
+const Kernels* get_kernels(const SwOptions& options)
+{
+	static const Kernels s_detected_kernels = detect_kernels();
+	return options.use_simd ? &s_detected_kernels : &kScalarKernels;
+}
+
 // ----------------------------------------------------------------------------
 // Used for interpolating vertex attributes (color and texture coordinates) in a triangle.
 
@@ -269,6 +731,89 @@ inline uint8_t sample_texture(const Texture& texture, const ImVec2& uv)
 	return texture.pixels[ty * texture.width + tx];
 }
 
+// uv 0 and 1 are the outer edges of the texture, texel centers are at half-texels.
+inline TexelPair texel_pair(float uv, int size, TextureFilter filter)
+{
+	if (filter == TextureFilter::Nearest) {
+		const int i = std::min(std::max(static_cast<int>(std::floor(uv * size)), 0), size - 1);
+		return TexelPair{i, i, 0};
+	}
+
+	// Bilinear, with 8 bits of sub-texel precision:
+	const int u = static_cast<int>(std::floor((uv * size - 0.5f) * 256.0f));
+	const int i0 = std::min(std::max(u >> 8, 0), size - 1);
+	const int i1 = std::min(std::max((u >> 8) + 1, 0), size - 1);
+	return TexelPair{i0, i1, static_cast<uint32_t>(u & 0xFF)};
+}
+
+inline uint32_t sample_texels(const uint32_t* row0, const uint32_t* row1, const TexelPair& x, uint32_t ty)
+{
+	return lerp_rgba(lerp_rgba(row0[x.i0], row0[x.i1], x.t), lerp_rgba(row1[x.i0], row1[x.i1], x.t), ty);
+}
+
+inline uint32_t sample_texture_rgba(const Texture& texture, const ImVec2& uv)
+{
+	const uint32_t* texels = reinterpret_cast<const uint32_t*>(texture.pixels);
+	const TexelPair x = texel_pair(uv.x, texture.width, texture.filter);
+	const TexelPair y = texel_pair(uv.y, texture.height, texture.filter);
+	if (texture.filter == TextureFilter::Nearest) { return texels[y.i0 * texture.width + x.i0]; }
+	return sample_texels(texels + y.i0 * texture.width, texels + y.i1 * texture.width, x, y.t);
+}
+
+// Bilinear sample of an 8-bit texture (the distance field font atlas).
+inline uint8_t sample_texture_bilinear(const Texture& texture, const ImVec2& uv)
+{
+	const TexelPair x = texel_pair(uv.x, texture.width, TextureFilter::Bilinear);
+	const TexelPair y = texel_pair(uv.y, texture.height, TextureFilter::Bilinear);
+	const uint8_t* row0 = texture.pixels + y.i0 * texture.width;
+	const uint8_t* row1 = texture.pixels + y.i1 * texture.width;
+	const uint32_t top    = row0[x.i0] * (256 - x.t) + row0[x.i1] * x.t;
+	const uint32_t bottom = row1[x.i0] * (256 - x.t) + row1[x.i1] * x.t;
+	return static_cast<uint8_t>((top * (256 - y.t) + bottom * y.t + (1u << 15)) >> 16);
+}
+
+// Maps distance field values to coverage when a texel is pixels_per_texel pixels big:
+// 128 is on the outline, and the pixels within half a pixel of it get partly covered.
+// All glyphs of a font share a scale, so the last table is kept (per painting thread).
+inline const uint8_t* distance_field_coverage(const Texture& texture, float pixels_per_texel)
+{
+	thread_local float   table_pixels_per_texel = -1.0f;
+	thread_local int     table_spread = 0;
+	thread_local uint8_t table[256];
+
+	if (pixels_per_texel != table_pixels_per_texel || texture.sdf_spread != table_spread) {
+		const float pixels_per_step = pixels_per_texel * texture.sdf_spread / 128.0f;
+		for (int i = 0; i < 256; ++i) {
+			const float coverage = std::min(std::max((i - 128) * pixels_per_step + 0.5f, 0.0f), 1.0f);
+			table[i] = static_cast<uint8_t>(coverage * 255.0f + 0.5f);
+		}
+		table_pixels_per_texel = pixels_per_texel;
+		table_spread = texture.sdf_spread;
+	}
+	return table;
+}
+
+// How many pixels a texel covers when uv moves by uv_dx / uv_dy per pixel (averaged over both directions).
+inline float pixels_per_texel(const Texture& texture, const ImVec2& uv_dx, const ImVec2& uv_dy)
+{
+	const ImVec2 texels_x = ImVec2(uv_dx.x * texture.width, uv_dx.y * texture.height);
+	const ImVec2 texels_y = ImVec2(uv_dy.x * texture.width, uv_dy.y * texture.height);
+	const float texels_dx = std::sqrt(texels_x.x * texels_x.x + texels_x.y * texels_x.y);
+	const float texels_dy = std::sqrt(texels_y.x * texels_y.x + texels_y.y * texels_y.y);
+	const float texels_per_pixel = 0.5f * (texels_dx + texels_dy);
+	return texels_per_pixel > 0.0f ? 1.0f / texels_per_pixel : 1e6f;
+}
+
+inline ColorInt modulate(const ColorInt& a, const ColorInt& b)
+{
+	ColorInt result;
+	result.a = a.a * b.a / 255;
+	result.b = a.b * b.b / 255;
+	result.g = a.g * b.g / 255;
+	result.r = a.r * b.r / 255;
+	return result;
+}
+
 void paint_uniform_rectangle(
 	const PaintTarget& target,
 	const ImVec2&      min_f,
@@ -282,29 +827,17 @@ void paint_uniform_rectangle(
 	int max_x_i = static_cast<int>(target.scale.x * max_f.x + 0.5f);
 	int max_y_i = static_cast<int>(target.scale.y * max_f.y + 0.5f);
 
-	// Clamp to render target:
-	min_x_i = std::max(min_x_i, 0);
-	min_y_i = std::max(min_y_i, 0);
-	max_x_i = std::min(max_x_i, target.width);
-	max_y_i = std::min(max_y_i, target.height);
+	// Clamp to render target (or tile):
+	min_x_i = std::max(min_x_i, target.min_x);
+	min_y_i = std::max(min_y_i, target.min_y);
+	max_x_i = std::min(max_x_i, target.max_x);
+	max_y_i = std::min(max_y_i, target.max_y);
+	if (min_x_i >= max_x_i || min_y_i >= max_y_i) { return; }
 
 	stats->uniform_rectangle_pixels += (max_x_i - min_x_i) * (max_y_i - min_y_i);
 
-	// We often blend the same colors over and over again, so optimize for this (saves 25% total cpu):
-	uint32_t last_target_pixel = target.pixels[min_y_i * target.width + min_x_i];
-	uint32_t last_output = blend(ColorInt(last_target_pixel), color).toUint32();
-
 	for (int y = min_y_i; y < max_y_i; ++y) {
-		for (int x = min_x_i; x < max_x_i; ++x) {
-			uint32_t& target_pixel = target.pixels[y * target.width + x];
-			if (target_pixel == last_target_pixel) {
-				target_pixel = last_output;
-				continue;
-			}
-			last_target_pixel = target_pixel;
-			target_pixel = blend(ColorInt(target_pixel), color).toUint32();
-			last_output = target_pixel;
-		}
+		target.kernels->blend_uniform_span(target.at(min_x_i, y), max_x_i - min_x_i, color);
 	}
 }
 
@@ -343,7 +876,19 @@ void paint_uniform_textured_rectangle(
 	max_x_i = std::min(max_x_i, target.width);
 	max_y_i = std::min(max_y_i, target.height);
 
-	stats->font_pixels += (max_x_i - min_x_i) * (max_y_i - min_y_i);
+	// The part inside our tile. The uv:s are still stepped from the bounding box corner,
+	// so a tile gets exactly the same values as painting the whole thing at once.
+	const int begin_x = std::max(min_x_i, target.min_x);
+	const int begin_y = std::max(min_y_i, target.min_y);
+	const int end_x = std::min(max_x_i, target.max_x);
+	const int end_y = std::min(max_y_i, target.max_y);
+	if (begin_x >= end_x || begin_y >= end_y) { return; }
+
+	if (texture.rgba) {
+		stats->image_pixels += (end_x - begin_x) * (end_y - begin_y);
+	} else {
+		stats->font_pixels += (end_x - begin_x) * (end_y - begin_y);
+	}
 
 	const auto topleft = ImVec2(min_x_i + 0.5f * target.scale.x,
 	                            min_y_i + 0.5f * target.scale.y);
@@ -357,24 +902,88 @@ void paint_uniform_textured_rectangle(
 		min_v.uv.y + (topleft.y - min_v.pos.y) * delta_uv_per_pixel.y,
 	};
 	ImVec2 current_uv = uv_topleft;
+	for (int x = min_x_i; x < begin_x; ++x) { current_uv.x += delta_uv_per_pixel.x; }
+	for (int y = min_y_i; y < begin_y; ++y) { current_uv.y += delta_uv_per_pixel.y; }
+	const float row_start_uv_x = current_uv.x;
+
+	if (texture.rgba) {
+		// Sprites, icons and the like: the texel is the color, tinted by the vertex color.
+		// Texel columns are worked out once per chunk of columns instead of once per pixel.
+		const uint32_t* texels = reinterpret_cast<const uint32_t*>(texture.pixels);
+		const bool nearest = texture.filter == TextureFilter::Nearest;
+		const ColorInt tint = ColorInt(min_v.col);
+		const bool is_white = min_v.col == IM_COL32_WHITE;
+
+		const int kChunkSize = 64;
+		TexelPair columns[kChunkSize];
+
+		for (int chunk_x = begin_x; chunk_x < end_x; chunk_x += kChunkSize) {
+			const int count = std::min(kChunkSize, end_x - chunk_x);
+			for (int i = 0; i < count; ++i, current_uv.x += delta_uv_per_pixel.x) {
+				columns[i] = texel_pair(current_uv.x, texture.width, texture.filter);
+			}
 
-	for (int y = min_y_i; y < max_y_i; ++y, current_uv.y += delta_uv_per_pixel.y) {
-		current_uv.x = uv_topleft.x;
-		for (int x = min_x_i; x < max_x_i; ++x, current_uv.x += delta_uv_per_pixel.x) {
-			uint32_t& target_pixel = target.pixels[y * target.width + x];
-			const uint8_t texel = sample_texture(texture, current_uv);
+			float row_uv_y = current_uv.y;
+			for (int y = begin_y; y < end_y; ++y, row_uv_y += delta_uv_per_pixel.y) {
+				const TexelPair texel_row = texel_pair(row_uv_y, texture.height, texture.filter);
+				const uint32_t* row0 = texels + texel_row.i0 * texture.width;
+				const uint32_t* row1 = texels + texel_row.i1 * texture.width;
+				uint32_t* row = target.at(chunk_x, y);
+
+				for (int i = 0; i < count; ++i) {
+					const uint32_t texel = nearest ? row0[columns[i].i0] : sample_texels(row0, row1, columns[i], texel_row.t);
+					if (is_white && (texel >> IM_COL32_A_SHIFT) == 0xFF) {
+						row[i] = texel; // Opaque, no blending needed.
+						continue;
+					}
+					ColorInt source = ColorInt(texel);
+					if (!is_white) { source = modulate(source, tint); }
+					if (source.a == 0) { continue; } // Transparent.
+					if (source.a == 255) {
+						row[i] = source.toUint32();
+						continue;
+					}
+					row[i] = blend(ColorInt(row[i]), source).toUint32();
+				}
+			}
+		}
+		return;
+	}
 
-			// The font texture is all black or all white, so optimize for this:
-			if (texel == 0) { continue; }
-			if (texel == 255) {
-				target_pixel = min_v.col;
-				continue;
+	// Sample a chunk of texels, then let the span kernel blend them all at once:
+	const int kChunkSize = 64;
+	uint8_t coverage[kChunkSize];
+
+	if (texture.sdf_spread != 0) {
+		// Distance fields get filtered and turned into coverage for the size they're drawn at:
+		const uint8_t* coverage_table = distance_field_coverage(texture,
+			pixels_per_texel(texture, ImVec2(delta_uv_per_pixel.x, 0.0f), ImVec2(0.0f, delta_uv_per_pixel.y)));
+
+		for (int y = begin_y; y < end_y; ++y, current_uv.y += delta_uv_per_pixel.y) {
+			current_uv.x = row_start_uv_x;
+			for (int x = begin_x; x < end_x; ) {
+				const int chunk_end = std::min(x + kChunkSize, end_x);
+				int count = 0;
+				for (int cx = x; cx < chunk_end; ++cx, current_uv.x += delta_uv_per_pixel.x) {
+					coverage[count++] = coverage_table[sample_texture_bilinear(texture, current_uv)];
+				}
+				target.kernels->blend_coverage_span(target.at(x, y), coverage, count, min_v.col);
+				x = chunk_end;
 			}
+		}
+		return;
+	}
 
-			// Other textured rectangles
-			ColorInt source_color = ColorInt(min_v.col);
-			source_color.a = source_color.a * texel / 255;
-			target_pixel = blend(ColorInt(target_pixel), source_color).toUint32();
+	for (int y = begin_y; y < end_y; ++y, current_uv.y += delta_uv_per_pixel.y) {
+		current_uv.x = row_start_uv_x;
+		for (int x = begin_x; x < end_x; ) {
+			const int chunk_end = std::min(x + kChunkSize, end_x);
+			int count = 0;
+			for (int cx = x; cx < chunk_end; ++cx, current_uv.x += delta_uv_per_pixel.x) {
+				coverage[count++] = sample_texture(texture, current_uv);
+			}
+			target.kernels->blend_coverage_span(target.at(x, y), coverage, count, min_v.col);
+			x = chunk_end;
 		}
 	}
 }
@@ -460,7 +1069,16 @@ void paint_triangle(
 	const Barycentric bary_dx      = inv_area * (w0_dx      * bary_0 + w1_dx      * bary_1 + w2_dx      * bary_2);
 	const Barycentric bary_dy      = inv_area * (w0_dy      * bary_0 + w1_dy      * bary_1 + w2_dy      * bary_2);
 
+	// Only paint the part inside our tile, but step the interpolation from the bounding box corner
+	// so the float rounding is exactly the same as when painting the whole triangle at once:
+	const int begin_x = std::max(min_x_i, target.min_x);
+	const int begin_y = std::max(min_y_i, target.min_y);
+	const int end_x = std::min(max_x_i, target.max_x);
+	const int end_y = std::min(max_y_i, target.max_y);
+	if (begin_x >= end_x || begin_y >= end_y) { return; }
+
 	Barycentric bary_current_row = bary_topleft;
+	for (int y = min_y_i; y < begin_y; ++y) { bary_current_row += bary_dy; }
 
 	// ------------------------------------------------------------------------
 	// For pixel-perfect inside/outside testing:
@@ -475,6 +1093,22 @@ void paint_triangle(
 	const auto p1i = as_point(p1);
 	const auto p2i = as_point(p2);
 
+	// The edge functions are linear, so step them per pixel instead of evaluating them.
+	// Everything is integer, so this is exact.
+	const auto p_topleft = Point{kFixedBias * begin_x + kFixedBias / 2, kFixedBias * begin_y + kFixedBias / 2};
+
+	Int w0i_row = sign * orient2d(p1i, p2i, p_topleft) + bias0i;
+	Int w1i_row = sign * orient2d(p2i, p0i, p_topleft) + bias1i;
+	Int w2i_row = sign * orient2d(p0i, p1i, p_topleft) + bias2i;
+
+	const Int w0i_dx = -sign * (p2i.y - p1i.y) * kFixedBias;
+	const Int w1i_dx = -sign * (p0i.y - p2i.y) * kFixedBias;
+	const Int w2i_dx = -sign * (p1i.y - p0i.y) * kFixedBias;
+
+	const Int w0i_dy = sign * (p2i.x - p1i.x) * kFixedBias;
+	const Int w1i_dy = sign * (p0i.x - p2i.x) * kFixedBias;
+	const Int w2i_dy = sign * (p1i.x - p0i.x) * kFixedBias;
+
 	// ------------------------------------------------------------------------
 
 	const bool has_uniform_color = (v0.col == v1.col && v0.col == v2.col);
@@ -483,50 +1117,55 @@ void paint_triangle(
 	const ImVec4 c1 = color_convert_u32_to_float4(v1.col);
 	const ImVec4 c2 = color_convert_u32_to_float4(v2.col);
 
-	// We often blend the same colors over and over again, so optimize for this (saves 10% total cpu):
-	uint32_t last_target_pixel = 0;
-	uint32_t last_output = blend(ColorInt(last_target_pixel), ColorInt(v0.col)).toUint32();
+	// The uv:s change linearly, so a distance field texel is the same size everywhere in the triangle:
+	const uint8_t* coverage_table = nullptr;
+	if (texture && texture->sdf_spread != 0) {
+		const ImVec2 uv_dx = bary_dx.w0 * ImVec2{v0.uv.x, v0.uv.y} + bary_dx.w1 * ImVec2{v1.uv.x, v1.uv.y} + bary_dx.w2 * ImVec2{v2.uv.x, v2.uv.y};
+		const ImVec2 uv_dy = bary_dy.w0 * ImVec2{v0.uv.x, v0.uv.y} + bary_dy.w1 * ImVec2{v1.uv.x, v1.uv.y} + bary_dy.w2 * ImVec2{v2.uv.x, v2.uv.y};
+		coverage_table = distance_field_coverage(*texture, pixels_per_texel(*texture, uv_dx, uv_dy));
+	}
+
+	for (int y = begin_y; y < end_y; ++y, w0i_row += w0i_dy, w1i_row += w1i_dy, w2i_row += w2i_dy) {
+		auto w0i = w0i_row;
+		auto w1i = w1i_row;
+		auto w2i = w2i_row;
+
+		if (has_uniform_color && !texture) {
+			// The inside pixels of a row are one span, so find it and blend it in one go:
+			int x = begin_x;
+			for (; x < end_x && (w0i < 0 || w1i < 0 || w2i < 0); ++x, w0i += w0i_dx, w1i += w1i_dx, w2i += w2i_dx) {}
+			const int span_begin = x;
+			for (; x < end_x && w0i >= 0 && w1i >= 0 && w2i >= 0; ++x, w0i += w0i_dx, w1i += w1i_dx, w2i += w2i_dx) {}
+
+			stats->uniform_triangle_pixels += x - span_begin;
+			target.kernels->blend_uniform_span(target.at(span_begin, y), x - span_begin, ColorInt(v0.col));
+
+			bary_current_row += bary_dy;
+			continue;
+		}
 
-	for (int y = min_y_i; y < max_y_i; ++y) {
 		auto bary = bary_current_row;
+		for (int x = min_x_i; x < begin_x; ++x) { bary += bary_dx; }
 
 		bool has_been_inside_this_row = false;
 
-		for (int x = min_x_i; x < max_x_i; ++x) {
+		for (int x = begin_x; x < end_x; ++x, w0i += w0i_dx, w1i += w1i_dx, w2i += w2i_dx) {
 			const auto w0 = bary.w0;
 			const auto w1 = bary.w1;
 			const auto w2 = bary.w2;
 			bary += bary_dx;
 
-			{
-				// Inside/outside test:
-				const auto p = Point{kFixedBias * x + kFixedBias / 2, kFixedBias * y + kFixedBias / 2};
-				const auto w0i = sign * orient2d(p1i, p2i, p) + bias0i;
-				const auto w1i = sign * orient2d(p2i, p0i, p) + bias1i;
-				const auto w2i = sign * orient2d(p0i, p1i, p) + bias2i;
-				if (w0i < 0 || w1i < 0 || w2i < 0) {
-					if (has_been_inside_this_row) {
-						break; // Gives a nice 10% speedup
-					} else {
-						continue;
-					}
+			// Inside/outside test:
+			if (w0i < 0 || w1i < 0 || w2i < 0) {
+				if (has_been_inside_this_row) {
+					break; // Gives a nice 10% speedup
+				} else {
+					continue;
 				}
 			}
 			has_been_inside_this_row = true;
 
-			uint32_t& target_pixel = target.pixels[y * target.width + x];
-
-			if (has_uniform_color && !texture) {
-				stats->uniform_triangle_pixels += 1;
-				if (target_pixel == last_target_pixel) {
-					target_pixel = last_output;
-					continue;
-				}
-				last_target_pixel = target_pixel;
-				target_pixel = blend(ColorInt(target_pixel), ColorInt(v0.col)).toUint32();
-				last_output = target_pixel;
-				continue;
-			}
+			uint32_t& target_pixel = *target.at(x, y);
 
 			ImVec4 src_color;
 
@@ -540,7 +1179,14 @@ void paint_triangle(
 			if (texture) {
 				stats->textured_triangle_pixels += 1;
 				const ImVec2 uv = w0 * ImVec2{v0.uv.x, v0.uv.y} + w1 * ImVec2{v1.uv.x, v1.uv.y} + w2 * ImVec2{v2.uv.x, v2.uv.y};
-				src_color.w *= sample_texture(*texture, uv) / 255.0f;
+				if (texture->rgba) {
+					const ImVec4 texel = color_convert_u32_to_float4(sample_texture_rgba(*texture, uv));
+					src_color = ImVec4(src_color.x * texel.x, src_color.y * texel.y, src_color.z * texel.z, src_color.w * texel.w);
+				} else if (coverage_table) {
+					src_color.w *= coverage_table[sample_texture_bilinear(*texture, uv)] / 255.0f;
+				} else {
+					src_color.w *= sample_texture(*texture, uv) / 255.0f;
+				}
 			}
 
 			if (src_color.w <= 0.0f) { continue; } // Transparent.
@@ -559,19 +1205,87 @@ void paint_triangle(
 	}
 }
 
-void paint_draw_cmd(
+// Something paint_draw_cmd has decided how to paint.
+// They are collected before painting so they can be binned into tiles.
+struct Primitive
+{
+	enum class Type : uint8_t { UniformRectangle, TexturedRectangle, Triangle };
+
+	Type              type;
+	const Texture*    texture;   // nullptr for untextured triangles.
+	ImVec4            clip_rect;
+	const ImDrawVert* v0;
+	const ImDrawVert* v1;        // The opposite corner for TexturedRectangle.
+	const ImDrawVert* v2;
+	ImVec2            min;       // Clipped corners in points, for UniformRectangle.
+	ImVec2            max;
+	int               min_x;     // Conservative pixel bounds [min, max), for binning.
+	int               min_y;
+	int               max_x;
+	int               max_y;
+};
+
+Primitive make_primitive(
 	const PaintTarget& target,
-	const ImDrawVert*  vertices,
-	const ImDrawIdx*   idx_buffer,
-	const ImDrawCmd&   pcmd,
-	const SwOptions&   options,
-	Stats*             stats)
+	Primitive::Type    type,
+	const Texture*     texture,
+	const ImVec4&      clip_rect,
+	const ImDrawVert&  v0,
+	const ImDrawVert&  v1,
+	const ImDrawVert&  v2)
+{
+	Primitive primitive;
+	primitive.type = type;
+	primitive.texture = texture;
+	primitive.clip_rect = clip_rect;
+	primitive.v0 = &v0;
+	primitive.v1 = &v1;
+	primitive.v2 = &v2;
+
+	// A pixel of slack on each side, the painting functions do the exact clipping:
+	const float min_x_f = std::max(min3(v0.pos.x, v1.pos.x, v2.pos.x), clip_rect.x);
+	const float min_y_f = std::max(min3(v0.pos.y, v1.pos.y, v2.pos.y), clip_rect.y);
+	const float max_x_f = std::min(max3(v0.pos.x, v1.pos.x, v2.pos.x), clip_rect.z);
+	const float max_y_f = std::min(max3(v0.pos.y, v1.pos.y, v2.pos.y), clip_rect.w);
+	primitive.min_x = std::max(static_cast<int>(std::floor(target.scale.x * min_x_f)) - 1, 0);
+	primitive.min_y = std::max(static_cast<int>(std::floor(target.scale.y * min_y_f)) - 1, 0);
+	primitive.max_x = std::min(static_cast<int>(std::ceil(target.scale.x * max_x_f)) + 1, target.width);
+	primitive.max_y = std::min(static_cast<int>(std::ceil(target.scale.y * max_y_f)) + 1, target.height);
+	return primitive;
+}
+
+void paint_primitive(const PaintTarget& target, const Primitive& primitive, Stats* stats)
+{
+	switch (primitive.type) {
+		case Primitive::Type::UniformRectangle:
+			paint_uniform_rectangle(target, primitive.min, primitive.max, ColorInt(primitive.v0->col), stats);
+			break;
+		case Primitive::Type::TexturedRectangle:
+			paint_uniform_textured_rectangle(target, *primitive.texture, primitive.clip_rect, *primitive.v0, *primitive.v1, stats);
+			break;
+		case Primitive::Type::Triangle:
+			paint_triangle(target, primitive.texture, primitive.clip_rect, *primitive.v0, *primitive.v1, *primitive.v2, stats);
+			break;
+	}
+}
+
+void paint_draw_cmd(
+	const PaintTarget&      target,
+	const ImDrawVert*       vertices,
+	const ImDrawIdx*        idx_buffer,
+	const ImDrawCmd&        pcmd,
+	const SwOptions&        options,
+	Stats*                  stats,
+	std::vector<Primitive>* primitives)
 {
 	const auto texture = reinterpret_cast<const Texture*>(pcmd.TextureId);
 	assert(texture);
 
-	// ImGui uses the first pixel for "white".
+	// ImGui uses the first pixel of the font texture for "white". Other textures are always sampled.
 	const ImVec2 white_uv = ImVec2(0.5f / texture->width, 0.5f / texture->height);
+	const bool always_textured = texture->rgba;
+
+	const ImVec4 clip_rect = ImVec4{pcmd.ClipRect.x, pcmd.ClipRect.y, pcmd.ClipRect.z, pcmd.ClipRect.w};
 
 	for (unsigned int i = 0; i + 3 <= pcmd.ElemCount; ) {
 		const ImDrawVert& v0 = vertices[idx_buffer[i + 0]];
@@ -598,7 +1312,7 @@ void paint_draw_cmd(
 					v0.col == v2.col &&
 					v0.col == v3.col;
 
-				const bool has_texture =
+				const bool has_texture = always_textured ||
 					ImVec2{v0.uv.x, v0.uv.y} != white_uv ||
 					ImVec2{v1.uv.x, v1.uv.y} != white_uv ||
 					ImVec2{v2.uv.x, v2.uv.y} != white_uv ||
@@ -606,7 +1320,7 @@ void paint_draw_cmd(
 
 				if (has_uniform_color && has_texture)
 				{
-					paint_uniform_textured_rectangle(target, *texture, ImVec4{pcmd.ClipRect.x, pcmd.ClipRect.y, pcmd.ClipRect.z, pcmd.ClipRect.w}, v0, v2, stats);
+					primitives->push_back(make_primitive(target, Primitive::Type::TexturedRectangle, texture, clip_rect, v0, v2, v2));
 					i += 6;
 					continue;
 				}
@@ -649,7 +1363,7 @@ void paint_draw_cmd(
 					v0.col == v4.col &&
 					v0.col == v5.col;
 
-				const bool has_texture =
+				const bool has_texture = always_textured ||
 					ImVec2{v0.uv.x, v0.uv.y} != white_uv ||
 					ImVec2{v1.uv.x, v1.uv.y} != white_uv ||
 					ImVec2{v2.uv.x, v2.uv.y} != white_uv ||
@@ -670,7 +1384,10 @@ void paint_draw_cmd(
 					if (has_texture) {
 						stats->textured_rectangle_pixels += num_pixels;
 					} else {
-						paint_uniform_rectangle(target, min, max, ColorInt(v0.col), stats);
+						Primitive primitive = make_primitive(target, Primitive::Type::UniformRectangle, nullptr, clip_rect, v0, v1, v2);
+						primitive.min = min;
+						primitive.max = max;
+						primitives->push_back(primitive);
 						i += 6;
 						continue;
 					}
@@ -686,13 +1403,470 @@ void paint_draw_cmd(
 			}
 		}
 
-		const bool has_texture = (ImVec2{v0.uv.x, v0.uv.y} != white_uv || ImVec2{v1.uv.x, v1.uv.y} != white_uv || ImVec2{v2.uv.x, v2.uv.y} != white_uv);
-		paint_triangle(target, has_texture ? texture : nullptr, ImVec4{pcmd.ClipRect.x, pcmd.ClipRect.y, pcmd.ClipRect.z, pcmd.ClipRect.w}, v0, v1, v2, stats);
+		const bool has_texture = always_textured || (ImVec2{v0.uv.x, v0.uv.y} != white_uv || ImVec2{v1.uv.x, v1.uv.y} != white_uv || ImVec2{v2.uv.x, v2.uv.y} != white_uv);
+		primitives->push_back(make_primitive(target, Primitive::Type::Triangle, has_texture ? texture : nullptr, clip_rect, v0, v1, v2));
 		i += 3;
 	}
 }
 
-void paint_draw_list(const PaintTarget& target, const ImDrawList* cmd_list, const SwOptions& options, Stats* stats)
+// ----------------------------------------------------------------------------
+// Multithreaded painting: the target is split into tiles, each primitive is binned into the tiles
+// it touches, and the tiles are then painted in parallel. Tiles do not overlap and paint their
+// primitives in order, so the result is the same as painting everything on one thread.
+
+void operator+=(Stats& a, const Stats& b)
+{
+	a.uniform_triangle_pixels            += b.uniform_triangle_pixels;
+	a.textured_triangle_pixels           += b.textured_triangle_pixels;
+	a.gradient_triangle_pixels           += b.gradient_triangle_pixels;
+	a.font_pixels                        += b.font_pixels;
+	a.image_pixels                       += b.image_pixels;
+	a.uniform_rectangle_pixels           += b.uniform_rectangle_pixels;
+	a.textured_rectangle_pixels          += b.textured_rectangle_pixels;
+	a.gradient_rectangle_pixels          += b.gradient_rectangle_pixels;
+	a.gradient_textured_rectangle_pixels += b.gradient_textured_rectangle_pixels;
+	a.repainted_tiles                    += b.repainted_tiles;
+	a.total_tiles                        += b.total_tiles;
+}
+
+using TaskFn = std::function<void(int task, Stats* stats)>;
+
+class WorkerPool
+{
+public:
+	~WorkerPool() { stop(); }
+
+	/// Runs job for every task in [0, num_tasks) on num_threads threads, the calling thread included.
+	/// Tasks are handed out through an atomic counter, so nothing is locked while they run.
+	void run(int num_threads, int num_tasks, const TaskFn& job, Stats* stats);
+
+	/// Joins all worker threads. The next run() starts them again.
+	void stop();
+
+private:
+	void worker_main(int worker_index, uint64_t seen_generation);
+	void work(Stats* stats);
+
+	std::vector<std::thread> threads;
+	std::vector<Stats>       worker_stats;
+	std::mutex               mutex;
+	std::condition_variable  wake_condition;
+	std::condition_variable  done_condition;
+	uint64_t                 generation  = 0;
+	int                      num_working = 0;
+	bool                     quit        = false;
+
+	const TaskFn*            job       = nullptr;
+	int                      num_tasks = 0;
+	std::atomic<int>         next_task{0};
+};
+
+void WorkerPool::run(int num_threads, int num_tasks, const TaskFn& job, Stats* stats)
+{
+	const int num_workers = num_threads - 1;
+	if (static_cast<int>(threads.size()) != num_workers) {
+		stop();
+		quit = false;
+		worker_stats.assign(num_workers, Stats{});
+		for (int i = 0; i < num_workers; ++i) {
+			threads.emplace_back(&WorkerPool::worker_main, this, i, generation);
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->job = &job;
+		this->num_tasks = num_tasks;
+		next_task = 0;
+		for (auto& worker_stat : worker_stats) { worker_stat = Stats{}; }
+		num_working = num_workers;
+		++generation;
+	}
+	wake_condition.notify_all();
+
+	work(stats);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done_condition.wait(lock, [this] { return num_working == 0; });
+	for (const auto& worker_stat : worker_stats) { *stats += worker_stat; }
+}
+
+void WorkerPool::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	wake_condition.notify_all();
+	for (auto& thread : threads) { thread.join(); }
+	threads.clear();
+}
+
+void WorkerPool::worker_main(int worker_index, uint64_t seen_generation)
+{
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake_condition.wait(lock, [&] { return quit || generation != seen_generation; });
+			if (quit) { return; }
+			seen_generation = generation;
+		}
+
+		work(&worker_stats[worker_index]);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			--num_working;
+		}
+		done_condition.notify_one();
+	}
+}
+
+void WorkerPool::work(Stats* stats)
+{
+	for (int task = next_task++; task < num_tasks; task = next_task++) {
+		(*job)(task, stats);
+	}
+}
+
+// ----------------------------------------------------------------------------
+// Damage tracking: every tile gets a hash of the primitives binned into it. A tile whose hash
+// is the same as in the previous frame will come out the same, so it does not need repainting.
+
+uint64_t hash_bytes(uint64_t hash, const void* data, size_t size)
+{
+	// FNV-1a
+	const auto bytes = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i) {
+		hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+const uint64_t kHashSeed = 0xcbf29ce484222325ull;
+
+uint64_t hash_primitive(const Primitive& primitive)
+{
+	uint64_t hash = kHashSeed;
+	hash = hash_bytes(hash, &primitive.type, sizeof(primitive.type));
+	hash = hash_bytes(hash, &primitive.texture, sizeof(primitive.texture));
+	if (primitive.texture) {
+		hash = hash_bytes(hash, &primitive.texture->pixels, sizeof(primitive.texture->pixels));
+		hash = hash_bytes(hash, &primitive.texture->version, sizeof(primitive.texture->version));
+	}
+	hash = hash_bytes(hash, &primitive.clip_rect, sizeof(primitive.clip_rect));
+	hash = hash_bytes(hash, primitive.v0, sizeof(ImDrawVert));
+	hash = hash_bytes(hash, primitive.v1, sizeof(ImDrawVert));
+	hash = hash_bytes(hash, primitive.v2, sizeof(ImDrawVert));
+	hash = hash_bytes(hash, &primitive.min, sizeof(primitive.min));
+	hash = hash_bytes(hash, &primitive.max, sizeof(primitive.max));
+	return hash;
+}
+
+/// Collects the primitives of a frame and paints them, binned into tiles when using more than
+/// one thread or when only the changed tiles should be repainted.
+class TilePainter
+{
+public:
+	std::vector<Primitive> primitives;
+
+	/// Paints and clears primitives.
+	void flush(const PaintTarget& target, const SwOptions& options, Stats* stats);
+
+	/// Like flush, but only clears (to clear_color) and repaints the tiles that changed since the last call.
+	/// Changed areas are written to damage.
+	void flush_changed(const PaintTarget& target, const SwOptions& options, uint32_t clear_color, std::vector<DamageRect>* damage, Stats* stats);
+
+	/// Clears every tile to clear_color and paints it in a small 32-bit buffer of its own,
+	/// then converts it to RGB565 in out (target.pixels is not used). One thread paints
+	/// full-width bands of rows instead, without binning.
+	void flush_rgb565(const PaintTarget& target, const SwOptions& options, uint32_t clear_color, uint16_t* out, Stats* stats);
+
+	/// Makes the next flush_changed repaint everything.
+	void forget_previous_frame() { previous_frame_hash = 0; }
+
+	void stop() { pool.stop(); }
+
+private:
+	void bin_primitives(const PaintTarget& target, const SwOptions& options);
+	void paint_tiles(const PaintTarget& target, const SwOptions& options, const uint32_t* clear_color, Stats* stats);
+	void flush_rgb565_bands(const PaintTarget& target, const SwOptions& options, uint32_t clear_color, uint16_t* out, Stats* stats);
+	void copy_clear_rgb565(const PaintTarget& target, uint16_t* out, int x, int y, int count) const
+	{
+		std::copy_n(&clear_rows_rgb565[(y & 3) * target.width + x], count, &out[y * target.width + x]);
+	}
+
+	WorkerPool                         pool;
+	int                                tile_size = 0;
+	int                                tiles_x = 0;
+	int                                tiles_y = 0;
+	std::vector<std::vector<uint32_t>> bins;  // Indices into primitives for each tile, in painting order.
+	std::vector<int>                   tiles_to_paint;
+	std::vector<uint16_t>              clear_rows_rgb565; // clear_color converted, one row per row of the dither matrix.
+	std::vector<std::pair<int, int>>   band_spans;        // Columns [first, second) a band's primitives reach.
+
+	uint64_t                           previous_frame_hash = 0; // Buffer, size, scale and options of the last flush_changed.
+	std::vector<uint64_t>              previous_tile_hashes;
+	std::vector<uint64_t>              primitive_hashes;
+};
+
+void TilePainter::bin_primitives(const PaintTarget& target, const SwOptions& options)
+{
+	tile_size = std::max(options.tile_size, 16);
+	tiles_x = (target.width + tile_size - 1) / tile_size;
+	tiles_y = (target.height + tile_size - 1) / tile_size;
+
+	bins.resize(tiles_x * tiles_y);
+	for (auto& bin : bins) { bin.clear(); }
+
+	for (uint32_t i = 0; i < primitives.size(); ++i) {
+		const Primitive& primitive = primitives[i];
+		if (primitive.min_x >= primitive.max_x || primitive.min_y >= primitive.max_y) { continue; }
+
+		for (int tile_y = primitive.min_y / tile_size; tile_y <= (primitive.max_y - 1) / tile_size; ++tile_y) {
+			for (int tile_x = primitive.min_x / tile_size; tile_x <= (primitive.max_x - 1) / tile_size; ++tile_x) {
+				bins[tile_y * tiles_x + tile_x].push_back(i);
+			}
+		}
+	}
+}
+
+void TilePainter::paint_tiles(const PaintTarget& target, const SwOptions& options, const uint32_t* clear_color, Stats* stats)
+{
+	const TaskFn paint_tile = [&](int task, Stats* tile_stats) {
+		const int tile = tiles_to_paint[task];
+
+		PaintTarget tile_target = target;
+		tile_target.min_x = (tile % tiles_x) * tile_size;
+		tile_target.min_y = (tile / tiles_x) * tile_size;
+		tile_target.max_x = std::min(tile_target.min_x + tile_size, target.width);
+		tile_target.max_y = std::min(tile_target.min_y + tile_size, target.height);
+
+		if (clear_color) {
+			for (int y = tile_target.min_y; y < tile_target.max_y; ++y) {
+				std::fill_n(target.at(tile_target.min_x, y), tile_target.max_x - tile_target.min_x, *clear_color);
+			}
+		}
+
+		for (const uint32_t index : bins[tile]) {
+			paint_primitive(tile_target, primitives[index], tile_stats);
+		}
+	};
+	pool.run(std::max(options.num_threads, 1), static_cast<int>(tiles_to_paint.size()), paint_tile, stats);
+}
+
+void TilePainter::flush(const PaintTarget& target, const SwOptions& options, Stats* stats)
+{
+	if (options.num_threads <= 1) {
+		for (const auto& primitive : primitives) {
+			paint_primitive(target, primitive, stats);
+		}
+		primitives.clear();
+		return;
+	}
+
+	bin_primitives(target, options);
+
+	tiles_to_paint.resize(tiles_x * tiles_y);
+	for (int tile = 0; tile < tiles_x * tiles_y; ++tile) { tiles_to_paint[tile] = tile; }
+
+	paint_tiles(target, options, nullptr, stats);
+
+	primitives.clear();
+}
+
+void TilePainter::flush_rgb565(const PaintTarget& target, const SwOptions& options, uint32_t clear_color, uint16_t* out, Stats* stats)
+{
+	// Pixels no primitive reaches stay clear_color, which converts to the same pixels in every
+	// row of the dither matrix, so those get copied instead of cleared, painted and converted:
+	const std::vector<uint32_t> clear_row(target.width, clear_color);
+	clear_rows_rgb565.resize(4 * target.width);
+	for (int y = 0; y < 4; ++y) {
+		target.kernels->convert_span_rgb565(clear_row.data(), &clear_rows_rgb565[y * target.width], target.width, 0, y, options.dither);
+	}
+
+	if (options.num_threads <= 1) {
+		flush_rgb565_bands(target, options, clear_color, out, stats);
+		return;
+	}
+
+	bin_primitives(target, options);
+
+	const TaskFn paint_tile = [&](int tile, Stats* tile_stats) {
+		thread_local std::vector<uint32_t> tile_pixels;
+		tile_pixels.resize(tile_size * tile_size);
+
+		PaintTarget tile_target = target;
+		tile_target.min_x = (tile % tiles_x) * tile_size;
+		tile_target.min_y = (tile / tiles_x) * tile_size;
+		tile_target.max_x = std::min(tile_target.min_x + tile_size, target.width);
+		tile_target.max_y = std::min(tile_target.min_y + tile_size, target.height);
+		tile_target.pixels = tile_pixels.data();
+		tile_target.stride = tile_target.max_x - tile_target.min_x;
+		tile_target.origin_x = tile_target.min_x;
+		tile_target.origin_y = tile_target.min_y;
+
+		if (bins[tile].empty()) {
+			for (int y = tile_target.min_y; y < tile_target.max_y; ++y) {
+				copy_clear_rgb565(target, out, tile_target.min_x, y, tile_target.stride);
+			}
+			return;
+		}
+
+		std::fill_n(tile_pixels.data(), tile_size * tile_size, clear_color);
+		for (const uint32_t index : bins[tile]) {
+			paint_primitive(tile_target, primitives[index], tile_stats);
+		}
+
+		for (int y = tile_target.min_y; y < tile_target.max_y; ++y) {
+			target.kernels->convert_span_rgb565(tile_target.at(tile_target.min_x, y), &out[y * target.width + tile_target.min_x],
+			                                    tile_target.stride, tile_target.min_x, y, options.dither);
+		}
+	};
+	pool.run(std::max(options.num_threads, 1), tiles_x * tiles_y, paint_tile, stats);
+
+	primitives.clear();
+}
+
+/// Binning would be overhead on a single thread, but a whole 32-bit frame would not stay in cache.
+/// So the rows are painted in bands, only where the band's primitives reach, and every
+/// primitive gets painted in each band it reaches into.
+void TilePainter::flush_rgb565_bands(const PaintTarget& target, const SwOptions& options, uint32_t clear_color, uint16_t* out, Stats* stats)
+{
+	constexpr int kBandBytes = 128 * 1024;
+	const int band_rows = std::max(kBandBytes / (target.width * static_cast<int>(sizeof(uint32_t))), 1);
+
+	thread_local std::vector<uint32_t> band_pixels;
+	band_pixels.resize(target.width * band_rows);
+
+	PaintTarget band_target = target;
+	band_target.pixels = band_pixels.data();
+	band_target.stride = target.width;
+	band_target.origin_x = 0;
+
+	for (int band_y = 0; band_y < target.height; band_y += band_rows) {
+		band_target.min_y = band_target.origin_y = band_y;
+		band_target.max_y = std::min(band_y + band_rows, target.height);
+
+		const auto reaches_band = [&band_target](const Primitive& primitive) {
+			return primitive.min_x < primitive.max_x && primitive.min_y < band_target.max_y && primitive.max_y > band_target.min_y;
+		};
+
+		// Merge the columns the primitives reach into spans:
+		band_spans.clear();
+		for (const Primitive& primitive : primitives) {
+			if (reaches_band(primitive)) { band_spans.emplace_back(primitive.min_x, primitive.max_x); }
+		}
+		std::sort(band_spans.begin(), band_spans.end());
+		size_t num_spans = 0;
+		for (const auto& span : band_spans) {
+			if (num_spans != 0 && span.first <= band_spans[num_spans - 1].second) {
+				band_spans[num_spans - 1].second = std::max(band_spans[num_spans - 1].second, span.second);
+			} else {
+				band_spans[num_spans++] = span;
+			}
+		}
+		band_spans.resize(num_spans);
+
+		// Copy what stays clear, clear what gets painted:
+		for (int y = band_target.min_y; y < band_target.max_y; ++y) {
+			int x = 0;
+			for (const auto& span : band_spans) {
+				copy_clear_rgb565(target, out, x, y, span.first - x);
+				std::fill_n(band_target.at(span.first, y), span.second - span.first, clear_color);
+				x = span.second;
+			}
+			copy_clear_rgb565(target, out, x, y, target.width - x);
+		}
+
+		for (const Primitive& primitive : primitives) {
+			if (reaches_band(primitive)) { paint_primitive(band_target, primitive, stats); }
+		}
+
+		for (int y = band_target.min_y; y < band_target.max_y; ++y) {
+			for (const auto& span : band_spans) {
+				target.kernels->convert_span_rgb565(band_target.at(span.first, y), &out[y * target.width + span.first],
+				                                    span.second - span.first, span.first, y, options.dither);
+			}
+		}
+	}
+
+	primitives.clear();
+}
+
+void TilePainter::flush_changed(const PaintTarget& target, const SwOptions& options, uint32_t clear_color, std::vector<DamageRect>* damage, Stats* stats)
+{
+	bin_primitives(target, options);
+
+	// Anything that changes every pixel means the previous frame is of no use:
+	uint64_t frame_hash = kHashSeed;
+	frame_hash = hash_bytes(frame_hash, &target.pixels, sizeof(target.pixels));
+	frame_hash = hash_bytes(frame_hash, &target.width, sizeof(target.width));
+	frame_hash = hash_bytes(frame_hash, &target.height, sizeof(target.height));
+	frame_hash = hash_bytes(frame_hash, &target.scale, sizeof(target.scale));
+	frame_hash = hash_bytes(frame_hash, &tile_size, sizeof(tile_size));
+	frame_hash = hash_bytes(frame_hash, &clear_color, sizeof(clear_color));
+	frame_hash = hash_bytes(frame_hash, &options.optimize_text, sizeof(options.optimize_text));
+	frame_hash = hash_bytes(frame_hash, &options.optimize_rectangles, sizeof(options.optimize_rectangles));
+
+	const bool repaint_all = frame_hash != previous_frame_hash;
+	previous_frame_hash = frame_hash;
+	previous_tile_hashes.resize(tiles_x * tiles_y, 0);
+
+	primitive_hashes.resize(primitives.size());
+	for (size_t i = 0; i < primitives.size(); ++i) {
+		primitive_hashes[i] = hash_primitive(primitives[i]);
+	}
+
+	tiles_to_paint.clear();
+	for (int tile = 0; tile < tiles_x * tiles_y; ++tile) {
+		uint64_t tile_hash = kHashSeed;
+		for (const uint32_t index : bins[tile]) {
+			tile_hash = hash_bytes(tile_hash, &primitive_hashes[index], sizeof(uint64_t));
+		}
+
+		if (repaint_all || tile_hash != previous_tile_hashes[tile]) {
+			tiles_to_paint.push_back(tile);
+		}
+		previous_tile_hashes[tile] = tile_hash;
+	}
+
+	stats->repainted_tiles += static_cast<int>(tiles_to_paint.size());
+	stats->total_tiles += tiles_x * tiles_y;
+
+	paint_tiles(target, options, &clear_color, stats);
+
+	// Merge changed tiles next to each other in a row into one rectangle,
+	// and rectangles spanning the same columns in consecutive rows:
+	damage->clear();
+	for (size_t i = 0; i < tiles_to_paint.size(); ) {
+		const int tile_y = tiles_to_paint[i] / tiles_x;
+		const int first_x = tiles_to_paint[i] % tiles_x;
+		int last_x = first_x;
+		for (++i; i < tiles_to_paint.size() && last_x + 1 < tiles_x && tiles_to_paint[i] == tile_y * tiles_x + last_x + 1; ++i) { ++last_x; }
+
+		DamageRect rect;
+		rect.x = first_x * tile_size;
+		rect.y = tile_y * tile_size;
+		rect.width = std::min((last_x + 1) * tile_size, target.width) - rect.x;
+		rect.height = std::min(rect.y + tile_size, target.height) - rect.y;
+
+		bool merged = false;
+		for (size_t j = 0; j < damage->size(); ++j) {
+			DamageRect& above = (*damage)[j];
+			if (above.x == rect.x && above.width == rect.width && above.y + above.height == rect.y) {
+				above.height += rect.height;
+				merged = true;
+				break;
+			}
+		}
+		if (!merged) { damage->push_back(rect); }
+	}
+
+	primitives.clear();
+}
+
+void paint_draw_list(const PaintTarget& target, const ImDrawList* cmd_list, const SwOptions& options, TilePainter* painter, Stats* stats)
 {
 	const ImDrawIdx* idx_buffer = &cmd_list->IdxBuffer[0];
 	const ImDrawVert* vertices = cmd_list->VtxBuffer.Data;
@@ -701,14 +1875,30 @@ void paint_draw_list(const PaintTarget& target, const ImDrawList* cmd_list, cons
 	{
 		const ImDrawCmd& pcmd = cmd_list->CmdBuffer[cmd_i];
 		if (pcmd.UserCallback) {
+			// The callback may depend on everything before it being painted:
+			painter->flush(target, options, stats);
 			pcmd.UserCallback(cmd_list, &pcmd);
 		} else {
-			paint_draw_cmd(target, vertices, idx_buffer, pcmd, options, stats);
+			paint_draw_cmd(target, vertices, idx_buffer, pcmd, options, stats, &painter->primitives);
 		}
 		idx_buffer += pcmd.ElemCount;
 	}
 }
 
+PaintTarget make_target(uint32_t* pixels, int width_pixels, int height_pixels, const SwOptions& options)
+{
+	const float width_points = ImGui::GetIO().DisplaySize.x;
+	const float height_points = ImGui::GetIO().DisplaySize.y;
+	const ImVec2 scale{width_pixels / width_points, height_pixels / height_points};
+	return PaintTarget{pixels, width_pixels, height_pixels, scale, get_kernels(options),
+	                   0, 0, width_pixels, height_pixels, width_pixels, 0, 0};
+}
+
+double milliseconds_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
 } // namespace
 
 void make_style_fast()
@@ -729,7 +1919,17 @@ void restore_style()
 	style.WindowRounding = default_style.WindowRounding;
 }
 
+static internal::Stats s_stats; // TODO: pass as an argument?
+static internal::TilePainter s_painter;
+static std::unique_ptr<internal::Texture> s_font_texture; // Points into ImGui's font atlas.
+static std::vector<std::unique_ptr<internal::Texture>> s_textures; // From create_texture.
+
 void bind_imgui_painting()
+{
+	rebind_font_texture();
+}
+
+void rebind_font_texture()
 {
 	ImGuiIO& io = ImGui::GetIO();
 
@@ -737,30 +1937,149 @@ void bind_imgui_painting()
 	uint8_t* tex_data;
 	int font_width, font_height;
 	io.Fonts->GetTexDataAsAlpha8(&tex_data, &font_width, &font_height);
-	const auto texture = new internal::Texture{tex_data, font_width, font_height};
-	io.Fonts->TexID = texture;
+	s_font_texture.reset(new internal::Texture(tex_data, font_width, font_height));
+	if (io.Fonts->Flags & ImFontAtlasFlags_SignedDistanceField) { s_font_texture->sdf_spread = io.Fonts->TexSdfSpread; }
+	io.Fonts->TexID = s_font_texture.get();
+	s_painter.forget_previous_frame(); // New glyphs may land at the old texture's address.
 }
 
-static internal::Stats s_stats; // TODO: pass as an argument?
+ImTextureID create_texture(const uint32_t* pixels, int width, int height, TextureFilter filter)
+{
+	assert(pixels && width > 0 && height > 0);
+	std::unique_ptr<internal::Texture> texture(new internal::Texture(nullptr, width, height, true, filter));
+	texture->storage.assign(pixels, pixels + width * height);
+	texture->pixels = reinterpret_cast<const uint8_t*>(texture->storage.data());
+	s_textures.push_back(std::move(texture));
+	return s_textures.back().get();
+}
+
+void update_texture(ImTextureID texture_id, const uint32_t* pixels)
+{
+	const auto texture = reinterpret_cast<internal::Texture*>(texture_id);
+	assert(texture && texture->rgba && pixels);
+	std::copy_n(pixels, texture->storage.size(), texture->storage.begin());
+	++texture->version;
+}
+
+void destroy_texture(ImTextureID texture_id)
+{
+	const auto it = std::find_if(s_textures.begin(), s_textures.end(), [texture_id](const std::unique_ptr<internal::Texture>& texture) {
+		return texture.get() == texture_id;
+	});
+	assert(it != s_textures.end());
+	if (it != s_textures.end()) { s_textures.erase(it); }
+}
 
 void paint_imgui(const ImDrawData* draw_data, uint32_t* pixels, int width_pixels, int height_pixels, const SwOptions& options)
 {
-	const float width_points = ImGui::GetIO().DisplaySize.x;
-	const float height_points = ImGui::GetIO().DisplaySize.y;
-	const internal::ImVec2 scale{width_pixels / width_points, height_pixels / height_points};
-	internal::PaintTarget target{pixels, width_pixels, height_pixels, scale};
+	const auto start = std::chrono::steady_clock::now();
+	const internal::PaintTarget target = internal::make_target(pixels, width_pixels, height_pixels, options);
 
 	s_stats = internal::Stats{};
 	for (int i = 0; i < draw_data->CmdListsCount; ++i) {
-		paint_draw_list(target, draw_data->CmdLists[i], options, &s_stats);
+		paint_draw_list(target, draw_data->CmdLists[i], options, &s_painter, &s_stats);
 	}
+	s_painter.flush(target, options, &s_stats);
+	s_painter.forget_previous_frame(); // We don't know if the caller cleared the buffer first.
+	s_stats.paint_ms = internal::milliseconds_since(start);
+}
+
+const std::vector<DamageRect>& paint_imgui_changes(const ImDrawData* draw_data, uint32_t* pixels, int width_pixels, int height_pixels, uint32_t clear_color, const SwOptions& options)
+{
+	static std::vector<DamageRect> s_damage;
+
+	const auto start = std::chrono::steady_clock::now();
+	const internal::PaintTarget target = internal::make_target(pixels, width_pixels, height_pixels, options);
+
+	// Callbacks may paint anything, so then we have to repaint everything:
+	bool has_callbacks = false;
+	for (int i = 0; i < draw_data->CmdListsCount; ++i) {
+		for (const ImDrawCmd& pcmd : draw_data->CmdLists[i]->CmdBuffer) {
+			has_callbacks |= pcmd.UserCallback != nullptr;
+		}
+	}
+
+	if (has_callbacks) {
+		std::fill_n(pixels, width_pixels * height_pixels, clear_color);
+		paint_imgui(draw_data, pixels, width_pixels, height_pixels, options);
+		s_damage.assign(1, DamageRect{0, 0, width_pixels, height_pixels});
+		return s_damage;
+	}
+
+	s_stats = internal::Stats{};
+	for (int i = 0; i < draw_data->CmdListsCount; ++i) {
+		paint_draw_list(target, draw_data->CmdLists[i], options, &s_painter, &s_stats);
+	}
+	s_painter.flush_changed(target, options, clear_color, &s_damage, &s_stats);
+	s_stats.paint_ms = internal::milliseconds_since(start);
+	return s_damage;
+}
+
+void paint_imgui_rgb565(const ImDrawData* draw_data, uint16_t* pixels, int width_pixels, int height_pixels, uint32_t clear_color, const SwOptions& options)
+{
+	const auto start = std::chrono::steady_clock::now();
+	const internal::PaintTarget target = internal::make_target(nullptr, width_pixels, height_pixels, options);
+
+	s_stats = internal::Stats{};
+	for (int i = 0; i < draw_data->CmdListsCount; ++i) {
+		const ImDrawList* cmd_list = draw_data->CmdLists[i];
+		const ImDrawIdx* idx_buffer = &cmd_list->IdxBuffer[0];
+		for (const ImDrawCmd& pcmd : cmd_list->CmdBuffer) {
+			// There are no 32-bit pixels for callbacks to paint into, so they are skipped.
+			if (!pcmd.UserCallback) {
+				paint_draw_cmd(target, cmd_list->VtxBuffer.Data, idx_buffer, pcmd, options, &s_stats, &s_painter.primitives);
+			}
+			idx_buffer += pcmd.ElemCount;
+		}
+	}
+	s_painter.flush_rgb565(target, options, clear_color, pixels, &s_stats);
+	s_painter.forget_previous_frame(); // Paints over what paint_imgui_changes may have left.
+	s_stats.paint_ms = internal::milliseconds_since(start);
 }
 
 void unbind_imgui_painting()
 {
 	ImGuiIO& io = ImGui::GetIO();
-	delete reinterpret_cast<internal::Texture*>(io.Fonts->TexID);
-	io.Fonts = nullptr;
+	s_font_texture.reset();
+	io.Fonts->TexID = nullptr;
+	s_textures.clear();
+	s_painter.stop();
+}
+
+void upscale(const uint32_t* src, int src_width, int src_height, uint32_t* dst, int dst_width, int dst_height, TextureFilter filter, const SwOptions& options)
+{
+	static std::vector<internal::TexelPair> s_columns;
+	static std::vector<uint32_t> s_blended_row;
+
+	// Which source pixels each column samples is the same for every row:
+	s_columns.resize(dst_width);
+	for (int x = 0; x < dst_width; ++x) {
+		s_columns[x] = internal::texel_pair((x + 0.5f) / dst_width, src_width, filter);
+	}
+	s_blended_row.resize(src_width);
+
+	const internal::Kernels* kernels = internal::get_kernels(options);
+	internal::TexelPair blended = {-1, -1, 0};
+
+	for (int y = 0; y < dst_height; ++y) {
+		// Blend the two source rows first (often shared with the previous row), then sample that row:
+		const internal::TexelPair row = internal::texel_pair((y + 0.5f) / dst_height, src_height, filter);
+		const uint32_t* source_row = src + row.i0 * src_width;
+		if (row.t != 0) {
+			if (row.i0 != blended.i0 || row.i1 != blended.i1 || row.t != blended.t) {
+				kernels->lerp_span(source_row, src + row.i1 * src_width, s_blended_row.data(), src_width, row.t);
+				blended = row;
+			}
+			source_row = s_blended_row.data();
+		}
+
+		uint32_t* out = dst + y * dst_width;
+		if (filter == TextureFilter::Nearest) {
+			for (int x = 0; x < dst_width; ++x) { out[x] = source_row[s_columns[x].i0]; }
+		} else {
+			kernels->sample_row(source_row, s_columns.data(), out, dst_width);
+		}
+	}
 }
 
 bool show_options(SwOptions* io_options)
@@ -769,6 +2088,10 @@ bool show_options(SwOptions* io_options)
 	bool changed = false;
 	changed |= ImGui::Checkbox("optimize_text", &io_options->optimize_text);
 	changed |= ImGui::Checkbox("optimize_rectangles", &io_options->optimize_rectangles);
+	changed |= ImGui::Checkbox("use_simd", &io_options->use_simd);
+	changed |= ImGui::Checkbox("dither", &io_options->dither);
+	changed |= ImGui::SliderInt("num_threads", &io_options->num_threads, 1, static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)));
+	changed |= ImGui::SliderInt("tile_size", &io_options->tile_size, 16, 256);
 	return changed;
 }
 
@@ -778,10 +2101,13 @@ void show_stats()
 	ImGui::Text("textured_triangle_pixels:           %7d",   s_stats.textured_triangle_pixels);
 	ImGui::Text("gradient_triangle_pixels:           %7d",   s_stats.gradient_triangle_pixels);
 	ImGui::Text("font_pixels:                        %7d",   s_stats.font_pixels);
+	ImGui::Text("image_pixels:                       %7d",   s_stats.image_pixels);
 	ImGui::Text("uniform_rectangle_pixels:           %7.0f", s_stats.uniform_rectangle_pixels);
 	ImGui::Text("textured_rectangle_pixels:          %7.0f", s_stats.textured_rectangle_pixels);
 	ImGui::Text("gradient_rectangle_pixels:          %7.0f", s_stats.gradient_rectangle_pixels);
 	ImGui::Text("gradient_textured_rectangle_pixels: %7.0f", s_stats.gradient_textured_rectangle_pixels);
+	ImGui::Text("repainted_tiles:                    %3d/%3d", s_stats.repainted_tiles, s_stats.total_tiles);
+	ImGui::Text("paint_ms:                           %7.2f", s_stats.paint_ms);
 }
 
 } // namespace imgui_sw
@@ -6,18 +6,20 @@
 // WHAT:
 //   This is a software renderer for Dear ImGui.
 //   It is decently fast, but has a lot of room for optimization.
+//   Rectangle, uniform triangle and font spans are blended with SSE2/AVX2 where available,
+//   and the frame can be split into tiles that are painted on a pool of threads.
 //   The goal was to get something fast and decently accurate in not too many lines of code.
 // LIMITATIONS:
 //   * It is not pixel-perfect, but it is good enough for must use cases.
-//   * It does not support painting with any other texture than the default font texture.
+//   * Textures other than the default font texture have to be registered with create_texture.
 #pragma once
 
 #include "../misc/macros.h"
 
-#ifdef NS_IMGUI_SOFTWARE_RENDERING
+#ifdef IMGUI_SOFTWARE_RENDERING
 #include <cstdint>
-
-struct ImDrawData;
+#include <vector>
+#include "imgui.h"
 
 namespace imgui_sw {
 
@@ -25,6 +27,10 @@ struct SwOptions
 {
 	bool optimize_text = true;  // No reason to turn this off.
 	bool optimize_rectangles = true; // No reason to turn this off.
+	bool use_simd = true; // SSE2/AVX2 span kernels when the CPU has them. Same output as the scalar path.
+	int num_threads = 1; // Paint on this many threads (the calling one included). More than 1 paints in tiles, with the same output (tools/replay --threads n times it).
+	int tile_size = 128; // Width and height of a tile in pixels when num_threads > 1, or for paint_imgui_changes.
+	bool dither = true; // Ordered dithering in paint_imgui_rgb565, hides banding in gradients.
 	// TODO: add some options for balancing accuracy and speed?
 };
 
@@ -34,13 +40,59 @@ void make_style_fast();
 /// Call once a the start of your program.
 void bind_imgui_painting();
 
+/// Point imgui_sw at ImGui's font atlas again after it got rebuilt (fonts added or resized, or a new ImGui context).
+/// Textures from create_texture stay valid.
+void rebind_font_texture();
+
 /// The buffer is assumed to follow how ImGui packs pixels, i.e. ABGR by default.
 /// Change with IMGUI_USE_BGRA_PACKED_COLOR.
 /// If width/height differs from ImGui::GetIO().DisplaySize then
 /// the function scales the UI to fit the given pixel buffer.
 void paint_imgui(const ImDrawData* draw_data, uint32_t* pixels, int width_pixels, int height_pixels, const SwOptions& options = {});
 
-/// Free the resources allocated by bind_imgui_painting.
+/// A part of the pixel buffer that was repainted by paint_imgui_changes.
+struct DamageRect
+{
+	int x, y, width, height; // In pixels.
+};
+
+/// Like paint_imgui, but only repaints what changed since the last call.
+/// The buffer must still hold what the last call painted (don't clear it in between),
+/// the changed parts get cleared to clear_color before painting.
+/// Changes are tracked per options.tile_size tile. Returns the repainted rectangles, valid until the next call.
+const std::vector<DamageRect>& paint_imgui_changes(const ImDrawData* draw_data, uint32_t* pixels, int width_pixels, int height_pixels, uint32_t clear_color, const SwOptions& options = {});
+
+/// How a texture from create_texture is sampled.
+enum class TextureFilter
+{
+	Nearest,  // Blocky and fastest. Good for pixel art at integer scales.
+	Bilinear, // Smooth when scaled.
+};
+
+/// Register an RGBA texture to paint with, e.g. through ImGui::Image or ImDrawList::AddImage.
+/// The pixels follow how ImGui packs colors (IM_COL32) and are copied, so the caller may free them.
+/// Axis-aligned quads with a uniform tint (sprites, icons, pre-rendered layers) take a fast path.
+ImTextureID create_texture(const uint32_t* pixels, int width, int height, TextureFilter filter = TextureFilter::Bilinear);
+
+/// Replace the pixels of a texture from create_texture. The size stays the same.
+void update_texture(ImTextureID texture_id, const uint32_t* pixels);
+
+/// Free a texture from create_texture. Textures still alive are freed by unbind_imgui_painting (at shutdown),
+/// rebuilding the font atlas leaves them alone (see rebind_font_texture).
+void destroy_texture(ImTextureID texture_id);
+
+/// Like paint_imgui, but to a 16-bit RGB565 buffer (red in the top bits) for 16-bit display surfaces.
+/// The frame is cleared to clear_color (ImGui packing) first. Each tile (or band of rows on one thread) is
+/// painted in 32 bits in a small buffer that stays in cache, so the 16-bit buffer is only written once per
+/// pixel. Pixels no primitive reaches get the converted clear color copied in. tools/replay --rgb565 times it.
+/// UserCallbacks are skipped, as they can only paint into 32-bit pixels.
+void paint_imgui_rgb565(const ImDrawData* draw_data, uint16_t* pixels, int width_pixels, int height_pixels, uint32_t clear_color, const SwOptions& options = {});
+
+/// Scales a whole pixel buffer to another size, e.g. a frame painted at a lower resolution up to the screen.
+/// Nearest is blocky, but exact for integer scales. Rows are blended with SIMD when options.use_simd is set.
+void upscale(const uint32_t* src, int src_width, int src_height, uint32_t* dst, int dst_width, int dst_height, TextureFilter filter = TextureFilter::Bilinear, const SwOptions& options = {});
+
+/// Free the resources allocated by bind_imgui_painting, and every texture from create_texture.
 void unbind_imgui_painting();
 
 /// Show ImGui controls for rendering options if you want to.
@@ -11,9 +11,53 @@
 #include "imgui_user.h"
 #include "imgui_internal.h"
 #include <cmath>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
 
 uint8_t ImGuiUser::current_modal_popup_id = 0;
 
+namespace
+{
+
+    struct text_size_key_t final
+    {
+
+        const ImFont* font;
+
+        float font_size;
+
+        size_t text_hash;
+
+        bool operator==(const text_size_key_t& other) const { return font == other.font && font_size == other.font_size && text_hash == other.text_hash; }
+
+    };
+
+    struct text_size_key_hash_t final
+    {
+
+        size_t operator()(const text_size_key_t& key) const { return key.text_hash ^ (std::hash<const void*>()(key.font) * 31u) ^ std::hash<float>()(key.font_size); }
+
+    };
+
+    struct text_size_entry_t final
+    {
+
+        // Compared on lookup, so two strings with the same hash can't get each other's size
+        std::string text;
+
+        ImVec2 size;
+
+    };
+
+    // Notifications come and go, so it simply starts over once it's this big
+    const size_t text_size_cache_capacity = 64;
+
+    std::unordered_map<text_size_key_t, text_size_entry_t, text_size_key_hash_t> text_size_cache;
+
+}
+
 /*
 @brief
 
@@ -288,4 +332,49 @@ void ImGuiUser::highlight_first_option_on_appearing(void)
         g.NavDisableHighlight = false;
         g.NavDisableMouseHover = true;
     }
-}
\ No newline at end of file
+}
+
+/*
+@brief
+
+    ImGui::CalcTextSize, but remembers the result for the current font and font size.
+    Only pays off for long text that rarely changes (the pause modals' captions, notifications),
+    a lookup costs about as much as measuring a short or changing text
+*/
+ImVec2 ImGuiUser::calc_text_size(const char* text, const char* text_end/* = nullptr*/)
+{
+    std::string_view view(text, text_end != nullptr ? static_cast<size_t>(text_end - text) : strlen(text));
+
+    text_size_key_t key{ImGui::GetFont(), ImGui::GetFontSize(), std::hash<std::string_view>()(view)};
+
+    auto entry = text_size_cache.find(key);
+
+    if (entry != text_size_cache.end() && view.compare(entry->second.text) == 0) return entry->second.size;
+
+    auto size = ImGui::CalcTextSize(view.data(), view.data() + view.size());
+
+    if (entry != text_size_cache.end())
+    {
+        entry->second.text.assign(view.data(), view.size());
+        entry->second.size = size;
+
+        return size;
+    }
+
+    if (text_size_cache.size() >= text_size_cache_capacity) text_size_cache.clear();
+
+    text_size_cache.emplace(key, text_size_entry_t{std::string(view), size});
+
+    return size;
+}
+
+/*
+@brief
+
+    Forgets all remembered text sizes (has to happen whenever the font atlas gets rebuilt,
+    a new font may end up at an old one's address)
+*/
+void ImGuiUser::clear_text_size_cache(void)
+{
+    text_size_cache.clear();
+}
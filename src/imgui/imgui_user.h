@@ -140,4 +140,21 @@ namespace ImGuiUser
     */
     void highlight_first_option_on_appearing(void);
 
+    /*
+    @brief
+
+        ImGui::CalcTextSize, but remembers the result for the current font and font size.
+        Only pays off for long text that rarely changes (the pause modals' captions, notifications),
+        a lookup costs about as much as measuring a short or changing text
+    */
+    ImVec2 calc_text_size(const char* text, const char* text_end = nullptr);
+
+    /*
+    @brief
+
+        Forgets all remembered text sizes (has to happen whenever the font atlas gets rebuilt,
+        a new font may end up at an old one's address)
+    */
+    void clear_text_size_cache(void);
+
 }
\ No newline at end of file
@@ -1,4 +1,4 @@
-#ifdef PLATFORM_LINUX
+#if defined(PLATFORM_LINUX) && !defined(LINUX_IMGUI_SOFTWARE_RENDERING)
 
 /*
 @file
@@ -11,6 +11,7 @@
 */
 
 #include "glfw.h"
+#include "capture/video_capture.h"
 #include "util/util.h"
 
 // ImGui and GLFW/OGL3 implementation
@@ -72,6 +73,68 @@ private:
 
     bool initialized;
 
+    // Frames being recorded get read into these and lent to the recorder two frames later, when the
+    // GPU is done with them (so reading them doesn't stall the frame). The recorder converts them
+    // while they stay mapped, we get them back another two frames later
+    static const size_t pixel_pack_buffer_count = 4;
+
+    GLuint pixel_pack_buffers[pixel_pack_buffer_count];
+
+    int pixel_pack_widths[pixel_pack_buffer_count], pixel_pack_heights[pixel_pack_buffer_count];
+
+    bool pixel_pack_pending[pixel_pack_buffer_count];
+
+    // Mapped and lent to the recorder (see video_recorder_t::lend_frame)
+    bool pixel_pack_lent[pixel_pack_buffer_count];
+
+    uint64_t pixel_pack_tickets[pixel_pack_buffer_count];
+
+    size_t pixel_pack_index;
+
+    /*
+    @brief
+
+        Lends the frame in pixel pack buffer @index to @recorder (mapped, copying 8MB per frame
+        at 1080p would take the game thread ~1.7ms)
+    */
+    void lend_pixel_pack_buffer(video_recorder_t* recorder, size_t index)
+    {
+        auto width = pixel_pack_widths[index];
+        auto height = pixel_pack_heights[index];
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_pack_buffers[index]);
+
+        auto pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(width) * height * 4, GL_MAP_READ_BIT);
+
+        if (pixels != nullptr)
+        {
+            pixel_pack_lent[index] = recorder->lend_frame(pixels, width, height, true, pixel_pack_tickets[index]);
+
+            // Dropped, the recorder is behind
+            if (!pixel_pack_lent[index]) glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        pixel_pack_pending[index] = false;
+    }
+
+    /*
+    @brief
+
+        Waits until @recorder is done with pixel pack buffer @index, then unmaps it
+    */
+    void return_pixel_pack_buffer(video_recorder_t* recorder, size_t index)
+    {
+        recorder->wait_returned(pixel_pack_tickets[index]);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_pack_buffers[index]);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        pixel_pack_lent[index] = false;
+    }
+
 public:
 
     /*
@@ -86,7 +149,7 @@ public:
 
 		Constructor
 	*/
-	glfw_imgui() : glfw_window(nullptr), initialized(false)
+	glfw_imgui() : glfw_window(nullptr), initialized(false), pixel_pack_buffers(), pixel_pack_widths(), pixel_pack_heights(), pixel_pack_pending(), pixel_pack_lent(), pixel_pack_tickets(), pixel_pack_index(0)
 	{
 
 	}
@@ -104,78 +167,178 @@ public:
     /*
     @brief
 
-        Sets up GLFW
+        Keeps @size if the monitor supports it, picks the biggest supported resolution otherwise
     */
-    bool setup(const std::string& window_title, area_size_t& size, bool vsync, bool fullscreen, std::string* error = nullptr, bool glfw_init = true)
+    bool choose_resolution(area_size_t& size, std::string* error = nullptr)
     {
-        if (initialized && glfw_init) return true;
-
-        // Setup window
-        if (glfw_init) glfwSetErrorCallback(glfw_error_callback);
+        // We only support 16:9 resolutions as of now!
+        const auto& supported_resolutions = util::get_supported_resolutions(16, 9);
 
-        if (/*glfw_init && */!glfwInit())
+        if (supported_resolutions.first.empty())
         {
-            if (error) *error = "glfwInit returned 0";
+            if (error) *error = "Failed to find supported resolutions";
 
             return false;
         }
 
-        // Check if the resolution we want to use is supported
-        const auto& supported_resolutions = util::get_supported_resolutions(16, 9); // We only support 16:9 resolutions as of now!
+        bool found = false;
 
-        if (supported_resolutions.first.empty())
+        for (const auto& resolution : supported_resolutions.first)
         {
-            glfwTerminate();
+            auto width = std::get<0>(resolution);
+            auto height = std::get<1>(resolution);
 
-            if (error) *error = "Failed to find supported resolutions";
+            if (width == static_cast<uint16_t>(size.width) && height == static_cast<uint16_t>(size.height))
+            {
+                found = true;
 
-            return false;
+                break;
+            }
         }
 
-        //if (fullscreen)
-        //{
-            bool found = false;
+        if (!found)
+        {
+            printf("Specified resolution not supported. Choosing biggest/native resolution!\n");
+            printf("Supported resolutions:\n");
 
             for (const auto& resolution : supported_resolutions.first)
             {
-                auto width = std::get<0>(resolution);
-                auto height = std::get<1>(resolution);
+                printf("%ix%i\n", static_cast<int32_t>(std::get<0>(resolution)), static_cast<int32_t>(std::get<1>(resolution)));
+            }
 
-                if (width == static_cast<uint16_t>(size.width) && height == static_cast<uint16_t>(size.height))
-                {
-                    found = true;
+            auto& last_elem = supported_resolutions.first.at(supported_resolutions.first.size() - 1);
 
-                    break;
-                }
-            }
+            size.width = static_cast<uint16_t>(std::get<0>(last_elem));
+            size.height = static_cast<uint16_t>(std::get<1>(last_elem));
+        }
 
-            if (!found)
-            {
-                printf("Specified resolution not supported. Choosing biggest/native resolution!\n");
-                printf("Supported resolutions:\n");
+        return true;
+    }
 
-                for (const auto& resolution : supported_resolutions.first)
-                {
-                    printf("%ix%i\n", static_cast<int32_t>(std::get<0>(resolution)), static_cast<int32_t>(std::get<1>(resolution)));
-                }
+    /*
+    @brief
 
-                auto& last_elem = supported_resolutions.first.at(supported_resolutions.first.size() - 1);
+        Changes the resolution and fullscreen state of the existing window (keeps the GL context)
+    */
+    bool change_video_mode(area_size_t& size, bool fullscreen, std::string* error = nullptr)
+    {
+        if (!choose_resolution(size, error)) return false;
 
-                size.width = static_cast<uint16_t>(std::get<0>(last_elem));
-                size.height = static_cast<uint16_t>(std::get<1>(last_elem));
-            }
-        /*}
+        auto monitor = glfwGetPrimaryMonitor();
+        auto mode = glfwGetVideoMode(monitor);
+        auto native = size.width == static_cast<uint32_t>(mode->width) && size.height == static_cast<uint32_t>(mode->height);
+
+        // Like in setup(), a window as big as the monitor becomes fullscreen (at the monitor's current mode)
+        if (fullscreen || native)
+        {
+            glfwSetWindowMonitor(glfw_window, monitor, 0, 0, size.width, size.height, native ? mode->refreshRate : GLFW_DONT_CARE);
+        }
         else
         {
-            if (!util::check_aspect_ratio(size))
-            {
-                glfwTerminate();
+            glfwSetWindowMonitor(glfw_window, nullptr, (mode->width - static_cast<int>(size.width)) / 2, (mode->height - static_cast<int>(size.height)) / 2, size.width, size.height, GLFW_DONT_CARE);
+        }
 
-                if (error) *error = "Specified resolution is not 16:9";
+        return true;
+    }
 
-                return false;
-            }
-        }*/
+    /*
+    @brief
+
+        Reads the frame we've just rendered (@width x @height) for @recorder, which gets it a
+        couple of frames later
+    */
+    void capture_frame(video_recorder_t* recorder, int width, int height)
+    {
+        if (pixel_pack_buffers[0] == 0) glGenBuffers(static_cast<GLsizei>(pixel_pack_buffer_count), pixel_pack_buffers);
+
+        // The frame from two frames ago is done on the GPU by now
+        auto ready_index = (pixel_pack_index + pixel_pack_buffer_count - 2) % pixel_pack_buffer_count;
+
+        if (pixel_pack_pending[ready_index]) lend_pixel_pack_buffer(recorder, ready_index);
+
+        // The buffer we're about to reuse got lent two frames ago, the recorder is usually done with it
+        if (pixel_pack_lent[pixel_pack_index]) return_pixel_pack_buffer(recorder, pixel_pack_index);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixel_pack_buffers[pixel_pack_index]);
+
+        if (pixel_pack_widths[pixel_pack_index] != width || pixel_pack_heights[pixel_pack_index] != height)
+        {
+            glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(width) * height * 4, nullptr, GL_STREAM_READ);
+
+            pixel_pack_widths[pixel_pack_index] = width;
+            pixel_pack_heights[pixel_pack_index] = height;
+        }
+
+        // Returns right away, the copy happens on the GPU
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        pixel_pack_pending[pixel_pack_index] = true;
+        pixel_pack_index = (pixel_pack_index + 1) % pixel_pack_buffer_count;
+    }
+
+    /*
+    @brief
+
+        Hands the frames still being read to @recorder and frees the pixel pack buffers
+        (before the GL context goes away, or when we stop recording)
+    */
+    void finish_capture(video_recorder_t* recorder)
+    {
+        if (pixel_pack_buffers[0] == 0) return;
+
+        // Oldest first
+        for (size_t i = 0; i < pixel_pack_buffer_count; i++)
+        {
+            auto index = (pixel_pack_index + i) % pixel_pack_buffer_count;
+
+            if (pixel_pack_pending[index]) lend_pixel_pack_buffer(recorder, index);
+        }
+
+        // Buffers can't be deleted while the recorder still reads them
+        for (size_t i = 0; i < pixel_pack_buffer_count; i++)
+        {
+            auto index = (pixel_pack_index + i) % pixel_pack_buffer_count;
+
+            if (pixel_pack_lent[index]) return_pixel_pack_buffer(recorder, index);
+
+            pixel_pack_widths[index] = pixel_pack_heights[index] = 0;
+        }
+
+        glDeleteBuffers(static_cast<GLsizei>(pixel_pack_buffer_count), pixel_pack_buffers);
+
+        pixel_pack_buffers[0] = 0;
+        pixel_pack_index = 0;
+    }
+
+    /*
+    @brief
+
+        Sets up GLFW
+    */
+    bool setup(const std::string& window_title, area_size_t& size, bool vsync, bool fullscreen, std::string* error = nullptr, bool glfw_init = true)
+    {
+        if (initialized && glfw_init) return true;
+
+        // Setup window
+        if (glfw_init) glfwSetErrorCallback(glfw_error_callback);
+
+        if (/*glfw_init && */!glfwInit())
+        {
+            if (error) *error = "glfwInit returned 0";
+
+            return false;
+        }
+
+        // Check if the resolution we want to use is supported
+        if (!choose_resolution(size, error))
+        {
+            glfwTerminate();
+
+            return false;
+        }
 
         if (!fullscreen)
         {
@@ -262,7 +425,8 @@ retrogames::imgui_wrapper_glfw_t::imgui_wrapper_glfw_t(settings_t* settings, con
     vsync(vsync),
     fullscreen(fullscreen),
     settings(settings),
-    imgui(new internal::glfw_imgui()) {}
+    imgui(new internal::glfw_imgui()),
+    video_recorder(nullptr) {}
 
 /*
 @brief
@@ -298,16 +462,6 @@ bool retrogames::imgui_wrapper_glfw_t::reinitialize(std::string* error/* = nullp
 		memcpy(original_style_colors, ImGui::GetStyle().Colors, sizeof(original_style_colors));
 	}
 
-    // Shutdown everything needed
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-
-    ImGui::DestroyContext();
-
-    glfwDestroyWindow(imgui->get_glfw_window());
-    glfwTerminate();
-
-    // Now, re-initialize
     // First, set the new resolution_area because when we change
     // the resolution in the menu, all we do is modify the string,
     // which doesn't get used apart from initially setting the
@@ -326,6 +480,22 @@ bool retrogames::imgui_wrapper_glfw_t::reinitialize(std::string* error/* = nullp
         }
     }
 
+    // Without vsync we render single buffered (see setup), and only a new window can change that.
+    // Everything else can change on the window and ImGui context we have
+    if (imgui_created && main_settings.vsync->get<bool>() == vsync) return reinitialize_in_place(error);
+
+    // The GL context goes away, get the frames we're still reading out of it
+    if (video_recorder) imgui->finish_capture(video_recorder);
+
+    // Shutdown everything needed
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui_ImplGlfw_Shutdown();
+
+    ImGui::DestroyContext();
+
+    glfwDestroyWindow(imgui->get_glfw_window());
+    glfwTerminate();
+
     // Now, re-initialize GLFW (create a new window etc)
     vsync = main_settings.vsync->get<bool>();
     fullscreen = main_settings.fullscreen->get<bool>();
@@ -336,7 +506,7 @@ bool retrogames::imgui_wrapper_glfw_t::reinitialize(std::string* error/* = nullp
     // GLFW re-initialized, re-initialize ImGui
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
+    ImGui::CreateContext(&font_atlas);
     ImGuiIO& io = ImGui::GetIO();
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
     //io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
@@ -373,6 +543,45 @@ bool retrogames::imgui_wrapper_glfw_t::reinitialize(std::string* error/* = nullp
     return true;
 }
 
+/*
+@brief
+
+	Changes the video mode without recreating the window, GL context or ImGui context.
+	Only the style and fonts depend on the resolution, so only they get rebuilt
+*/
+bool retrogames::imgui_wrapper_glfw_t::reinitialize_in_place(std::string* error/* = nullptr*/)
+{
+    auto& main_settings = settings->get_main_settings();
+
+    fullscreen = main_settings.fullscreen->get<bool>();
+
+    if (!imgui->change_video_mode(main_settings.resolution_area, fullscreen, error)) return false;
+
+    window_size = main_settings.resolution_area;
+
+    ImGui::GetIO().DisplaySize = ImVec2{static_cast<float>(window_size.width), static_cast<float>(window_size.height)};
+
+    // Rescale the style from the original one (like a fresh context would)
+    auto& style = ImGui::GetStyle();
+
+    style = original_style;
+
+    memcpy(style.Colors, original_style_colors, sizeof(original_style_colors));
+
+    style.ScaleAllSizes(static_cast<float>(window_size.height) / 1080.f);
+
+    // The fonts are sized by the resolution. Distance field fonts only get rescaled by main_reset(), bitmap
+    // fonts have to be dropped so it recreates them at the new size (begin_frame() uploads the new font texture)
+    if (!(ImGui::GetIO().Fonts->Flags & ImFontAtlasFlags_SignedDistanceField))
+    {
+        ImGui_ImplOpenGL3_DestroyFontsTexture();
+
+        ImGui::GetIO().Fonts->Clear();
+    }
+
+    return true;
+}
+
 /*
 @brief
 
@@ -399,7 +608,7 @@ bool retrogames::imgui_wrapper_glfw_t::initialize(bool glfw, std::string* error/
 
 	// Setup Dear ImGui context
     IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
+    ImGui::CreateContext(&font_atlas);
     ImGuiIO& io = ImGui::GetIO();
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
     //io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
@@ -453,6 +662,10 @@ bool retrogames::imgui_wrapper_glfw_t::begin_frame(void)
 {
 	// Start the Dear ImGui frame
     ImGui_ImplOpenGL3_NewFrame();
+
+    // Fonts got recreated (after changing the video mode in place), upload them again
+    if (ImGui::GetIO().Fonts->TexID == nullptr) ImGui_ImplOpenGL3_CreateFontsTexture();
+
     ImGui_ImplGlfw_NewFrame();
 
     ImGui::NewFrame();
@@ -489,6 +702,9 @@ void retrogames::imgui_wrapper_glfw_t::end_frame(bool should_render, const color
     glClear(GL_COLOR_BUFFER_BIT);
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
+    // Read the frame for the recorder before swapping (the back buffer is undefined afterwards)
+    if (video_recorder) imgui->capture_frame(video_recorder, display_w, display_h);
+
     if (vsync)
     {
         glfwSwapBuffers(window);
@@ -508,6 +724,8 @@ void retrogames::imgui_wrapper_glfw_t::shutdown(void)
 {
 	if (!imgui_created) return;
 
+    set_video_recorder(nullptr);
+
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
 
@@ -519,6 +737,19 @@ void retrogames::imgui_wrapper_glfw_t::shutdown(void)
 	imgui_created = false;
 }
 
+/*
+@brief
+
+    Records every rendered frame into @recorder from now on (nullptr stops, handing over
+    the frames still being read)
+*/
+void retrogames::imgui_wrapper_glfw_t::set_video_recorder(video_recorder_t* recorder)
+{
+    if (video_recorder && video_recorder != recorder) imgui->finish_capture(video_recorder);
+
+    video_recorder = recorder;
+}
+
 /*
 @brief
 
@@ -539,4 +770,26 @@ void retrogames::imgui_wrapper_glfw_t::poll_events(void)
     glfwPollEvents();
 }
 
+/*
+@brief
+
+    Blocks until events arrive or @timeout_seconds passed (negative waits for events only),
+    then processes them like poll_events()
+*/
+void retrogames::imgui_wrapper_glfw_t::wait_events(double timeout_seconds)
+{
+    if (timeout_seconds < 0.) glfwWaitEvents();
+    else glfwWaitEventsTimeout(timeout_seconds);
+}
+
+/*
+@brief
+
+    Makes a wait_events() call return right away (can be called from any thread)
+*/
+void retrogames::imgui_wrapper_glfw_t::wake(void)
+{
+    glfwPostEmptyEvent();
+}
+
 #endif
\ No newline at end of file
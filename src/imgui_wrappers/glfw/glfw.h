@@ -1,4 +1,4 @@
-#ifdef PLATFORM_LINUX
+#if defined(PLATFORM_LINUX) && !defined(LINUX_IMGUI_SOFTWARE_RENDERING)
 
 /*
 @file
@@ -24,6 +24,8 @@ struct GLFWwindow;
 namespace retrogames
 {
 
+	class video_recorder_t;
+
 	// So we don't have to include imgui/glfw headers here
 	namespace internal
 	{
@@ -60,6 +62,18 @@ namespace retrogames
 
 		bool original_style_colors_set;
 
+		// Shared by every ImGui context we create, so the fonts outlive recreating the window
+		ImFontAtlas font_atlas;
+
+		// Gets every rendered frame while recording
+		video_recorder_t* video_recorder;
+
+		/*
+		@brief
+
+			Changes the video mode without recreating the window, GL context or ImGui context
+		*/
+		bool reinitialize_in_place(std::string* error = nullptr);
 
 	public:
 
@@ -105,6 +119,14 @@ namespace retrogames
 		*/
 		bool reinitialize(std::string* error = nullptr);
 
+		/*
+		@brief
+
+			Records every rendered frame into @recorder from now on (nullptr stops, handing over
+			the frames still being read)
+		*/
+		void set_video_recorder(video_recorder_t* recorder);
+
 		/*
 		@brief
 
@@ -126,6 +148,21 @@ namespace retrogames
         */
         void poll_events(void);
 
+        /*
+        @brief
+
+            Blocks until events arrive or @timeout_seconds passed (negative waits for events only),
+            then processes them like poll_events()
+        */
+        void wait_events(double timeout_seconds);
+
+        /*
+        @brief
+
+            Makes a wait_events() call return right away (can be called from any thread)
+        */
+        static void wake(void);
+
 		/*
     	@brief
 
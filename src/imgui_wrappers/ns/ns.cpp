@@ -12,6 +12,7 @@
 
 #include "ns.h"
 #include "imgui/imgui.h"
+#include "misc/clock.h"
 #include <chrono>
 #include <glad/glad.h>  // glad library (OpenGL loader)
 
@@ -109,11 +110,11 @@ bool retrogames::imgui_wrapper_opengl_t::begin_frame(void)
 
     if (!g_time_set)
 	{
-	    g_time = std::chrono::high_resolution_clock::now();
+	    g_time = get_clock().now();
 		g_time_set = true;
 	}
 
-	auto current_time = std::chrono::high_resolution_clock::now();
+	auto current_time = get_clock().now();
 	auto delta_time_ns = current_time - g_time;
 	auto& io = ImGui::GetIO();
 
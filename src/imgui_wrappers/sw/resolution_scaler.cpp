@@ -0,0 +1,117 @@
+#if defined(PLATFORM_LINUX) && defined(LINUX_IMGUI_SOFTWARE_RENDERING)
+
+/*
+@file
+
+	resolution_scaler.cpp
+
+@purpose
+
+	Dynamic resolution for the software renderer: watches how long painting takes and
+	lowers or raises the resolution game layers get painted at to stay within a budget
+*/
+
+#include "resolution_scaler.h"
+
+namespace
+{
+
+	// The scales we can paint at, from full resolution down. Few steps means few buffer reallocations
+	const float scale_steps[] = { 1.f, .875f, .75f, .625f, .5f };
+	const int scale_step_count = static_cast<int>(sizeof(scale_steps) / sizeof(scale_steps[0]));
+
+	// How many frames to wait after changing the scale before changing it again
+	const uint32_t settle_frames = 30;
+
+	// Only go up a step if the estimate for it stays this far below the budget (keeps us from flip-flopping)
+	const double scale_up_headroom = .85;
+
+}
+
+/*
+@brief
+
+	Constructor, scaling is disabled until a budget is set
+*/
+retrogames::resolution_scaler_t::resolution_scaler_t() :
+	enabled(false),
+	budget_ms(0.),
+	scale_index(0),
+	average_ms(0.),
+	frames_since_change(0),
+	filter(imgui_sw::TextureFilter::Bilinear) {}
+
+/*
+@brief
+
+	Enables scaling to paint within @budget_ms milliseconds per frame (0 disables it and paints at full resolution)
+*/
+void retrogames::resolution_scaler_t::set_budget(double budget_ms)
+{
+	this->budget_ms = budget_ms;
+
+	enabled = budget_ms > 0.;
+	scale_index = 0;
+	average_ms = 0.;
+	frames_since_change = 0;
+}
+
+/*
+@brief
+
+	Feeds the time painting the last frame took, adjusting the scale if needed
+*/
+void retrogames::resolution_scaler_t::update(double paint_ms)
+{
+	if (!enabled) return;
+
+	// Exponential moving average, starting at the first sample
+	average_ms = frames_since_change == 0 ? paint_ms : average_ms + (paint_ms - average_ms) * .1;
+
+	if (++frames_since_change < settle_frames) return;
+
+	if (average_ms > budget_ms && scale_index + 1 < scale_step_count)
+	{
+		scale_index++;
+		frames_since_change = 0;
+
+		return;
+	}
+
+	if (scale_index > 0)
+	{
+		// Painting cost grows with the pixel count, so estimate what the next step up would take
+		auto ratio = scale_steps[scale_index - 1] / scale_steps[scale_index];
+
+		if (average_ms * ratio * ratio < budget_ms * scale_up_headroom)
+		{
+			scale_index--;
+			frames_since_change = 0;
+		}
+	}
+}
+
+/*
+@brief
+
+	Gets the scale to paint scaled layers at (1 when disabled)
+*/
+float retrogames::resolution_scaler_t::get_scale(void) const
+{
+	return enabled ? scale_steps[scale_index] : 1.f;
+}
+
+/*
+@brief
+
+	Checks if a draw list belongs to the layers painted at the lower resolution.
+	By default that's the background draw list (where the games draw), so windows and text stay sharp
+*/
+bool retrogames::resolution_scaler_t::is_scaled_layer(const ImDrawList* draw_list) const
+{
+	if (scaled_layer_predicate) return scaled_layer_predicate(draw_list);
+
+	return draw_list == ImGui::GetBackgroundDrawList();
+}
+
+#endif
@@ -0,0 +1,121 @@
+#if defined(PLATFORM_LINUX) && defined(LINUX_IMGUI_SOFTWARE_RENDERING)
+
+/*
+@file
+
+	resolution_scaler.h
+
+@purpose
+
+	Dynamic resolution for the software renderer: watches how long painting takes and
+	lowers or raises the resolution game layers get painted at to stay within a budget
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include "imgui/imgui.h"
+#include "imgui/imgui_sw.h"
+
+namespace retrogames
+{
+
+	class resolution_scaler_t final
+	{
+
+	protected:
+
+
+
+	private:
+
+		bool enabled;
+
+		// How long painting a frame may take (in milliseconds)
+		double budget_ms;
+
+		// The scale we paint scaled layers at, one of scale_steps
+		int scale_index;
+
+		// Smoothed paint time, so a single slow frame doesn't change the resolution
+		double average_ms;
+
+		// Frames since the scale last changed (the average needs time to settle)
+		uint32_t frames_since_change;
+
+		imgui_sw::TextureFilter filter;
+
+		std::function<bool(const ImDrawList*)> scaled_layer_predicate;
+
+	public:
+
+		/*
+		@brief
+
+			Constructor, scaling is disabled until a budget is set
+		*/
+		resolution_scaler_t();
+
+		/*
+		@brief
+
+			Enables scaling to paint within @budget_ms milliseconds per frame (0 disables it and paints at full resolution)
+		*/
+		void set_budget(double budget_ms);
+
+		/*
+		@brief
+
+			Feeds the time painting the last frame took, adjusting the scale if needed
+		*/
+		void update(double paint_ms);
+
+		/*
+		@brief
+
+			Gets the scale to paint scaled layers at (1 when disabled)
+		*/
+		float get_scale(void) const;
+
+		/*
+		@brief
+
+			Checks if a draw list belongs to the layers painted at the lower resolution.
+			By default that's the background draw list (where the games draw), so windows and text stay sharp
+		*/
+		bool is_scaled_layer(const ImDrawList* draw_list) const;
+
+		/*
+		@brief
+
+			Changes which draw lists are painted at the lower resolution
+		*/
+		void set_scaled_layer_predicate(const std::function<bool(const ImDrawList*)>& predicate) { scaled_layer_predicate = predicate; }
+
+		/*
+		@brief
+
+			Sets the filter used to upscale the scaled layers (nearest is blocky, but cheaper)
+		*/
+		void set_filter(imgui_sw::TextureFilter filter) { this->filter = filter; }
+
+		/*
+		@brief
+
+			Gets the filter used to upscale the scaled layers
+		*/
+		imgui_sw::TextureFilter get_filter(void) const { return filter; }
+
+		/*
+		@brief
+
+			Checks if we're scaling at all
+		*/
+		bool is_enabled(void) const { return enabled; }
+
+	};
+
+}
+
+#endif
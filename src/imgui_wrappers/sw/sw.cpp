@@ -0,0 +1,343 @@
+#if defined(PLATFORM_LINUX) && defined(LINUX_IMGUI_SOFTWARE_RENDERING)
+
+/*
+@file
+
+	sw.cpp
+
+@purpose
+
+	Wrap ImGui with software rendering into memory (Linux, no window/OpenGL needed)
+*/
+
+#include "sw.h"
+#include "misc/clock.h"
+#include "util/image.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+/*
+@brief
+
+	Constructor
+*/
+retrogames::imgui_wrapper_sw_t::imgui_wrapper_sw_t(settings_t* settings, const area_size_t& size) :
+	settings(settings),
+	imgui_created(false),
+	framebuffer_size(size),
+	damage(nullptr),
+	original_style_colors_set(false) {}
+
+/*
+@brief
+
+	Destructor
+*/
+retrogames::imgui_wrapper_sw_t::~imgui_wrapper_sw_t()
+{
+	shutdown();
+}
+
+/*
+@brief
+
+	Creates the ImGui context and sets up the IO the way we want it
+*/
+void retrogames::imgui_wrapper_sw_t::create_context(void)
+{
+	IMGUI_CHECKVERSION();
+	ImGui::CreateContext(&font_atlas);
+	ImGuiIO& io = ImGui::GetIO();
+	io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
+	io.IniFilename = nullptr; // Prevent ImGui from changing settings
+	io.DisplaySize = ImVec2{static_cast<float>(framebuffer_size.width), static_cast<float>(framebuffer_size.height)};
+	io.BackendPlatformName = io.BackendRendererName = "imgui_sw";
+
+	// There's no window to get keys from, so keys are indexed by their ImGuiKey directly
+	// (anything feeding us input can simply set io.KeysDown[key])
+	for (int key = 0; key < ImGuiKey_COUNT; key++) io.KeyMap[key] = key;
+
+	pixel_buffer.assign(static_cast<size_t>(framebuffer_size.width) * framebuffer_size.height, 0);
+
+	damage = nullptr;
+}
+
+/*
+@brief
+
+	Makes sure imgui_sw paints with the current font atlas (adding fonts invalidates it).
+	Only the font texture gets replaced, textures from imgui_sw::create_texture stay valid
+*/
+void retrogames::imgui_wrapper_sw_t::update_font_texture(void)
+{
+	auto& io = ImGui::GetIO();
+
+	if (io.Fonts->TexID != nullptr && io.Fonts->IsBuilt()) return;
+
+	imgui_sw::rebind_font_texture();
+}
+
+/*
+@brief
+
+	Initializes ImGui and the software renderer
+*/
+bool retrogames::imgui_wrapper_sw_t::initialize(std::string* error/* = nullptr*/)
+{
+	// Check if we've already created the ImGui context
+	if (imgui_created) return true;
+
+	if (framebuffer_size.width == 0 || framebuffer_size.height == 0)
+	{
+		if (error) *error = "Invalid framebuffer size";
+
+		return false;
+	}
+
+	create_context();
+
+	// Setup Dear ImGui style
+	ImGui::StyleColorsDark();
+
+	// Use as many threads as we have cores to paint
+	sw_options.num_threads = static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+
+	imgui_created = true;
+
+	// Save the original style
+	auto& style = ImGui::GetStyle();
+
+	original_style = style;
+
+	// Scale the style by our resolution
+	style.ScaleAllSizes(static_cast<float>(framebuffer_size.height) / 1080.f);
+
+	// All done!
+	return true;
+}
+
+/*
+@brief
+
+	Reinitializes ImGui with the video settings (resolution) from our settings
+*/
+bool retrogames::imgui_wrapper_sw_t::reinitialize(std::string* error/* = nullptr*/)
+{
+	if (!original_style_colors_set)
+	{
+		original_style_colors_set = true;
+
+		memcpy(original_style_colors, ImGui::GetStyle().Colors, sizeof(original_style_colors));
+	}
+
+	// Shutdown everything needed. The new context's font atlas gets rebound in begin_frame(),
+	// textures from imgui_sw::create_texture outlive the context
+	ImGui::DestroyContext();
+
+	// Grab the new resolution (the menu only modifies the string)
+	auto& main_settings = settings->get_main_settings();
+
+	main_settings.resolution_area = area_size_t(1280, 720); // 720p default
+	{
+		auto res = main_settings.resolution->get<std::string>();
+		auto pos = res.find_first_of('x');
+
+		if (pos != std::string::npos)
+		{
+			main_settings.resolution_area.width = std::stoi(res.substr(0, pos));
+			main_settings.resolution_area.height = std::stoi(res.substr(pos + 1));
+		}
+	}
+
+	if (main_settings.resolution_area.width == 0 || main_settings.resolution_area.height == 0)
+	{
+		if (error) *error = "Invalid resolution " + main_settings.resolution->get<std::string>();
+
+		return false;
+	}
+
+	framebuffer_size = main_settings.resolution_area;
+
+	create_context();
+
+	auto& style = ImGui::GetStyle();
+
+	style = original_style;
+
+	memcpy(style.Colors, original_style_colors, sizeof(original_style_colors));
+
+	style.ScaleAllSizes(static_cast<float>(framebuffer_size.height) / 1080.f);
+
+	return true;
+}
+
+/*
+@brief
+
+	Begins a frame
+*/
+bool retrogames::imgui_wrapper_sw_t::begin_frame(void)
+{
+	// Determine frametime (this will also tell us the FPS in the end)
+	static bool g_time_set = false;
+	static std::chrono::high_resolution_clock::time_point g_time;
+
+	if (!g_time_set)
+	{
+		g_time = get_clock().now();
+		g_time_set = true;
+	}
+
+	auto current_time = get_clock().now();
+	auto delta_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(current_time - g_time);
+	auto& io = ImGui::GetIO();
+
+	io.DeltaTime = std::max(static_cast<float>(static_cast<double>(delta_time_ns.count()) / 1000000000.), 1e-6f); // ImGui doesn't like a delta time of 0
+
+	g_time = current_time;
+
+	// Fonts may have been added since the last frame
+	update_font_texture();
+
+	ImGui::NewFrame();
+
+	return true;
+}
+
+/*
+@brief
+
+	Ends a frame, painting it into our pixel buffer if @should_render is set
+*/
+void retrogames::imgui_wrapper_sw_t::end_frame(bool should_render, const color_t clear_color/* = color_t(20, 20, 20)*/)
+{
+	ImGui::Render();
+
+	if (!should_render) return;
+
+	auto paint_start = std::chrono::steady_clock::now();
+	auto clear_color_u32 = IM_COL32(clear_color.r(), clear_color.g(), clear_color.b(), 255);
+	auto scale = resolution_scaler.get_scale();
+
+	// Only repaint what changed since the last frame (pixel_buffer still holds it)
+	if (scale >= 1.f) damage = &imgui_sw::paint_imgui_changes(ImGui::GetDrawData(), pixel_buffer.data(), static_cast<int>(framebuffer_size.width), static_cast<int>(framebuffer_size.height), clear_color_u32, sw_options);
+	else paint_scaled(ImGui::GetDrawData(), scale, clear_color_u32);
+
+	resolution_scaler.update(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - paint_start).count());
+}
+
+/*
+@brief
+
+	Paints the scaled layers at the resolution scaler's scale, upscales them into
+	our pixel buffer and paints everything else over that at full resolution
+*/
+void retrogames::imgui_wrapper_sw_t::paint_scaled(const ImDrawData* draw_data, float scale, uint32_t clear_color)
+{
+	auto width = static_cast<int>(framebuffer_size.width), height = static_cast<int>(framebuffer_size.height);
+	auto scaled_width = std::max(static_cast<int>(width * scale), 1), scaled_height = std::max(static_cast<int>(height * scale), 1);
+
+	// Only the draw lists at the bottom can be scaled, or we'd change what's painted over what
+	int scaled_lists = 0;
+
+	while (scaled_lists < draw_data->CmdListsCount && resolution_scaler.is_scaled_layer(draw_data->CmdLists[scaled_lists])) scaled_lists++;
+
+	ImDrawData layers = *draw_data;
+
+	layers.CmdListsCount = scaled_lists;
+
+	scaled_buffer.assign(static_cast<size_t>(scaled_width) * scaled_height, clear_color);
+
+	imgui_sw::paint_imgui(&layers, scaled_buffer.data(), scaled_width, scaled_height, sw_options);
+	imgui_sw::upscale(scaled_buffer.data(), scaled_width, scaled_height, pixel_buffer.data(), width, height, resolution_scaler.get_filter(), sw_options);
+
+	layers.CmdLists = draw_data->CmdLists + scaled_lists;
+	layers.CmdListsCount = draw_data->CmdListsCount - scaled_lists;
+
+	imgui_sw::paint_imgui(&layers, pixel_buffer.data(), width, height, sw_options);
+
+	full_damage.assign(1, imgui_sw::DamageRect{ 0, 0, width, height });
+	damage = &full_damage;
+}
+
+/*
+@brief
+
+	Shuts down ImGui and the software renderer
+*/
+void retrogames::imgui_wrapper_sw_t::shutdown(void)
+{
+	if (!imgui_created) return;
+
+	if (ImGui::GetIO().Fonts->TexID != nullptr) imgui_sw::unbind_imgui_painting();
+
+	ImGui::DestroyContext();
+
+	imgui_created = false;
+}
+
+/*
+@brief
+
+	Saves the last painted frame, as PNG or PPM depending on the extension of @path
+*/
+bool retrogames::imgui_wrapper_sw_t::save_screenshot(const std::string& path, std::string* error/* = nullptr*/) const
+{
+	return util::save_image(path, pixel_buffer.data(), framebuffer_size, error);
+}
+
+/*
+@brief
+
+	Retrieves the last painted frame
+*/
+const std::vector<uint32_t>& retrogames::imgui_wrapper_sw_t::get_pixels(void) const
+{
+	return pixel_buffer;
+}
+
+/*
+@brief
+
+	Retrieves the parts of the pixel buffer that changed in the last painted frame
+*/
+const std::vector<imgui_sw::DamageRect>& retrogames::imgui_wrapper_sw_t::get_damage(void) const
+{
+	static const std::vector<imgui_sw::DamageRect> no_damage;
+
+	return damage ? *damage : no_damage;
+}
+
+/*
+@brief
+
+	Retrieves the size of the pixel buffer
+*/
+const retrogames::area_size_t& retrogames::imgui_wrapper_sw_t::get_framebuffer_size(void) const
+{
+	return framebuffer_size;
+}
+
+/*
+@brief
+
+	Retrieves the software rendering options so they can be changed
+*/
+imgui_sw::SwOptions& retrogames::imgui_wrapper_sw_t::get_sw_options(void)
+{
+	return sw_options;
+}
+
+/*
+@brief
+
+	Retrieves the dynamic resolution controller (disabled until it gets a budget)
+*/
+retrogames::resolution_scaler_t& retrogames::imgui_wrapper_sw_t::get_resolution_scaler(void)
+{
+	return resolution_scaler;
+}
+
+#endif
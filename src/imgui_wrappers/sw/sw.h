@@ -0,0 +1,191 @@
+#if defined(PLATFORM_LINUX) && defined(LINUX_IMGUI_SOFTWARE_RENDERING)
+
+/*
+@file
+
+	sw.h
+
+@purpose
+
+	Wrap ImGui with software rendering into memory (Linux, no window/OpenGL needed)
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "misc/color.h"
+#include "misc/area_size.h"
+#include "misc/settings.h"
+#include "misc/macros.h"
+#include "imgui/imgui.h"
+#include "imgui/imgui_sw.h"
+#include "resolution_scaler.h"
+
+namespace retrogames
+{
+
+	class imgui_wrapper_sw_t final
+	{
+
+	protected:
+
+
+
+	private:
+
+		settings_t* settings;
+
+		bool imgui_created;
+
+		area_size_t framebuffer_size;
+
+		// The frame we've painted last (ImGui's packing, RGBA in memory)
+		std::vector<uint32_t> pixel_buffer;
+
+		// Software rendering options
+		imgui_sw::SwOptions sw_options;
+
+		// What changed in the last painted frame (owned by imgui_sw)
+		const std::vector<imgui_sw::DamageRect>* damage;
+
+		// Lowers the resolution of game layers when painting gets too slow
+		resolution_scaler_t resolution_scaler;
+
+		// Game layers painted at the scaled resolution, before upscaling
+		std::vector<uint32_t> scaled_buffer;
+
+		// The whole frame, for when we didn't paint incrementally
+		std::vector<imgui_sw::DamageRect> full_damage;
+
+		ImGuiStyle original_style;
+
+		ImVec4 original_style_colors[static_cast<uint8_t>(ImGuiCol_COUNT)];
+
+		bool original_style_colors_set;
+
+		// Shared by every ImGui context we create, so the fonts outlive a resolution change
+		ImFontAtlas font_atlas;
+
+		/*
+		@brief
+
+			Creates the ImGui context and sets up the IO the way we want it
+		*/
+		void create_context(void);
+
+		/*
+		@brief
+
+			Makes sure imgui_sw paints with the current font atlas (adding fonts invalidates it)
+		*/
+		void update_font_texture(void);
+
+		/*
+		@brief
+
+			Paints the scaled layers at the resolution scaler's scale, upscales them into
+			our pixel buffer and paints everything else over that at full resolution
+		*/
+		void paint_scaled(const ImDrawData* draw_data, float scale, uint32_t clear_color);
+
+	public:
+
+		/*
+		@brief
+
+			Constructor
+		*/
+		imgui_wrapper_sw_t(settings_t* settings, const area_size_t& size);
+
+		/*
+		@brief
+
+			Destructor
+		*/
+		~imgui_wrapper_sw_t();
+
+		/*
+		@brief
+
+			Begins a frame
+		*/
+		bool begin_frame(void);
+
+		/*
+		@brief
+
+			Ends a frame, painting it into our pixel buffer if @should_render is set
+		*/
+		void end_frame(bool should_render, const color_t clear_color = color_t(20, 20, 20));
+
+		/*
+		@brief
+
+			Initializes ImGui and the software renderer
+		*/
+		bool initialize(std::string* error = nullptr);
+
+		/*
+		@brief
+
+			Reinitializes ImGui with the video settings (resolution) from our settings
+		*/
+		bool reinitialize(std::string* error = nullptr);
+
+		/*
+		@brief
+
+			Shuts down ImGui and the software renderer
+		*/
+		void shutdown(void);
+
+		/*
+		@brief
+
+			Saves the last painted frame, as PNG or PPM depending on the extension of @path
+		*/
+		bool save_screenshot(const std::string& path, std::string* error = nullptr) const;
+
+		/*
+		@brief
+
+			Retrieves the last painted frame
+		*/
+		const std::vector<uint32_t>& get_pixels(void) const;
+
+		/*
+		@brief
+
+			Retrieves the parts of the pixel buffer that changed in the last painted frame,
+			for presenting only those
+		*/
+		const std::vector<imgui_sw::DamageRect>& get_damage(void) const;
+
+		/*
+		@brief
+
+			Retrieves the size of the pixel buffer
+		*/
+		const area_size_t& get_framebuffer_size(void) const;
+
+		/*
+		@brief
+
+			Retrieves the software rendering options so they can be changed
+		*/
+		imgui_sw::SwOptions& get_sw_options(void);
+
+		/*
+		@brief
+
+			Retrieves the dynamic resolution controller (disabled until it gets a budget)
+		*/
+		resolution_scaler_t& get_resolution_scaler(void);
+
+	};
+
+}
+
+#endif
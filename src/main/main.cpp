@@ -10,8 +10,11 @@
     main_ files.
 */
 
+#include <atomic>
 #include "main.h"
 #include "imgui/imgui.h"
+#include "capture/latency_probe.h"
+#include "misc/clock.h"
 #include "misc/color.h"
 #include "mainmenu/mainmenu.h"
 
@@ -20,6 +23,20 @@ namespace retrogames
 
     static mainmenu_t mainmenu;
 
+    // Frames we still draw after waking up, before we may wait again (ImGui needs a frame or two
+    // to settle after input, hovering and opening popups take effect a frame later)
+    static constexpr uint8_t idle_settle_frames = 2;
+
+    static uint8_t idle_frames_left = idle_settle_frames;
+
+    // Frames per second we still run while the window is in the background
+    static constexpr double background_fps = 4.;
+
+    // Set by main_wake()
+    static std::atomic<bool> wake_requested(false);
+
+    static void(*wake_callback)(void) = nullptr;
+
 }
 
 /*
@@ -54,6 +71,10 @@ void retrogames::main_initialize(settings_t* settings)
 */
 bool retrogames::main_frame(bool should_render, bool& reset_video_mode)
 {
+    // everything drawn in this frame animates from the same point in time
+    get_clock().begin_frame();
+    get_latency_probe().begin_frame();
+
     return mainmenu.run(should_render, reset_video_mode);
 }
 
@@ -64,7 +85,12 @@ bool retrogames::main_frame(bool should_render, bool& reset_video_mode)
 */
 void retrogames::main_handle_key(bool down, ImGuiKey key)
 {
+    // the latency probe follows the key if the game takes it
+    get_latency_probe().begin_key();
+
     mainmenu.handle_key(down, key);
+
+    get_latency_probe().end_key();
 }
 
 /*
@@ -75,4 +101,90 @@ void retrogames::main_handle_key(bool down, ImGuiKey key)
 void retrogames::main_reset(void)
 {
     mainmenu.reset();
-}
\ No newline at end of file
+
+    // draw the new video mode before waiting for input again
+    idle_frames_left = idle_settle_frames;
+}
+/*
+@brief
+
+    Checks if the platform may wait for input instead of drawing the next frame
+    right away (nothing is animating, like in an untouched main menu)
+
+@params
+
+    @timeout_seconds:   Receives how long the platform may wait at most
+                        (negative means until input arrives)
+
+@return
+
+    True if the platform may wait, false if it should draw the next frame
+*/
+bool retrogames::main_should_idle(double& timeout_seconds)
+{
+    if (wake_requested.exchange(false) || !mainmenu.get_idle_timeout(timeout_seconds))
+    {
+        idle_frames_left = idle_settle_frames;
+
+        return false;
+    }
+
+    if (idle_frames_left > 0)
+    {
+        idle_frames_left--;
+
+        return false;
+    }
+
+    // Whatever wakes us up gets the settle frames again
+    idle_frames_left = idle_settle_frames;
+
+    return true;
+}
+
+/*
+@brief
+
+    Gets how long the platform may wait for input between frames while its window is in
+    the background (unfocused or minimized). Nothing gets drawn then, the slow frames only
+    keep the menu and games ticking, and games keep their timers right (see base_draw)
+*/
+double retrogames::main_get_background_timeout(void)
+{
+    // Whatever brings us back to the foreground gets the settle frames before we may idle again
+    idle_frames_left = idle_settle_frames;
+
+    return 1. / background_fps;
+}
+
+/*
+@brief
+
+    Requests a frame while the platform waits for input (can be called from any thread)
+*/
+void retrogames::main_wake(void)
+{
+    wake_requested = true;
+
+    if (wake_callback != nullptr) wake_callback();
+}
+
+/*
+@brief
+
+    Sets the platform's function to interrupt its wait for input (see main_wake)
+*/
+void retrogames::main_set_wake_callback(void(*callback)(void))
+{
+    wake_callback = callback;
+}
+
+/*
+@brief
+
+    Gets how every game played so far went, "<game>: <outcome>" (for run summaries)
+*/
+std::vector<std::string> retrogames::main_get_outcomes(void)
+{
+    return mainmenu.get_outcomes();
+}
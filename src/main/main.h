@@ -10,6 +10,9 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 typedef int ImGuiKey;
 
 namespace retrogames
@@ -60,4 +63,51 @@ namespace retrogames
     */
     void main_reset(void);
 
+    /*
+    @brief
+
+        Checks if the platform may wait for input instead of drawing the next frame
+        right away (nothing is animating, like in an untouched main menu)
+
+    @params
+
+        @timeout_seconds:   Receives how long the platform may wait at most
+                            (negative means until input arrives)
+
+    @return
+
+        True if the platform may wait, false if it should draw the next frame
+    */
+    bool main_should_idle(double& timeout_seconds);
+
+    /*
+    @brief
+
+        Gets how long the platform may wait for input between frames while its window is in
+        the background (unfocused or minimized). Nothing gets drawn then, the slow frames only
+        keep the menu and games ticking, and games keep their timers right (see base_draw)
+    */
+    double main_get_background_timeout(void);
+
+    /*
+    @brief
+
+        Requests a frame while the platform waits for input (can be called from any thread)
+    */
+    void main_wake(void);
+
+    /*
+    @brief
+
+        Sets the platform's function to interrupt its wait for input (see main_wake)
+    */
+    void main_set_wake_callback(void(*callback)(void));
+
+    /*
+    @brief
+
+        Gets how every game played so far went, "<game>: <outcome>" (for run summaries)
+    */
+    std::vector<std::string> main_get_outcomes(void);
+
 }
\ No newline at end of file
@@ -12,6 +12,7 @@
 
 #include "imgui/imgui.h"
 #include "main.h"
+#include "capture/latency_probe.h"
 #include "imgui/imgui_impl_sdl.h"
 #include "imgui/imgui_impl_opengl3.h"
 #include <stdio.h>
@@ -288,6 +289,9 @@ void main_loop(void* arg)
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
     SDL_GL_SwapWindow(g_Window);
 
+    // the frame got swapped, inputs it shows made it to the screen
+    retrogames::get_latency_probe().presented();
+
     // Don't forget to sync to make sure you store it to IndexedDB
     /*EM_ASM(
         FS.syncfs(function (err) {
@@ -0,0 +1,632 @@
+#ifdef PLATFORM_HEADLESS
+
+/*
+@file
+
+    main_headless.cpp
+
+@purpose
+
+    Main entry point for our program (Linux, headless: no window, no OpenGL, no sound output).
+    Frames are stepped by a virtual clock (misc/clock.h) as fast as they can be made, input comes
+    from a script, so runs are the same every time (benchmarks, soak tests, the build farm)
+
+@usage
+
+    --frames <n>            Exit after n frames (0, the default, runs until the program exits itself)
+    --fps <n>               Frames per virtual second (default: main_fps from the settings)
+    --input <path>          Key events to feed in (see @format)
+    --render                Paint every frame through imgui_sw (default: build the draw data, paint nothing)
+    --screenshot-every <n>  Save every n-th frame, implies --render (0, the default, saves nothing)
+    --screenshot <prefix>   Path prefix of the screenshots, the frame number and extension get appended (default: "screenshot_")
+    --format <png|ppm>      Screenshot format (default: png)
+    --threads <n>           Threads to paint with (default: one per core)
+    --realtime              Pace the frames to the wall clock instead of running as fast as possible
+    --time-scale <x>        Like --realtime, but time passes x times as fast (10 plays 10 minutes in one)
+    --pacing <path>         With --realtime/--time-scale: write frame time and jitter histograms into a file
+                            (main_precise_frame_pacing in the settings picks the pacing mode)
+    --seed <n>              Seed for the games' random numbers (default: 1, 0 picks a random one). Together with
+                            the virtual clock, the same input script plays out the same way every run
+    --summary <path>        Write a summary of the run (frame times, how the games went) into a file, so runs
+                            before and after a change can be compared
+    --startup-trace <path>  Write how long each stage of the startup took into a file (see capture/startup_trace.h)
+
+@format
+
+    The input script has one event per line, in the order they happen:
+
+        <when> <down|up> <key>      Presses/releases a key, named after ImGuiKey_ without the prefix
+                                    (LeftArrow, Enter, Escape, W, ...) or MouseLeft/MouseRight
+        <when> move <x> <y>         Moves the mouse to x, y (pixels)
+
+    <when> is a frame number (the first frame is 1), or a time since the start of the run on our
+    clock with an "ms" suffix (1500ms), fed in with the first frame that starts at or after it.
+    Games tick on the same clock, so a time also picks the game tick an event lands before.
+    Empty lines and lines starting with # are skipped. For example:
+
+        # select the first game, start it and move up a bit
+        10 move 118 104
+        11 down MouseLeft
+        12 up MouseLeft
+        ...
+        2000ms down W
+        3000ms up W
+
+    The summary has one "<key> <value>" line per value: seed, frames, fps, game_time_s, wall_time_s,
+    frame_ms_avg, frame_ms_p50, frame_ms_p99, frame_ms_max (real time spent on a frame) and one
+    "outcome <game>: <outcome>" line per game played
+*/
+
+#include "capture/latency_probe.h"
+#include "capture/startup_trace.h"
+#include "fpsmanager/fpsmanager.h"
+#include "imgui_wrappers/sw/sw.h"
+#include "imgui/imgui.h"
+#include "main.h"
+#include "misc/clock.h"
+#include "snd/snd.h"
+#include "util/util.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace retrogames
+{
+
+	// see snd/snd.h
+	snd_t* snd = nullptr;
+
+    // Variables
+	std::unique_ptr<imgui_wrapper_sw_t> imgui = nullptr;
+
+	// Command line options (see @usage above)
+	struct launch_options_t final
+	{
+
+		uint64_t frames = 0;
+
+		uint32_t fps = 0;
+
+		std::string input_path;
+
+		bool render = false;
+
+		uint64_t screenshot_every = 0;
+
+		std::string screenshot_prefix = "screenshot_";
+
+		std::string screenshot_extension = ".png";
+
+		int threads = 0;
+
+		bool realtime = false;
+
+		double time_scale = 0.;
+
+		std::string pacing_path;
+
+		uint32_t seed = 1;
+
+		std::string summary_path;
+
+		std::string startup_trace_path;
+
+	};
+
+	// A line of the input script
+	struct input_event_t final
+	{
+
+		enum class type_e
+		{
+
+			KEY,
+			MOUSE_BUTTON,
+			MOUSE_MOVE
+
+		};
+
+		// When it happens: the frame, or the time since the start if @timed
+		uint64_t frame;
+
+		bool timed;
+
+		std::chrono::nanoseconds time;
+
+		type_e type;
+
+		bool down;
+
+		// The ImGuiKey or mouse button
+		int key;
+
+		ImVec2 mouse_pos;
+
+	};
+
+	// ImGuiKey_ names as the input script writes them
+	static const char* key_names[ImGuiKey_COUNT] =
+	{
+		"Tab", "LeftArrow", "RightArrow", "UpArrow", "DownArrow", "PageUp", "PageDown", "Home", "End", "Insert",
+		"Delete", "Backspace", "Space", "Enter", "Escape", "KeyPadEnter", "A", "C", "D", "S", "V", "W", "X", "Y", "Z"
+	};
+
+    /*
+    @brief
+
+        Main entry point of our program (within the retrogames namespace)
+    */
+   	void main(const launch_options_t& options);
+
+	/*
+	@brief
+
+		Parses the command line, returns false on invalid arguments
+	*/
+	static bool parse_launch_options(int argc, char** argv, launch_options_t& options)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			auto has_value = i + 1 < argc;
+
+			if (strcmp(argv[i], "--frames") == 0 && has_value) options.frames = strtoull(argv[++i], nullptr, 10);
+			else if (strcmp(argv[i], "--fps") == 0 && has_value) options.fps = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+			else if (strcmp(argv[i], "--input") == 0 && has_value) options.input_path = argv[++i];
+			else if (strcmp(argv[i], "--render") == 0) options.render = true;
+			else if (strcmp(argv[i], "--screenshot-every") == 0 && has_value) options.screenshot_every = strtoull(argv[++i], nullptr, 10);
+			else if (strcmp(argv[i], "--screenshot") == 0 && has_value) options.screenshot_prefix = argv[++i];
+			else if (strcmp(argv[i], "--format") == 0 && has_value) options.screenshot_extension = std::string(".") + argv[++i];
+			else if (strcmp(argv[i], "--threads") == 0 && has_value) options.threads = atoi(argv[++i]);
+			else if (strcmp(argv[i], "--realtime") == 0) options.realtime = true;
+			else if (strcmp(argv[i], "--time-scale") == 0 && has_value) options.time_scale = atof(argv[++i]);
+			else if (strcmp(argv[i], "--pacing") == 0 && has_value) options.pacing_path = argv[++i];
+			else if (strcmp(argv[i], "--seed") == 0 && has_value) options.seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+			else if (strcmp(argv[i], "--summary") == 0 && has_value) options.summary_path = argv[++i];
+			else if (strcmp(argv[i], "--startup-trace") == 0 && has_value) options.startup_trace_path = argv[++i];
+			else
+			{
+				fprintf(stderr, "Unknown or incomplete argument: %s\n", argv[i]);
+
+				return false;
+			}
+		}
+
+		if (options.screenshot_extension != ".png" && options.screenshot_extension != ".ppm")
+		{
+			fprintf(stderr, "Unsupported screenshot format: %s\n", options.screenshot_extension.c_str() + 1);
+
+			return false;
+		}
+
+		if (options.time_scale < 0.)
+		{
+			fprintf(stderr, "The time scale can't be negative\n");
+
+			return false;
+		}
+
+		// Screenshots need something to show
+		if (options.screenshot_every != 0) options.render = true;
+
+		return true;
+	}
+
+	/*
+	@brief
+
+		Reads the input script at @path (see @format above)
+	*/
+	static bool load_input_script(const std::string& path, std::vector<input_event_t>& events, std::string* error)
+	{
+		std::ifstream file(path);
+
+		if (!file)
+		{
+			if (error) *error = "Failed to open input script " + path;
+
+			return false;
+		}
+
+		std::string line;
+
+		for (uint32_t line_number = 1; std::getline(file, line); line_number++)
+		{
+			std::istringstream stream(line);
+
+			std::string when, action, key_name;
+
+			input_event_t event;
+
+			// Skip empty lines and comments
+			stream >> std::ws;
+
+			if (stream.peek() == EOF || stream.peek() == '#') continue;
+
+			auto where = path + ":" + std::to_string(line_number) + ": ";
+
+			if (!(stream >> when >> action))
+			{
+				if (error) *error = where + "expected \"<when> <down|up|move> ...\"";
+
+				return false;
+			}
+
+			// A frame, or a time in ms
+			char* end = nullptr;
+
+			event.timed = when.size() > 2 && when.compare(when.size() - 2, 2, "ms") == 0;
+			event.frame = 0;
+			event.time = std::chrono::nanoseconds(0);
+
+			if (event.timed) event.time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double, std::milli>(strtod(when.c_str(), &end)));
+			else event.frame = strtoull(when.c_str(), &end, 10);
+
+			if (end != when.c_str() + when.size() - (event.timed ? 2 : 0))
+			{
+				if (error) *error = where + "expected a frame or a time in ms, got " + when;
+
+				return false;
+			}
+
+			if (action == "move")
+			{
+				event.type = input_event_t::type_e::MOUSE_MOVE;
+
+				if (!(stream >> event.mouse_pos.x >> event.mouse_pos.y))
+				{
+					if (error) *error = where + "expected \"<when> move <x> <y>\"";
+
+					return false;
+				}
+			}
+			else if (action == "down" || action == "up")
+			{
+				if (!(stream >> key_name))
+				{
+					if (error) *error = where + "expected \"<when> <down|up> <key>\"";
+
+					return false;
+				}
+
+				event.down = action == "down";
+				event.type = input_event_t::type_e::KEY;
+				event.key = ImGuiKey_COUNT;
+
+				for (int key = 0; key < ImGuiKey_COUNT; key++) if (key_name == key_names[key]) event.key = key;
+
+				if (key_name == "MouseLeft" || key_name == "MouseRight")
+				{
+					event.type = input_event_t::type_e::MOUSE_BUTTON;
+					event.key = key_name == "MouseLeft" ? 0 : 1;
+				}
+				else if (event.key == ImGuiKey_COUNT)
+				{
+					if (error) *error = where + "unknown key " + key_name;
+
+					return false;
+				}
+			}
+			else
+			{
+				if (error) *error = where + "unknown event " + action;
+
+				return false;
+			}
+
+			// Events fire in the order of the script, frames and times can't go back within their kind
+			auto previous = std::find_if(events.rbegin(), events.rend(), [&event](const input_event_t& other) { return other.timed == event.timed; });
+
+			if (previous != events.rend() && (event.timed ? event.time < previous->time : event.frame < previous->frame))
+			{
+				if (error) *error = where + "events have to be in the order they happen";
+
+				return false;
+			}
+
+			events.push_back(event);
+		}
+
+		return true;
+	}
+
+	/*
+	@brief
+
+		Saves the current frame as a screenshot
+	*/
+	static void save_screenshot(const launch_options_t& options, uint64_t frame)
+	{
+		auto path = options.screenshot_prefix + std::to_string(frame) + options.screenshot_extension;
+
+		std::string error;
+
+		if (!imgui->save_screenshot(path, &error)) fprintf(stderr, "%s\n", error.c_str());
+	}
+
+}
+
+/*
+@brief
+
+    Main program entry point (Linux, headless)
+*/
+int main(int argc, char** argv)
+{
+	// The time to the first frame counts from here
+	retrogames::get_startup_trace();
+
+	retrogames::launch_options_t options;
+
+	if (!retrogames::parse_launch_options(argc, argv, options)) return 1;
+
+    retrogames::main(options);
+
+    return 0;
+}
+
+/*
+@brief
+
+    Main entry point of our program (within the retrogames namespace)
+*/
+void retrogames::main(const launch_options_t& options)
+{
+	auto& startup_trace = get_startup_trace();
+
+	// Load the sounds on a worker while we set up everything else (they don't get played anywhere,
+	// nothing needs them before the first frame)
+	snd_t _snd;
+
+	_snd.initialize_async();
+
+	snd = &_snd;
+
+	// Create and load our settings (never saved, a run shouldn't change the next one)
+	startup_trace_t::stage_t settings_stage(startup_trace, "settings");
+
+	settings_t settings("settings.json");
+
+	auto& main_settings = settings.get_main_settings();
+
+	settings_stage.end();
+
+	std::string error;
+
+	// Grab the input script
+	std::vector<input_event_t> input_events;
+
+	if (!options.input_path.empty() && !load_input_script(options.input_path, input_events, &error))
+	{
+		fprintf(stderr, "%s\n", error.c_str());
+
+		return;
+	}
+
+	auto fps = options.fps != 0 ? options.fps : main_settings.fps->get<uint32_t>();
+
+	// Initialize the imgui object
+	startup_trace_t::stage_t imgui_stage(startup_trace, "imgui");
+
+	imgui = std::make_unique<imgui_wrapper_sw_t>(&settings, main_settings.resolution_area);
+
+	if (!imgui->initialize(&error))
+	{
+        fprintf(stderr, (std::string("Failed to initialize ImGui. Terminating process.\n\nError: ") + error).c_str());
+
+		return;
+	}
+
+	imgui_stage.end();
+
+	if (options.threads > 0) imgui->get_sw_options().num_threads = options.threads;
+
+	// Everything keeps time with our clock from now on. By default every frame moves it by the
+	// same amount, however long the frame really took
+	std::unique_ptr<clock_source_t> clock;
+
+	virtual_clock_t* virtual_clock = nullptr;
+
+	if (options.time_scale > 0.) clock = std::make_unique<scaled_clock_t>(options.time_scale);
+	else if (options.realtime) clock = std::make_unique<real_clock_t>();
+	else clock.reset(virtual_clock = new virtual_clock_t());
+
+	set_clock(clock.get());
+
+	auto frame_step = fpsmanager_t::calculate_delay(static_cast<uint16_t>(fps));
+
+    // Create the fpsmanager object (if the clock moves by itself)
+	std::unique_ptr<fpsmanager_t> fpsmanager;
+
+	if (!virtual_clock) fpsmanager = std::make_unique<fpsmanager_t>(static_cast<uint16_t>(fps), main_settings.precise_frame_pacing->get<bool>());
+
+	// The games pick the same random numbers every run (unless we're asked not to)
+	util::set_random_seed(options.seed);
+
+	// initialize main functions
+	startup_trace_t::stage_t menu_stage(startup_trace, "menu");
+
+	main_initialize(&settings);
+
+	menu_stage.end();
+
+	// should we reset video settings?
+	bool reset_video_settings = false;
+
+	auto next_event = input_events.begin();
+
+	// How long the frames really took (10us buckets up to 100ms)
+	double total_frame_ms = 0., max_frame_ms = 0.;
+
+	pacing_histogram_t frame_times(std::chrono::microseconds(10), 10000);
+
+	auto start_time = std::chrono::steady_clock::now();
+	auto clock_start_time = clock->now();
+
+	uint64_t frame;
+
+    // Main loop
+	for (frame = 1; options.frames == 0 || frame <= options.frames; frame++)
+    {
+		auto frame_start = std::chrono::steady_clock::now();
+
+		// Feed in the input of this frame (imgui_sw maps every ImGuiKey to itself)
+		auto elapsed = clock->now() - clock_start_time;
+
+		for (auto& io = ImGui::GetIO(); next_event != input_events.end() && (next_event->timed ? next_event->time <= elapsed : next_event->frame <= frame); ++next_event)
+		{
+			switch (next_event->type)
+			{
+			case input_event_t::type_e::KEY:
+				io.KeysDown[next_event->key] = next_event->down;
+
+				get_latency_probe().stamp_event();
+
+				main_handle_key(next_event->down, next_event->key);
+
+				break;
+			case input_event_t::type_e::MOUSE_BUTTON:
+				io.MouseDown[next_event->key] = next_event->down;
+
+				break;
+			case input_event_t::type_e::MOUSE_MOVE:
+				io.MousePos = next_event->mouse_pos;
+
+				break;
+			}
+		}
+
+		// Begin the frame
+		imgui->begin_frame();
+
+		// Draw (there's always something to draw into, even if it doesn't get painted)
+		auto should_exit = main_frame(true, reset_video_settings);
+
+		// End the frame
+		imgui->end_frame(options.render, color_t(40, 40, 40));
+
+		// Inputs the frame shows are done (painted or not)
+		get_latency_probe().presented();
+
+		// The first frame is done, finish what it didn't need
+		if (frame == 1)
+		{
+			startup_trace.first_frame();
+
+			startup_trace_t::stage_t sounds_stage(startup_trace, "sounds_wait");
+
+			if (!_snd.wait())
+			{
+				fprintf(stderr, "Failed to initialize sound library\n");
+
+				break;
+			}
+
+			sounds_stage.end();
+
+			if (!options.startup_trace_path.empty())
+			{
+				printf("%s\n", startup_trace.get_summary().c_str());
+
+				if (!startup_trace.write(options.startup_trace_path, &error)) fprintf(stderr, "%s\n", error.c_str());
+			}
+		}
+
+		auto frame_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame_start).count();
+
+		total_frame_ms += frame_ms;
+
+		if (frame_ms > max_frame_ms) max_frame_ms = frame_ms;
+
+		frame_times.add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double, std::milli>(frame_ms)));
+
+		// Save screenshots if we should
+		if (options.screenshot_every != 0 && frame % options.screenshot_every == 0) save_screenshot(options, frame);
+
+		// Exit if we should
+		if (should_exit) break;
+
+		// On to the next frame's time
+		if (virtual_clock) virtual_clock->advance(frame_step);
+		else fpsmanager->run();
+
+		// Reset video mode if we should
+		if (reset_video_settings)
+		{
+			reset_video_settings = false;
+
+			if (!imgui->reinitialize(&error))
+			{
+				fprintf(stderr, (std::string("Failed to re-initialize ImGui. Exiting process.\n\nError: ") + error).c_str());
+
+				break;
+			}
+
+			// Tell anything else that the video mode changed
+			main_reset();
+
+			// Follow the new frame rate, unless it came from the command line
+			if (options.fps == 0)
+			{
+				fps = settings.get_main_settings().fps->get<uint32_t>();
+
+				frame_step = fpsmanager_t::calculate_delay(static_cast<uint16_t>(fps));
+
+				if (fpsmanager) fpsmanager.reset(new fpsmanager_t(static_cast<uint16_t>(fps), main_settings.precise_frame_pacing->get<bool>()));
+			}
+		}
+	}
+
+	auto frames = std::min(frame, options.frames != 0 ? options.frames : frame);
+	auto wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	auto clock_seconds = std::chrono::duration<double>(clock->now() - clock_start_time).count();
+
+	printf("frames: %llu, game time: %.3f s, wall time: %.3f s, frame time: %.3f ms avg, %.3f ms max\n",
+		static_cast<unsigned long long>(frames), clock_seconds, wall_seconds,
+		frames != 0 ? total_frame_ms / static_cast<double>(frames) : 0., max_frame_ms);
+
+	auto outcomes = main_get_outcomes();
+
+	for (const auto& outcome : outcomes) printf("outcome %s\n", outcome.c_str());
+
+	// Write the summary if we should
+	if (!options.summary_path.empty())
+	{
+		auto file = fopen(options.summary_path.c_str(), "w");
+
+		if (file != nullptr)
+		{
+			auto to_ms = [](std::chrono::nanoseconds duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+
+			fprintf(file, "seed %u\nframes %llu\nfps %u\ngame_time_s %.3f\nwall_time_s %.3f\n", options.seed, static_cast<unsigned long long>(frames), fps, clock_seconds, wall_seconds);
+			fprintf(file, "frame_ms_avg %.3f\nframe_ms_p50 %.3f\nframe_ms_p99 %.3f\nframe_ms_max %.3f\n",
+				frames != 0 ? total_frame_ms / static_cast<double>(frames) : 0.,
+				to_ms(frame_times.get_percentile(.5)), to_ms(frame_times.get_percentile(.99)), max_frame_ms);
+
+			for (const auto& outcome : outcomes) fprintf(file, "outcome %s\n", outcome.c_str());
+
+			fclose(file);
+		}
+		else
+		{
+			fprintf(stderr, "Failed to open %s for writing\n", options.summary_path.c_str());
+		}
+	}
+
+	if (fpsmanager)
+	{
+		printf("%s\n", fpsmanager->get_summary().c_str());
+
+		if (!options.pacing_path.empty() && !fpsmanager->write_histograms(options.pacing_path, &error)) fprintf(stderr, "%s\n", error.c_str());
+	}
+
+	// Done, shut down ImGui
+	imgui->shutdown();
+
+	// Our clock is gone with us
+	set_clock(nullptr);
+}
+#endif
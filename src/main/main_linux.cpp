@@ -1,4 +1,4 @@
-#ifdef PLATFORM_LINUX
+#if defined(PLATFORM_LINUX) && !defined(LINUX_IMGUI_SOFTWARE_RENDERING)
 
 /*
 @file
@@ -8,9 +8,21 @@
 @purpose
 
     Main entry point for our program (Linux)
+
+@usage
+
+    --record <path>         Record ImGui's draw data of every frame into a file (replay it with tools/replay)
+    --video <path>          Record a video of every rendered frame (Y4M), with the sounds in a .wav next to it
+    --pacing <path>         Write frame time and jitter histograms into a file when exiting and print their summary (without vsync)
+    --startup-trace <path>  Write how long each stage of the startup took into a file (see capture/startup_trace.h)
 */
 
 #include <GLFW/glfw3.h>
+#include <cstring>
+#include "capture/drawdata_capture.h"
+#include "capture/latency_probe.h"
+#include "capture/startup_trace.h"
+#include "capture/video_capture.h"
 #include "misc/window.h"
 #include "fpsmanager/fpsmanager.h"
 #include "imgui_wrappers/glfw/glfw.h"
@@ -32,9 +44,12 @@ namespace retrogames
     /*
     @brief
 
-        Main entry point of our program (within the retrogames namespace)
+        Main entry point of our program (within the retrogames namespace), @record_path is empty
+        unless we should record the draw data, @video_path unless we should record a video,
+        @pacing_path unless we should write the frame pacing histograms, @startup_trace_path
+        unless we should write the startup trace
     */
-   	void main(void);
+   	void main(const std::string& record_path, const std::string& video_path, const std::string& pacing_path, const std::string& startup_trace_path);
 
 	/*
 	@brief
@@ -99,7 +114,12 @@ namespace retrogames
 
 		auto found_key = to_imgui_key(key);
 
-		if (found_key != static_cast<ImGuiKey>(ImGuiKey_COUNT)) main_handle_key(action == GLFW_PRESS, found_key);
+		if (found_key == static_cast<ImGuiKey>(ImGuiKey_COUNT)) return;
+
+		// The key's input latency starts counting when GLFW hands us the event
+		get_latency_probe().stamp_event();
+
+		main_handle_key(action == GLFW_PRESS, found_key);
 	}
 
 }
@@ -109,9 +129,28 @@ namespace retrogames
 
     Main program entry point (Linux)
 */
-int main(void)
+int main(int argc, char** argv)
 {
-    retrogames::main();
+	// The time to the first frame counts from here
+	retrogames::get_startup_trace();
+
+	std::string record_path, video_path, pacing_path, startup_trace_path;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) record_path = argv[++i];
+		else if (strcmp(argv[i], "--video") == 0 && i + 1 < argc) video_path = argv[++i];
+		else if (strcmp(argv[i], "--pacing") == 0 && i + 1 < argc) pacing_path = argv[++i];
+		else if (strcmp(argv[i], "--startup-trace") == 0 && i + 1 < argc) startup_trace_path = argv[++i];
+		else
+		{
+			fprintf(stderr, "Unknown or incomplete argument: %s\n", argv[i]);
+
+			return 1;
+		}
+	}
+
+    retrogames::main(record_path, video_path, pacing_path, startup_trace_path);
 
     return 0;
 }
@@ -121,25 +160,27 @@ int main(void)
 
     Main entry point of our program (within the retrogames namespace)
 */
-void retrogames::main(void)
+void retrogames::main(const std::string& record_path, const std::string& video_path, const std::string& pacing_path, const std::string& startup_trace_path)
 {
-	// Create and load our settings
-	settings_t settings("settings.json");
-
-	auto& main_settings = settings.get_main_settings();
+	auto& startup_trace = get_startup_trace();
 
-	// load the sound library
+	// Load the sound library on a worker while we create the window, the first frame doesn't need it
+	// (playing a sound waits for it)
 	snd_t _snd;
 
-	if (!_snd.initialize())
-	{
-		fprintf(stderr, "Failed to initialize sound library\n");
-
-		return;
-	}
+	_snd.initialize_async();
 
 	snd = &_snd;
 
+	// Create and load our settings
+	startup_trace_t::stage_t settings_stage(startup_trace, "settings");
+
+	settings_t settings("settings.json");
+
+	auto& main_settings = settings.get_main_settings();
+
+	settings_stage.end();
+
 	// Grab the main settings
 	auto vsync = main_settings.vsync->get<bool>();
 	auto fullscreen = main_settings.fullscreen->get<bool>();
@@ -151,6 +192,8 @@ void retrogames::main(void)
 	// Attempt to initialize GLFW
 	std::string error;
 
+	startup_trace_t::stage_t window_stage(startup_trace, "window");
+
 	if (!imgui->initialize(true, &error))
 	{
         fprintf(stderr, (std::string("Failed to initialize GLFW. Terminating process.\n\nError: ") + error).c_str());
@@ -158,7 +201,11 @@ void retrogames::main(void)
 		return;
 	}
 
+	window_stage.end();
+
 	// Attempt to initialize ImGui
+	startup_trace_t::stage_t imgui_stage(startup_trace, "imgui");
+
 	if (!imgui->initialize(false, &error))
 	{
         fprintf(stderr, (std::string("Failed to initialize ImGui. Terminating process.\n\nError: ") + error).c_str());
@@ -166,6 +213,8 @@ void retrogames::main(void)
 		return;
 	}
 
+	imgui_stage.end();
+
 	// Listen for focus events so we know if our window is focused or not
 	glfw_window = imgui->get_glfw_window();
 
@@ -176,24 +225,99 @@ void retrogames::main(void)
 	// Also set the key callback so we can listen for keys
 	previous_key_callback = glfwSetKeyCallback(glfw_window, glfw_key_callback);
 
+	// Record the draw data if we should
+	std::unique_ptr<drawdata_recorder_t> recorder;
+
+	if (!record_path.empty())
+	{
+		recorder = std::make_unique<drawdata_recorder_t>();
+
+		if (!recorder->open(record_path, &error))
+		{
+			fprintf(stderr, "%s\n", error.c_str());
+
+			return;
+		}
+	}
+
+	// Record a video if we should (the sounds we play go into its audio track)
+	std::unique_ptr<video_recorder_t> video_recorder;
+
+	if (!video_path.empty())
+	{
+		// The video's audio track needs the sounds right away
+		if (!_snd.wait())
+		{
+			fprintf(stderr, "Failed to initialize sound library\n");
+
+			return;
+		}
+
+		video_recorder = std::make_unique<video_recorder_t>();
+
+		for (uint32_t i = 0; i < static_cast<uint32_t>(snd_t::sounds_e::SOUND_SIZE); i++)
+		{
+			auto& file = snd->get_sound_file(static_cast<snd_t::sounds_e>(i));
+
+			video_recorder->set_sound(i, file.second, file.first);
+		}
+
+		int width, height;
+
+		glfwGetFramebufferSize(glfw_window, &width, &height);
+
+		// With vsync we run at the monitor's refresh rate
+		auto video_fps = vsync ? static_cast<uint32_t>(glfwGetVideoMode(glfwGetPrimaryMonitor())->refreshRate) : fps;
+
+		if (!video_recorder->open(video_path, video_fps, width, height, &error))
+		{
+			fprintf(stderr, "%s\n", error.c_str());
+
+			return;
+		}
+
+		snd->set_play_listener([&video_recorder](snd_t::sounds_e sound, float volume) { video_recorder->play_sound(static_cast<uint32_t>(sound), volume); });
+
+		imgui->set_video_recorder(video_recorder.get());
+	}
+
     // Create the fpsmanager object (if vsync is disabled)
 	std::unique_ptr<fpsmanager_t> fpsmanager;
 
 	static bool vsync_enabled = vsync;
 
-	if (!vsync_enabled) fpsmanager = std::make_unique<fpsmanager_t>(static_cast<uint16_t>(fps));
+	if (!vsync_enabled) fpsmanager = std::make_unique<fpsmanager_t>(static_cast<uint16_t>(fps), main_settings.precise_frame_pacing->get<bool>());
 
 	// initialize main functions
+	startup_trace_t::stage_t menu_stage(startup_trace, "menu");
+
 	main_initialize(&settings);
 
+	menu_stage.end();
+
+	// Let anything interrupt our wait for input when it needs a frame (see main_wake)
+	main_set_wake_callback(&imgui_wrapper_glfw_t::wake);
+
 	// should we reset video settings?
 	bool reset_video_settings = false;
 
+	// set once the first frame is on the screen
+	bool startup_done = false;
+
     // Main loop
     while (!imgui->should_close())
     {
-        // Poll window events
-		imgui->poll_events();
+        // Poll window events, or wait for them if nothing is animating (an untouched main menu
+		// doesn't need to be drawn until input arrives). In the background (unfocused or minimized)
+		// we only run a few frames a second, waiting for events in between. Videos need every frame
+		// to keep their timing
+		auto background = !video_recorder && (!window_focused || glfwGetWindowAttrib(glfw_window, GLFW_ICONIFIED));
+		double idle_timeout = 0.;
+		auto waited = background || (!video_recorder && main_should_idle(idle_timeout));
+
+		if (background) imgui->wait_events(main_get_background_timeout());
+		else if (waited) imgui->wait_events(idle_timeout);
+		else imgui->poll_events();
 
 		// Begin the frame
 		auto render = imgui->begin_frame();
@@ -205,11 +329,55 @@ void retrogames::main(void)
 		// End the frame
 		imgui->end_frame(should_render, color_t(40, 40, 40));
 
+		// The frame got swapped, inputs it shows made it to the screen
+		get_latency_probe().presented();
+
+		// The first frame is on the screen, finish what it didn't need
+		if (!startup_done)
+		{
+			startup_done = true;
+
+			startup_trace.first_frame();
+
+			startup_trace_t::stage_t sounds_stage(startup_trace, "sounds_wait");
+
+			if (!_snd.wait())
+			{
+				fprintf(stderr, "Failed to initialize sound library\n");
+
+				break;
+			}
+
+			sounds_stage.end();
+
+			if (!startup_trace_path.empty())
+			{
+				printf("%s\n", startup_trace.get_summary().c_str());
+
+				if (!startup_trace.write(startup_trace_path, &error)) fprintf(stderr, "%s\n", error.c_str());
+			}
+		}
+
+		// Record what we've just rendered
+		if (recorder && should_render) recorder->record(ImGui::GetDrawData());
+
 		// Exit if we should
 		if (should_exit) break;
 
-		// Limit our FPS
-		if (!vsync_enabled) fpsmanager->run();
+		// Limit our FPS. Waiting for events (in the background, or an idle menu waiting up to a minute)
+		// already did, start pacing over after it so the wait doesn't count as missed frames
+		if (!vsync_enabled)
+		{
+			if (waited)
+			{
+				fpsmanager->reset();
+			}
+			else
+			{
+				fpsmanager->set_precise(main_settings.precise_frame_pacing->get<bool>());
+				fpsmanager->run();
+			}
+		}
 
 		// Reset video mode if we should
 		if (reset_video_settings)
@@ -231,8 +399,11 @@ void retrogames::main(void)
 
 			window_focused = glfwGetWindowAttrib(glfw_window, GLFW_FOCUSED);
 
-			// Also set the key callback so we can listen for keys
-			previous_key_callback = glfwSetKeyCallback(glfw_window, glfw_key_callback);
+			// Also set the key callback so we can listen for keys. The video mode usually changes on the
+			// window we already hooked, don't make our callback its own previous callback then
+			auto key_callback = glfwSetKeyCallback(glfw_window, glfw_key_callback);
+
+			if (key_callback != glfw_key_callback) previous_key_callback = key_callback;
 
 			// Tell anything else that the video mode changed
 			main_reset();
@@ -248,18 +419,29 @@ void retrogames::main(void)
 			}
 			else if (!vsync_enabled && old_vsync_enabled)
 			{
-				fpsmanager.reset(new fpsmanager_t(static_cast<uint16_t>(settings.get_main_settings().fps->get<uint32_t>())));
+				fpsmanager.reset(new fpsmanager_t(static_cast<uint16_t>(settings.get_main_settings().fps->get<uint32_t>()), settings.get_main_settings().precise_frame_pacing->get<bool>()));
 			}
 			else if (!vsync_enabled)
 			{
-				fpsmanager.reset(new fpsmanager_t(static_cast<uint16_t>(settings.get_main_settings().fps->get<uint32_t>())));
+				fpsmanager.reset(new fpsmanager_t(static_cast<uint16_t>(settings.get_main_settings().fps->get<uint32_t>()), settings.get_main_settings().precise_frame_pacing->get<bool>()));
 			}
 		}
 	}
 
-	// Thread finished, shut down ImGui and GLFW
+	// Tell how well we kept the framerate (only when asked to with --pacing)
+	if (fpsmanager && !pacing_path.empty())
+	{
+		printf("%s\n", fpsmanager->get_summary().c_str());
+
+		if (!fpsmanager->write_histograms(pacing_path, &error)) fprintf(stderr, "%s\n", error.c_str());
+	}
+
+	// Thread finished, shut down ImGui and GLFW (hands the last frames to the video recorder)
 	imgui->shutdown();
 
+	// Write the rest of the video
+	if (video_recorder && !video_recorder->close(&error)) fprintf(stderr, "%s\n", error.c_str());
+
 	// Save our settings
 	settings.save();
 }
@@ -0,0 +1,381 @@
+#if defined(PLATFORM_LINUX) && defined(LINUX_IMGUI_SOFTWARE_RENDERING) && !defined(PLATFORM_HEADLESS)
+
+/*
+@file
+
+    main_linux_sw.cpp
+
+@purpose
+
+    Main entry point for our program (Linux, software rendering without a window)
+
+@usage
+
+    --frames <n>            Exit after n frames (0, the default, runs until the program exits itself)
+    --screenshot-every <n>  Save every n-th frame (0, the default, only saves the last frame when --frames is set)
+    --screenshot <prefix>   Path prefix of the screenshots, the frame number and extension get appended (default: "screenshot_")
+    --format <png|ppm>      Screenshot format (default: png)
+    --threads <n>           Threads to paint with (default: one per core)
+    --unlimited             Don't limit the framerate (for profiling)
+    --pacing <path>         Write frame time and jitter histograms into a file when exiting and print their summary
+    --render-budget <ms>    Lower the resolution of game layers when painting takes longer than this (default: 0, off)
+    --upscale <bilinear|nearest>  How game layers painted at a lower resolution get upscaled (default: bilinear)
+    --record <path>         Record ImGui's draw data of every frame into a file (replay it with tools/replay)
+    --video <path>          Record a video of every painted frame (Y4M), with the sounds in a .wav next to it
+    --startup-trace <path>  Write how long each stage of the startup took into a file (see capture/startup_trace.h)
+*/
+
+#include "capture/drawdata_capture.h"
+#include "capture/latency_probe.h"
+#include "capture/startup_trace.h"
+#include "capture/video_capture.h"
+#include "fpsmanager/fpsmanager.h"
+#include "imgui_wrappers/sw/sw.h"
+#include "imgui/imgui.h"
+#include "main.h"
+#include "snd/snd.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace retrogames
+{
+
+	// see snd/snd.h
+	snd_t* snd = nullptr;
+
+    // Variables
+	std::unique_ptr<imgui_wrapper_sw_t> imgui = nullptr;
+
+	// Command line options (see @usage above)
+	struct launch_options_t final
+	{
+
+		uint64_t frames = 0;
+
+		uint64_t screenshot_every = 0;
+
+		std::string screenshot_prefix = "screenshot_";
+
+		std::string screenshot_extension = ".png";
+
+		int threads = 0;
+
+		bool unlimited = false;
+
+		double render_budget_ms = 0.;
+
+		bool nearest_upscale = false;
+
+		std::string record_path;
+
+		std::string video_path;
+
+		std::string pacing_path;
+
+		std::string startup_trace_path;
+
+	};
+
+    /*
+    @brief
+
+        Main entry point of our program (within the retrogames namespace)
+    */
+   	void main(const launch_options_t& options);
+
+	/*
+	@brief
+
+		Parses the command line, returns false on invalid arguments
+	*/
+	static bool parse_launch_options(int argc, char** argv, launch_options_t& options)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			auto has_value = i + 1 < argc;
+
+			if (strcmp(argv[i], "--frames") == 0 && has_value) options.frames = strtoull(argv[++i], nullptr, 10);
+			else if (strcmp(argv[i], "--screenshot-every") == 0 && has_value) options.screenshot_every = strtoull(argv[++i], nullptr, 10);
+			else if (strcmp(argv[i], "--screenshot") == 0 && has_value) options.screenshot_prefix = argv[++i];
+			else if (strcmp(argv[i], "--format") == 0 && has_value) options.screenshot_extension = std::string(".") + argv[++i];
+			else if (strcmp(argv[i], "--threads") == 0 && has_value) options.threads = atoi(argv[++i]);
+			else if (strcmp(argv[i], "--unlimited") == 0) options.unlimited = true;
+			else if (strcmp(argv[i], "--render-budget") == 0 && has_value) options.render_budget_ms = atof(argv[++i]);
+			else if (strcmp(argv[i], "--upscale") == 0 && has_value) options.nearest_upscale = strcmp(argv[++i], "nearest") == 0;
+			else if (strcmp(argv[i], "--record") == 0 && has_value) options.record_path = argv[++i];
+			else if (strcmp(argv[i], "--video") == 0 && has_value) options.video_path = argv[++i];
+			else if (strcmp(argv[i], "--pacing") == 0 && has_value) options.pacing_path = argv[++i];
+			else if (strcmp(argv[i], "--startup-trace") == 0 && has_value) options.startup_trace_path = argv[++i];
+			else
+			{
+				fprintf(stderr, "Unknown or incomplete argument: %s\n", argv[i]);
+
+				return false;
+			}
+		}
+
+		if (options.screenshot_extension != ".png" && options.screenshot_extension != ".ppm")
+		{
+			fprintf(stderr, "Unsupported screenshot format: %s\n", options.screenshot_extension.c_str() + 1);
+
+			return false;
+		}
+
+		return true;
+	}
+
+	/*
+	@brief
+
+		Saves the current frame as a screenshot
+	*/
+	static void save_screenshot(const launch_options_t& options, uint64_t frame)
+	{
+		auto path = options.screenshot_prefix + std::to_string(frame) + options.screenshot_extension;
+
+		std::string error;
+
+		if (!imgui->save_screenshot(path, &error)) fprintf(stderr, "%s\n", error.c_str());
+	}
+
+}
+
+/*
+@brief
+
+    Main program entry point (Linux, software rendering)
+*/
+int main(int argc, char** argv)
+{
+	// The time to the first frame counts from here
+	retrogames::get_startup_trace();
+
+	retrogames::launch_options_t options;
+
+	if (!retrogames::parse_launch_options(argc, argv, options)) return 1;
+
+    retrogames::main(options);
+
+    return 0;
+}
+
+/*
+@brief
+
+    Main entry point of our program (within the retrogames namespace)
+*/
+void retrogames::main(const launch_options_t& options)
+{
+	auto& startup_trace = get_startup_trace();
+
+	// Load the sound library on a worker while we set up everything else, the first frame doesn't need it
+	// (playing a sound waits for it)
+	snd_t _snd;
+
+	_snd.initialize_async();
+
+	snd = &_snd;
+
+	// Create and load our settings
+	startup_trace_t::stage_t settings_stage(startup_trace, "settings");
+
+	settings_t settings("settings.json");
+
+	auto& main_settings = settings.get_main_settings();
+
+	settings_stage.end();
+
+	// Grab the main settings (vsync doesn't mean anything without a display, so only the FPS limit is used)
+	auto fps = main_settings.fps->get<uint32_t>();
+
+	// Initialize the imgui object
+	startup_trace_t::stage_t imgui_stage(startup_trace, "imgui");
+
+	imgui = std::make_unique<imgui_wrapper_sw_t>(&settings, main_settings.resolution_area);
+
+	std::string error;
+
+	if (!imgui->initialize(&error))
+	{
+        fprintf(stderr, (std::string("Failed to initialize ImGui. Terminating process.\n\nError: ") + error).c_str());
+
+		return;
+	}
+
+	imgui_stage.end();
+
+	if (options.threads > 0) imgui->get_sw_options().num_threads = options.threads;
+
+	imgui->get_resolution_scaler().set_budget(options.render_budget_ms);
+
+	if (options.nearest_upscale) imgui->get_resolution_scaler().set_filter(imgui_sw::TextureFilter::Nearest);
+
+	// Record the draw data if we should
+	std::unique_ptr<drawdata_recorder_t> recorder;
+
+	if (!options.record_path.empty())
+	{
+		recorder = std::make_unique<drawdata_recorder_t>();
+
+		if (!recorder->open(options.record_path, &error))
+		{
+			fprintf(stderr, "%s\n", error.c_str());
+
+			return;
+		}
+	}
+
+	// Record a video if we should (the sounds we play go into its audio track)
+	std::unique_ptr<video_recorder_t> video_recorder;
+
+	if (!options.video_path.empty())
+	{
+		// The video's audio track needs the sounds right away
+		if (!_snd.wait())
+		{
+			fprintf(stderr, "Failed to initialize sound library\n");
+
+			return;
+		}
+
+		video_recorder = std::make_unique<video_recorder_t>();
+
+		for (uint32_t i = 0; i < static_cast<uint32_t>(snd_t::sounds_e::SOUND_SIZE); i++)
+		{
+			auto& file = snd->get_sound_file(static_cast<snd_t::sounds_e>(i));
+
+			video_recorder->set_sound(i, file.second, file.first);
+		}
+
+		auto& size = imgui->get_framebuffer_size();
+
+		if (!video_recorder->open(options.video_path, fps, static_cast<int>(size.width), static_cast<int>(size.height), &error))
+		{
+			fprintf(stderr, "%s\n", error.c_str());
+
+			return;
+		}
+
+		snd->set_play_listener([&video_recorder](snd_t::sounds_e sound, float volume) { video_recorder->play_sound(static_cast<uint32_t>(sound), volume); });
+	}
+
+    // Create the fpsmanager object (if we want to limit the framerate)
+	std::unique_ptr<fpsmanager_t> fpsmanager;
+
+	if (!options.unlimited) fpsmanager = std::make_unique<fpsmanager_t>(static_cast<uint16_t>(fps), main_settings.precise_frame_pacing->get<bool>());
+
+	// initialize main functions
+	startup_trace_t::stage_t menu_stage(startup_trace, "menu");
+
+	main_initialize(&settings);
+
+	menu_stage.end();
+
+	// should we reset video settings?
+	bool reset_video_settings = false;
+
+    // Main loop
+	for (uint64_t frame = 1; options.frames == 0 || frame <= options.frames; frame++)
+    {
+		// Begin the frame
+		auto should_render = imgui->begin_frame();
+
+		// Draw
+		auto should_exit = main_frame(should_render, reset_video_settings);
+
+		// End the frame
+		imgui->end_frame(should_render, color_t(40, 40, 40));
+
+		// The frame got painted, inputs it shows made it to the screen
+		get_latency_probe().presented();
+
+		// The first frame is done, finish what it didn't need
+		if (frame == 1)
+		{
+			startup_trace.first_frame();
+
+			startup_trace_t::stage_t sounds_stage(startup_trace, "sounds_wait");
+
+			if (!_snd.wait())
+			{
+				fprintf(stderr, "Failed to initialize sound library\n");
+
+				break;
+			}
+
+			sounds_stage.end();
+
+			if (!options.startup_trace_path.empty())
+			{
+				printf("%s\n", startup_trace.get_summary().c_str());
+
+				if (!startup_trace.write(options.startup_trace_path, &error)) fprintf(stderr, "%s\n", error.c_str());
+			}
+		}
+
+		// Record what we've just painted
+		if (recorder && should_render) recorder->record(ImGui::GetDrawData());
+
+		if (video_recorder && should_render)
+		{
+			auto& size = imgui->get_framebuffer_size();
+
+			video_recorder->add_frame(imgui->get_pixels().data(), static_cast<int>(size.width), static_cast<int>(size.height));
+		}
+
+		// Save screenshots if we should
+		if ((options.screenshot_every != 0 && frame % options.screenshot_every == 0) ||
+			(options.screenshot_every == 0 && options.frames != 0 && frame == options.frames))
+		{
+			save_screenshot(options, frame);
+		}
+
+		// Exit if we should
+		if (should_exit) break;
+
+		// Limit our FPS
+		if (fpsmanager)
+		{
+			fpsmanager->set_precise(main_settings.precise_frame_pacing->get<bool>());
+			fpsmanager->run();
+		}
+
+		// Reset video mode if we should
+		if (reset_video_settings)
+		{
+			reset_video_settings = false;
+
+			if (!imgui->reinitialize(&error))
+			{
+				fprintf(stderr, (std::string("Failed to re-initialize ImGui. Exiting process.\n\nError: ") + error).c_str());
+
+				break;
+			}
+
+			// Tell anything else that the video mode changed
+			main_reset();
+
+			// Reset the FPS manager
+			if (fpsmanager) fpsmanager.reset(new fpsmanager_t(static_cast<uint16_t>(settings.get_main_settings().fps->get<uint32_t>()), main_settings.precise_frame_pacing->get<bool>()));
+		}
+	}
+
+	// Tell how well we kept the framerate (only when asked to with --pacing)
+	if (fpsmanager && !options.pacing_path.empty())
+	{
+		printf("%s\n", fpsmanager->get_summary().c_str());
+
+		if (!fpsmanager->write_histograms(options.pacing_path, &error)) fprintf(stderr, "%s\n", error.c_str());
+	}
+
+	// Done, shut down ImGui
+	imgui->shutdown();
+
+	// Write the rest of the video
+	if (video_recorder && !video_recorder->close(&error)) fprintf(stderr, "%s\n", error.c_str());
+
+	// Save our settings
+	settings.save();
+}
+#endif
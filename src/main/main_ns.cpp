@@ -14,6 +14,7 @@
 #include <sys/stat.h>
 #include <string>
 #include <unordered_map>
+#include "capture/latency_probe.h"
 #include "fpsmanager/fpsmanager.h"
 #include "imgui_wrappers/ns/ns.h"
 #include "imgui/imgui.h"
@@ -272,6 +273,9 @@ void retrogames::main(void)
 		// End the frame
 		imgui->end_frame(true, color_t(40, 40, 40));
 
+		// The frame got swapped, inputs it shows made it to the screen
+		get_latency_probe().presented();
+
 		// Exit if we should (if game::draw returns true)
 		if (should_exit) break;
     }
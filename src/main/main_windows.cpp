@@ -14,6 +14,8 @@
 #include <unordered_map>
 #include "misc/settings.h"
 #include "misc/window.h"
+#include "capture/latency_probe.h"
+#include "capture/startup_trace.h"
 #include "fpsmanager/fpsmanager.h"
 #include "imgui_wrappers/dx9/dx9.h"
 #include "imgui/imgui.h"
@@ -124,7 +126,13 @@ LRESULT CALLBACK retrogames::window_procedure(HWND hwnd, UINT msg, WPARAM wparam
 			{
 				auto found_key = to_imgui_key(wparam);
 
-				if (found_key != static_cast<ImGuiKey>(ImGuiKey_COUNT)) main_handle_key(msg == WM_KEYDOWN, found_key);
+				if (found_key != static_cast<ImGuiKey>(ImGuiKey_COUNT))
+				{
+					// The key's input latency starts counting when we get the message
+					get_latency_probe().stamp_event();
+
+					main_handle_key(msg == WM_KEYDOWN, found_key);
+				}
 			}
 
 			break;
@@ -146,6 +154,9 @@ LRESULT CALLBACK retrogames::window_procedure(HWND hwnd, UINT msg, WPARAM wparam
 */
 INT WINAPI WinMain(HINSTANCE,HINSTANCE,char*,int)
 {
+    // the time to the first frame counts from here
+    retrogames::get_startup_trace();
+
     retrogames::main();
 
     return 0;
@@ -158,23 +169,25 @@ INT WINAPI WinMain(HINSTANCE,HINSTANCE,char*,int)
 */
 void retrogames::main(void)
 {
-	// create and load our settings
-	settings_t settings("settings.json");
-
-	auto& main_settings = settings.get_main_settings();
+	auto& startup_trace = get_startup_trace();
 
-	// load the sound library
+	// load the sound library on a worker while we create the window, the first frame doesn't need it
+	// (playing a sound waits for it)
 	snd_t _snd;
 
-	if (!_snd.initialize())
-	{
-		MessageBoxA(nullptr, "Failed to initialize sound library", "cpp-retro-games", MB_ICONERROR | MB_SETFOREGROUND);
-
-		return;
-	}
+	_snd.initialize_async();
 
 	snd = &_snd;
 
+	// create and load our settings
+	startup_trace_t::stage_t settings_stage(startup_trace, "settings");
+
+	settings_t settings("settings.json");
+
+	auto& main_settings = settings.get_main_settings();
+
+	settings_stage.end();
+
 	// grab the wanted resolution from our settings
 	auto resolution = main_settings.resolution_area;
 
@@ -189,6 +202,8 @@ void retrogames::main(void)
 	// attempt to initialize DirectX
 	std::string error;
 
+	startup_trace_t::stage_t window_stage(startup_trace, "window");
+
 	if (!imgui->initialize(true, &error, window_procedure))
 	{
 		MessageBoxA(nullptr, (std::string("Failed to initialize DirectX9. Terminating process.\n\nError: ") + error).c_str(), "cpp-retro-games", MB_ICONERROR | MB_SETFOREGROUND);
@@ -196,7 +211,11 @@ void retrogames::main(void)
 		return;
 	}
 
+	window_stage.end();
+
 	// attempt to initialize ImGui
+	startup_trace_t::stage_t imgui_stage(startup_trace, "imgui");
+
 	if (!imgui->initialize(false, &error))
 	{
 		MessageBoxA(nullptr, (std::string("Failed to initialize DirectX. Terminating process.\n\nError: ") + error).c_str(), "cpp-retro-games", MB_ICONERROR | MB_SETFOREGROUND);
@@ -204,6 +223,8 @@ void retrogames::main(void)
 		return;
 	}
 
+	imgui_stage.end();
+
 	// initialize our textures
 	/*textures_t _textures;
 
@@ -227,14 +248,21 @@ void retrogames::main(void)
 
 	static bool vsync_enabled = vsync;
 
-	if (!vsync_enabled) fpsmanager = std::make_unique<fpsmanager_t>(static_cast<uint16_t>(fps));
+	if (!vsync_enabled) fpsmanager = std::make_unique<fpsmanager_t>(static_cast<uint16_t>(fps), settings.get_main_settings().precise_frame_pacing->get<bool>());
 
 	// call the main initialize function
+	startup_trace_t::stage_t menu_stage(startup_trace, "menu");
+
 	main_initialize(&settings);
 
+	menu_stage.end();
+
 	// this will be true if we changed video settings
 	bool reset_video_settings = false;
 
+	// set once the first frame is on the screen
+	bool startup_done = false;
+
 	// start our main loop
 	MSG msg{};
 
@@ -249,21 +277,56 @@ void retrogames::main(void)
 			continue;
 		}
 
+		// in the background (unfocused or minimized) we only run a few frames a second
+		auto background = !window->is_in_foreground() || IsIconic(window->get_handle());
+
 		// begin the frame
 		auto render = imgui->begin_frame();
 
 		// draw
-		auto should_render = render && window->is_in_foreground();
+		auto should_render = render && !background;
 		auto should_exit = main_frame(should_render, reset_video_settings);
 
 		// end the frame
 		imgui->end_frame(should_render, color_t(40, 40, 40));
 
+		// the frame got presented, inputs it shows made it to the screen
+		get_latency_probe().presented();
+
+		// the first frame is on the screen, finish what it didn't need
+		if (!startup_done)
+		{
+			startup_done = true;
+
+			startup_trace.first_frame();
+
+			startup_trace_t::stage_t sounds_stage(startup_trace, "sounds_wait");
+
+			if (!_snd.wait())
+			{
+				MessageBoxA(nullptr, "Failed to initialize sound library", "cpp-retro-games", MB_ICONERROR | MB_SETFOREGROUND);
+
+				break;
+			}
+		}
+
 		// exit if we should (if main_frame returns true)
 		if (should_exit) break;
 
+		// in the background, sleep until a message arrives or the next slow frame is due
+		// (instead of limiting our FPS, start pacing over once we're back)
+		if (background)
+		{
+			MsgWaitForMultipleObjects(0, nullptr, FALSE, static_cast<DWORD>(main_get_background_timeout() * 1000.), QS_ALLINPUT);
+
+			if (fpsmanager) fpsmanager->reset();
+		}
 		// limit our FPS
-		if (!vsync_enabled) fpsmanager->run();
+		else if (!vsync_enabled)
+		{
+			fpsmanager->set_precise(settings.get_main_settings().precise_frame_pacing->get<bool>());
+			fpsmanager->run();
+		}
 
 		// reset video mode if we should
 		if (reset_video_settings)
@@ -302,11 +365,11 @@ void retrogames::main(void)
 			}
 			else if (!vsync_enabled && old_vsync_enabled)
 			{
-				fpsmanager.reset(new fpsmanager_t(static_cast<uint16_t>(settings.get_main_settings().fps->get<uint32_t>())));
+				fpsmanager.reset(new fpsmanager_t(static_cast<uint16_t>(settings.get_main_settings().fps->get<uint32_t>()), settings.get_main_settings().precise_frame_pacing->get<bool>()));
 			}
 			else if (!vsync_enabled)
 			{
-				fpsmanager.reset(new fpsmanager_t(static_cast<uint16_t>(settings.get_main_settings().fps->get<uint32_t>())));
+				fpsmanager.reset(new fpsmanager_t(static_cast<uint16_t>(settings.get_main_settings().fps->get<uint32_t>()), settings.get_main_settings().precise_frame_pacing->get<bool>()));
 			}
 		}
 	}
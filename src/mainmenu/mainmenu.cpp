@@ -12,6 +12,10 @@
 #include <stdio.h>
 #include "mainmenu.h"
 #include "imgui/imgui.h"
+#include "imgui/imgui_internal.h"
+#include "capture/latency_probe.h"
+#include "capture/startup_trace.h"
+#include "misc/clock.h"
 #include "misc/macros.h"
 #include "misc/settings.h"
 #include "imgui/imgui_user.h"
@@ -56,52 +60,65 @@ void retrogames::mainmenu_t::initialize(settings_t* settings)
     // Save a pointer to the settings
     this->settings = settings;
 
-    // Add any ImGui fonts we may need
+#ifndef PLATFORM_EMSCRIPTEN
+    // Cache baked font atlases next to the settings
+    auto& settings_path = settings->get_path();
+
+    font_service.set_cache_path(settings_path.substr(0, settings_path.find_last_of("/\\") + 1) + "fonts.cache");
+#endif
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_EMSCRIPTEN)
+    // The OpenGL 3 and software renderers draw distance field fonts, so one atlas serves every resolution
+    font_service.set_distance_field(true);
+#endif
+
+    // Request any ImGui fonts we may need
     create_fonts();
 
     // Create the games manager
-    games_manager = std::make_unique<games_manager_t>(settings, &default_font_small, &default_font_mid, &default_font_big);
+    games_manager = std::make_unique<games_manager_t>(settings, &font_service, default_font_small, default_font_mid, default_font_big);
 
     // Setup the ImGui style
     setup_style();
 
     // Here we add our games. Each game can have a pointer to it's icon,
     // version numbering, and name.
+    startup_trace_t::stage_t games_stage(get_startup_trace(), "games");
+
     games_manager->add_game<games::snake_t>("snake");
     games_manager->add_game<games::pingpong_t>("pingpong");
 
+    games_stage.end();
+
     selected_game_name = &settings->create("main_last_selected_game", "none");
 
     auto selected_game_name_str = selected_game_name->get<std::string>();
 
     selected_game = selected_game_name_str.compare("none") == 0 ? nullptr : games_manager->select_game(selected_game_name_str);
+
+    // The games requested their fonts while being added, build them all at once
+    startup_trace_t::stage_t fonts_stage(get_startup_trace(), "fonts");
+
+    font_service.build();
 }
 
 /*
 @brief
 
-    Creates needed fonts
+    Requests needed fonts (they get created by font_service.build())
 */
 void retrogames::mainmenu_t::create_fonts(void)
 {
-    auto& io = ImGui::GetIO();
-
-    ImFontConfig default_font_big_config;
-
-    default_font_big_config.SizePixels = std::ceil(static_cast<float>(settings->get_main_settings().resolution_area.height) / 25.f) * global_scaling;
-    default_font_big = io.Fonts->AddFontDefault(&default_font_big_config);
-
-    ImFontConfig default_font_small_config;
+    // The big one goes first, it's ImGui's default font
+    auto default_font_big_size = std::ceil(static_cast<float>(settings->get_main_settings().resolution_area.height) / 25.f) * global_scaling;
 
-    default_font_small_config.SizePixels = std::ceil(default_font_big_config.SizePixels * .5f);
-    default_font_small = io.Fonts->AddFontDefault(&default_font_small_config);
-
-    ImFontConfig default_font_mid_config;
-
-    default_font_mid_config.SizePixels = std::ceil(default_font_big_config.SizePixels * .75f);
-    default_font_mid = io.Fonts->AddFontDefault(&default_font_mid_config);
+    default_font_big = font_service.request("default_big", default_font_big_size);
+    default_font_small = font_service.request("default_small", std::ceil(default_font_big_size * .5f));
+    default_font_mid = font_service.request("default_mid", std::ceil(default_font_big_size * .75f));
 
 #if defined(PLATFORM_NS) && defined(NS_ENABLE_NXLINK)
+    auto& io = ImGui::GetIO();
+
     TRACE("Resolution area: %ux%u, displaysize: %.0fx%.0f", settings->get_main_settings().resolution_area.width, settings->get_main_settings().resolution_area.height, io.DisplaySize.x, io.DisplaySize.y);
 #endif
 }
@@ -123,6 +140,8 @@ void retrogames::mainmenu_t::reset(void)
 
         reset_game = false;
     }
+
+    font_service.build();
 }
 
 /*
@@ -158,6 +177,9 @@ void retrogames::mainmenu_t::setup_style(void)
 */
 bool retrogames::mainmenu_t::run(bool should_render, bool& reset_video_mode)
 {
+    // whatever animates this frame asks for the next one (see @get_idle_timeout)
+    next_frame_request = std::chrono::high_resolution_clock::time_point::max();
+
 #if defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
     // To check if any video settings changed
     struct video_settings_t final
@@ -272,6 +294,11 @@ bool retrogames::mainmenu_t::run(bool should_render, bool& reset_video_mode)
 
         if (!should_run_game)
         {
+            // Remember how it went, and log the session's input latency
+            if (selected_game != nullptr) outcomes.push_back(selected_game->get_information().name + ": " + selected_game->get_outcome());
+
+            get_latency_probe().end_session();
+
             // Reset video mode to original
             if (main_reset_video_settings)
             {
@@ -293,15 +320,18 @@ bool retrogames::mainmenu_t::run(bool should_render, bool& reset_video_mode)
 
             // Reset the game at least if the video mode doesn't change
             if (!main_reset_video_settings) selected_game->base_reset(settings, false);
+
+            // Measure the input latency while playing if wanted
+            if (settings->get_main_settings().latency_probe->get<bool>()) get_latency_probe().begin_session(selected_game->get_information().name);
         }
     }
 
     if (should_run_game)
     {
-        ImGui::PushFont(default_font_big);
+        ImGui::PushFont(*default_font_big);
 
         if (selected_game->base_draw(should_render)) game_running = false;
-        if (selected_game->is_paused() && should_render && selected_game->draw_pause_menu(default_font_big)) game_running = false;
+        if (selected_game->is_paused() && should_render && selected_game->draw_pause_menu(*default_font_big)) game_running = false;
 
         ImGui::PopFont();
 
@@ -321,15 +351,25 @@ bool retrogames::mainmenu_t::run(bool should_render, bool& reset_video_mode)
         {
             // Reset the game
             if (!main_reset_video_settings) selected_game->base_reset(settings, false);
+
+            // Measure the input latency while playing if wanted
+            if (settings->get_main_settings().latency_probe->get<bool>()) get_latency_probe().begin_session(selected_game->get_information().name);
+        }
+        else
+        {
+            // Remember how it went, and log the session's input latency
+            if (selected_game != nullptr) outcomes.push_back(selected_game->get_information().name + ": " + selected_game->get_outcome());
+
+            get_latency_probe().end_session();
         }
     }
 
     if (should_run_game)
     {
-        ImGui::PushFont(default_font_big);
+        ImGui::PushFont(*default_font_big);
 
         if (selected_game->base_draw(should_render)) game_running = false;
-        if (selected_game->is_paused() && selected_game->draw_pause_menu(default_font_big)) game_running = false;
+        if (selected_game->is_paused() && selected_game->draw_pause_menu(*default_font_big)) game_running = false;
 
         ImGui::PopFont();
 
@@ -465,18 +505,20 @@ bool retrogames::mainmenu_t::run(bool should_render, bool& reset_video_mode)
         static std::string last_notification; // To see if the notification message changed
         static constexpr float fade_time = .5f; // How many seconds it takes for the notification to fade in/out
 
+        auto now = get_clock().get_frame_time();
+
         if (last_notification.compare(current_notification) != 0)
         {
             // Notification changed
             if (last_notification.empty() && !current_notification.empty())
             {
                 // Notification has just been set
-                fade_start_time = std::chrono::high_resolution_clock::now();
+                fade_start_time = now;
             }
             else if (!current_notification.empty() && !last_notification.empty())
             {
                 // Notification text changed, don't fade in again
-                if (std::chrono::high_resolution_clock::now() - fade_start_time > std::chrono::milliseconds(static_cast<int64_t>(fade_time * 1000.f))) fade_start_time = std::chrono::high_resolution_clock::now() - std::chrono::milliseconds(static_cast<int64_t>(fade_time * 1000.f));
+                if (now - fade_start_time > std::chrono::milliseconds(static_cast<int64_t>(fade_time * 1000.f))) fade_start_time = now - std::chrono::milliseconds(static_cast<int64_t>(fade_time * 1000.f));
             }
 
             last_notification = current_notification;
@@ -485,7 +527,7 @@ bool retrogames::mainmenu_t::run(bool should_render, bool& reset_video_mode)
         else if (notification_modified)
         {
             // Notification recreated, don't fade in again
-            if (std::chrono::high_resolution_clock::now() - fade_start_time > std::chrono::milliseconds(static_cast<int64_t>(fade_time * 1000.f))) fade_start_time = std::chrono::high_resolution_clock::now() - std::chrono::milliseconds(static_cast<int64_t>(fade_time * 1000.f));
+            if (now - fade_start_time > std::chrono::milliseconds(static_cast<int64_t>(fade_time * 1000.f))) fade_start_time = now - std::chrono::milliseconds(static_cast<int64_t>(fade_time * 1000.f));
 
             notification_modified = false;
         }
@@ -494,7 +536,7 @@ bool retrogames::mainmenu_t::run(bool should_render, bool& reset_video_mode)
         if (current_notification.empty()) return;
 
         // Check if the time is over
-        if (std::chrono::high_resolution_clock::now() - fade_start_time >= std::chrono::seconds(notification_length))
+        if (now - fade_start_time >= std::chrono::seconds(notification_length))
         {
             current_notification.clear();
             last_notification.clear();
@@ -509,7 +551,18 @@ bool retrogames::mainmenu_t::run(bool should_render, bool& reset_video_mode)
         auto background_color = raw_background_color;
         auto text_color = raw_text_color;
         auto border_color = raw_border_color;
-        auto expired = std::chrono::high_resolution_clock::now() - fade_start_time;
+        auto expired = now - fade_start_time;
+
+        // keep drawing while we fade, and wake up for the fade out while we're fully visible
+        if (expired < std::chrono::milliseconds(static_cast<int64_t>(fade_time * 1000.f)) ||
+            expired > std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::seconds(notification_length)) - std::chrono::milliseconds(static_cast<int64_t>(fade_time * 1000.f)))
+        {
+            request_frame_at(now);
+        }
+        else
+        {
+            request_frame_at(fade_start_time + std::chrono::seconds(notification_length) - std::chrono::milliseconds(static_cast<int64_t>(fade_time * 1000.f)));
+        }
 
         if (expired < std::chrono::milliseconds(static_cast<int64_t>(fade_time * 1000.f)))
         {
@@ -539,9 +592,9 @@ bool retrogames::mainmenu_t::run(bool should_render, bool& reset_video_mode)
             border_color.w *= mult;
         }
 
-        ImGui::PushFont(default_font_small);
+        ImGui::PushFont(*default_font_small);
 
-        auto size = ImVec2{ImGui::CalcTextSize(current_notification.c_str()).x + ImGui::GetStyle().FramePadding.x * 2.f + ImGui::GetStyle().ItemSpacing.x,ImGui::GetFrameHeight() + ImGui::GetStyle().ItemSpacing.y * 2.f};
+        auto size = ImVec2{ImGuiUser::calc_text_size(current_notification.c_str()).x + ImGui::GetStyle().FramePadding.x * 2.f + ImGui::GetStyle().ItemSpacing.x,ImGui::GetFrameHeight() + ImGui::GetStyle().ItemSpacing.y * 2.f};
         auto pos = ImVec2{resolution_area.width * .5f - size.x * .5f, (resolution_area.height - indent_height * .5f) - size.y * .5f};
 
         ImGui::SetNextWindowPos(pos, ImGuiCond_Always);
@@ -580,7 +633,7 @@ bool retrogames::mainmenu_t::run(bool should_render, bool& reset_video_mode)
     ImGui::PushStyleColor(ImGuiCol_WindowBg, main_window_bg_color);
     ImGui::PushStyleColor(ImGuiCol_Border, {0.f,0.f,0.f,0.f});
     ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0.f);
-    ImGui::PushFont(default_font_big);
+    ImGui::PushFont(*default_font_big);
 
     if (ImGui::Begin("Menu selection", nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoBackground | ImGuiWindowFlags_NoMove))
     {
@@ -1103,6 +1156,7 @@ bool retrogames::mainmenu_t::run(bool should_render, bool& reset_video_mode)
                 ImGuiUser::toggle_button(settings->get_main_settings().draw_fps, "Draw FPS", "If enabled, the FPS will be drawn in games using the specified alignment.");
                 ImGuiUser::toggle_button(settings->get_main_settings().draw_frametime, "Draw frametime", "If enabled, the frametime (in ms) will be drawn in games using the specified alignment.");
                 ImGuiUser::toggle_button(settings->get_main_settings().draw_playtime, "Draw playtime", "If enabled, the playtime (hh:mm:ss:ms) will be drawn in games using the specified alignment.");
+                ImGuiUser::toggle_button(settings->get_main_settings().latency_probe, "Measure input latency", "If enabled, the time from pressing a key until the game shows its effect will be measured. Percentiles get drawn in games and written to latency.log when leaving them.");
 
                 // Combos
                 ImGui::Separator();
@@ -1176,9 +1230,11 @@ bool retrogames::mainmenu_t::run(bool should_render, bool& reset_video_mode)
 
                 ImGuiUser::toggle_button(settings->get_main_settings().fullscreen, "Fullscreen", "Turns on/off fullscreen video mode.");
                 ImGuiUser::toggle_button(settings->get_main_settings().vsync, "Vertical sync", "Turns on/off vertical sync. Reduces screen tearing, although framerate will be limited to the refresh rate of your monitor.");
+                ImGuiUser::toggle_button(settings->get_main_settings().precise_frame_pacing, "Precise frame pacing", "If enabled, frames will be started within microseconds of their time by spinning for the last bit of the wait. Costs a little CPU time, for high framerates without vertical sync.");
                 ImGuiUser::toggle_button(settings->get_main_settings().draw_fps, "Draw FPS", "If enabled, the FPS will be drawn in games using the specified alignment.");
                 ImGuiUser::toggle_button(settings->get_main_settings().draw_frametime, "Draw frametime", "If enabled, the frametime (in ms) will be drawn in games using the specified alignment.");
                 ImGuiUser::toggle_button(settings->get_main_settings().draw_playtime, "Draw playtime", "If enabled, the playtime (hh:mm:ss:ms) will be drawn in games using the specified alignment.");
+                ImGuiUser::toggle_button(settings->get_main_settings().latency_probe, "Measure input latency", "If enabled, the time from pressing a key until the game shows its effect will be measured. Percentiles get drawn in games and written to latency.log when leaving them.");
 
                 // Combos
                 ImGui::Separator();
@@ -1402,7 +1458,7 @@ bool retrogames::mainmenu_t::run(bool should_render, bool& reset_video_mode)
     draw_notification();
 
     // draw the time
-    ImGui::PushFont(default_font_small);
+    ImGui::PushFont(*default_font_small);
 
     time_t rawtime;
     tm* timeinfo;
@@ -1415,27 +1471,35 @@ bool retrogames::mainmenu_t::run(bool should_render, bool& reset_video_mode)
 
     strftime(datetime_buffer, 80, "%d/%m %I:%M%p", timeinfo);
 
+    // the time only shows minutes, so it only needs us to be drawn when the next one starts
+    request_frame_at(get_clock().get_frame_time() + std::chrono::seconds(60 - timeinfo->tm_sec));
+
     auto date_text_size = ImGui::CalcTextSize(datetime_buffer);
 
     ImGui::GetBackgroundDrawList()->AddText(ImVec2((resolution_area.width - indent_width * 2.f) - date_text_size.x, indent_height * .5f - ImGui::GetFontSize() * .5f), ImGui::GetColorU32({1.f,1.f,1.f,1.f}), datetime_buffer);
     ImGui::PopFont();
 
     // draw the currently selected item
-    ImGui::PushFont(default_font_big);
+    ImGui::PushFont(*default_font_big);
     ImGui::GetBackgroundDrawList()->AddText(ImVec2(indent_width * 2.f, indent_height * .5f - ImGui::GetFontSize() * .5f), ImGui::GetColorU32({1.f,1.f,1.f,1.f}), selection_names[static_cast<uint8_t>(selected_item)].c_str());
     ImGui::PopFont();
 
-    // lines at the top and bottom
+    // lines at the top and bottom (the indents scale with the resolution and rarely land on whole pixels,
+    // keep the lines one pixel sharp anyway), only for these two so anything drawn after them stays anti-aliased
+    auto background_flags = ImGui::GetBackgroundDrawList()->Flags;
+
+    ImGui::GetBackgroundDrawList()->Flags |= ImDrawListFlags_CrispLines;
     ImGui::GetBackgroundDrawList()->AddLine(ImVec2(indent_width, indent_height), ImVec2(resolution_area.width - indent_width, indent_height), ImGui::GetColorU32({1.f, 1.f, 1.f, 1.f}));
     ImGui::GetBackgroundDrawList()->AddLine(ImVec2(indent_width, indent_height + selection_size.y), ImVec2(resolution_area.width - indent_width, indent_height + selection_size.y), ImGui::GetColorU32({1.f,1.f,1.f,1.f}));
+    ImGui::GetBackgroundDrawList()->Flags = background_flags;
 
     // selected game
-    ImGui::PushFont(default_font_small);
+    ImGui::PushFont(*default_font_small);
     ImGui::GetBackgroundDrawList()->AddText(ImVec2(indent_width * 2.f, static_cast<float>(resolution_area.height) - indent_height * .5f - ImGui::GetFontSize() * .5f), ImGui::GetColorU32({1.f,1.f,1.f,1.f}), (std::string("v") + CPP_RETRO_GAMES_VERSION + " - selected game: " + (selected_game == nullptr ? "none" : selected_game->get_information().name)).c_str());
     ImGui::PopFont();
 
     // fps
-    ImGui::PushFont(default_font_small);
+    ImGui::PushFont(*default_font_small);
 
     char fps_text[80];
 
@@ -1451,6 +1515,54 @@ bool retrogames::mainmenu_t::run(bool should_render, bool& reset_video_mode)
     return should_exit;
 }
 
+/*
+@brief
+
+    Makes sure we get drawn again at @time_point at the latest, even without input
+*/
+void retrogames::mainmenu_t::request_frame_at(const std::chrono::high_resolution_clock::time_point& time_point)
+{
+    if (time_point < next_frame_request) next_frame_request = time_point;
+}
+
+/*
+@brief
+
+    Checks if nothing in the menu is animating, so we don't need to be drawn until input arrives.
+    @timeout_seconds receives how long it may take at most until we have to be drawn anyway
+    (negative if we only need input)
+*/
+bool retrogames::mainmenu_t::get_idle_timeout(double& timeout_seconds)
+{
+    // games animate all the time
+    if (game_running && selected_game != nullptr) return false;
+
+    auto& g = *ImGui::GetCurrentContext();
+
+    // modal popups fade the background in and out, and text fields blink their cursor
+    if ((g.DimBgRatio > 0.f && g.DimBgRatio < 1.f) || ImGui::GetIO().WantTextInput) return false;
+
+    if (next_frame_request == std::chrono::high_resolution_clock::time_point::max())
+    {
+        timeout_seconds = -1.;
+
+        return true;
+    }
+
+    auto& clock = get_clock();
+
+    // a clock that only moves when stepped won't get anywhere while we wait
+    if (clock.get_rate() <= 0.) return false;
+
+    auto now = clock.now();
+
+    if (next_frame_request <= now) return false;
+
+    timeout_seconds = std::chrono::duration<double>(next_frame_request - now).count() / clock.get_rate();
+
+    return true;
+}
+
 /*
 @brief
 
@@ -1459,4 +1571,18 @@ bool retrogames::mainmenu_t::run(bool should_render, bool& reset_video_mode)
 void retrogames::mainmenu_t::handle_key(bool down, ImGuiKey key)
 {
     if (selected_game != nullptr && game_running) selected_game->handle_key(key, down);
+}
+
+/*
+@brief
+
+    Gets how every game played so far went, "<game>: <outcome>" (the running one last)
+*/
+std::vector<std::string> retrogames::mainmenu_t::get_outcomes(void) const
+{
+    auto all_outcomes = outcomes;
+
+    if (game_running && selected_game != nullptr) all_outcomes.push_back(selected_game->get_information().name + ": " + selected_game->get_outcome() + " (still playing)");
+
+    return all_outcomes;
 }
\ No newline at end of file
@@ -10,7 +10,11 @@
 
 typedef int ImGuiKey;
 
+#include <chrono>
 #include <memory>
+#include <string>
+#include <vector>
+#include "fonts/font_service.h"
 #include "games/manager.h"
 #include "imgui/imgui.h"
 #include "misc/area_size.h"
@@ -33,7 +37,10 @@ namespace retrogames
 
         game_base_t* selected_game;
 
-        ImFont *default_font_small, *default_font_big, *default_font_mid;
+        // Owns all fonts, the default ones below are handles into it
+        font_service_t font_service;
+
+        ImFont **default_font_small, **default_font_big, **default_font_mid;
 
         cfgvalue_t* selected_game_name;
 
@@ -44,6 +51,19 @@ namespace retrogames
 
         float global_scaling;
 
+        // How the games we've left went, "<game>: <outcome>" (see @get_outcomes)
+        std::vector<std::string> outcomes;
+
+        // The earliest point in time something in the menu has to be drawn again (see @get_idle_timeout)
+        std::chrono::high_resolution_clock::time_point next_frame_request;
+
+        /*
+        @brief
+
+            Makes sure we get drawn again at @time_point at the latest, even without input
+        */
+        void request_frame_at(const std::chrono::high_resolution_clock::time_point& time_point);
+
         /*
         @brief
 
@@ -63,7 +83,7 @@ namespace retrogames
         /*
         @brief
 
-            Creates needed fonts
+            Requests needed fonts (they get created by font_service.build())
         */
         void create_fonts(void);
 
@@ -72,7 +92,7 @@ namespace retrogames
 
             Constructor
         */
-        mainmenu_t() : selected_game(nullptr), games_manager(nullptr), game_running(false), global_scaling(1.f), reset_game(false) {}
+        mainmenu_t() : selected_game(nullptr), games_manager(nullptr), default_font_small(nullptr), default_font_big(nullptr), default_font_mid(nullptr), game_running(false), global_scaling(1.f), reset_game(false), next_frame_request(std::chrono::high_resolution_clock::time_point::max()) {}
 
         /*
         @brief
@@ -110,6 +130,22 @@ namespace retrogames
         */
         void handle_key(bool down, ImGuiKey key);
 
+        /*
+        @brief
+
+            Checks if nothing in the menu is animating, so we don't need to be drawn until input arrives.
+            @timeout_seconds receives how long it may take at most until we have to be drawn anyway
+            (negative if we only need input)
+        */
+        bool get_idle_timeout(double& timeout_seconds);
+
+        /*
+        @brief
+
+            Gets how every game played so far went, "<game>: <outcome>" (the running one last)
+        */
+        std::vector<std::string> get_outcomes(void) const;
+
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,235 @@
+/*
+@file
+
+	clock.h
+
+@purpose
+
+	Where all of our time comes from. Everything asks get_clock() instead of
+	std::chrono::high_resolution_clock, so the time can be warped (scaled_clock_t) or
+	stepped by hand (virtual_clock_t) for simulations and tests that run the same every time.
+	Code drawing a frame uses the frame's time (get_frame_time), which is read once per frame
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+namespace retrogames
+{
+
+	class clock_source_t
+	{
+
+	protected:
+
+
+
+	private:
+
+		// The frame's time since the epoch in ticks of time_point::duration (0 until the first frame)
+		std::atomic<std::chrono::high_resolution_clock::rep> frame_time;
+
+	public:
+
+		using time_point = std::chrono::high_resolution_clock::time_point;
+		using duration = std::chrono::high_resolution_clock::duration;
+
+		/*
+		@brief
+
+			Constructor
+		*/
+		clock_source_t() : frame_time(0) {}
+
+		/*
+		@brief
+
+			Destructor
+		*/
+		virtual ~clock_source_t() {}
+
+		/*
+		@brief
+
+			Gets the current time (any thread)
+		*/
+		virtual time_point now(void) const = 0;
+
+		/*
+		@brief
+
+			Gets how many seconds pass on this clock per second of the wall clock
+			(0 if it only moves when it gets stepped)
+		*/
+		virtual double get_rate(void) const = 0;
+
+		/*
+		@brief
+
+			Gets the wall clock's time when this clock reaches @point (for sleeping until then).
+			Clocks that get stepped never get there by themselves, they return the wall clock's now
+		*/
+		virtual time_point to_wall_time(const time_point& point) const = 0;
+
+		/*
+		@brief
+
+			Remembers the current time as the time of the frame we're starting (see get_frame_time)
+		*/
+		void begin_frame(void)
+		{
+			frame_time.store(now().time_since_epoch().count(), std::memory_order_relaxed);
+		}
+
+		/*
+		@brief
+
+			Gets the time the current frame started at, so drawing a frame doesn't ask for the
+			time over and over (and everything in it animates from the same time).
+			Falls back to now() before the first frame
+		*/
+		time_point get_frame_time(void) const
+		{
+			auto ticks = frame_time.load(std::memory_order_relaxed);
+
+			return ticks != 0 ? time_point(duration(ticks)) : now();
+		}
+
+	};
+
+	// The wall clock (the default)
+	class real_clock_t final : public clock_source_t
+	{
+
+	public:
+
+		time_point now(void) const override { return std::chrono::high_resolution_clock::now(); }
+
+		double get_rate(void) const override { return 1.; }
+
+		time_point to_wall_time(const time_point& point) const override { return point; }
+
+	};
+
+	// The wall clock, running @rate times as fast (from the moment it got created)
+	class scaled_clock_t final : public clock_source_t
+	{
+
+	private:
+
+		time_point start;
+
+		double rate;
+
+	public:
+
+		/*
+		@brief
+
+			Constructor
+		*/
+		scaled_clock_t(double rate) : start(std::chrono::high_resolution_clock::now()), rate(rate) {}
+
+		time_point now(void) const override
+		{
+			return start + std::chrono::duration_cast<duration>((std::chrono::high_resolution_clock::now() - start) * rate);
+		}
+
+		double get_rate(void) const override { return rate; }
+
+		time_point to_wall_time(const time_point& point) const override
+		{
+			return start + std::chrono::duration_cast<duration>((point - start) / rate);
+		}
+
+	};
+
+	// Only moves when it gets stepped (starts at the wall clock's time when it got created)
+	class virtual_clock_t final : public clock_source_t
+	{
+
+	private:
+
+		std::atomic<std::chrono::high_resolution_clock::rep> ticks;
+
+	public:
+
+		/*
+		@brief
+
+			Constructor
+		*/
+		virtual_clock_t() : ticks(std::chrono::high_resolution_clock::now().time_since_epoch().count()) {}
+
+		time_point now(void) const override { return time_point(duration(ticks.load(std::memory_order_acquire))); }
+
+		double get_rate(void) const override { return 0.; }
+
+		time_point to_wall_time(const time_point& /*point*/) const override { return std::chrono::high_resolution_clock::now(); }
+
+		/*
+		@brief
+
+			Moves the time forward by @step
+		*/
+		template <typename T> void advance(const T& step)
+		{
+			ticks.fetch_add(std::chrono::duration_cast<duration>(step).count(), std::memory_order_acq_rel);
+		}
+
+	};
+
+	namespace detail
+	{
+
+		/*
+		@brief
+
+			Gets the wall clock we default to
+		*/
+		inline real_clock_t& real_clock(void)
+		{
+			static real_clock_t clock;
+
+			return clock;
+		}
+
+		/*
+		@brief
+
+			Holds the clock everything uses
+		*/
+		inline std::atomic<clock_source_t*>& current_clock(void)
+		{
+			static std::atomic<clock_source_t*> clock(&real_clock());
+
+			return clock;
+		}
+
+	}
+
+	/*
+	@brief
+
+		Gets the clock everything uses
+	*/
+	inline clock_source_t& get_clock(void)
+	{
+		return *detail::current_clock().load(std::memory_order_acquire);
+	}
+
+	/*
+	@brief
+
+		Makes everything use @clock from now on (nullptr goes back to the wall clock).
+		Set it before starting anything that keeps time (games, timers), their time points
+		don't carry over between clocks
+	*/
+	inline void set_clock(clock_source_t* clock)
+	{
+		detail::current_clock().store(clock != nullptr ? clock : &detail::real_clock(), std::memory_order_release);
+	}
+
+}
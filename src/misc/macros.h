@@ -25,6 +25,10 @@
 // and the final product will have this commented (so it uses OpenGL).
 //#define NS_IMGUI_SOFTWARE_RENDERING
 
+#ifdef NS_IMGUI_SOFTWARE_RENDERING
+#define IMGUI_SOFTWARE_RENDERING
+#endif
+
 // For debugging purposes, nxlink can be enabled
 #define NS_ENABLE_NXLINK
 
@@ -40,6 +44,16 @@
 #define UI_SCALE 1.f
 #endif
 
+#if defined(PLATFORM_LINUX) && defined(LINUX_IMGUI_SOFTWARE_RENDERING)
+// Set by 'make SOFTWARE_RENDERING=1'. ImGui will be painted into memory by imgui_sw instead
+// of a GLFW/OpenGL window, so the program can run (and take screenshots) without a display.
+#define IMGUI_SOFTWARE_RENDERING
+#endif
+
+// PLATFORM_HEADLESS is set by 'make headless' (along with the two above). Same as software rendering,
+// but frames get stepped by a virtual clock as fast as possible, input comes from a script and sounds
+// go nowhere (no SFML), see main_headless.cpp. For benchmarks and soak tests on machines without audio
+
 #ifdef PLATFORM_EMSCRIPTEN
 // Define the desired framebuffer resolution (here we set it to 720p).
 #define FB_WIDTH  1280
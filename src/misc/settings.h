@@ -68,6 +68,7 @@ namespace retrogames
 		cfgvalue_t* fullscreen;
 		cfgvalue_t* resolution;
 		cfgvalue_t* fps;
+		cfgvalue_t* precise_frame_pacing;
 #endif
 
 		area_size_t resolution_area;
@@ -75,11 +76,12 @@ namespace retrogames
 		cfgvalue_t* draw_fps, *draw_frametime, *draw_playtime, *draw_position;
 		cfgvalue_t* timeout_time;
 		cfgvalue_t* sound_effect_volume;
+		cfgvalue_t* latency_probe;
 
 		main_settings_t()
 		{
 #if defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
-			vsync = fullscreen = resolution = fps = nullptr;
+			vsync = fullscreen = resolution = fps = precise_frame_pacing = nullptr;
 #endif
 
 			resolution_area = area_size_t(1280, 720);
@@ -87,6 +89,7 @@ namespace retrogames
 			draw_fps = draw_frametime = draw_playtime = draw_position = nullptr;
 			timeout_time = nullptr;
 			sound_effect_volume = nullptr;
+			latency_probe = nullptr;
 		}
 
 	};
@@ -117,6 +120,13 @@ namespace retrogames
 		*/
 		main_settings_t& get_main_settings(void) { return main_settings; }
 
+		/*
+		@brief
+
+			Gets the path we've loaded the settings from
+		*/
+		const std::string& get_path(void) const { return path; }
+
 		/*
 		@brief
 
@@ -154,6 +164,7 @@ namespace retrogames
 			main_settings.fullscreen = &create("main_fullscreen", false);
 			main_settings.resolution = &create("main_resolution", "1280x720");
 			main_settings.fps = &create("main_fps", 60u);
+			main_settings.precise_frame_pacing = &create("main_precise_frame_pacing", false);
 			main_settings.resolution_area = area_size_t(1280, 720); // 720p default
 			{
 				auto res = main_settings.resolution->get<std::string>();
@@ -178,6 +189,7 @@ namespace retrogames
 			main_settings.draw_position = &create("main_draw_position_alignment", "topright");
 			main_settings.timeout_time = &create("main_lostfocus_timeout_time", 3u);
 			main_settings.sound_effect_volume = &create("main_sound_effect_volume", 50.f);
+			main_settings.latency_probe = &create("main_latency_probe", false);
 		}
 
 		/*
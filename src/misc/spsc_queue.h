@@ -0,0 +1,97 @@
+/*
+@file
+
+	spsc_queue.h
+
+@purpose
+
+	Fixed-size lock-free queue with exactly one producer thread and one consumer thread
+	(input events going from the render thread to a simulation thread, for example)
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace retrogames
+{
+
+	template <typename T, std::size_t capacity>
+	class spsc_queue_t final
+	{
+
+		static_assert(capacity != 0 && (capacity & (capacity - 1)) == 0, "capacity has to be a power of two");
+
+	protected:
+
+
+
+	private:
+
+		std::array<T, capacity> items;
+
+		// Both only ever grow, the slot is the counter masked by capacity - 1
+		std::atomic<std::size_t> head, tail;
+
+	public:
+
+		/*
+		@brief
+
+			Constructor
+		*/
+		spsc_queue_t() :
+			head(0),
+			tail(0) {}
+
+		/*
+		@brief
+
+			Adds @item to the queue (producer thread). Returns false if the queue is full
+		*/
+		bool push(const T& item)
+		{
+			auto current_tail = tail.load(std::memory_order_relaxed);
+
+			if (current_tail - head.load(std::memory_order_acquire) == capacity) return false;
+
+			items[current_tail & (capacity - 1)] = item;
+
+			tail.store(current_tail + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		/*
+		@brief
+
+			Takes the oldest item off the queue (consumer thread). Returns false if the queue is empty
+		*/
+		bool pop(T& item)
+		{
+			auto current_head = head.load(std::memory_order_relaxed);
+
+			if (current_head == tail.load(std::memory_order_acquire)) return false;
+
+			item = items[current_head & (capacity - 1)];
+
+			head.store(current_head + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		/*
+		@brief
+
+			Checks if there's nothing to pop (consumer thread)
+		*/
+		bool empty(void) const
+		{
+			return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+		}
+
+	};
+
+}
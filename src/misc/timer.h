@@ -5,12 +5,13 @@
 
 @purpose
 
-	Timing
+	Timing (in the time of get_clock(), see clock.h)
 */
 
 #pragma once
 
 #include <chrono>
+#include "clock.h"
 
 namespace retrogames
 {
@@ -35,13 +36,13 @@ namespace retrogames
 		/*
 		@brief
 
-			Offsets the time by std::chrono::high_resolution_clock::now() - @point
+			Offsets the time by get_clock().now() - @point
 		*/
 		void offset_by_time(const std::chrono::high_resolution_clock::time_point& point)
 		{
 			if (!started_) return;
 
-			auto offset = std::chrono::high_resolution_clock::now() - point;
+			auto offset = get_clock().now() - point;
 
 			/*if (paused_) pause_time += offset;
 			else start_time += offset;*/
@@ -82,7 +83,7 @@ namespace retrogames
 			if (paused_ || !started_) return;
 
 			paused_ = true;
-			pause_time = std::chrono::high_resolution_clock::now();
+			pause_time = get_clock().now();
 		}
 
 		/*
@@ -95,7 +96,7 @@ namespace retrogames
 			if (!paused_ || !started_) return;
 
 			paused_ = false;
-			start_time += std::chrono::high_resolution_clock::now() - pause_time;
+			start_time += get_clock().now() - pause_time;
 		}
 
 		/*
@@ -108,7 +109,7 @@ namespace retrogames
 		{
 			if (!start_time_set) return T(0);
 
-			return std::chrono::duration_cast<T>(std::chrono::high_resolution_clock::now() - get_time_point());
+			return std::chrono::duration_cast<T>(get_clock().now() - get_time_point());
 		}
 
 		/*
@@ -118,7 +119,7 @@ namespace retrogames
 		*/
 		void start(void)
 		{
-			start_time = std::chrono::high_resolution_clock::now();
+			start_time = get_clock().now();
 
 			started_ = start_time_set = true;
 			paused_ = false;
@@ -163,7 +164,7 @@ namespace retrogames
 		std::chrono::high_resolution_clock::time_point get_time_point(void) const
 		{
 			if (!started_) return start_time;
-			if (paused_) return start_time + (std::chrono::high_resolution_clock::now() - pause_time);
+			if (paused_) return start_time + (get_clock().now() - pause_time);
 
 			return start_time;
 		}
@@ -0,0 +1,98 @@
+/*
+@file
+
+	triple_buffer.h
+
+@purpose
+
+	Lock-free handoff of snapshots from one writer thread to one reader thread.
+	The writer always has a buffer to fill and the reader always has one to read,
+	so neither ever waits on the other; the reader just gets the newest snapshot
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace retrogames
+{
+
+	template <typename T>
+	class triple_buffer_t final
+	{
+
+	protected:
+
+
+
+	private:
+
+		// The middle buffer's index lives in the low bits, fresh_bit is set when it holds
+		// a snapshot the reader didn't pick up yet
+		static constexpr uint8_t index_mask = 3;
+		static constexpr uint8_t fresh_bit = 4;
+
+		std::array<T, 3> buffers;
+
+		std::atomic<uint8_t> middle;
+
+		// Only touched by the writer and the reader respectively
+		uint8_t back, front;
+
+	public:
+
+		/*
+		@brief
+
+			Constructor
+		*/
+		triple_buffer_t() :
+			middle(1),
+			back(0),
+			front(2) {}
+
+		/*
+		@brief
+
+			Gets the buffer the writer fills (holds whatever was published two snapshots ago)
+		*/
+		T& get_back(void) { return buffers[back]; }
+
+		/*
+		@brief
+
+			Hands the back buffer over to the reader (writer thread)
+		*/
+		void publish(void)
+		{
+			back = middle.exchange(static_cast<uint8_t>(back | fresh_bit), std::memory_order_acq_rel) & index_mask;
+		}
+
+		/*
+		@brief
+
+			Picks up the newest published snapshot if there is one (reader thread).
+			Returns true if get_front() changed
+		*/
+		bool update(void)
+		{
+			if ((middle.load(std::memory_order_relaxed) & fresh_bit) == 0) return false;
+
+			front = middle.exchange(front, std::memory_order_acq_rel) & index_mask;
+
+			return true;
+		}
+
+		/*
+		@brief
+
+			Gets the snapshot the reader works with. It stays the reader's until the next
+			update(), so the reader may modify it
+		*/
+		T& get_front(void) { return buffers[front]; }
+
+	};
+
+}
@@ -0,0 +1,204 @@
+/*
+@file
+
+	simulation_thread.cpp
+
+@purpose
+
+	Running game logic at a fixed rate on its own thread
+*/
+
+#include "simulation_thread.h"
+#include "fpsmanager/fpsmanager.h"
+#include "misc/clock.h"
+
+/*
+@brief
+
+	Constructor
+*/
+retrogames::simulation_thread_t::simulation_thread_t() :
+	tick_interval(0),
+	tick_count(0),
+	active(false),
+	started(false),
+	stopping(false),
+	threaded(false) {}
+
+/*
+@brief
+
+	Destructor, stops the thread
+*/
+retrogames::simulation_thread_t::~simulation_thread_t()
+{
+	stop();
+}
+
+/*
+@brief
+
+	Starts calling @tick @ticks_per_second times a second (while active).
+	Stops a previous run first
+*/
+void retrogames::simulation_thread_t::start(uint16_t ticks_per_second, std::function<void(void)> tick)
+{
+	stop();
+
+	this->tick = std::move(tick);
+
+	tick_interval = fpsmanager_t::calculate_delay(ticks_per_second);
+	next_tick = get_clock().now();
+	tick_count = 0;
+	stopping = false;
+	started = true;
+
+#ifndef PLATFORM_EMSCRIPTEN
+	threaded = get_clock().get_rate() > 0.;
+
+	if (threaded) thread = std::thread(&simulation_thread_t::run, this);
+#endif
+}
+
+/*
+@brief
+
+	Stops the thread and waits for the current tick to finish. Afterwards the caller
+	owns all of the simulation's state until the next start()
+*/
+void retrogames::simulation_thread_t::stop(void)
+{
+	if (!started) return;
+
+#ifndef PLATFORM_EMSCRIPTEN
+	if (threaded)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			stopping = true;
+		}
+
+		condition.notify_one();
+
+		thread.join();
+	}
+#endif
+
+	started = false;
+}
+
+/*
+@brief
+
+	Lets ticks run (or holds them back, e.g. while the game is paused).
+	The first tick after activating runs right away
+*/
+void retrogames::simulation_thread_t::set_active(bool active)
+{
+	// Called every frame, only bother the thread when something changes
+	if (this->active.load(std::memory_order_relaxed) == active) return;
+
+#ifndef PLATFORM_EMSCRIPTEN
+	if (threaded)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			this->active = active;
+		}
+
+		condition.notify_one();
+
+		return;
+	}
+#endif
+
+	this->active = active;
+
+	if (active) next_tick = get_clock().now();
+}
+
+/*
+@brief
+
+	Runs due ticks on the calling thread when there's no simulation thread (Emscripten,
+	stepped clocks), does nothing otherwise. Call once per frame
+*/
+void retrogames::simulation_thread_t::pump(void)
+{
+	if (!started || threaded || !active) return;
+
+	auto& clock = get_clock();
+	auto now = clock.now();
+
+	if (now < next_tick) return;
+
+	tick();
+
+	tick_count++;
+	next_tick += tick_interval;
+
+	if (clock.get_rate() > 0.)
+	{
+		// Like the fpsmanager, don't try to catch up on ticks we missed (one per frame at most)
+		if (next_tick < now) next_tick = now + tick_interval;
+	}
+	else
+	{
+		// A stepped clock doesn't miss anything, run every tick that's due so the same steps
+		// always give the same ticks
+		while (next_tick <= now)
+		{
+			tick();
+
+			tick_count++;
+			next_tick += tick_interval;
+		}
+	}
+}
+
+#ifndef PLATFORM_EMSCRIPTEN
+/*
+@brief
+
+	The thread's main loop
+*/
+void retrogames::simulation_thread_t::run(void)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while (!stopping)
+	{
+		if (!active)
+		{
+			// Sleep until we're needed again, then tick right away
+			condition.wait(lock, [this]() { return stopping || active; });
+
+			next_tick = get_clock().now();
+
+			continue;
+		}
+
+		// Wait for the next tick (waking up early if we got stopped or deactivated)
+		if (condition.wait_until(lock, get_clock().to_wall_time(next_tick), [this]() { return stopping || !active; })) continue;
+
+		// Don't hold the lock while ticking, set_active() shouldn't have to wait on game logic
+		lock.unlock();
+
+		tick();
+
+		lock.lock();
+
+		tick_count++;
+
+		// Don't try to catch up on ticks we missed (the machine was suspended or a tick took too long),
+		// a burst of moves would be worse than a late one
+		next_tick += tick_interval;
+
+		auto now = get_clock().now();
+
+		if (next_tick < now) next_tick = now + tick_interval;
+	}
+}
+#endif
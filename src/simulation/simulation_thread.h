@@ -0,0 +1,141 @@
+/*
+@file
+
+	simulation_thread.h
+
+@purpose
+
+	Running game logic at a fixed rate on its own thread, so slow frames don't delay
+	game ticks and slow ticks don't delay frames. Games publish what the render thread
+	needs to draw through a triple_buffer_t and get input through a spsc_queue_t.
+
+	Emscripten builds don't have threads, and nothing could wake a thread up in time when the clock
+	only moves when stepped (see misc/clock.h). The ticks run on the render thread then (see @pump)
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace retrogames
+{
+
+	class simulation_thread_t final
+	{
+
+	protected:
+
+
+
+	private:
+
+		std::function<void(void)> tick;
+
+		std::chrono::nanoseconds tick_interval;
+
+		// When the next tick is due (only used by whoever runs the ticks)
+		std::chrono::high_resolution_clock::time_point next_tick;
+
+		// Ticks run since start() (only used by whoever runs the ticks)
+		uint64_t tick_count;
+
+		// Ticks only run while active. Guarded by @mutex when written, so the thread can sleep on @condition
+		std::atomic<bool> active;
+
+		bool started, stopping;
+
+		// Ticks run on the thread (not in pump)
+		bool threaded;
+
+#ifndef PLATFORM_EMSCRIPTEN
+		std::thread thread;
+
+		std::mutex mutex;
+		std::condition_variable condition;
+
+		/*
+		@brief
+
+			The thread's main loop
+		*/
+		void run(void);
+#endif
+
+	public:
+
+		/*
+		@brief
+
+			Constructor
+		*/
+		simulation_thread_t();
+
+		/*
+		@brief
+
+			Destructor, stops the thread
+		*/
+		~simulation_thread_t();
+
+		/*
+		@brief
+
+			Starts calling @tick @ticks_per_second times a second (while active).
+			Stops a previous run first
+		*/
+		void start(uint16_t ticks_per_second, std::function<void(void)> tick);
+
+		/*
+		@brief
+
+			Stops the thread and waits for the current tick to finish. Afterwards the caller
+			owns all of the simulation's state until the next start()
+		*/
+		void stop(void);
+
+		/*
+		@brief
+
+			Lets ticks run (or holds them back, e.g. while the game is paused).
+			The first tick after activating runs right away
+		*/
+		void set_active(bool active);
+
+		/*
+		@brief
+
+			Runs due ticks on the calling thread when there's no simulation thread (Emscripten,
+			stepped clocks), does nothing otherwise. Call once per frame
+		*/
+		void pump(void);
+
+		/*
+		@brief
+
+			Checks if we're started
+		*/
+		bool is_started(void) const { return started; }
+
+		/*
+		@brief
+
+			Gets the time between two ticks
+		*/
+		const std::chrono::nanoseconds& get_tick_interval(void) const { return tick_interval; }
+
+		/*
+		@brief
+
+			Gets the number of the tick that's running (call from within the tick)
+		*/
+		uint64_t get_tick_count(void) const { return tick_count; }
+
+	};
+
+}
@@ -9,8 +9,11 @@
 */
 
 #include "snd.h"
+#include "capture/startup_trace.h"
 
-#if defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
+#if defined(PLATFORM_HEADLESS)
+// no sound library, sounds only go to the play listener
+#elif defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
 #include <SFML/Audio.hpp>
 #else
 #include <SDL2/SDL.h>
@@ -35,7 +38,11 @@ extern unsigned int stb_decompress(unsigned char *output, const unsigned char *i
 
     Constructor
 */
-retrogames::snd_t::snd_t() : initialized(false) {}
+retrogames::snd_t::snd_t() : initialized(false)
+#if defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
+    , loaded(false)
+#endif
+{}
 
 /*
 @brief
@@ -43,6 +50,52 @@ retrogames::snd_t::snd_t() : initialized(false) {}
     Tries to initialize all our sounds
 */
 bool retrogames::snd_t::initialize(void)
+{
+    return initialized = load();
+}
+
+#if defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
+/*
+@brief
+
+    Starts initializing all our sounds on a worker thread, so decoding them runs next to
+    creating the window. Playing a sound waits for it, so does wait()
+*/
+void retrogames::snd_t::initialize_async(void)
+{
+    std::lock_guard<std::mutex> lock(loading_mutex);
+
+    loading = std::async(std::launch::async, [this]() -> bool
+    {
+        startup_trace_t::stage_t stage(get_startup_trace(), "sounds");
+
+        return load();
+    });
+}
+
+/*
+@brief
+
+    Waits for initialize_async() to finish, returns true if all our sounds loaded (any thread)
+*/
+bool retrogames::snd_t::wait(void)
+{
+    std::lock_guard<std::mutex> lock(loading_mutex);
+
+    if (loading.valid()) initialized = loading.get();
+
+    if (initialized) loaded.store(true, std::memory_order_release);
+
+    return initialized;
+}
+#endif
+
+/*
+@brief
+
+    Decompresses and loads all our sounds
+*/
+bool retrogames::snd_t::load(void)
 {
     auto decompress = [](const uint32_t size, const uint32_t* data) -> std::pair<uint32_t, uint8_t*>
     {
@@ -53,7 +106,15 @@ bool retrogames::snd_t::initialize(void)
         return std::make_pair<uint32_t, uint8_t*>(static_cast<uint32_t>(buf_decompressed_size), static_cast<uint8_t*>(buf_decompressed_data));
     };
 
-#if defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
+#if defined(PLATFORM_HEADLESS)
+    // keep the files around for the play listener (the video recorder mixes them)
+    auto add_sound = [this, &decompress](sounds_e sound, const uint32_t size, const uint32_t* data) -> bool
+    {
+        sounds_raw.at(static_cast<std::size_t>(sound)) = decompress(size, data);
+
+        return true;
+    };
+#elif defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
     auto add_sound = [this, &decompress](sounds_e sound, const uint32_t size, const uint32_t* data) -> bool
     {
         auto sound_raw = (sounds_raw.at(static_cast<std::size_t>(sound)) = decompress(size, data));
@@ -144,9 +205,6 @@ bool retrogames::snd_t::initialize(void)
     if (!add_sound(sounds_e::SOUND_PAUSE, pause_compressed_size, pause_compressed_data)) return false;
     if (!add_sound(sounds_e::SOUND_EAT, eat_compressed_size, eat_compressed_data)) return false;
 
-    // all done!
-    initialized = true;
-
     // all our sounds loaded successfully
     return true;
 }
@@ -158,9 +216,16 @@ bool retrogames::snd_t::initialize(void)
 */
 retrogames::snd_t::~snd_t()
 {
+#if defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
+    // don't pull the sounds from under a worker still loading them
+    wait();
+#endif
+
     if (!initialized) return;
 
-#if defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
+#if defined(PLATFORM_HEADLESS)
+    for (auto& sound_raw : sounds_raw) delete[] sound_raw.second;
+#elif defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
     // clean up our sounds
     for (std::size_t i = 0; i < sound_buffers.size(); i++)
     {
@@ -191,13 +256,24 @@ retrogames::snd_t::~snd_t()
 */
 void retrogames::snd_t::play_sound(sounds_e sound, float volume/* = 100.f*/)
 {
+#if defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
+    // still loading (or failed to), the first sound waits for them
+    if (!loaded.load(std::memory_order_acquire) && !wait()) return;
+#endif
+
+    if (play_listener) play_listener(sound, volume);
+
+#if defined(PLATFORM_HEADLESS)
+    // null sink, there's nothing to play it on
+#elif defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
     auto snd = sounds.at(static_cast<std::size_t>(sound));
 
-#if defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
     if (snd->getVolume() != volume) snd->setVolume(volume);
 
     snd->play();
 #else
+    auto snd = sounds.at(static_cast<std::size_t>(sound));
+
     auto vol = static_cast<int32_t>((volume / 100.f) * static_cast<float>(MIX_MAX_VOLUME));
 
     if (Mix_VolumeChunk(snd, -1) != vol) Mix_VolumeChunk(snd, vol);
@@ -11,9 +11,18 @@
 #pragma once
 
 #include <array>
+#include <functional>
 #include <stdint.h>
 
 #if defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
+#include <atomic>
+#include <future>
+#include <mutex>
+#endif
+
+#if defined(PLATFORM_HEADLESS)
+// Sounds only go to the play listener, nothing gets played
+#elif defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
 namespace sf
 {
 
@@ -53,7 +62,9 @@ namespace retrogames
 
         std::array<std::pair<uint32_t, uint8_t*>, static_cast<std::size_t>(sounds_e::SOUND_SIZE)> sounds_raw;
 
-#if defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
+#if defined(PLATFORM_HEADLESS)
+        // Nothing to play the sounds with, the decompressed files are all we keep
+#elif defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
         std::array<sf::SoundBuffer*, static_cast<std::size_t>(sounds_e::SOUND_SIZE)> sound_buffers;
         std::array<sf::Sound*, static_cast<std::size_t>(sounds_e::SOUND_SIZE)> sounds;
 #else
@@ -63,6 +74,26 @@ namespace retrogames
 
         bool initialized;
 
+#if defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
+        // Set while initialize_async() runs, wait() picks up its result
+        std::future<bool> loading;
+
+        std::mutex loading_mutex;
+
+        // Set once wait() saw our sounds loaded, so playing one doesn't take loading_mutex after that
+        std::atomic<bool> loaded;
+#endif
+
+        // Gets told about every sound we play (the video recorder mixes them into its audio track)
+        std::function<void(sounds_e, float)> play_listener;
+
+        /*
+        @brief
+
+            Decompresses and loads all our sounds
+        */
+        bool load(void);
+
     public:
 
         /*
@@ -86,6 +117,23 @@ namespace retrogames
         */
         bool initialize(void);
 
+#if defined(PLATFORM_WINDOWS) || defined(PLATFORM_LINUX)
+        /*
+        @brief
+
+            Starts initializing all our sounds on a worker thread, so decoding them runs next to
+            creating the window. Playing a sound waits for it, so does wait()
+        */
+        void initialize_async(void);
+
+        /*
+        @brief
+
+            Waits for initialize_async() to finish, returns true if all our sounds loaded (any thread)
+        */
+        bool wait(void);
+#endif
+
         /*
         @brief
 
@@ -93,6 +141,21 @@ namespace retrogames
         */
         void play_sound(sounds_e sound, float volume = 100.f);
 
+        /*
+        @brief
+
+            Retrieves the size and contents of @sound's .wav file (once initialized, see wait())
+        */
+        const std::pair<uint32_t, uint8_t*>& get_sound_file(sounds_e sound) const { return sounds_raw.at(static_cast<std::size_t>(sound)); }
+
+        /*
+        @brief
+
+            Calls @listener with every sound played from now on (on the thread playing it).
+            Set it before anything plays sounds, it isn't synchronized
+        */
+        void set_play_listener(std::function<void(sounds_e sound, float volume)> listener) { play_listener = std::move(listener); }
+
     };
 
     extern snd_t* snd;
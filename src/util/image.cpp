@@ -0,0 +1,213 @@
+/*
+@file
+
+	image.cpp
+
+@purpose
+
+	Writing pixel buffers to image files (PPM and PNG), used for screenshots
+*/
+
+#include "image.h"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+namespace retrogames
+{
+
+	namespace detail
+	{
+
+		/*
+		@brief
+
+			CRC-32 as used by PNG chunks
+		*/
+		static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t size)
+		{
+			static uint32_t table[256];
+			static bool table_created = false;
+
+			if (!table_created)
+			{
+				for (uint32_t n = 0; n < 256; n++)
+				{
+					auto c = n;
+
+					for (uint8_t k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+
+					table[n] = c;
+				}
+
+				table_created = true;
+			}
+
+			crc = ~crc;
+
+			for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+
+			return ~crc;
+		}
+
+		static void push_u32_be(std::vector<uint8_t>& out, uint32_t value)
+		{
+			out.push_back(static_cast<uint8_t>(value >> 24));
+			out.push_back(static_cast<uint8_t>(value >> 16));
+			out.push_back(static_cast<uint8_t>(value >> 8));
+			out.push_back(static_cast<uint8_t>(value));
+		}
+
+		static void push_png_chunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+		{
+			push_u32_be(out, static_cast<uint32_t>(data.size()));
+
+			auto start = out.size();
+
+			out.insert(out.end(), type, type + 4);
+			out.insert(out.end(), data.begin(), data.end());
+
+			push_u32_be(out, crc32(0, out.data() + start, out.size() - start));
+		}
+
+		static bool write_file(const std::string& path, const uint8_t* data, size_t size, std::string* error)
+		{
+			auto file = fopen(path.c_str(), "wb");
+
+			if (!file)
+			{
+				if (error) *error = "Failed to open " + path + " for writing";
+
+				return false;
+			}
+
+			auto written = fwrite(data, 1, size, file);
+
+			fclose(file);
+
+			if (written != size)
+			{
+				if (error) *error = "Failed to write " + path;
+
+				return false;
+			}
+
+			return true;
+		}
+
+	}
+
+}
+
+/*
+@brief
+
+	Saves @pixels as a binary PPM (P6) file
+*/
+bool retrogames::util::save_ppm(const std::string& path, const uint32_t* pixels, const area_size_t& size, std::string* error/* = nullptr*/)
+{
+	auto header = "P6\n" + std::to_string(size.width) + " " + std::to_string(size.height) + "\n255\n";
+
+	std::vector<uint8_t> data(header.begin(), header.end());
+
+	data.reserve(data.size() + static_cast<size_t>(size.width) * size.height * 3);
+
+	auto bytes = reinterpret_cast<const uint8_t*>(pixels);
+
+	for (size_t i = 0; i < static_cast<size_t>(size.width) * size.height; i++)
+	{
+		data.insert(data.end(), bytes + i * 4, bytes + i * 4 + 3);
+	}
+
+	return detail::write_file(path, data.data(), data.size(), error);
+}
+
+/*
+@brief
+
+	Saves @pixels as an RGB PNG file
+*/
+bool retrogames::util::save_png(const std::string& path, const uint32_t* pixels, const area_size_t& size, std::string* error/* = nullptr*/)
+{
+	// Raw scanlines: a filter byte (0 = none) followed by RGB for every pixel
+	const size_t row_size = 1 + static_cast<size_t>(size.width) * 3;
+
+	std::vector<uint8_t> raw;
+
+	raw.reserve(row_size * size.height);
+
+	auto bytes = reinterpret_cast<const uint8_t*>(pixels);
+
+	for (uint32_t y = 0; y < size.height; y++)
+	{
+		raw.push_back(0);
+
+		for (uint32_t x = 0; x < size.width; x++)
+		{
+			auto pixel = bytes + (static_cast<size_t>(y) * size.width + x) * 4;
+
+			raw.insert(raw.end(), pixel, pixel + 3);
+		}
+	}
+
+	// zlib stream made of stored (uncompressed) deflate blocks, max 65535 bytes each
+	std::vector<uint8_t> idat = { 0x78, 0x01 };
+
+	idat.reserve(raw.size() + raw.size() / 65535 * 5 + 16);
+
+	size_t offset = 0;
+
+	do
+	{
+		auto block_size = static_cast<uint16_t>(std::min<size_t>(raw.size() - offset, 65535));
+		auto last_block = offset + block_size == raw.size();
+
+		idat.push_back(last_block ? 1 : 0);
+		idat.push_back(static_cast<uint8_t>(block_size));
+		idat.push_back(static_cast<uint8_t>(block_size >> 8));
+		idat.push_back(static_cast<uint8_t>(~block_size));
+		idat.push_back(static_cast<uint8_t>(~block_size >> 8));
+		idat.insert(idat.end(), raw.begin() + offset, raw.begin() + offset + block_size);
+
+		offset += block_size;
+	}
+	while (offset < raw.size());
+
+	// Adler-32 of the uncompressed data
+	uint32_t adler_a = 1, adler_b = 0;
+
+	for (auto byte : raw)
+	{
+		adler_a = (adler_a + byte) % 65521;
+		adler_b = (adler_b + adler_a) % 65521;
+	}
+
+	detail::push_u32_be(idat, (adler_b << 16) | adler_a);
+
+	// Header: width, height, 8 bits per channel, RGB, default compression/filter, no interlacing
+	std::vector<uint8_t> ihdr;
+
+	detail::push_u32_be(ihdr, size.width);
+	detail::push_u32_be(ihdr, size.height);
+	ihdr.insert(ihdr.end(), { 8, 2, 0, 0, 0 });
+
+	std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+
+	detail::push_png_chunk(png, "IHDR", ihdr);
+	detail::push_png_chunk(png, "IDAT", idat);
+	detail::push_png_chunk(png, "IEND", {});
+
+	return detail::write_file(path, png.data(), png.size(), error);
+}
+
+/*
+@brief
+
+	Calls save_png or save_ppm, depending on the extension of @path
+*/
+bool retrogames::util::save_image(const std::string& path, const uint32_t* pixels, const area_size_t& size, std::string* error/* = nullptr*/)
+{
+	if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".ppm") == 0) return save_ppm(path, pixels, size, error);
+
+	return save_png(path, pixels, size, error);
+}
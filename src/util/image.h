@@ -0,0 +1,57 @@
+/*
+@file
+
+	image.h
+
+@purpose
+
+	Writing pixel buffers to image files (PPM and PNG), used for screenshots
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "misc/area_size.h"
+
+namespace retrogames
+{
+
+	namespace util
+	{
+
+		/*
+		@brief
+
+			Saves @pixels (ImGui's packing, so R, G, B, A in memory) as a binary PPM (P6) file.
+			The alpha channel is dropped.
+
+		@return
+
+			True on success, false (and @error set) if the file couldn't be written
+		*/
+		bool save_ppm(const std::string& path, const uint32_t* pixels, const area_size_t& size, std::string* error = nullptr);
+
+		/*
+		@brief
+
+			Saves @pixels (ImGui's packing, so R, G, B, A in memory) as an RGB PNG file.
+			The alpha channel is dropped.
+
+		@notes
+
+			The image data isn't compressed (stored deflate blocks) to keep this free of dependencies
+			and fast enough to call every frame. Run the result through a PNG optimizer if size matters.
+		*/
+		bool save_png(const std::string& path, const uint32_t* pixels, const area_size_t& size, std::string* error = nullptr);
+
+		/*
+		@brief
+
+			Calls save_png or save_ppm, depending on the extension of @path (.ppm, anything else is PNG)
+		*/
+		bool save_image(const std::string& path, const uint32_t* pixels, const area_size_t& size, std::string* error = nullptr);
+
+	}
+
+}
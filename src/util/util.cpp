@@ -10,7 +10,7 @@
 
 #ifdef PLATFORM_WINDOWS
 #include <Windows.h>
-#elif defined(PLATFORM_LINUX)
+#elif defined(PLATFORM_LINUX) && !defined(LINUX_IMGUI_SOFTWARE_RENDERING)
 #include <GLFW/glfw3.h>
 #endif
 
@@ -80,7 +80,19 @@ const std::pair<std::vector<std::tuple<uint16_t, uint16_t, uint16_t>>, std::stri
 
     std::unordered_map<std::pair<uint16_t, uint16_t>, std::vector<uint16_t>, retrogames::detail::hash_pair_t> supported_resolutions_map;
 
-#ifdef PLATFORM_LINUX
+#if defined(PLATFORM_LINUX) && defined(LINUX_IMGUI_SOFTWARE_RENDERING)
+    // There's no monitor to ask when rendering in software, so offer the common 16:9 resolutions
+    static const uint16_t software_resolutions[][2] = { { 1280, 720 }, { 1600, 900 }, { 1920, 1080 }, { 2560, 1440 }, { 3840, 2160 } };
+
+    for (const auto& resolution : software_resolutions)
+    {
+        const area_size_t size(resolution[0], resolution[1]);
+
+        if ((aspect_x != 0 || aspect_y != 0) && !check_aspect_ratio(size, aspect_x, aspect_y)) continue;
+
+        supported_resolutions_map[std::make_pair(resolution[0], resolution[1])].push_back(60);
+    }
+#elif defined(PLATFORM_LINUX)
     int mode_count;
 
     auto modes = glfwGetVideoModes(glfwGetPrimaryMonitor(), &mode_count);
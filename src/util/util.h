@@ -16,6 +16,7 @@
 #include "misc/area_size.h"
 
 #ifndef PLATFORM_EMSCRIPTEN
+#include <atomic>
 #include <random>
 #else
 #include <stdlib.h>
@@ -52,6 +53,52 @@ namespace retrogames
 		bool check_aspect_ratio(const area_size_t& size, const uint8_t aspect_x = 16, const uint8_t aspect_y = 9);
 #endif
 
+		namespace detail
+		{
+
+			// What random() seeds its generators with (0 for a random seed). Every change bumps the
+			// generation, so each thread's generator notices and seeds itself again
+			struct random_seed_t final
+			{
+
+				std::atomic<uint32_t> seed{0};
+
+				std::atomic<uint32_t> generation{0};
+
+			};
+
+			/*
+			@brief
+
+				Gets random()'s seed
+			*/
+			inline random_seed_t& random_seed(void)
+			{
+				static random_seed_t seed;
+
+				return seed;
+			}
+
+		}
+
+		/*
+		@brief
+
+			Makes random() return the same numbers on every run (per thread, in the order it gets
+			called there), 0 goes back to a random seed. For runs that have to play out the same
+		*/
+		inline void set_random_seed(uint32_t seed)
+		{
+#ifndef PLATFORM_EMSCRIPTEN
+			auto& random_seed = detail::random_seed();
+
+			random_seed.seed = seed;
+			random_seed.generation++;
+#else
+			srand(seed);
+#endif
+		}
+
 		/*
 		@brief
 
@@ -68,8 +115,23 @@ namespace retrogames
 #ifndef PLATFORM_EMSCRIPTEN
 			using dist_type = typename std::conditional<std::is_integral<T>::value, std::uniform_int_distribution<T>, std::uniform_real_distribution<T>>::type;
 
-			thread_local static std::mt19937 gen(std::random_device{}());
+			thread_local static std::mt19937 gen;
     		thread_local static dist_type dist;
+			thread_local static uint32_t generation = 0;
+
+			// (Re)seed if this thread's generator is new or the seed changed
+			auto& random_seed = detail::random_seed();
+			auto current_generation = random_seed.generation.load(std::memory_order_acquire) + 1;
+
+			if (generation != current_generation)
+			{
+				generation = current_generation;
+
+				auto seed = random_seed.seed.load(std::memory_order_relaxed);
+
+				gen.seed(seed != 0 ? seed : std::random_device{}());
+				dist.reset();
+			}
 
 			return dist(gen, typename dist_type::param_type{min, max});
 #else
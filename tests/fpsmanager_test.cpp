@@ -0,0 +1,112 @@
+/*
+@file
+
+	fpsmanager_test.cpp
+
+@purpose
+
+	Checks fpsmanager_t's bookkeeping on a virtual clock, so it runs the same every time.
+	Built and run by 'make check'
+*/
+
+#include <chrono>
+#include <cstdio>
+#include "fpsmanager/fpsmanager.h"
+#include "misc/clock.h"
+
+namespace
+{
+
+	int failures = 0;
+
+	/*
+	@brief
+
+		Reports @what as failed unless @condition holds
+	*/
+	void expect(bool condition, const char* what)
+	{
+		if (condition) return;
+
+		fprintf(stderr, "FAILED: %s\n", what);
+
+		failures++;
+	}
+
+	/*
+	@brief
+
+		Runs @count frames on @clock, each exactly one interval after the last
+	*/
+	void run_frames(retrogames::fpsmanager_t& fpsmanager, retrogames::virtual_clock_t& clock, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			clock.advance(fpsmanager.get_update_interval());
+
+			fpsmanager.run();
+		}
+	}
+
+	/*
+	@brief
+
+		A long wait for events (an idle menu, or the background) followed by reset() must not
+		count as missed frames, nor show up in the jitter
+	*/
+	void test_long_gap_after_reset(retrogames::virtual_clock_t& clock)
+	{
+		retrogames::fpsmanager_t fpsmanager(60);
+
+		fpsmanager.run();
+
+		run_frames(fpsmanager, clock, 10);
+
+		clock.advance(std::chrono::seconds(60));
+
+		fpsmanager.reset();
+		fpsmanager.run();
+
+		run_frames(fpsmanager, clock, 10);
+
+		expect(fpsmanager.get_missed_frames() == 0, "a minute long gap after reset() counts as missed frames");
+		expect(fpsmanager.get_jitter().get_max() < fpsmanager.get_update_interval(), "a minute long gap after reset() shows up in the jitter");
+	}
+
+	/*
+	@brief
+
+		Without reset() the same gap is a stall, and has to count as one
+	*/
+	void test_long_gap_without_reset(retrogames::virtual_clock_t& clock)
+	{
+		retrogames::fpsmanager_t fpsmanager(60);
+
+		fpsmanager.run();
+
+		run_frames(fpsmanager, clock, 10);
+
+		clock.advance(std::chrono::seconds(60));
+
+		fpsmanager.run();
+
+		expect(fpsmanager.get_missed_frames() >= 60 * 60 - 1, "a minute long stall doesn't count as missed frames");
+	}
+
+}
+
+int main(void)
+{
+	retrogames::virtual_clock_t clock;
+
+	retrogames::set_clock(&clock);
+
+	test_long_gap_after_reset(clock);
+	test_long_gap_without_reset(clock);
+
+	retrogames::set_clock(nullptr);
+
+	if (failures == 0) printf("fpsmanager_test: passed\n");
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,621 @@
+/*
+@file
+
+    replay.cpp
+
+@purpose
+
+    Replays draw data recorded with --record (see src/capture/drawdata_capture.h) through
+    imgui_sw or the OpenGL3 backend as fast as possible, to benchmark renderers on real sessions.
+    Build with 'make replay' (or 'make replay REPLAY_OPENGL=1' to get --opengl as well, which needs EGL and
+    works without a display, e.g. on Mesa's llvmpipe).
+
+@usage
+
+    replay <file> [options]
+
+    --repeat <n>     Replay the recording n times (default: 1)
+    --threads <n>    Threads imgui_sw paints with (default: 1)
+    --no-simd        Use imgui_sw's scalar span kernels
+    --changes        Paint with paint_imgui_changes (repaints only what changed between frames)
+    --rgb565         Paint with paint_imgui_rgb565
+    --dump <path>    Save the last frame as a .ppm
+    --compare        Also paint every frame with the scalar span kernels on one thread (and without --changes),
+                     exit with 1 at the first pixel that differs from the options being replayed. For checking
+                     that the SIMD kernels, tiles and change tracking paint exactly what the plain path does
+    --opengl         Render with the OpenGL3 backend into an offscreen framebuffer instead (REPLAY_OPENGL builds only)
+    --streaming <legacy|ring|persistent>  How the OpenGL3 backend uploads vertices and indices (default: the best one available)
+    --finish         Wait for OpenGL to finish every frame, so frames get timed including what the GPU (or llvmpipe) did
+*/
+
+#include "capture/drawdata_capture.h"
+#include "imgui/imgui.h"
+#include "imgui/imgui_sw.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef REPLAY_OPENGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include "imgui/imgui_impl_opengl3.h"
+#endif
+
+namespace
+{
+
+	// Command line options (see @usage above)
+	struct replay_options_t final
+	{
+
+		std::string path;
+
+		int repeat = 1;
+
+		imgui_sw::SwOptions sw_options;
+
+		bool changes = false;
+
+		bool rgb565 = false;
+
+		std::string dump_path;
+
+		bool compare = false;
+
+		bool opengl = false;
+
+#ifdef REPLAY_OPENGL
+		ImGui_ImplOpenGL3_StreamingMode streaming_mode = ImGui_ImplOpenGL3_StreamingMode_Auto;
+#endif
+
+		bool finish = false;
+
+	};
+
+	// How long painting the frames took
+	struct timings_t final
+	{
+
+		double total_ms = 0., min_ms = 1e9, max_ms = 0.;
+
+		uint64_t frames = 0;
+
+		void add(double ms)
+		{
+			total_ms += ms;
+			min_ms = std::min(min_ms, ms);
+			max_ms = std::max(max_ms, ms);
+			frames++;
+		}
+
+	};
+
+#ifdef REPLAY_OPENGL
+	const char* streaming_mode_names[] = { "auto", "legacy", "ring", "persistent" };
+
+	/*
+	@brief
+
+		Turns the name of a streaming mode into the mode, returns false if there's no such mode
+	*/
+	bool parse_streaming_mode(const char* name, ImGui_ImplOpenGL3_StreamingMode& mode)
+	{
+		for (int i = 0; i < static_cast<int>(sizeof(streaming_mode_names) / sizeof(streaming_mode_names[0])); i++)
+		{
+			if (strcmp(name, streaming_mode_names[i]) != 0) continue;
+
+			mode = static_cast<ImGui_ImplOpenGL3_StreamingMode>(i);
+
+			return true;
+		}
+
+		return false;
+	}
+
+	/*
+	@brief
+
+		Gets the name of a streaming mode
+	*/
+	const char* streaming_mode_name(ImGui_ImplOpenGL3_StreamingMode mode)
+	{
+		return streaming_mode_names[static_cast<int>(mode)];
+	}
+#endif
+
+	/*
+	@brief
+
+		Parses the command line, returns false on invalid arguments
+	*/
+	bool parse_options(int argc, char** argv, replay_options_t& options)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			auto has_value = i + 1 < argc;
+
+			if (strcmp(argv[i], "--repeat") == 0 && has_value) options.repeat = std::max(1, atoi(argv[++i]));
+			else if (strcmp(argv[i], "--threads") == 0 && has_value) options.sw_options.num_threads = std::max(1, atoi(argv[++i]));
+			else if (strcmp(argv[i], "--no-simd") == 0) options.sw_options.use_simd = false;
+			else if (strcmp(argv[i], "--changes") == 0) options.changes = true;
+			else if (strcmp(argv[i], "--rgb565") == 0) options.rgb565 = true;
+			else if (strcmp(argv[i], "--dump") == 0 && has_value) options.dump_path = argv[++i];
+			else if (strcmp(argv[i], "--compare") == 0) options.compare = true;
+			else if (strcmp(argv[i], "--opengl") == 0) options.opengl = true;
+			else if (strcmp(argv[i], "--finish") == 0) options.finish = true;
+#ifdef REPLAY_OPENGL
+			else if (strcmp(argv[i], "--streaming") == 0 && has_value && parse_streaming_mode(argv[i + 1], options.streaming_mode)) i++;
+#endif
+			else if (argv[i][0] != '-' && options.path.empty()) options.path = argv[i];
+			else
+			{
+				fprintf(stderr, "Unknown or incomplete argument: %s\n", argv[i]);
+
+				return false;
+			}
+		}
+
+		if (options.path.empty())
+		{
+			fprintf(stderr, "Usage: replay <file> [--repeat n] [--threads n] [--no-simd] [--changes] [--rgb565] [--dump path] [--compare] [--opengl] [--streaming mode] [--finish]\n");
+
+			return false;
+		}
+
+		if (options.compare && options.opengl)
+		{
+			fprintf(stderr, "--compare only works with imgui_sw\n");
+
+			return false;
+		}
+
+#ifndef REPLAY_OPENGL
+		if (options.opengl)
+		{
+			fprintf(stderr, "--opengl needs a build with 'make replay REPLAY_OPENGL=1'\n");
+
+			return false;
+		}
+#endif
+
+		return true;
+	}
+
+	/*
+	@brief
+
+		Makes @atlas ImGui's font atlas, as if ImGui had built it
+	*/
+	void load_atlas(const retrogames::drawdata_player_t::atlas_t& atlas)
+	{
+		auto fonts = ImGui::GetIO().Fonts;
+
+		fonts->ClearTexData();
+
+		// The atlas frees this, so it has to come from ImGui's allocator
+		fonts->TexPixelsAlpha8 = static_cast<unsigned char*>(IM_ALLOC(atlas.alpha.size()));
+		fonts->TexWidth = atlas.width;
+		fonts->TexHeight = atlas.height;
+
+		memcpy(fonts->TexPixelsAlpha8, atlas.alpha.data(), atlas.alpha.size());
+
+		// Both renderers pick the distance field path from these when they get the atlas
+		if (atlas.sdf_spread > 0)
+		{
+			fonts->Flags |= ImFontAtlasFlags_SignedDistanceField;
+			fonts->TexSdfSpread = atlas.sdf_spread;
+		}
+		else fonts->Flags &= ~ImFontAtlasFlags_SignedDistanceField;
+	}
+
+	/*
+	@brief
+
+		Milliseconds passed since @start
+	*/
+	double milliseconds_since(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	/*
+	@brief
+
+		Saves the 32-bit frame in @pixels as a binary .ppm
+	*/
+	bool save_ppm(const std::string& path, const uint32_t* pixels, int width, int height)
+	{
+		auto file = fopen(path.c_str(), "wb");
+
+		if (file == nullptr) return false;
+
+		fprintf(file, "P6\n%d %d\n255\n", width, height);
+
+		std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+
+		for (int y = 0; y < height; y++)
+		{
+			for (int x = 0; x < width; x++)
+			{
+				auto pixel = pixels[static_cast<size_t>(y) * width + x];
+
+				row[x * 3 + 0] = static_cast<uint8_t>(pixel >> IM_COL32_R_SHIFT);
+				row[x * 3 + 1] = static_cast<uint8_t>(pixel >> IM_COL32_G_SHIFT);
+				row[x * 3 + 2] = static_cast<uint8_t>(pixel >> IM_COL32_B_SHIFT);
+			}
+
+			fwrite(row.data(), row.size(), 1, file);
+		}
+
+		return fclose(file) == 0;
+	}
+
+	/*
+	@brief
+
+		Finds the first pixel where @a and @b (@width * @height pixels) differ, returns false if there's none
+	*/
+	template <typename T> bool find_difference(const std::vector<T>& a, const std::vector<T>& b, int width, int& x, int& y)
+	{
+		auto difference = std::mismatch(a.begin(), a.end(), b.begin());
+
+		if (difference.first == a.end()) return false;
+
+		auto index = static_cast<int>(difference.first - a.begin());
+
+		x = index % width;
+		y = index / width;
+
+		return true;
+	}
+
+	/*
+	@brief
+
+		Replays every frame through imgui_sw, returns false if --compare found a difference
+	*/
+	bool replay_sw(retrogames::drawdata_player_t& player, const replay_options_t& options, timings_t& timings)
+	{
+		std::vector<uint32_t> pixels, reference_pixels;
+		std::vector<uint16_t> pixels_rgb565, reference_pixels_rgb565;
+
+		// What every frame gets compared against with --compare: the plain path
+		auto reference_options = options.sw_options;
+
+		reference_options.use_simd = false;
+		reference_options.num_threads = 1;
+
+		uint64_t frame_number = 0;
+
+		auto current_atlas = player.get_atlases().size();
+		int width = 0, height = 0;
+
+		for (int r = 0; r < options.repeat; r++)
+		{
+			for (auto frame : player.get_frames())
+			{
+				// Binding isn't part of painting, so keep it out of the timings
+				if (frame->atlas != current_atlas)
+				{
+					if (current_atlas != player.get_atlases().size()) imgui_sw::unbind_imgui_painting();
+
+					current_atlas = frame->atlas;
+
+					load_atlas(player.get_atlases()[current_atlas]);
+
+					imgui_sw::bind_imgui_painting();
+
+					player.set_font_texture(ImGui::GetIO().Fonts->TexID);
+				}
+
+				auto frame_width = static_cast<int>(frame->draw_data.DisplaySize.x);
+				auto frame_height = static_cast<int>(frame->draw_data.DisplaySize.y);
+
+				if (frame_width <= 0 || frame_height <= 0) continue;
+
+				if (frame_width != width || frame_height != height)
+				{
+					width = frame_width;
+					height = frame_height;
+
+					pixels.assign(static_cast<size_t>(width) * height, 0);
+					pixels_rgb565.assign(pixels.size(), 0);
+
+					if (options.compare)
+					{
+						reference_pixels.assign(pixels.size(), 0);
+						reference_pixels_rgb565.assign(pixels.size(), 0);
+					}
+				}
+
+				// imgui_sw scales from ImGui's display size to the pixels it paints
+				ImGui::GetIO().DisplaySize = frame->draw_data.DisplaySize;
+
+				auto start = std::chrono::steady_clock::now();
+
+				if (options.rgb565) imgui_sw::paint_imgui_rgb565(&frame->draw_data, pixels_rgb565.data(), width, height, IM_COL32(40, 40, 40, 255), options.sw_options);
+				else if (options.changes) imgui_sw::paint_imgui_changes(&frame->draw_data, pixels.data(), width, height, IM_COL32(40, 40, 40, 255), options.sw_options);
+				else
+				{
+					// Clearing is part of what a frame costs when everything gets repainted
+					std::fill(pixels.begin(), pixels.end(), IM_COL32(40, 40, 40, 255));
+
+					imgui_sw::paint_imgui(&frame->draw_data, pixels.data(), width, height, options.sw_options);
+				}
+
+				timings.add(milliseconds_since(start));
+
+				frame_number++;
+
+				if (!options.compare) continue;
+
+				int x, y;
+				bool different;
+
+				if (options.rgb565)
+				{
+					imgui_sw::paint_imgui_rgb565(&frame->draw_data, reference_pixels_rgb565.data(), width, height, IM_COL32(40, 40, 40, 255), reference_options);
+
+					different = find_difference(pixels_rgb565, reference_pixels_rgb565, width, x, y);
+				}
+				else
+				{
+					std::fill(reference_pixels.begin(), reference_pixels.end(), IM_COL32(40, 40, 40, 255));
+
+					imgui_sw::paint_imgui(&frame->draw_data, reference_pixels.data(), width, height, reference_options);
+
+					different = find_difference(pixels, reference_pixels, width, x, y);
+				}
+
+				if (different)
+				{
+					auto index = static_cast<size_t>(y) * width + x;
+
+					fprintf(stderr, "Frame %llu differs at %d, %d: 0x%08x, the scalar kernels on one thread paint 0x%08x\n",
+						static_cast<unsigned long long>(frame_number), x, y,
+						options.rgb565 ? pixels_rgb565[index] : pixels[index], options.rgb565 ? reference_pixels_rgb565[index] : reference_pixels[index]);
+
+					if (current_atlas != player.get_atlases().size()) imgui_sw::unbind_imgui_painting();
+
+					return false;
+				}
+			}
+		}
+
+		if (options.compare) printf("Every frame matches the scalar kernels on one thread\n");
+
+		if (!options.dump_path.empty())
+		{
+			if (options.rgb565) fprintf(stderr, "--dump only saves 32-bit frames\n");
+			else if (!save_ppm(options.dump_path, pixels.data(), width, height)) fprintf(stderr, "Couldn't save %s\n", options.dump_path.c_str());
+		}
+
+		if (current_atlas != player.get_atlases().size()) imgui_sw::unbind_imgui_painting();
+
+		return true;
+	}
+
+#ifdef REPLAY_OPENGL
+	/*
+	@brief
+
+		Creates an OpenGL context without a window or display (EGL's surfaceless platform, which
+		Mesa's llvmpipe supports, so the OpenGL backend can be measured on machines without a GPU)
+	*/
+	bool create_headless_context(EGLDisplay& display, EGLContext& context)
+	{
+		auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+		display = get_platform_display != nullptr ? get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr) : eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+		if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr) || !eglBindAPI(EGL_OPENGL_API)) return false;
+
+		context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, nullptr);
+
+		return context != EGL_NO_CONTEXT && eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+	}
+
+	/*
+	@brief
+
+		Replays every frame through the OpenGL3 backend, into an offscreen framebuffer.
+		Frames get timed from the start of rendering until the backend returns (plus glFinish() with --finish)
+	*/
+	bool replay_opengl(retrogames::drawdata_player_t& player, const replay_options_t& options, timings_t& timings)
+	{
+		EGLDisplay display = EGL_NO_DISPLAY;
+		EGLContext context = EGL_NO_CONTEXT;
+
+		if (!create_headless_context(display, context))
+		{
+			fprintf(stderr, "Failed to create an OpenGL context (EGL error 0x%x)\n", eglGetError());
+
+			if (display != EGL_NO_DISPLAY) eglTerminate(display);
+
+			return false;
+		}
+
+		printf("OpenGL: %s, %s\n", reinterpret_cast<const char*>(glGetString(GL_RENDERER)), reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+
+		// The biggest frame decides the framebuffer size
+		int width = 1, height = 1;
+
+		for (auto frame : player.get_frames())
+		{
+			width = std::max(width, static_cast<int>(frame->draw_data.DisplaySize.x * frame->draw_data.FramebufferScale.x));
+			height = std::max(height, static_cast<int>(frame->draw_data.DisplaySize.y * frame->draw_data.FramebufferScale.y));
+		}
+
+		GLuint framebuffer = 0, renderbuffer = 0;
+
+		glGenRenderbuffers(1, &renderbuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+		glGenFramebuffers(1, &framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+
+		ImGui_ImplOpenGL3_SetStreamingMode(options.streaming_mode);
+
+		// Without a NewFrame() the backend never creates its shaders by itself
+		auto success = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE && ImGui_ImplOpenGL3_Init("#version 130") && ImGui_ImplOpenGL3_CreateDeviceObjects();
+
+		if (!success) fprintf(stderr, "Failed to initialize OpenGL\n");
+
+		auto current_atlas = player.get_atlases().size();
+		const retrogames::drawdata_player_t::frame_t* last_frame = nullptr;
+
+		for (int r = 0; r < options.repeat && success; r++)
+		{
+			for (auto frame : player.get_frames())
+			{
+				if (frame->atlas != current_atlas)
+				{
+					current_atlas = frame->atlas;
+
+					load_atlas(player.get_atlases()[current_atlas]);
+
+					// The backend converts the alpha atlas to RGBA itself
+					ImGui_ImplOpenGL3_DestroyFontsTexture();
+					ImGui_ImplOpenGL3_CreateFontsTexture();
+
+					player.set_font_texture(ImGui::GetIO().Fonts->TexID);
+				}
+
+				auto start = std::chrono::steady_clock::now();
+
+				glViewport(0, 0, width, height);
+				glClearColor(40.f / 255.f, 40.f / 255.f, 40.f / 255.f, 1.f);
+				glClear(GL_COLOR_BUFFER_BIT);
+
+				ImGui_ImplOpenGL3_RenderDrawData(const_cast<ImDrawData*>(&frame->draw_data));
+
+				if (options.finish) glFinish();
+
+				timings.add(milliseconds_since(start));
+
+				last_frame = frame;
+			}
+		}
+
+		if (success)
+		{
+			// Whatever is still queued belongs to the total as well
+			auto start = std::chrono::steady_clock::now();
+
+			glFinish();
+
+			timings.total_ms += milliseconds_since(start);
+
+			printf("Streaming mode: %s\n", streaming_mode_name(ImGui_ImplOpenGL3_GetStreamingMode()));
+
+			if (!options.dump_path.empty() && last_frame != nullptr)
+			{
+				auto frame_width = static_cast<int>(last_frame->draw_data.DisplaySize.x * last_frame->draw_data.FramebufferScale.x);
+				auto frame_height = static_cast<int>(last_frame->draw_data.DisplaySize.y * last_frame->draw_data.FramebufferScale.y);
+
+				std::vector<uint32_t> pixels(static_cast<size_t>(frame_width) * frame_height);
+
+				// OpenGL's rows go bottom up, the picture's top row is the framebuffer's last one
+				glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+				for (int y = 0; y < frame_height; y++) glReadPixels(0, height - 1 - y, frame_width, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data() + static_cast<size_t>(y) * frame_width);
+
+				if (!save_ppm(options.dump_path, pixels.data(), frame_width, frame_height)) fprintf(stderr, "Couldn't save %s\n", options.dump_path.c_str());
+			}
+
+			ImGui_ImplOpenGL3_Shutdown();
+		}
+
+		glDeleteFramebuffers(1, &framebuffer);
+		glDeleteRenderbuffers(1, &renderbuffer);
+
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext(display, context);
+		eglTerminate(display);
+
+		return success;
+	}
+#endif
+
+}
+
+/*
+@brief
+
+    Replay tool entry point
+*/
+int main(int argc, char** argv)
+{
+	replay_options_t options;
+
+	if (!parse_options(argc, argv, options)) return 1;
+
+	retrogames::drawdata_player_t player;
+
+	std::string error;
+
+	if (!player.load(options.path, &error))
+	{
+		fprintf(stderr, "%s\n", error.c_str());
+
+		return 1;
+	}
+
+	if (player.get_frames().empty())
+	{
+		fprintf(stderr, "%s doesn't contain any frames\n", options.path.c_str());
+
+		return 1;
+	}
+
+	printf("%zu frames, %zu font atlas(es)", player.get_frames().size(), player.get_atlases().size());
+
+	if (player.get_dropped_commands() != 0) printf(", %llu draw commands with other textures or callbacks skipped", static_cast<unsigned long long>(player.get_dropped_commands()));
+
+	printf("\n");
+
+	// The painters need a context for the font atlas, but no frame ever gets started
+	ImGui::CreateContext();
+
+	timings_t timings;
+
+#ifdef REPLAY_OPENGL
+	if (options.opengl)
+	{
+		if (!replay_opengl(player, options, timings))
+		{
+			ImGui::DestroyContext();
+
+			return 1;
+		}
+	}
+	else
+#endif
+	if (!replay_sw(player, options, timings))
+	{
+		ImGui::DestroyContext();
+
+		return 1;
+	}
+
+	ImGui::DestroyContext();
+
+	if (timings.frames == 0)
+	{
+		fprintf(stderr, "Nothing got painted\n");
+
+		return 1;
+	}
+
+	auto average_ms = timings.total_ms / static_cast<double>(timings.frames);
+
+	printf("%s: %llu frames in %.1f ms, %.3f ms average (min %.3f, max %.3f), %.1f fps\n",
+		options.opengl ? "opengl3" : "imgui_sw", static_cast<unsigned long long>(timings.frames), timings.total_ms, average_ms, timings.min_ms, timings.max_ms, 1000. / average_ms);
+
+	return 0;
+}
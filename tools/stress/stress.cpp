@@ -0,0 +1,204 @@
+/*
+@file
+
+    stress.cpp
+
+@purpose
+
+    Hammers the lock-free handoffs between threads (src/misc/spsc_queue.h and src/misc/triple_buffer.h)
+    from a producer and a consumer thread and checks that nothing gets lost, reordered or torn.
+    Build with 'make stress', which turns on ThreadSanitizer, so data races get reported as well.
+
+@usage
+
+    stress [options]
+
+    --iterations <n>    Items pushed through the queue and snapshots published (default: 1000000)
+*/
+
+#include "misc/spsc_queue.h"
+#include "misc/triple_buffer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+
+	// Queue items and snapshots carry their sequence number in every field, a torn copy mixes two
+	struct item_t final
+	{
+
+		uint64_t sequence;
+
+		uint64_t check;
+
+	};
+
+	struct snapshot_t final
+	{
+
+		uint64_t sequence;
+
+		uint64_t values[32];
+
+	};
+
+	/*
+	@brief
+
+		Pushes @iterations items through a small queue, so it keeps running full and empty.
+		Returns false if the consumer got an item out of order or torn
+	*/
+	bool stress_spsc_queue(uint64_t iterations)
+	{
+		retrogames::spsc_queue_t<item_t, 16> queue;
+
+		std::thread producer([&queue, iterations]()
+		{
+			for (uint64_t i = 0; i < iterations; i++)
+			{
+				while (!queue.push(item_t{ i, ~i })) std::this_thread::yield();
+			}
+		});
+
+		uint64_t expected = 0;
+		auto failed = false;
+
+		while (expected < iterations && !failed)
+		{
+			item_t item;
+
+			if (!queue.pop(item))
+			{
+				std::this_thread::yield();
+
+				continue;
+			}
+
+			if (item.sequence != expected || item.check != ~expected)
+			{
+				fprintf(stderr, "spsc_queue_t: expected item %llu, got %llu (check %llx)\n",
+					static_cast<unsigned long long>(expected), static_cast<unsigned long long>(item.sequence), static_cast<unsigned long long>(item.check));
+
+				failed = true;
+			}
+
+			expected++;
+		}
+
+		// The producer would spin on a full queue forever otherwise
+		if (failed)
+		{
+			item_t item;
+
+			while (expected < iterations) if (queue.pop(item)) expected++;
+		}
+
+		producer.join();
+
+		if (!failed && !queue.empty())
+		{
+			fprintf(stderr, "spsc_queue_t: items left over after popping all of them\n");
+
+			failed = true;
+		}
+
+		if (!failed) printf("spsc_queue_t: %llu items in order\n", static_cast<unsigned long long>(iterations));
+
+		return !failed;
+	}
+
+	/*
+	@brief
+
+		Publishes @iterations snapshots while the reader picks up whatever is newest.
+		Returns false if the reader saw a torn snapshot or went back in time
+	*/
+	bool stress_triple_buffer(uint64_t iterations)
+	{
+		retrogames::triple_buffer_t<snapshot_t> snapshots;
+
+		snapshots.get_front().sequence = 0;
+
+		for (auto& value : snapshots.get_front().values) value = 0;
+
+		std::thread writer([&snapshots, iterations]()
+		{
+			for (uint64_t i = 1; i <= iterations; i++)
+			{
+				auto& back = snapshots.get_back();
+
+				back.sequence = i;
+
+				for (auto& value : back.values) value = i;
+
+				snapshots.publish();
+			}
+		});
+
+		uint64_t last = 0, updates = 0;
+		auto failed = false;
+
+		while (last < iterations && !failed)
+		{
+			if (!snapshots.update())
+			{
+				std::this_thread::yield();
+
+				continue;
+			}
+
+			auto& front = snapshots.get_front();
+
+			for (auto value : front.values) if (value != front.sequence) failed = true;
+
+			if (failed || front.sequence <= last)
+			{
+				fprintf(stderr, "triple_buffer_t: got snapshot %llu after %llu%s\n",
+					static_cast<unsigned long long>(front.sequence), static_cast<unsigned long long>(last), failed ? " (torn)" : "");
+
+				failed = true;
+			}
+
+			last = front.sequence;
+			updates++;
+
+			// The front buffer is the reader's until the next update, writing it must not race the writer
+			front.values[0] = front.sequence;
+		}
+
+		writer.join();
+
+		if (!failed) printf("triple_buffer_t: %llu snapshots published, %llu picked up in order\n",
+			static_cast<unsigned long long>(iterations), static_cast<unsigned long long>(updates));
+
+		return !failed;
+	}
+
+}
+
+int main(int argc, char** argv)
+{
+	uint64_t iterations = 1000000;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) iterations = strtoull(argv[++i], nullptr, 10);
+		else
+		{
+			fprintf(stderr, "Usage: stress [--iterations n]\n");
+
+			return 2;
+		}
+	}
+
+	if (iterations == 0) iterations = 1;
+
+	auto success = stress_spsc_queue(iterations);
+
+	success = stress_triple_buffer(iterations) && success;
+
+	return success ? 0 : 1;
+}